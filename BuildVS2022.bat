@@ -51,6 +51,7 @@ echo Compiling with Visual Studio 2022...
 cl /EHsc /MD /O2 /W3 /DWIN32 /D_WINDOWS /DNDEBUG ^
     /I"%FFMPEG_DIR%\include" ^
     "%SRC_DIR%\main.cpp" "%SRC_DIR%\VideoPlayer.cpp" "%SRC_DIR%\AudioPlayer.cpp" "%SRC_DIR%\ProgressBar.cpp" "%SRC_DIR%\ControlPanel.cpp" ^
+    "%SRC_DIR%\AudioRingBuffer.cpp" "%SRC_DIR%\AudioClock.cpp" "%SRC_DIR%\TimeStretcher.cpp" "%SRC_DIR%\AudioDSP.cpp" "%SRC_DIR%\YuvConvert.cpp" "%SRC_DIR%\D3D9YuvRenderer.cpp" "%SRC_DIR%\FrameMailbox.cpp" "%SRC_DIR%\SoftwareScaler.cpp" "%SRC_DIR%\DisplayPipeline.cpp" "%SRC_DIR%\OffscreenRenderer.cpp" "%SRC_DIR%\FrameStats.cpp" "%SRC_DIR%\FrameStatsOverlay.cpp" "%SRC_DIR%\WorkStealingPool.cpp" "%SRC_DIR%\GridPlayer.cpp" "%SRC_DIR%\StartupTrace.cpp" "%SRC_DIR%\MediaIO.cpp" "%SRC_DIR%\PrefetchCache.cpp" "%SRC_DIR%\MemoryBudget.cpp" "%SRC_DIR%\FramePool.cpp" "%SRC_DIR%\PlayerMetrics.cpp" ^
     /Fe:"%BUILD_DIR%\VideoPlayer.exe" ^    /link ^
     /LIBPATH:"%FFMPEG_DIR%\lib" ^
     avformat.lib avcodec.lib avutil.lib swscale.lib swresample.lib ^
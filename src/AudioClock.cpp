@@ -0,0 +1,190 @@
+#include "AudioClock.h"
+#include <cmath>
+#include <algorithm>
+
+AudioClock::AudioClock()
+    : m_hasSample(false)
+    , m_running(false)
+    , m_sampleMedia(0.0)
+    , m_sampleTime(0.0)
+    , m_rate(0.0)
+    , m_heldMedia(0.0)
+    , m_sampleRate(44100.0)
+    , m_lastPosition(0.0)
+    , m_driftValid(false)
+    , m_driftStartPosition(0.0)
+    , m_driftStartTime(0.0)
+    , m_driftPpm(0.0)
+    , m_driftSeconds(0.0)
+    , m_errorSum(0.0)
+    , m_errorMax(0.0)
+    , m_sampleCount(0)
+{
+}
+
+void AudioClock::SetSampleRate(double framesPerSecond)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_sampleRate = framesPerSecond;
+}
+
+void AudioClock::Reset(double mediaTime)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_segments.clear();
+    m_hasSample = false;
+    m_rate = 0.0;
+    m_heldMedia = mediaTime;
+}
+
+void AudioClock::QueueSegment(uint64_t deviceFrame, double mediaTime, uint32_t frames, double mediaDuration)
+{
+    if (frames == 0)
+        return;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_segments.push_back({ deviceFrame, frames, mediaTime, mediaDuration });
+}
+
+double AudioClock::MapPosition(double deviceFrame, double& rate) const
+{
+    rate = 0.0;
+    if (m_segments.empty())
+        return m_heldMedia;
+
+    for (const Segment& seg : m_segments)
+    {
+        double start = (double)seg.deviceFrame;
+        double end = start + seg.frames;
+
+        // 位置落在两段之间（设备在播放静音）：停在下一段的起点
+        if (deviceFrame < start)
+            return seg.mediaTime;
+
+        if (deviceFrame < end)
+        {
+            double mediaPerFrame = seg.mediaDuration / seg.frames;
+            rate = mediaPerFrame * m_sampleRate;
+            return seg.mediaTime + (deviceFrame - start) * mediaPerFrame;
+        }
+    }
+
+    // 超出已提交的数据（欠载）：停在最后一段的终点
+    const Segment& last = m_segments.back();
+    return last.mediaTime + last.mediaDuration;
+}
+
+void AudioClock::UpdatePosition(double deviceFrame, double timestamp)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // 设备位置回退说明 IAudioClient 被重置, 重新开始漂移统计
+    if (deviceFrame < m_lastPosition)
+    {
+        m_driftValid = false;
+    }
+    m_lastPosition = deviceFrame;
+
+    double rate = 0.0;
+    double media = MapPosition(deviceFrame, rate);
+
+    // 统计外推误差（上一次采样外推到本次采样时刻的误差）
+    if (m_hasSample && m_running && rate > 0.0 && m_rate > 0.0)
+    {
+        double error = fabs(media - ExtrapolateLocked(timestamp));
+        m_errorSum += error;
+        m_errorMax = (std::max)(m_errorMax, error);
+        m_sampleCount++;
+    }
+
+    m_sampleMedia = media;
+    m_sampleTime = timestamp;
+    m_rate = rate;
+    m_hasSample = true;
+
+    // 丢弃已经播放完毕的段, 保留最后一段用于欠载时保持时钟
+    while (m_segments.size() > 1 &&
+           (double)(m_segments.front().deviceFrame + m_segments.front().frames) <= deviceFrame)
+    {
+        m_segments.pop_front();
+    }
+
+    // 设备时钟漂移：设备帧位置推进的时间与单调时钟推进的时间之差
+    if (m_running)
+    {
+        if (!m_driftValid)
+        {
+            m_driftValid = true;
+            m_driftStartPosition = deviceFrame;
+            m_driftStartTime = timestamp;
+        }
+        else
+        {
+            double wallElapsed = timestamp - m_driftStartTime;
+            if (wallElapsed > 1.0)
+            {
+                double deviceElapsed = (deviceFrame - m_driftStartPosition) / m_sampleRate;
+                m_driftPpm = (deviceElapsed - wallElapsed) / wallElapsed * 1e6;
+                m_driftSeconds = wallElapsed;
+            }
+        }
+    }
+}
+
+void AudioClock::SetRunning(bool running, double now)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (running == m_running)
+        return;
+
+    if (m_hasSample)
+    {
+        if (!running)
+        {
+            // 冻结在暂停时刻的值
+            m_sampleMedia = ExtrapolateLocked(now);
+        }
+        m_sampleTime = now;
+    }
+
+    m_running = running;
+    m_driftValid = false;
+}
+
+double AudioClock::ExtrapolateLocked(double now) const
+{
+    if (!m_hasSample)
+        return m_heldMedia;
+
+    if (!m_running || m_rate <= 0.0)
+        return m_sampleMedia;
+
+    double media = m_sampleMedia + (now - m_sampleTime) * m_rate;
+
+    // 不能超过已提交给设备的数据
+    if (!m_segments.empty())
+    {
+        const Segment& last = m_segments.back();
+        media = (std::min)(media, last.mediaTime + last.mediaDuration);
+    }
+    return media;
+}
+
+double AudioClock::Get(double now) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return ExtrapolateLocked(now);
+}
+
+AudioClockStats AudioClock::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    AudioClockStats stats;
+    stats.driftPpm = m_driftPpm;
+    stats.observedSeconds = m_driftSeconds;
+    stats.meanPredictionError = m_sampleCount > 0 ? m_errorSum / m_sampleCount : 0.0;
+    stats.maxPredictionError = m_errorMax;
+    stats.sampleCount = m_sampleCount;
+    return stats;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <cstdint>
+
+// 音频时钟漂移统计
+struct AudioClockStats {
+    double driftPpm;                // 设备时钟相对系统单调时钟的漂移（百万分之一）
+    double observedSeconds;         // 漂移统计覆盖的连续播放时长
+    double meanPredictionError;     // 外推值与设备采样值之间的平均误差（秒）
+    double maxPredictionError;      // 最大误差（秒）
+    uint64_t sampleCount;           // 设备位置采样次数
+};
+
+// 基于设备播放位置的音频时钟
+// 渲染线程登记"设备帧区间 -> 媒体时间"的映射并定期提交设备位置采样,
+// 任意线程可以在两次采样之间用单调时钟外推出当前正在播放的媒体时间
+// 时间参数统一为秒, 由调用方提供同一单调时钟（Windows 下为 QPC）
+class AudioClock {
+public:
+    AudioClock();
+
+    // 设备采样率（帧/秒）
+    void SetSampleRate(double framesPerSecond);
+
+    // 重置映射（跳转、停止、设备重建时调用）, 在新数据播放前时钟保持为 mediaTime
+    void Reset(double mediaTime);
+
+    // 登记一段已提交给设备的音频: 从设备帧 deviceFrame 开始的 frames 帧对应
+    // 媒体时间 [mediaTime, mediaTime + mediaDuration)
+    void QueueSegment(uint64_t deviceFrame, double mediaTime, uint32_t frames, double mediaDuration);
+
+    // 提交一次设备位置采样（设备帧位置与对应的单调时钟时间）
+    void UpdatePosition(double deviceFrame, double timestamp);
+
+    // 暂停/恢复外推（设备停止时位置不再前进）
+    void SetRunning(bool running, double now);
+
+    // 查询当前媒体时间（线程安全）
+    double Get(double now) const;
+
+    AudioClockStats GetStats() const;
+
+private:
+    struct Segment {
+        uint64_t deviceFrame;
+        uint32_t frames;
+        double mediaTime;
+        double mediaDuration;
+    };
+
+    double MapPosition(double deviceFrame, double& rate) const;
+    double ExtrapolateLocked(double now) const;
+
+    std::deque<Segment> m_segments;
+    bool m_hasSample;           // 是否已有有效的位置采样
+    bool m_running;
+    double m_sampleMedia;       // 最近一次采样对应的媒体时间
+    double m_sampleTime;        // 最近一次采样的单调时钟时间
+    double m_rate;              // 媒体时间相对真实时间的速率（变速播放时不为 1）
+    double m_heldMedia;         // 没有采样时返回的媒体时间
+    double m_sampleRate;
+    double m_lastPosition;      // 最近一次采样的设备帧位置
+
+    // 漂移统计（基于设备帧位置, 不受跳转和同步补偿影响）
+    bool m_driftValid;
+    double m_driftStartPosition;
+    double m_driftStartTime;
+    double m_driftPpm;
+    double m_driftSeconds;
+    double m_errorSum;
+    double m_errorMax;
+    uint64_t m_sampleCount;
+
+    mutable std::mutex m_mutex;
+};
@@ -0,0 +1,174 @@
+#include "AudioDSP.h"
+#include <cmath>
+#include <algorithm>
+#include <emmintrin.h>
+
+AudioDSP::AudioDSP()
+    : m_volume(1.0f)
+    , m_streamGain(1.0f)
+    , m_limiterEnabled(true)
+    , m_currentGain(1.0f)
+    , m_targetGain(1.0f)
+    , m_rampStep(0.0f)
+    , m_rampRemaining(0)
+    , m_rampFrames(441)
+    , m_limiterThreshold(0.89f)    // 约 -1 dBFS 开始压缩
+{
+}
+
+void AudioDSP::Configure(int sampleRate)
+{
+    // 增益变化在 10ms 内线性渐变
+    m_rampFrames = (std::max)(1, sampleRate / 100);
+}
+
+void AudioDSP::SetVolume(float volume)
+{
+    m_volume = (std::max)(0.0f, (std::min)(1.0f, volume));
+}
+
+void AudioDSP::SetStreamGainDb(float gainDb)
+{
+    m_streamGain = powf(10.0f, gainDb / 20.0f);
+}
+
+void AudioDSP::Process(float* left, float* right, int frames)
+{
+    if (frames <= 0)
+        return;
+
+    // 目标变化时从当前增益重新开始一段 m_rampFrames 帧的线性渐变, 步长只在这里计算,
+    // 渐变跨越多个处理块时每块沿同一条直线继续
+    float target = m_volume * m_streamGain;
+    if (target != m_targetGain)
+    {
+        m_targetGain = target;
+        m_rampStep = (target - m_currentGain) / m_rampFrames;
+        m_rampRemaining = m_rampFrames;
+    }
+
+    if (m_rampRemaining > 0)
+    {
+        // 渐变部分之后使用恒定增益
+        int rampCount = (std::min)(frames, m_rampRemaining);
+        ApplyGainRamp(left, rampCount, m_currentGain, m_rampStep);
+        if (right)
+            ApplyGainRamp(right, rampCount, m_currentGain, m_rampStep);
+
+        m_rampRemaining -= rampCount;
+        m_currentGain = (m_rampRemaining == 0) ? m_targetGain : m_currentGain + m_rampStep * rampCount;
+
+        ApplyGain(left + rampCount, frames - rampCount, m_currentGain);
+        if (right)
+            ApplyGain(right + rampCount, frames - rampCount, m_currentGain);
+    }
+    else if (m_currentGain != 1.0f)
+    {
+        ApplyGain(left, frames, m_currentGain);
+        if (right)
+            ApplyGain(right, frames, m_currentGain);
+    }
+
+    if (m_limiterEnabled)
+    {
+        SoftLimit(left, frames, m_limiterThreshold);
+        if (right)
+            SoftLimit(right, frames, m_limiterThreshold);
+    }
+}
+
+void AudioDSP::ApplyGain(float* buffer, int count, float gain)
+{
+    int i = 0;
+    __m128 g = _mm_set1_ps(gain);
+    for (; i + 4 <= count; i += 4)
+    {
+        _mm_storeu_ps(buffer + i, _mm_mul_ps(_mm_loadu_ps(buffer + i), g));
+    }
+    for (; i < count; i++)
+    {
+        buffer[i] *= gain;
+    }
+}
+
+void AudioDSP::ApplyGainRamp(float* buffer, int count, float startGain, float step)
+{
+    int i = 0;
+    __m128 g = _mm_setr_ps(startGain, startGain + step, startGain + 2 * step, startGain + 3 * step);
+    __m128 g4 = _mm_set1_ps(step * 4);
+    for (; i + 4 <= count; i += 4)
+    {
+        _mm_storeu_ps(buffer + i, _mm_mul_ps(_mm_loadu_ps(buffer + i), g));
+        g = _mm_add_ps(g, g4);
+    }
+    for (; i < count; i++)
+    {
+        buffer[i] *= startGain + step * i;
+    }
+}
+
+void AudioDSP::MixInto(float* dst, const float* src, int count, float gain)
+{
+    int i = 0;
+    __m128 g = _mm_set1_ps(gain);
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 mixed = _mm_add_ps(_mm_loadu_ps(dst + i), _mm_mul_ps(_mm_loadu_ps(src + i), g));
+        _mm_storeu_ps(dst + i, mixed);
+    }
+    for (; i < count; i++)
+    {
+        dst[i] += src[i] * gain;
+    }
+}
+
+// 软限幅：阈值以下保持线性, 超出部分用 tanh 有理近似压缩到 [threshold, 1.0)
+// tanh(z) ≈ z * (27 + z²) / (27 + 9z²), z 限制在 [0, 3]
+static inline float SoftLimitScalar(float x, float threshold)
+{
+    float a = fabsf(x);
+    if (a <= threshold)
+        return x;
+
+    float knee = 1.0f - threshold;
+    float z = (std::min)((a - threshold) / knee, 3.0f);
+    float z2 = z * z;
+    float limited = threshold + knee * (z * (27.0f + z2) / (27.0f + 9.0f * z2));
+    return x < 0.0f ? -limited : limited;
+}
+
+void AudioDSP::SoftLimit(float* buffer, int count, float threshold)
+{
+    int i = 0;
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    const __m128 t = _mm_set1_ps(threshold);
+    const __m128 knee = _mm_set1_ps(1.0f - threshold);
+    const __m128 invKnee = _mm_set1_ps(1.0f / (1.0f - threshold));
+    const __m128 three = _mm_set1_ps(3.0f);
+    const __m128 c27 = _mm_set1_ps(27.0f);
+    const __m128 c9 = _mm_set1_ps(9.0f);
+
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 x = _mm_loadu_ps(buffer + i);
+        __m128 sign = _mm_and_ps(x, signMask);
+        __m128 a = _mm_andnot_ps(signMask, x);
+        __m128 over = _mm_cmpgt_ps(a, t);
+
+        // 整组都在阈值以下时跳过（常见情况）
+        if (_mm_movemask_ps(over) == 0)
+            continue;
+
+        __m128 z = _mm_min_ps(_mm_mul_ps(_mm_sub_ps(a, t), invKnee), three);
+        __m128 z2 = _mm_mul_ps(z, z);
+        __m128 th = _mm_div_ps(_mm_mul_ps(z, _mm_add_ps(c27, z2)), _mm_add_ps(c27, _mm_mul_ps(c9, z2)));
+        __m128 limited = _mm_add_ps(t, _mm_mul_ps(knee, th));
+
+        __m128 result = _mm_or_ps(_mm_and_ps(over, limited), _mm_andnot_ps(over, a));
+        _mm_storeu_ps(buffer + i, _mm_or_ps(result, sign));
+    }
+    for (; i < count; i++)
+    {
+        buffer[i] = SoftLimitScalar(buffer[i], threshold);
+    }
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <atomic>
+
+// 软件音频处理级 - 位于重采样之后、写入环形缓冲区之前
+// 负责音量/流增益（带平滑渐变, 拖动音量滑块时无拉链噪声）和软限幅器
+// 内核函数使用 SSE2 向量化, 尾部样本用标量处理
+class AudioDSP {
+public:
+    AudioDSP();
+
+    void Configure(int sampleRate);
+
+    // 用户音量 (0.0 - 1.0), 可在任意线程调用, 由处理线程渐变到目标值
+    void SetVolume(float volume);
+
+    // 流增益（如 ReplayGain）, 单位 dB
+    void SetStreamGainDb(float gainDb);
+
+    void SetLimiterEnabled(bool enabled) { m_limiterEnabled = enabled; }
+
+    // 原地处理平面立体声数据, right 为空时按单声道处理
+    void Process(float* left, float* right, int frames);
+
+    // 向量化内核（也供软件混音使用）
+    static void ApplyGain(float* buffer, int count, float gain);
+    static void ApplyGainRamp(float* buffer, int count, float startGain, float step);
+    static void MixInto(float* dst, const float* src, int count, float gain);
+    static void SoftLimit(float* buffer, int count, float threshold);
+
+private:
+    std::atomic<float> m_volume;
+    std::atomic<float> m_streamGain;    // 线性增益
+    std::atomic<bool> m_limiterEnabled;
+    float m_currentGain;                // 当前实际增益（处理线程）
+    float m_targetGain;                 // 正在渐变到的增益
+    float m_rampStep;                   // 每帧增益变化, 目标变化时计算一次
+    int m_rampRemaining;                // 渐变剩余帧数, 可跨越多个处理块
+    int m_rampFrames;                   // 增益渐变长度
+    float m_limiterThreshold;
+};
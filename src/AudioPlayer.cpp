@@ -1,12 +1,46 @@
 #include "AudioPlayer.h"
+#include "StartupTrace.h"
+#include "PlayerMetrics.h"
 #include <iostream>
 #include <cmath>
 #include <algorithm>
+#include <cstdlib>
+#include <avrt.h>
 
 // 定义常量
 const double AudioPlayer::AV_NOSYNC_THRESHOLD = 10.0;
 const int AudioPlayer::AUDIO_DIFF_AVG_NB = 20;
 const int AudioPlayer::SAMPLE_CORRECTION_PERCENT_MAX = 10;
+const int AudioPlayer::LOOP_CROSSFADE_MS = 20;
+
+// 延迟档位参数：设备缓冲区时长 / 软件环形缓冲区时长（毫秒）
+// 环形缓冲区需要容纳容器中音视频交织造成的突发写入, 因此比设备缓冲区大得多;
+// 跳转和停止时会清空环形缓冲区, 所以它不会影响暂停/跳转的响应速度
+struct LatencyProfileInfo {
+    const char* name;
+    int deviceBufferMs;
+    int ringBufferMs;
+};
+
+static const LatencyProfileInfo& GetLatencyProfileInfo(LatencyProfile profile)
+{
+    static const LatencyProfileInfo profiles[] = {
+        { "10ms",  10,  100 },
+        { "20ms",  20,  150 },
+        { "50ms",  50,  250 },
+        { "200ms", 200, 1000 }
+    };
+    return profiles[(int)profile];
+}
+
+// 单调时钟（秒）, 与 IAudioClock::GetPosition 返回的 QPC 时间戳同源
+static double QpcNowSeconds()
+{
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart / frequency.QuadPart;
+}
 
 AudioPlayer::AudioPlayer(WORD nChannels, DWORD nSamplesPerSec)
     : m_nChannels(nChannels)
@@ -14,16 +48,34 @@ AudioPlayer::AudioPlayer(WORD nChannels, DWORD nSamplesPerSec)
     , m_maxSampleCount(0)
     , m_pwfx(nullptr)
     , m_flags(0)
+    , m_comInitialized(false)
+    , m_latencyProfile(LatencyProfile::NORMAL)
+    , m_hRefillEvent(nullptr)
+    , m_hSpaceEvent(nullptr)
+    , m_hShutdownEvent(nullptr)
+    , m_renderThread(nullptr)
+    , m_underrunCount(0)
+    , m_submittedFrames(0)
+    , m_deviceClockFrequency(0)
     , m_audioCodecContext(nullptr)
     , m_audioCodec(nullptr)
     , m_swrContext(nullptr)
+    , m_audioTimeBase{ 1, 1 }
     , m_audioStreamIndex(-1)    , m_isInitialized(false)
     , m_isPlaying(false)
+    , m_isStopped(true)
     , m_volume(1.0f)
     , m_audioOffset(0.0)
+    , m_playbackSpeed(1.0)
+    , m_stretcherResetPending(false)
+    , m_loopEndPts(NAN)
+    , m_tailFrames(0)
+    , m_crossfadePending(false)
+    , m_crossfadePos(0)
     , m_videoClock(0.0)
+    , m_audioMaster(false)
     , m_audioClock(0.0)
-    , m_audioWriteTime(0.0)
+    , m_lastClockReport(0.0)
     , m_audioDiffCum(0.0)
     , m_audioDiffAvgCoef(0.0)
     , m_audioDiffAvgCount(0)
@@ -31,20 +83,35 @@ AudioPlayer::AudioPlayer(WORD nChannels, DWORD nSamplesPerSec)
     , m_bufferFrameCount(0)
     , m_audioHwBufSize(0)
 {
-    // 初始化COM
-    CoInitialize(nullptr);
-    
     // 计算加权平均系数 (公比q)
     // audio_diff_avg_coef = exp(log(0.01) / AUDIO_DIFF_AVG_NB)
     m_audioDiffAvgCoef = exp(log(0.01) / AUDIO_DIFF_AVG_NB); // ≈ 0.79432
     
-    InitWASAPI();
+    m_timeStretcher.Configure(m_nSamplesPerSec);
+    m_dsp.Configure(m_nSamplesPerSec);
+    m_tailLeft.resize(m_nSamplesPerSec * LOOP_CROSSFADE_MS / 1000);
+    m_tailRight.resize(m_tailLeft.size());
+    
+    // 事件驱动填充所需的事件对象
+    m_hRefillEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    m_hSpaceEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    m_hShutdownEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+    
+    // WASAPI 设备在第一次打开带音频的文件时才初始化（见 EnsureDevice）
 }
 
 AudioPlayer::~AudioPlayer()
 {
     CleanupAudio();
-    CoUninitialize();
+    
+    if (m_hRefillEvent) CloseHandle(m_hRefillEvent);
+    if (m_hSpaceEvent) CloseHandle(m_hSpaceEvent);
+    if (m_hShutdownEvent) CloseHandle(m_hShutdownEvent);
+    
+    if (m_comInitialized)
+    {
+        CoUninitialize();
+    }
 }
 
 bool AudioPlayer::Initialize(AVFormatContext* formatContext)
@@ -52,11 +119,79 @@ bool AudioPlayer::Initialize(AVFormatContext* formatContext)
     if (!formatContext)
         return false;
     
-    return SetupAudioDecoder(formatContext);
+    if (!SetupAudioDecoder(formatContext))
+    {
+        ReleaseDecoder();
+        return false;
+    }
+    
+    // 没有音频流的文件不会走到这里, 也就不会打开音频设备
+    if (FAILED(EnsureDevice()))
+    {
+        ReleaseDecoder();
+        return false;
+    }
+    return true;
+}
+
+void AudioPlayer::Close()
+{
+    if (m_pAudioClient)
+    {
+        // 设备保持打开, 只清空上一个文件残留在设备缓冲区和环形缓冲区中的样本
+        Stop();
+
+        // Reset 把设备位置清零, 已提交帧数和时钟映射要一起归零, 否则下一个文件的段登记在旧的偏移上,
+        // 时钟一直停在段起点; 渲染线程可能正在填充, 在 m_refillMutex 下进行
+        std::lock_guard<std::mutex> lock(m_refillMutex);
+        m_pAudioClient->Reset();
+        m_submittedFrames = 0;
+        m_clock.Reset(0.0);
+    }
+    ReleaseDecoder();
+}
+
+HRESULT AudioPlayer::EnsureDevice()
+{
+    if (m_pAudioClient)
+        return S_OK;
+    
+    if (!m_comInitialized)
+    {
+        HRESULT hr = CoInitialize(nullptr);
+        m_comInitialized = SUCCEEDED(hr);   // S_FALSE 同样需要配对的 CoUninitialize
+    }
+    
+    StartupTraceScope trace("InitWASAPI");
+    HRESULT hr = InitWASAPI();
+    if (FAILED(hr))
+    {
+        // 释放初始化到一半的客户端, 下一次打开文件时重试
+        ReleaseWASAPI();
+    }
+    return hr;
+}
+
+void AudioPlayer::ReleaseDecoder()
+{
+    if (m_swrContext)
+    {
+        swr_free(&m_swrContext);
+    }
+    if (m_audioCodecContext)
+    {
+        avcodec_free_context(&m_audioCodecContext);
+    }
+    m_audioCodec = nullptr;
+    m_audioStreamIndex = -1;
+    m_isInitialized = false;
 }
 
 bool AudioPlayer::SetupAudioDecoder(AVFormatContext* formatContext)
 {
+    // 重新初始化（打开新文件、宫格切换焦点）时先释放上一路的解码器和重采样器
+    ReleaseDecoder();
+    
     // 查找音频流
     for (unsigned int i = 0; i < formatContext->nb_streams; i++)
     {
@@ -77,6 +212,21 @@ bool AudioPlayer::SetupAudioDecoder(AVFormatContext* formatContext)
     
     // 获取音频解码器参数
     AVCodecParameters* codecPar = formatContext->streams[m_audioStreamIndex]->codecpar;
+    m_audioTimeBase = formatContext->streams[m_audioStreamIndex]->time_base;
+    
+    // 读取 ReplayGain 标签作为流增益（流元数据优先, 其次容器元数据）
+    const AVDictionaryEntry* replayGain = av_dict_get(formatContext->streams[m_audioStreamIndex]->metadata,
+                                                      "REPLAYGAIN_TRACK_GAIN", nullptr, 0);
+    if (!replayGain)
+    {
+        replayGain = av_dict_get(formatContext->metadata, "REPLAYGAIN_TRACK_GAIN", nullptr, 0);
+    }
+    float streamGainDb = replayGain ? (float)atof(replayGain->value) : 0.0f;
+    m_dsp.SetStreamGainDb(streamGainDb);
+    if (replayGain)
+    {
+        std::cout << "ReplayGain: " << streamGainDb << " dB" << std::endl;
+    }
     
     // 查找音频解码器
     m_audioCodec = avcodec_find_decoder(codecPar->codec_id);
@@ -102,7 +252,10 @@ bool AudioPlayer::SetupAudioDecoder(AVFormatContext* formatContext)
     }
     
     // 打开音频解码器
-    if (avcodec_open2(m_audioCodecContext, m_audioCodec, nullptr) < 0)
+    double openStartMs = StartupTrace::Instance().NowMs();
+    int openResult = avcodec_open2(m_audioCodecContext, m_audioCodec, nullptr);
+    StartupTrace::Instance().Complete("avcodec_open2 (audio)", openStartMs, StartupTrace::Instance().NowMs());
+    if (openResult < 0)
     {
         std::cerr << "Failed to open audio codec" << std::endl;
         return false;
@@ -137,15 +290,17 @@ bool AudioPlayer::SetupAudioDecoder(AVFormatContext* formatContext)
         return false;
     }
     
-    // WASAPI已在构造函数中初始化
     m_isInitialized = true;
-    std::cout << "Audio player initialized successfully with WASAPI" << std::endl;
+    std::cout << "Audio decoder initialized" << std::endl;
     return true;
 }
 
 HRESULT AudioPlayer::InitWASAPI()
 {
-    constexpr auto REFTIMES_PER_SEC = 10000000; // 1秒的缓冲区
+    constexpr REFERENCE_TIME REFTIMES_PER_MS = 10000; // 1毫秒 (100ns 单位)
+
+    const LatencyProfileInfo& profile = GetLatencyProfileInfo(m_latencyProfile);
+    REFERENCE_TIME bufferDuration = profile.deviceBufferMs * REFTIMES_PER_MS;
 
     HRESULT hr;
 
@@ -170,21 +325,6 @@ HRESULT AudioPlayer::InitWASAPI()
         return hr;
     }
 
-    // 获取音频会话管理器和音量控制
-    CComPtr<IAudioSessionManager> pAudioSessionManager;
-    hr = m_pDevice->Activate(__uuidof(IAudioSessionManager), CLSCTX_INPROC_SERVER,
-                            NULL, (void**)&pAudioSessionManager);
-    if (FAILED(hr)) {
-        std::cerr << "Failed to get audio session manager" << std::endl;
-        return hr;
-    }
-
-    hr = pAudioSessionManager->GetSimpleAudioVolume(&GUID_NULL, 0, &m_pSimpleAudioVolume);
-    if (FAILED(hr)) {
-        std::cerr << "Failed to get simple audio volume" << std::endl;
-        return hr;
-    }
-
     // 获取混合格式
     hr = m_pAudioClient->GetMixFormat(&m_pwfx);
     if (FAILED(hr)) {
@@ -198,18 +338,26 @@ HRESULT AudioPlayer::InitWASAPI()
     m_pwfx->nAvgBytesPerSec = m_pwfx->nSamplesPerSec * m_nChannels * (m_pwfx->wBitsPerSample / 8);
     m_pwfx->wFormatTag = WAVE_FORMAT_EXTENSIBLE;
 
-    // 初始化音频客户端
+    // 初始化音频客户端 - 事件回调模式, 由设备按周期通知填充
     hr = m_pAudioClient->Initialize(
         AUDCLNT_SHAREMODE_SHARED,
-        AUDCLNT_STREAMFLAGS_AUTOCONVERTPCM | AUDCLNT_STREAMFLAGS_SRC_DEFAULT_QUALITY,
-        REFTIMES_PER_SEC,
+        AUDCLNT_STREAMFLAGS_EVENTCALLBACK | AUDCLNT_STREAMFLAGS_AUTOCONVERTPCM | AUDCLNT_STREAMFLAGS_SRC_DEFAULT_QUALITY,
+        bufferDuration,
         0,
         m_pwfx,
         NULL);
     if (FAILED(hr)) {
         std::cerr << "Failed to initialize audio client" << std::endl;
         return hr;
-    }    // 获取渲染客户端
+    }
+
+    hr = m_pAudioClient->SetEventHandle(m_hRefillEvent);
+    if (FAILED(hr)) {
+        std::cerr << "Failed to set audio event handle" << std::endl;
+        return hr;
+    }
+
+    // 获取渲染客户端
     hr = m_pAudioClient->GetService(__uuidof(IAudioRenderClient), (void**)&m_pRenderClient);
     if (FAILED(hr)) {
         std::cerr << "Failed to get render client" << std::endl;
@@ -223,6 +371,15 @@ HRESULT AudioPlayer::InitWASAPI()
         return hr;
     }
     
+    // 获取设备时钟（播放位置）
+    hr = m_pAudioClient->GetService(__uuidof(IAudioClock), (void**)&m_pDeviceClock);
+    if (FAILED(hr) || FAILED(m_pDeviceClock->GetFrequency(&m_deviceClockFrequency))) {
+        std::cerr << "Failed to get audio clock" << std::endl;
+        return FAILED(hr) ? hr : E_FAIL;
+    }
+    m_submittedFrames = 0;
+    m_clock.SetSampleRate(m_nSamplesPerSec);
+
     // 计算硬件缓冲区大小（字节）
     m_audioHwBufSize = m_bufferFrameCount * m_pwfx->nChannels * (m_pwfx->wBitsPerSample / 8);
     
@@ -230,15 +387,283 @@ HRESULT AudioPlayer::InitWASAPI()
     m_audioDiffThreshold = (double)m_audioHwBufSize / (m_pwfx->nSamplesPerSec * m_pwfx->nChannels * (m_pwfx->wBitsPerSample / 8));
     
     std::cout << "Audio buffer size: " << m_bufferFrameCount << " frames" << std::endl;
-    std::cout << "Audio diff threshold: " << m_audioDiffThreshold << " seconds" << std::endl;
+    std::cout << "Audio diff threshold: " << m_audioDiffThreshold.load() << " seconds" << std::endl;
 
-    m_maxSampleCount = m_pwfx->nSamplesPerSec;
+    // 软件环形缓冲区
+    m_maxSampleCount = profile.ringBufferMs * (int)m_nSamplesPerSec / 1000;
+    m_ringBuffer.Allocate(m_maxSampleCount, m_nChannels, m_nSamplesPerSec);
     m_flags = 0;
+    m_underrunCount = 0;
+
+    // 延迟测量：设备周期、流延迟、设备缓冲区和环形缓冲区
+    REFERENCE_TIME defaultPeriod = 0, minimumPeriod = 0, streamLatency = 0;
+    m_pAudioClient->GetDevicePeriod(&defaultPeriod, &minimumPeriod);
+    m_pAudioClient->GetStreamLatency(&streamLatency);
+    double deviceBufferMs = 1000.0 * m_bufferFrameCount / m_nSamplesPerSec;
+    std::cout << "Latency profile " << profile.name
+              << ": device period " << defaultPeriod / (double)REFTIMES_PER_MS << "ms"
+              << " (min " << minimumPeriod / (double)REFTIMES_PER_MS << "ms)"
+              << ", stream latency " << streamLatency / (double)REFTIMES_PER_MS << "ms"
+              << ", device buffer " << deviceBufferMs << "ms"
+              << ", ring " << profile.ringBufferMs << "ms" << std::endl;
+
+    // 启动事件驱动的渲染线程
+    ResetEvent(m_hShutdownEvent);
+    m_renderThread = CreateThread(nullptr, 0, RenderThreadProc, this, 0, nullptr);
 
     std::cout << "WASAPI initialized successfully" << std::endl;
     return hr;
 }
 
+void AudioPlayer::ReleaseWASAPI()
+{
+    // 先停止渲染线程, 它会访问渲染客户端
+    if (m_renderThread)
+    {
+        SetEvent(m_hShutdownEvent);
+        WaitForSingleObject(m_renderThread, 2000);
+        CloseHandle(m_renderThread);
+        m_renderThread = nullptr;
+    }
+
+    if (m_pAudioClient)
+    {
+        m_pAudioClient->Stop();
+        m_pAudioClient->Reset();
+    }
+
+    if (m_underrunCount > 0)
+    {
+        std::cout << "Audio underruns: " << m_underrunCount << std::endl;
+    }
+
+    AudioClockStats stats = m_clock.GetStats();
+    if (stats.sampleCount > 0)
+    {
+        std::cout << "Audio clock: drift " << stats.driftPpm << "ppm over " << stats.observedSeconds << "s"
+                  << ", prediction error mean " << stats.meanPredictionError * 1000.0 << "ms"
+                  << " max " << stats.maxPredictionError * 1000.0 << "ms" << std::endl;
+    }
+
+    // 释放WASAPI资源
+    m_pDeviceClock.Release();
+    m_pRenderClient.Release();
+    m_pAudioClient.Release();
+    m_pDevice.Release();
+    m_pEnumerator.Release();
+
+    if (m_pwfx)
+    {
+        CoTaskMemFree(m_pwfx);
+        m_pwfx = nullptr;
+    }
+
+    m_ringBuffer.Clear();
+}
+
+HRESULT AudioPlayer::SetLatencyProfile(LatencyProfile profile)
+{
+    if (profile == m_latencyProfile && m_pAudioClient)
+        return S_OK;
+    
+    // 设备尚未初始化时只记录档位, 第一次打开带音频的文件时按该档位创建
+    if (!m_pAudioClient)
+    {
+        m_latencyProfile = profile;
+        return S_OK;
+    }
+
+    // 重建设备后设备位置从零开始, 保持媒体时间连续
+    double mediaTime = GetAudioClock();
+
+    // 解码线程只在持有 m_deviceMutex 时访问客户端和环形缓冲区（等待空闲空间时释放）, 重建在两次写入之间进行
+    std::lock_guard<std::mutex> lock(m_deviceMutex);
+    m_latencyProfile = profile;
+    ReleaseWASAPI();
+
+    HRESULT hr = InitWASAPI();
+    if (FAILED(hr))
+    {
+        // 不留下初始化到一半的客户端, 写入方据此放弃; 下一次打开文件时重试
+        ReleaseWASAPI();
+    }
+    m_clock.Reset(mediaTime);
+    if (SUCCEEDED(hr) && m_isPlaying)
+    {
+        hr = m_pAudioClient->Start();
+    }
+    
+    // 新的环形缓冲区为空, 唤醒等待空闲空间的解码线程
+    SetEvent(m_hSpaceEvent);
+    return hr;
+}
+
+void AudioPlayer::SetPlaybackSpeed(double speed)
+{
+    m_playbackSpeed = (std::max)(0.5, (std::min)(4.0, speed));
+}
+
+void AudioPlayer::Flush(double mediaTime)
+{
+    m_stretcherResetPending = true;
+    m_ringBuffer.Clear();
+    m_clock.Reset(mediaTime);
+    SetEvent(m_hSpaceEvent);
+}
+
+void AudioPlayer::SetLoopEnd(double endPts)
+{
+    m_loopEndPts = endPts;
+    m_tailFrames = 0;
+    m_crossfadePending = false;
+}
+
+void AudioPlayer::SpliceLoop()
+{
+    m_crossfadePending = m_tailFrames > 0;
+    m_crossfadePos = 0;
+}
+
+HRESULT AudioPlayer::WriteLooped(const float* left, const float* right, int sampleCount, double pts, double speed)
+{
+    // 循环终点之后的样本不播放, 开头 LOOP_CROSSFADE_MS 保留下来, 在循环点与循环起点的样本交叉淡化
+    if (!std::isnan(m_loopEndPts) && !std::isnan(pts) && !m_crossfadePending)
+    {
+        double sampleDuration = speed / m_nSamplesPerSec;
+        int keep = sampleCount;
+        if (pts + sampleCount * sampleDuration > m_loopEndPts)
+        {
+            keep = (int)((m_loopEndPts - pts) / sampleDuration);
+            keep = (std::max)(0, (std::min)(sampleCount, keep));
+        }
+        if (keep < sampleCount)
+        {
+            int take = (std::min)(sampleCount - keep, (int)m_tailLeft.size() - m_tailFrames);
+            std::copy(left + keep, left + keep + take, m_tailLeft.begin() + m_tailFrames);
+            std::copy(right + keep, right + keep + take, m_tailRight.begin() + m_tailFrames);
+            m_tailFrames += take;
+            sampleCount = keep;
+            if (sampleCount == 0)
+                return S_OK;
+        }
+    }
+    
+    if (m_crossfadePending)
+    {
+        // 线性交叉淡化：循环起点样本 0 -> 1, 尾巴 1 -> 0
+        int count = (std::min)(sampleCount, m_tailFrames - m_crossfadePos);
+        float step = 1.0f / m_tailFrames;
+        float fadeIn = m_crossfadePos * step;
+        
+        m_mixLeft.assign(left, left + sampleCount);
+        m_mixRight.assign(right, right + sampleCount);
+        AudioDSP::ApplyGainRamp(m_mixLeft.data(), count, fadeIn, step);
+        AudioDSP::ApplyGainRamp(m_mixRight.data(), count, fadeIn, step);
+        AudioDSP::ApplyGainRamp(&m_tailLeft[m_crossfadePos], count, 1.0f - fadeIn, -step);
+        AudioDSP::ApplyGainRamp(&m_tailRight[m_crossfadePos], count, 1.0f - fadeIn, -step);
+        AudioDSP::MixInto(m_mixLeft.data(), &m_tailLeft[m_crossfadePos], count, 1.0f);
+        AudioDSP::MixInto(m_mixRight.data(), &m_tailRight[m_crossfadePos], count, 1.0f);
+        left = m_mixLeft.data();
+        right = m_mixRight.data();
+        
+        m_crossfadePos += count;
+        if (m_crossfadePos >= m_tailFrames)
+        {
+            m_crossfadePending = false;
+            m_tailFrames = 0;
+        }
+    }
+    
+    return WriteFLTP(left, right, sampleCount, pts, speed);
+}
+
+DWORD WINAPI AudioPlayer::RenderThreadProc(LPVOID lpParam)
+{
+    AudioPlayer* player = static_cast<AudioPlayer*>(lpParam);
+
+    // 渲染线程注册为 MMCSS "Pro Audio" 任务, 降低被调度延迟
+    CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+    DWORD taskIndex = 0;
+    HANDLE hTask = AvSetMmThreadCharacteristicsA("Pro Audio", &taskIndex);
+
+    player->RenderLoop();
+
+    if (hTask)
+    {
+        AvRevertMmThreadCharacteristics(hTask);
+    }
+    CoUninitialize();
+    return 0;
+}
+
+void AudioPlayer::RenderLoop()
+{
+    HANDLE waitHandles[2] = { m_hShutdownEvent, m_hRefillEvent };
+
+    while (true)
+    {
+        DWORD ret = WaitForMultipleObjects(2, waitHandles, FALSE, 2000);
+        if (ret == WAIT_OBJECT_0)
+        {
+            break;
+        }
+        if (ret == WAIT_OBJECT_0 + 1)
+        {
+            RefillDeviceBuffer();
+        }
+    }
+}
+
+void AudioPlayer::RefillDeviceBuffer()
+{
+    std::lock_guard<std::mutex> lock(m_refillMutex);
+
+    UINT32 padding = 0;
+    if (FAILED(m_pAudioClient->GetCurrentPadding(&padding)))
+        return;
+
+    UINT32 framesFree = m_bufferFrameCount - padding;
+    if (framesFree == 0)
+        return;
+
+    MetricsScope writeScope(MetricStage::AUDIO_WRITE);
+    BYTE* pData = GetBuffer(framesFree);
+    if (!pData)
+        return;
+
+    // 从环形缓冲区取数据, 不足部分补静音
+    double pts = NAN, mediaDuration = 0.0;
+    size_t got = m_ringBuffer.Read((float*)pData, framesFree, &pts, &mediaDuration);
+    if (got > 0 && !std::isnan(pts))
+    {
+        // 登记这段设备帧对应的媒体时间（变速时媒体时长不等于播放时长）
+        m_clock.QueueSegment(m_submittedFrames, pts, (uint32_t)got, mediaDuration);
+    }
+    if (got < framesFree)
+    {
+        memset((float*)pData + got * m_nChannels, 0, (framesFree - got) * m_nChannels * sizeof(float));
+        if (m_isPlaying && got > 0)
+        {
+            m_underrunCount++;
+            PlayerMetrics::Count(MetricCounter::AUDIO_UNDERRUNS);
+        }
+    }
+
+    ReleaseBuffer(framesFree);
+    m_submittedFrames += framesFree;
+
+    // 采样设备播放位置, 位置单位换算为帧, QPC 时间戳单位为 100ns
+    UINT64 position = 0, qpcPosition = 0;
+    if (SUCCEEDED(m_pDeviceClock->GetPosition(&position, &qpcPosition)))
+    {
+        double deviceFrame = (double)position * m_nSamplesPerSec / m_deviceClockFrequency;
+        m_clock.UpdatePosition(deviceFrame, qpcPosition / 1e7);
+    }
+
+    // 通知解码线程有空闲空间
+    SetEvent(m_hSpaceEvent);
+}
+
 HRESULT AudioPlayer::Start()
 {
     if (m_pAudioClient)
@@ -246,10 +671,13 @@ HRESULT AudioPlayer::Start()
         // 重置音视频同步状态
         m_videoClock = 0.0;
         m_audioClock = 0.0;
-        m_audioWriteTime = 0.0;
         m_audioDiffCum = 0.0;
         m_audioDiffAvgCount = 0;
+        m_ringBuffer.Clear();
+        m_clock.Reset(0.0);
+        m_clock.SetRunning(true, QpcNowSeconds());
         
+        m_isStopped = false;
         m_isPlaying = true;
         return m_pAudioClient->Start();
     }
@@ -261,13 +689,17 @@ HRESULT AudioPlayer::Stop()
     if (m_pAudioClient)
     {
         m_isPlaying = false;
+        m_isStopped = true;
         
         // 重置音视频同步状态
         m_videoClock = 0.0;
         m_audioClock = 0.0;
-        m_audioWriteTime = 0.0;
         m_audioDiffCum = 0.0;
         m_audioDiffAvgCount = 0;
+        m_ringBuffer.Clear();
+        m_clock.Reset(0.0);
+        m_clock.SetRunning(false, QpcNowSeconds());
+        SetEvent(m_hSpaceEvent);
         
         return m_pAudioClient->Stop();
     }
@@ -279,6 +711,7 @@ void AudioPlayer::Pause()
     if (m_pAudioClient)
     {
         m_isPlaying = !m_isPlaying;
+        m_clock.SetRunning(m_isPlaying, QpcNowSeconds());
         if (m_isPlaying)
         {
             m_pAudioClient->Start();
@@ -292,11 +725,9 @@ void AudioPlayer::Pause()
 
 void AudioPlayer::SetVolume(float volume)
 {
+    // 音量在软件处理级中实现, 不再修改系统会话音量
     m_volume = (volume < 0.0f) ? 0.0f : (volume > 1.0f) ? 1.0f : volume;
-    if (m_pSimpleAudioVolume)
-    {
-        m_pSimpleAudioVolume->SetMasterVolume(m_volume, NULL);
-    }
+    m_dsp.SetVolume(m_volume);
 }
 
 BYTE* AudioPlayer::GetBuffer(UINT32 wantFrames)
@@ -322,59 +753,45 @@ HRESULT AudioPlayer::ReleaseBuffer(UINT32 writtenFrames)
     return E_FAIL;
 }
 
-HRESULT AudioPlayer::WriteFLTP(float* left, float* right, UINT32 sampleCount)
+HRESULT AudioPlayer::WriteFLTP(const float* left, const float* right, UINT32 sampleCount, double pts, double speed)
 {
+    std::unique_lock<std::mutex> lock(m_deviceMutex);
     if (!m_pAudioClient || !m_pRenderClient)
         return E_FAIL;
 
-    // 检查缓冲区填充情况
-    UINT32 padding;
-    HRESULT hr = m_pAudioClient->GetCurrentPadding(&padding);
-    if (FAILED(hr))
-        return hr;
-
-    // 如果缓冲区满了，重置以避免延迟累积
-    if ((m_maxSampleCount - padding) < sampleCount)
+    // 写入环形缓冲区（立体声交替存储, 单声道复制左声道, 都为空则写静音）
+    // 缓冲区满时等待渲染线程消耗数据（背压）, 而不是重置设备丢弃已排队的音频
+    // 暂停时继续等待, 恢复后接着写完这一帧; 只有 Stop/Close 或客户端被释放时才放弃剩余样本
+    UINT32 written = 0;
+    int stalls = 0;
+    while (written < sampleCount && !m_isStopped)
     {
-        m_pAudioClient->Stop();
-        m_pAudioClient->Reset();
-        m_pAudioClient->Start();
-    }
-
-    // 获取缓冲区
-    auto pData = GetBuffer(sampleCount);
-    if (!pData)
-        return E_FAIL;
-
-    if (left && right)
-    {
-        // 立体声：交替存储左右声道
-        for (UINT32 i = 0; i < sampleCount; i++)
+        double chunkPts = std::isnan(pts) ? NAN : pts + (double)written / m_nSamplesPerSec * speed;
+        written += (UINT32)m_ringBuffer.Write(left ? left + written : nullptr,
+                                              right ? right + written : nullptr,
+                                              sampleCount - written, chunkPts, speed);
+        if (written < sampleCount)
         {
-            int p = i * 2;
-            ((float*)pData)[p] = left[i];
-            ((float*)pData)[p + 1] = right[i];
+            // 等待期间释放锁, UI 线程可以切换延迟档位; 重建失败时客户端为空, 放弃剩余样本
+            lock.unlock();
+            DWORD wait = WaitForSingleObject(m_hSpaceEvent, 500);
+            lock.lock();
+            if (!m_pAudioClient)
+                return E_FAIL;
+            
+            // 播放中设备长时间不消耗数据（设备丢失等）时放弃剩余样本, 避免阻塞解码线程; 暂停不算停滞
+            if (wait != WAIT_TIMEOUT || !m_isPlaying)
+            {
+                stalls = 0;
+            }
+            else if (++stalls >= 4)
+            {
+                break;
+            }
         }
     }
-    else if (left)
-    {
-        // 单声道：左声道复制到右声道
-        for (UINT32 i = 0; i < sampleCount; i++)
-        {
-            int p = i * 2;
-            ((float*)pData)[p] = left[i];
-            ((float*)pData)[p + 1] = left[i];
-        }
-    }
-    else
-    {
-        // 静音
-        memset(pData, 0, sampleCount * m_nChannels * sizeof(float));    }
 
-    // 更新音频写入时间（用于音频时钟计算）
-    m_audioWriteTime += (double)sampleCount / m_pwfx->nSamplesPerSec;
-    
-    return ReleaseBuffer(sampleCount);
+    return S_OK;
 }
 
 HRESULT AudioPlayer::PlaySinWave(int nb_samples)
@@ -404,23 +821,39 @@ void AudioPlayer::SetVideoTime(double videoTime)
     m_videoClock = videoTime + m_audioOffset;
 }
 
+void AudioPlayer::SetAudioMaster(bool audioMaster)
+{
+    m_audioMaster = audioMaster;
+    m_audioDiffCum = 0.0;
+    m_audioDiffAvgCount = 0;
+}
+
 double AudioPlayer::GetAudioClock() const
 {
-    return m_audioClock;
+    return m_clock.Get(QpcNowSeconds());
+}
+
+AudioClockStats AudioPlayer::GetAudioClockStats() const
+{
+    return m_clock.GetStats();
 }
 
 void AudioPlayer::UpdateAudioSync()
 {
-    // 更新音频时钟
-    if (m_isPlaying && m_pAudioClient)
+    // 更新音频时钟（设备播放位置外推, 不依赖写入量累计）
+    double now = QpcNowSeconds();
+    m_audioClock = m_clock.Get(now);
+
+    // 定期输出时钟漂移统计
+    if (now - m_lastClockReport >= 30.0)
     {
-        UINT32 numFramesPadding;
-        HRESULT hr = m_pAudioClient->GetCurrentPadding(&numFramesPadding);
-        if (SUCCEEDED(hr))
+        m_lastClockReport = now;
+        AudioClockStats stats = m_clock.GetStats();
+        if (stats.sampleCount > 0)
         {
-            // 计算音频时钟 = 写入时间 - 缓冲区中剩余的播放时间
-            double bufferTime = (double)numFramesPadding / m_pwfx->nSamplesPerSec;
-            m_audioClock = m_audioWriteTime - bufferTime;
+            std::cout << "Audio clock: drift " << stats.driftPpm << "ppm over " << stats.observedSeconds << "s"
+                      << ", prediction error mean " << stats.meanPredictionError * 1000.0 << "ms"
+                      << " max " << stats.maxPredictionError * 1000.0 << "ms" << std::endl;
         }
     }
 }
@@ -430,6 +863,10 @@ int AudioPlayer::SynchronizeAudio(AVFrame* frame, int wantedNbSamples)
     if (!frame || !m_isPlaying)
         return wantedNbSamples;
     
+    // 变速播放时视频按调整后的节奏调度（高倍速仅解码关键帧）, 纯音频模式下没有视频时钟, 都不做样本补偿
+    if (m_playbackSpeed != 1.0 || m_audioMaster)
+        return frame->nb_samples;
+    
     int nbSamples = frame->nb_samples;
     
     // 计算当前音视频时间差
@@ -454,6 +891,8 @@ int AudioPlayer::SynchronizeAudio(AVFrame* frame, int wantedNbSamples)
     // 计算加权平均差异
     // avg_diff = audio_diff_cum * (1.0 - audio_diff_avg_coef)
     double avgDiff = m_audioDiffCum * (1.0 - m_audioDiffAvgCoef);
+    PlayerMetrics::SetGauge(MetricGauge::AUDIO_SYNC_DIFF_US, (int64_t)(diff * 1e6));
+    PlayerMetrics::SetGauge(MetricGauge::AUDIO_SYNC_AVG_DIFF_US, (int64_t)(avgDiff * 1e6));
     
     // 如果加权平均差异超过阈值，进行样本数调整
     if (fabs(avgDiff) >= m_audioDiffThreshold)
@@ -470,8 +909,11 @@ int AudioPlayer::SynchronizeAudio(AVFrame* frame, int wantedNbSamples)
         wantedNbSamples = (wantedNbSamples < minNbSamples) ? minNbSamples : 
                          (wantedNbSamples > maxNbSamples) ? maxNbSamples : wantedNbSamples;
         
-        std::cout << "Audio sync: diff=" << diff << ", avg_diff=" << avgDiff 
-                  << ", samples=" << nbSamples << "->" << wantedNbSamples << std::endl;
+        // 每帧都可能调整, 不再逐帧输出日志, 差值和调整次数计入播放指标
+        if (wantedNbSamples != nbSamples)
+        {
+            PlayerMetrics::Count(MetricCounter::AUDIO_SYNC_CORRECTIONS);
+        }
     }
     else
     {
@@ -483,7 +925,8 @@ int AudioPlayer::SynchronizeAudio(AVFrame* frame, int wantedNbSamples)
 
 HRESULT AudioPlayer::ProcessAudioFrame(AVFrame* frame)
 {
-    if (!frame || !m_swrContext || !m_isPlaying)
+    // 暂停前已解码的帧照常写入（WriteFLTP 等到恢复播放）, 停止后才丢弃
+    if (!frame || !m_swrContext || m_isStopped)
         return E_FAIL;
     
     // 更新音频时钟
@@ -495,8 +938,8 @@ HRESULT AudioPlayer::ProcessAudioFrame(AVFrame* frame)
     // 如果需要样本补偿，使用swr_set_compensation
     if (wantedNbSamples != frame->nb_samples)
     {
-        int compensation = (wantedNbSamples - frame->nb_samples) * m_pwfx->nSamplesPerSec / frame->sample_rate;
-        int out_count = wantedNbSamples * m_pwfx->nSamplesPerSec / frame->sample_rate;
+        int compensation = (wantedNbSamples - frame->nb_samples) * (int)m_nSamplesPerSec / frame->sample_rate;
+        int out_count = wantedNbSamples * (int)m_nSamplesPerSec / frame->sample_rate;
         
         if (swr_set_compensation(m_swrContext, compensation, out_count) < 0)
         {
@@ -505,10 +948,18 @@ HRESULT AudioPlayer::ProcessAudioFrame(AVFrame* frame)
         }
     }
     
+    // 计算首个输出样本的媒体时间（需扣除重采样器内部缓存的延迟）
+    double pts = NAN;
+    if (frame->best_effort_timestamp != AV_NOPTS_VALUE)
+    {
+        pts = frame->best_effort_timestamp * av_q2d(m_audioTimeBase);
+        pts -= (double)swr_get_delay(m_swrContext, 1000) / 1000.0;
+    }
+    
     // 分配输出缓冲区
     uint8_t* output[2] = {nullptr};
     int out_samples = av_rescale_rnd(swr_get_delay(m_swrContext, frame->sample_rate) + frame->nb_samples,
-                                    m_pwfx->nSamplesPerSec, frame->sample_rate, AV_ROUND_UP);
+                                    m_nSamplesPerSec, frame->sample_rate, AV_ROUND_UP);
     
     if (av_samples_alloc(output, nullptr, 2, out_samples, AV_SAMPLE_FMT_FLTP, 0) < 0)
     {
@@ -526,8 +977,38 @@ HRESULT AudioPlayer::ProcessAudioFrame(AVFrame* frame)
         return E_FAIL;
     }
     
-    // 写入音频数据
-    HRESULT hr = WriteFLTP((float*)output[0], (float*)output[1], converted_samples);
+    // 软件处理级：音量/流增益渐变与软限幅
+    m_dsp.Process((float*)output[0], (float*)output[1], converted_samples);
+    
+    // 写入音频数据（变速时先经过 WSOLA 时间伸缩）
+    HRESULT hr;
+    double speed = m_playbackSpeed;
+    if (m_stretcherResetPending.exchange(false))
+    {
+        m_timeStretcher.Reset();
+        m_tailFrames = 0;
+        m_crossfadePending = false;
+    }
+    if (speed != m_timeStretcher.GetSpeed())
+    {
+        m_timeStretcher.SetSpeed(speed);
+    }
+    
+    if (speed == 1.0)
+    {
+        hr = WriteLooped((float*)output[0], (float*)output[1], converted_samples, pts, 1.0);
+    }
+    else
+    {
+        double stretchedPts = NAN;
+        int stretched = m_timeStretcher.Process((float*)output[0], (float*)output[1], converted_samples, pts, stretchedPts);
+        hr = S_OK;
+        if (stretched > 0)
+        {
+            hr = WriteLooped(m_timeStretcher.OutputLeft(), m_timeStretcher.OutputRight(),
+                             stretched, stretchedPts, speed);
+        }
+    }
     
     // 释放缓冲区
     av_freep(&output[0]);
@@ -537,39 +1018,13 @@ HRESULT AudioPlayer::ProcessAudioFrame(AVFrame* frame)
 
 void AudioPlayer::CleanupAudio()
 {
-    // 停止音频播放
-    if (m_pAudioClient)
-    {
-        m_pAudioClient->Stop();
-        m_pAudioClient->Reset();
-    }
-
-    // 释放WASAPI资源
-    m_pRenderClient.Release();
-    m_pSimpleAudioVolume.Release();
-    m_pAudioClient.Release();
-    m_pDevice.Release();
-    m_pEnumerator.Release();
-
-    if (m_pwfx)
-    {
-        CoTaskMemFree(m_pwfx);
-        m_pwfx = nullptr;
-    }
+    // 停止音频播放并释放WASAPI资源
+    ReleaseWASAPI();
 
     // 清理FFmpeg资源
-    if (m_swrContext)
-    {
-        swr_free(&m_swrContext);
-    }
-
-    if (m_audioCodecContext)
-    {
-        avcodec_free_context(&m_audioCodecContext);
-    }
-
-    m_isInitialized = false;
+    ReleaseDecoder();
     m_isPlaying = false;
+    m_isStopped = true;
 }
 
 // Audio offset control methods
@@ -7,6 +7,13 @@
 #include <Audioclient.h>
 #include <audiopolicy.h>
 #include <memory>
+#include <mutex>
+#include <vector>
+#include "AudioRingBuffer.h"
+#include "AudioClock.h"
+#include "TimeStretcher.h"
+#include "AudioDSP.h"
+#include <atomic>
 
 extern "C" {
 #include "libavcodec/avcodec.h"
@@ -18,28 +25,57 @@ extern "C" {
 
 #pragma comment(lib, "ole32.lib")
 #pragma comment(lib, "oleaut32.lib")
+#pragma comment(lib, "avrt.lib")
+
+// 音频延迟档位 - 决定 WASAPI 设备缓冲区周期和软件环形缓冲区大小
+enum class LatencyProfile {
+    ULTRA_LOW,      // 10ms 设备缓冲
+    LOW,            // 20ms 设备缓冲
+    NORMAL,         // 50ms 设备缓冲
+    SAFE            // 200ms 设备缓冲
+};
 
 class AudioPlayer {
 public:
     AudioPlayer(WORD nChannels = 2, DWORD nSamplesPerSec = 44100);
     ~AudioPlayer();
     
+    // 为 formatContext 的音频流创建解码器和重采样器; 音频设备在第一次成功时才初始化, 之后在各文件之间复用
     bool Initialize(AVFormatContext* formatContext);
+    // 关闭文件：释放解码器和重采样器, 停止并清空设备但保留 WASAPI 客户端
+    void Close();
     HRESULT Start();
     HRESULT Stop();    void Pause();
-    void SetVolume(float volume); // 0.0 - 1.0
+    void SetVolume(float volume); // 0.0 - 1.0, 软件增益（平滑渐变）
+    
+    // 延迟档位控制（播放中切换会重建 WASAPI 客户端, 设备尚未初始化时只记录档位）
+    HRESULT SetLatencyProfile(LatencyProfile profile);
+    LatencyProfile GetLatencyProfile() const { return m_latencyProfile; }
+    
+    // 清空已排队但未播放的音频（跳转时调用）, mediaTime 为跳转目标
+    void Flush(double mediaTime);
+    
+    // 循环播放（解码线程调用）：媒体时间 endPts 之后的样本不再播放, 其开头一小段保留为淡出尾巴; NAN 表示不限制
+    void SetLoopEnd(double endPts);
+    // 在循环点换入循环起点之后调用：接下来写入的样本与保留的尾巴交叉淡化, 没有尾巴时直接拼接
+    void SpliceLoop();
+    
+    // 变速播放 (0.5x - 4x), 音频经 WSOLA 处理保持音调
+    void SetPlaybackSpeed(double speed);
+    double GetPlaybackSpeed() const { return m_playbackSpeed; }
     
     // 音频偏移控制
     void SetAudioOffset(double offset);
     double GetAudioOffset() const;
     
     bool IsInitialized() const { return m_isInitialized; }
+    bool IsDeviceReady() const { return m_pAudioClient != nullptr; }
     
     // WASAPI缓冲区操作
     BYTE* GetBuffer(UINT32 wantFrames);
     HRESULT ReleaseBuffer(UINT32 writtenFrames);
-      // FLTP格式音频写入 - 左右声道分开处理
-    HRESULT WriteFLTP(float* left, float* right, UINT32 sampleCount);
+      // FLTP格式音频写入 - 左右声道分开处理, pts 为首个样本的媒体时间（NAN 表示连续）
+    HRESULT WriteFLTP(const float* left, const float* right, UINT32 sampleCount, double pts = NAN, double speed = 1.0);
     
     // 新增：带音视频同步的音频帧处理
     HRESULT ProcessAudioFrame(AVFrame* frame);
@@ -52,7 +88,9 @@ public:
     
     // 新增：音视频同步功能
     void SetVideoTime(double videoTime);
-    double GetAudioClock() const;
+    void SetAudioMaster(bool audioMaster);  // 没有视频显示时以音频为主时钟, 不做样本补偿
+    double GetAudioClock() const;       // 线程安全, 基于设备播放位置外推
+    AudioClockStats GetAudioClockStats() const;
     void UpdateAudioSync();
     int SynchronizeAudio(AVFrame* frame, int wantedNbSamples);
     
@@ -67,30 +105,64 @@ private:
     CComPtr<IMMDevice> m_pDevice;
     CComPtr<IAudioClient> m_pAudioClient;
     CComPtr<IAudioRenderClient> m_pRenderClient;
-    CComPtr<ISimpleAudioVolume> m_pSimpleAudioVolume;
+    CComPtr<IAudioClock> m_pDeviceClock;
+    UINT64 m_deviceClockFrequency;  // IAudioClock 位置单位（每秒）
     
     DWORD m_flags;
+    bool m_comInitialized;          // 初始化设备的线程上调用过 CoInitialize
+    
+    // 延迟档位与事件驱动填充
+    LatencyProfile m_latencyProfile;
+    AudioRingBuffer m_ringBuffer;   // 解码线程 -> 渲染线程
+    HANDLE m_hRefillEvent;          // WASAPI 请求填充事件
+    HANDLE m_hSpaceEvent;           // 环形缓冲区有空闲空间
+    HANDLE m_hShutdownEvent;        // 渲染线程退出事件
+    HANDLE m_renderThread;
+    std::mutex m_deviceMutex;       // 解码线程每次写入环形缓冲区 / UI 线程重建客户端（切换档位）
+    UINT32 m_underrunCount;         // 渲染线程欠载次数
+    UINT64 m_submittedFrames;       // 已提交给设备的帧数（含静音）, 与设备位置同一起点
+    std::mutex m_refillMutex;       // 渲染线程每次填充 / UI 线程关闭文件时重置设备位置
     
     // FFmpeg 音频相关
     AVCodecContext* m_audioCodecContext;
     const AVCodec* m_audioCodec;
     SwrContext* m_swrContext;
+    AVRational m_audioTimeBase;
     int m_audioStreamIndex;    // 状态
     bool m_isInitialized;
-    bool m_isPlaying;
+    std::atomic<bool> m_isPlaying;  // UI 线程设置, 解码线程和渲染线程读取
+    std::atomic<bool> m_isStopped;  // Stop/Close 后为 true, 解码线程放弃正在写入的样本; 暂停时仍为 false
     float m_volume;
     double m_audioOffset;   // 音频偏移量（秒）
     
+    // 变速播放
+    std::atomic<double> m_playbackSpeed;    // UI 线程设置
+    TimeStretcher m_timeStretcher;          // 仅在解码线程使用
+    AudioDSP m_dsp;                         // 音量/流增益/限幅
+    std::atomic<bool> m_stretcherResetPending;  // 跳转后由解码线程重置伸缩器
+    
+    // 循环点交叉淡化（仅在解码线程使用）
+    double m_loopEndPts;
+    std::vector<float> m_tailLeft;          // 循环终点之后的样本（DSP 处理后）
+    std::vector<float> m_tailRight;
+    int m_tailFrames;
+    bool m_crossfadePending;
+    int m_crossfadePos;                     // 已与循环起点样本混合的尾巴帧数
+    std::vector<float> m_mixLeft;
+    std::vector<float> m_mixRight;
+    
     // 新增：音视频同步相关变量
     double m_videoClock;        // 视频时钟（主时钟）
-    double m_audioClock;        // 音频时钟
-    double m_audioWriteTime;    // 音频写入时间
+    bool m_audioMaster;         // 视频不解码时音频自身为主时钟
+    double m_audioClock;        // 音频时钟（最近一次 UpdateAudioSync 的快照）
+    AudioClock m_clock;         // 设备位置驱动的音频时钟
+    double m_lastClockReport;   // 上次输出时钟漂移统计的时间
     
     // 音频同步算法相关
     double m_audioDiffCum;          // 累计音视频差异（加权总和）
     double m_audioDiffAvgCoef;      // 加权平均系数（公比q）
     int m_audioDiffAvgCount;        // 差异计数
-    double m_audioDiffThreshold;    // 音频同步阈值
+    std::atomic<double> m_audioDiffThreshold;   // 音频同步阈值（随延迟档位重建）
     
     // 音频缓冲区信息
     UINT32 m_bufferFrameCount;      // 音频缓冲区帧数
@@ -100,9 +172,18 @@ private:
     static const double AV_NOSYNC_THRESHOLD;      // 10.0秒
     static const int AUDIO_DIFF_AVG_NB;           // 20次
     static const int SAMPLE_CORRECTION_PERCENT_MAX; // 10%
+    static const int LOOP_CROSSFADE_MS;
     
     // 私有方法
+    HRESULT EnsureDevice();
     HRESULT InitWASAPI();
+    void ReleaseWASAPI();
+    static DWORD WINAPI RenderThreadProc(LPVOID lpParam);
+    void RenderLoop();
+    void RefillDeviceBuffer();
     bool SetupAudioDecoder(AVFormatContext* formatContext);
+    void ReleaseDecoder();
     void CleanupAudio();
+    // 按循环终点截断并在循环点交叉淡化后写入环形缓冲区
+    HRESULT WriteLooped(const float* left, const float* right, int sampleCount, double pts, double speed);
 };
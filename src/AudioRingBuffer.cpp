@@ -0,0 +1,127 @@
+#include "AudioRingBuffer.h"
+#include <cstring>
+#include <algorithm>
+
+AudioRingBuffer::AudioRingBuffer()
+    : m_dataCharge(MemoryCategory::AUDIO)
+    , m_totalWritten(0)
+    , m_totalRead(0)
+    , m_sampleRate(44100)
+    , m_capacity(0)
+    , m_readPos(0)
+    , m_size(0)
+    , m_channels(2)
+{
+}
+
+void AudioRingBuffer::Allocate(size_t capacityFrames, int channels, int sampleRate)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_channels = channels;
+    m_sampleRate = sampleRate;
+    m_markers.clear();
+    m_totalRead = m_totalWritten;
+    m_capacity = capacityFrames;
+    m_data.assign(capacityFrames * channels, 0.0f);
+    m_dataCharge.Set(m_data.capacity() * sizeof(float));
+    m_readPos = 0;
+    m_size = 0;
+}
+
+size_t AudioRingBuffer::Write(const float* left, const float* right, size_t frames, double pts, double speed)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    size_t toWrite = (std::min)(frames, m_capacity - m_size);
+    if (toWrite > 0 && !std::isnan(pts))
+    {
+        m_markers.push_back({ m_totalWritten, pts, speed });
+    }
+
+    size_t writePos = (m_readPos + m_size) % (m_capacity ? m_capacity : 1);
+
+    for (size_t i = 0; i < toWrite; i++)
+    {
+        float* dst = &m_data[writePos * m_channels];
+        float l = left ? left[i] : 0.0f;
+        float r = right ? right[i] : l;
+
+        dst[0] = l;
+        if (m_channels > 1)
+        {
+            dst[1] = r;
+        }
+
+        if (++writePos == m_capacity)
+        {
+            writePos = 0;
+        }
+    }
+
+    m_size += toWrite;
+    m_totalWritten += toWrite;
+    return toWrite;
+}
+
+size_t AudioRingBuffer::Read(float* dst, size_t frames, double* firstPts, double* mediaDuration)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    size_t toRead = (std::min)(frames, m_size);
+
+    // 丢弃已被后续标记覆盖的旧标记, 用最近的标记推算首帧时间
+    while (m_markers.size() > 1 && m_markers[1].writeIndex <= m_totalRead)
+    {
+        m_markers.pop_front();
+    }
+    bool hasMarker = !m_markers.empty() && m_markers.front().writeIndex <= m_totalRead;
+    double speed = hasMarker ? m_markers.front().speed : 1.0;
+    if (firstPts)
+    {
+        *firstPts = NAN;
+        if (hasMarker)
+        {
+            *firstPts = m_markers.front().pts + (double)(m_totalRead - m_markers.front().writeIndex) / m_sampleRate * speed;
+        }
+    }
+    if (mediaDuration)
+    {
+        *mediaDuration = (double)toRead / m_sampleRate * speed;
+    }
+
+    size_t done = 0;
+
+    // 最多分两段拷贝（环绕）
+    while (done < toRead)
+    {
+        size_t chunk = (std::min)(toRead - done, m_capacity - m_readPos);
+        memcpy(dst + done * m_channels, &m_data[m_readPos * m_channels], chunk * m_channels * sizeof(float));
+        m_readPos = (m_readPos + chunk) % m_capacity;
+        done += chunk;
+    }
+
+    m_size -= toRead;
+    m_totalRead += toRead;
+    return toRead;
+}
+
+void AudioRingBuffer::Clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_readPos = 0;
+    m_size = 0;
+    m_markers.clear();
+    m_totalRead = m_totalWritten;
+}
+
+size_t AudioRingBuffer::AvailableToRead() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_size;
+}
+
+size_t AudioRingBuffer::AvailableToWrite() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_capacity - m_size;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include "MemoryBudget.h"
+
+// 音频环形缓冲区 - 解码线程写入, WASAPI 事件回调线程读取
+// 以交错格式 (interleaved float) 存储立体声样本, 容量以帧 (frame) 为单位
+// 写入时可附带媒体时间戳, 读取时返回所读数据首帧对应的媒体时间
+class AudioRingBuffer {
+public:
+    AudioRingBuffer();
+
+    // 分配容量（帧数），会清空已有数据
+    void Allocate(size_t capacityFrames, int channels, int sampleRate);
+
+    // 写入平面格式数据, right 为空时复制左声道, 两者都为空时写入静音
+    // pts 为首帧媒体时间（秒）, NAN 表示紧接上一次写入; speed 为每帧代表的媒体时长倍数（变速播放）
+    // 返回实际写入的帧数（缓冲区满时可能小于 frames）
+    size_t Write(const float* left, const float* right, size_t frames, double pts = NAN, double speed = 1.0);
+
+    // 读取交错格式数据到 dst, 返回实际读取的帧数
+    // firstPts 非空时返回首帧的媒体时间（未知时为 NAN）, mediaDuration 返回所读数据覆盖的媒体时长
+    size_t Read(float* dst, size_t frames, double* firstPts = nullptr, double* mediaDuration = nullptr);
+
+    // 清空缓冲区（跳转/停止时丢弃已排队的音频）
+    void Clear();
+
+    size_t AvailableToRead() const;
+    size_t AvailableToWrite() const;
+    size_t Capacity() const { return m_capacity; }
+
+private:
+    // 时间戳标记：写入计数 writeIndex 处的帧对应媒体时间 pts
+    struct PtsMarker {
+        uint64_t writeIndex;
+        double pts;
+        double speed;
+    };
+
+    std::vector<float> m_data;
+    MemoryCharge m_dataCharge;  // 计入内存预算的 AUDIO
+    std::deque<PtsMarker> m_markers;
+    uint64_t m_totalWritten;    // 累计写入帧数
+    uint64_t m_totalRead;       // 累计读取帧数
+    int m_sampleRate;
+    size_t m_capacity;      // 容量（帧）
+    size_t m_readPos;       // 读位置（帧）
+    size_t m_size;          // 已存储帧数
+    int m_channels;
+    mutable std::mutex m_mutex;
+};
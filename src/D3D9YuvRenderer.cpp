@@ -0,0 +1,213 @@
+#include "D3D9YuvRenderer.h"
+#include <d3dcompiler.h>
+#include <iostream>
+#include <cstring>
+
+// 预变换顶点：屏幕坐标 + 纹理坐标
+struct QuadVertex {
+    float x, y, z, rhw;
+    float u, v;
+};
+
+static const DWORD QUAD_FVF = D3DFVF_XYZRHW | D3DFVF_TEX1;
+
+D3D9YuvRenderer::D3D9YuvRenderer()
+    : m_currentSet(-1)
+{
+    memset(m_planeWidth, 0, sizeof(m_planeWidth));
+    memset(m_planeHeight, 0, sizeof(m_planeHeight));
+    m_matrix = MakeYuvToRgbMatrix(YuvColorSpace::BT601, false);
+}
+
+D3D9YuvRenderer::~D3D9YuvRenderer()
+{
+    Release();
+}
+
+bool D3D9YuvRenderer::Create(IDirect3DDevice9* device, int width, int height, int chromaShiftX, int chromaShiftY)
+{
+    Release();
+
+    if (!device || width <= 0 || height <= 0)
+        return false;
+
+    // 检查设备能力：动态纹理、非 2 的幂纹理、ps_2_0
+    D3DCAPS9 caps;
+    if (FAILED(device->GetDeviceCaps(&caps)))
+        return false;
+
+    if (!(caps.Caps2 & D3DCAPS2_DYNAMICTEXTURES))
+    {
+        std::cout << "YUV texture path disabled: dynamic textures not supported" << std::endl;
+        return false;
+    }
+    if ((caps.TextureCaps & D3DPTEXTURECAPS_POW2) && !(caps.TextureCaps & D3DPTEXTURECAPS_NONPOW2CONDITIONAL))
+    {
+        std::cout << "YUV texture path disabled: non power-of-two textures not supported" << std::endl;
+        return false;
+    }
+    if (caps.PixelShaderVersion < D3DPS_VERSION(2, 0))
+    {
+        std::cout << "YUV texture path disabled: pixel shader 2.0 not supported" << std::endl;
+        return false;
+    }
+
+    // 运行时编译像素着色器
+    ComPtr<ID3DBlob> code;
+    ComPtr<ID3DBlob> errors;
+    HRESULT hr = D3DCompile(YUV_PIXEL_SHADER_SOURCE, strlen(YUV_PIXEL_SHADER_SOURCE), "YuvConvert",
+                            nullptr, nullptr, "main", "ps_2_0", D3DCOMPILE_OPTIMIZATION_LEVEL3, 0,
+                            code.GetAddressOf(), errors.GetAddressOf());
+    if (FAILED(hr))
+    {
+        std::cerr << "Failed to compile YUV pixel shader: "
+                  << (errors ? (const char*)errors->GetBufferPointer() : "unknown error") << std::endl;
+        return false;
+    }
+
+    hr = device->CreatePixelShader((const DWORD*)code->GetBufferPointer(), m_pixelShader.GetAddressOf());
+    if (FAILED(hr))
+    {
+        std::cerr << "Failed to create YUV pixel shader, HRESULT: 0x" << std::hex << hr << std::dec << std::endl;
+        return false;
+    }
+
+    m_planeWidth[0] = width;
+    m_planeHeight[0] = height;
+    m_planeWidth[1] = m_planeWidth[2] = -((-width) >> chromaShiftX);
+    m_planeHeight[1] = m_planeHeight[2] = -((-height) >> chromaShiftY);
+
+    for (int set = 0; set < TEXTURE_SETS; set++)
+    {
+        for (int plane = 0; plane < 3; plane++)
+        {
+            hr = device->CreateTexture(m_planeWidth[plane], m_planeHeight[plane], 1, D3DUSAGE_DYNAMIC,
+                                       D3DFMT_L8, D3DPOOL_DEFAULT,
+                                       m_textures[set][plane].GetAddressOf(), nullptr);
+            if (FAILED(hr))
+            {
+                std::cerr << "Failed to create YUV plane texture, HRESULT: 0x" << std::hex << hr << std::dec << std::endl;
+                Release();
+                return false;
+            }
+        }
+    }
+
+    m_device = device;
+    std::cout << "YUV texture path enabled (" << width << "x" << height
+              << ", chroma " << m_planeWidth[1] << "x" << m_planeHeight[1] << ")" << std::endl;
+    return true;
+}
+
+void D3D9YuvRenderer::Release()
+{
+    for (int set = 0; set < TEXTURE_SETS; set++)
+    {
+        for (int plane = 0; plane < 3; plane++)
+        {
+            m_textures[set][plane].Reset();
+        }
+    }
+    m_pixelShader.Reset();
+    m_device.Reset();
+    m_currentSet = -1;
+}
+
+bool D3D9YuvRenderer::Upload(const uint8_t* const planes[3], const int strides[3])
+{
+    if (!IsReady())
+        return false;
+
+    // 写入另一组纹理, 上一帧仍可能在 GPU 队列中被读取
+    int set = (m_currentSet + 1) % TEXTURE_SETS;
+
+    for (int plane = 0; plane < 3; plane++)
+    {
+        D3DLOCKED_RECT lockedRect;
+        HRESULT hr = m_textures[set][plane]->LockRect(0, &lockedRect, nullptr, D3DLOCK_DISCARD);
+        if (FAILED(hr))
+        {
+            std::cerr << "Failed to lock YUV plane texture" << std::endl;
+            return false;
+        }
+
+        const uint8_t* src = planes[plane];
+        uint8_t* dst = (uint8_t*)lockedRect.pBits;
+        int rowBytes = m_planeWidth[plane];
+
+        if (lockedRect.Pitch == strides[plane])
+        {
+            // 行距相同（FramePool 的行字节数按 64 字节对齐, 常与纹理行距一致）时连同行尾填充一次复制整个平面
+            memcpy(dst, src, (size_t)lockedRect.Pitch * (m_planeHeight[plane] - 1) + rowBytes);
+        }
+        else
+        {
+            for (int y = 0; y < m_planeHeight[plane]; y++)
+            {
+                memcpy(dst + y * lockedRect.Pitch, src + y * strides[plane], rowBytes);
+            }
+        }
+
+        m_textures[set][plane]->UnlockRect(0);
+    }
+
+    m_currentSet = set;
+    return true;
+}
+
+bool D3D9YuvRenderer::Draw(const RECT& dstRect)
+{
+    if (!IsReady() || m_currentSet < 0)
+        return false;
+
+    // 像素中心对齐：D3D9 的光栅化规则要求屏幕坐标偏移 -0.5
+    float left = dstRect.left - 0.5f;
+    float top = dstRect.top - 0.5f;
+    float right = dstRect.right - 0.5f;
+    float bottom = dstRect.bottom - 0.5f;
+
+    QuadVertex quad[4] = {
+        { left,  top,    0.0f, 1.0f, 0.0f, 0.0f },
+        { right, top,    0.0f, 1.0f, 1.0f, 0.0f },
+        { left,  bottom, 0.0f, 1.0f, 0.0f, 1.0f },
+        { right, bottom, 0.0f, 1.0f, 1.0f, 1.0f },
+    };
+
+    for (int plane = 0; plane < 3; plane++)
+    {
+        m_device->SetTexture(plane, m_textures[m_currentSet][plane].Get());
+        m_device->SetSamplerState(plane, D3DSAMP_MINFILTER, D3DTEXF_LINEAR);
+        m_device->SetSamplerState(plane, D3DSAMP_MAGFILTER, D3DTEXF_LINEAR);
+        m_device->SetSamplerState(plane, D3DSAMP_MIPFILTER, D3DTEXF_NONE);
+        m_device->SetSamplerState(plane, D3DSAMP_ADDRESSU, D3DTADDRESS_CLAMP);
+        m_device->SetSamplerState(plane, D3DSAMP_ADDRESSV, D3DTADDRESS_CLAMP);
+    }
+
+    m_device->SetRenderState(D3DRS_LIGHTING, FALSE);
+    m_device->SetRenderState(D3DRS_CULLMODE, D3DCULL_NONE);
+    m_device->SetRenderState(D3DRS_ZENABLE, D3DZB_FALSE);
+    m_device->SetRenderState(D3DRS_ALPHABLENDENABLE, FALSE);
+    m_device->SetPixelShader(m_pixelShader.Get());
+    m_device->SetPixelShaderConstantF(0, &m_matrix.rows[0][0], 3);
+    m_device->SetFVF(QUAD_FVF);
+
+    HRESULT hr = m_device->BeginScene();
+    if (SUCCEEDED(hr))
+    {
+        hr = m_device->DrawPrimitiveUP(D3DPT_TRIANGLESTRIP, 2, quad, sizeof(QuadVertex));
+        m_device->EndScene();
+    }
+
+    m_device->SetPixelShader(nullptr);
+    for (int plane = 0; plane < 3; plane++)
+    {
+        m_device->SetTexture(plane, nullptr);
+    }
+
+    if (FAILED(hr))
+    {
+        std::cerr << "Failed to draw YUV quad, HRESULT: 0x" << std::hex << hr << std::dec << std::endl;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <windows.h>
+#include <d3d9.h>
+#include <wrl.h>
+#include <cstdint>
+#include "YuvConvert.h"
+
+#pragma comment(lib, "d3dcompiler.lib")
+
+using Microsoft::WRL::ComPtr;
+
+// D3D9 纹理渲染器 - 平面 YUV 直接上传到三张 L8 动态纹理, 由像素着色器完成颜色转换,
+// 纹理采样器完成缩放, CPU 只负责按行拷贝原始平面数据
+// 纹理组双缓冲：上传写入当前未被绘制的一组, 并以 D3DLOCK_DISCARD 锁定, 避免等待 GPU
+class D3D9YuvRenderer {
+public:
+    D3D9YuvRenderer();
+    ~D3D9YuvRenderer();
+
+    // 创建纹理和着色器; 设备不支持动态纹理/L8 格式/ps_2_0 时返回 false, 调用方回退到 RGB 路径
+    bool Create(IDirect3DDevice9* device, int width, int height, int chromaShiftX, int chromaShiftY);
+    void Release();
+    bool IsReady() const { return m_pixelShader != nullptr; }
+
+    // 设置颜色转换矩阵（颜色空间/范围/黑白滤镜）
+    void SetMatrix(const YuvToRgbMatrix& matrix) { m_matrix = matrix; }
+
+    // 上传一帧 Y/U/V 平面
+    bool Upload(const uint8_t* const planes[3], const int strides[3]);
+
+    // 把最近上传的一帧绘制到后备缓冲区的目标矩形（调用方负责 Clear/Present）
+    bool Draw(const RECT& dstRect);
+
+private:
+    static const int TEXTURE_SETS = 2;
+
+    ComPtr<IDirect3DDevice9> m_device;
+    ComPtr<IDirect3DPixelShader9> m_pixelShader;
+    ComPtr<IDirect3DTexture9> m_textures[TEXTURE_SETS][3];  // [组][Y/U/V]
+    int m_currentSet;       // 最近一次上传完成的纹理组, -1 表示尚无数据
+    int m_planeWidth[3];
+    int m_planeHeight[3];
+    YuvToRgbMatrix m_matrix;
+};
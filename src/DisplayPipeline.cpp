@@ -0,0 +1,156 @@
+#include "DisplayPipeline.h"
+
+void CalculateDisplayRect(ScalingMode mode, int windowWidth, int windowHeight, int videoWidth, int videoHeight,
+                          int& displayWidth, int& displayHeight, int& offsetX, int& offsetY)
+{
+    displayWidth = 0;
+    displayHeight = 0;
+    offsetX = 0;
+    offsetY = 0;
+
+    // 安全检查：确保窗口和视频尺寸有效
+    if (windowWidth <= 0 || windowHeight <= 0 || videoWidth <= 0 || videoHeight <= 0)
+    {
+        return;
+    }
+
+    switch (mode)
+    {
+    case ScalingMode::FIT_TO_WINDOW:
+        {
+            // 保持宽高比，适应窗口，用黑边填充
+            double scaleX = (double)windowWidth / videoWidth;
+            double scaleY = (double)windowHeight / videoHeight;
+            double scale = (scaleX < scaleY) ? scaleX : scaleY; // 选择较小的缩放比例以确保视频完全显示
+
+            // 确保缩放不会产生无效尺寸
+            if (scale <= 0.0)
+            {
+                return;
+            }
+
+            displayWidth = (int)(videoWidth * scale);
+            displayHeight = (int)(videoHeight * scale);
+
+            // 确保计算结果不为负
+            if (displayWidth < 0) displayWidth = 0;
+            if (displayHeight < 0) displayHeight = 0;
+
+            offsetX = (windowWidth - displayWidth) / 2;
+            offsetY = (windowHeight - displayHeight) / 2;
+        }
+        break;
+    case ScalingMode::ORIGINAL_SIZE:
+        {
+            // 原始尺寸，居中显示
+            displayWidth = videoWidth;
+            displayHeight = videoHeight;
+
+            // 确保视频不会超出窗口边界
+            if (displayWidth > windowWidth) {
+                displayWidth = windowWidth;
+            }
+            if (displayHeight > windowHeight) {
+                displayHeight = windowHeight;
+            }
+
+            offsetX = (windowWidth - displayWidth) / 2;
+            offsetY = (windowHeight - displayHeight) / 2;
+
+            // 确保偏移不为负
+            if (offsetX < 0) offsetX = 0;
+            if (offsetY < 0) offsetY = 0;
+        }
+        break;
+    }
+}
+
+void ApplyFrameFilter(FilterType filter, int mosaicSize, uint8_t* buffer, int width, int height, int stride, int bytesPerPixel)
+{
+    switch (filter)
+    {
+    case FilterType::NONE:
+        // 不应用任何滤镜
+        break;
+    case FilterType::GRAYSCALE:
+        ApplyGrayscaleFilter(buffer, width, height, stride, bytesPerPixel);
+        break;
+    case FilterType::MOSAIC:
+        ApplyMosaicFilter(buffer, width, height, stride, bytesPerPixel, mosaicSize);
+        break;
+    }
+}
+
+void ApplyGrayscaleFilter(uint8_t* buffer, int width, int height, int stride, int bytesPerPixel)
+{
+    if (bytesPerPixel != 3 && bytesPerPixel != 4)
+        return;
+
+    for (int y = 0; y < height; y++)
+    {
+        uint8_t* row = buffer + (size_t)y * stride;
+        for (int x = 0; x < width; x++)
+        {
+            uint8_t* pixel = row + x * bytesPerPixel;
+            uint8_t b = pixel[0];
+            uint8_t g = pixel[1];
+            uint8_t r = pixel[2];
+
+            // 使用标准灰度公式: 0.299*R + 0.587*G + 0.114*B
+            uint8_t gray = (uint8_t)(0.299 * r + 0.587 * g + 0.114 * b);
+
+            pixel[0] = gray; // B
+            pixel[1] = gray; // G
+            pixel[2] = gray; // R
+            // Alpha 通道保持不变
+        }
+    }
+}
+
+void ApplyMosaicFilter(uint8_t* buffer, int width, int height, int stride, int bytesPerPixel, int blockSize)
+{
+    if ((bytesPerPixel != 3 && bytesPerPixel != 4) || blockSize <= 0)
+        return;
+
+    for (int y = 0; y < height; y += blockSize)
+    {
+        for (int x = 0; x < width; x += blockSize)
+        {
+            // 计算马赛克块的平均颜色
+            int totalR = 0, totalG = 0, totalB = 0;
+            int count = 0;
+
+            // 采样块内的像素
+            for (int dy = 0; dy < blockSize && (y + dy) < height; dy++)
+            {
+                for (int dx = 0; dx < blockSize && (x + dx) < width; dx++)
+                {
+                    const uint8_t* pixel = buffer + (size_t)(y + dy) * stride + (x + dx) * bytesPerPixel;
+                    totalB += pixel[0];
+                    totalG += pixel[1];
+                    totalR += pixel[2];
+                    count++;
+                }
+            }
+
+            if (count > 0)
+            {
+                uint8_t avgR = totalR / count;
+                uint8_t avgG = totalG / count;
+                uint8_t avgB = totalB / count;
+
+                // 将平均颜色应用到整个块
+                for (int dy = 0; dy < blockSize && (y + dy) < height; dy++)
+                {
+                    for (int dx = 0; dx < blockSize && (x + dx) < width; dx++)
+                    {
+                        uint8_t* pixel = buffer + (size_t)(y + dy) * stride + (x + dx) * bytesPerPixel;
+                        pixel[0] = avgB; // B
+                        pixel[1] = avgG; // G
+                        pixel[2] = avgR; // R
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+// 显示流程中与平台无关的部分：缩放模式、显示区域计算和 CPU 滤镜
+// VideoPlayer（GDI/D3D9）与 OffscreenRenderer（无窗口）共用这些实现, 两者的画面布局和滤镜结果一致
+
+// 缩放模式枚举
+enum class ScalingMode {
+    FIT_TO_WINDOW,      // 适应窗口（保持宽高比，黑边填充）
+    ORIGINAL_SIZE       // 原始尺寸
+};
+
+// 滤镜类型枚举
+enum class FilterType {
+    NONE,           // 无滤镜
+    GRAYSCALE,      // 黑白
+    MOSAIC          // 马赛克
+};
+
+// 计算视频在窗口（后备缓冲区）中的显示区域, 尺寸无效时全部返回 0
+void CalculateDisplayRect(ScalingMode mode, int windowWidth, int windowHeight, int videoWidth, int videoHeight,
+                          int& displayWidth, int& displayHeight, int& offsetX, int& offsetY);
+
+// 在 BGR24 / BGRA 图像上原地应用滤镜, stride 为行字节数, Alpha 通道保持不变
+void ApplyFrameFilter(FilterType filter, int mosaicSize, uint8_t* buffer, int width, int height, int stride, int bytesPerPixel);
+void ApplyGrayscaleFilter(uint8_t* buffer, int width, int height, int stride, int bytesPerPixel);
+void ApplyMosaicFilter(uint8_t* buffer, int width, int height, int stride, int bytesPerPixel, int blockSize);
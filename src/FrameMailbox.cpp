@@ -0,0 +1,135 @@
+#include "FrameMailbox.h"
+#include <cstring>
+
+TripleBuffer::TripleBuffer()
+{
+    Reset();
+}
+
+void TripleBuffer::Publish()
+{
+    // release: 写入的帧数据对取得该槽的读端可见; acquire: 换回的槽已被读端用完
+    m_back = (int)(m_middle.exchange((unsigned)m_back | DIRTY_FLAG, std::memory_order_acq_rel) & INDEX_MASK);
+}
+
+bool TripleBuffer::Acquire()
+{
+    // 只有读端会清除标记, 检查后到交换前写端可能再次提交, 交换得到的仍是最新帧
+    if (!(m_middle.load(std::memory_order_relaxed) & DIRTY_FLAG))
+    {
+        return false;
+    }
+    m_front = (int)(m_middle.exchange((unsigned)m_front, std::memory_order_acq_rel) & INDEX_MASK);
+    return true;
+}
+
+void TripleBuffer::Reset()
+{
+    m_back = 0;
+    m_middle.store(1, std::memory_order_relaxed);
+    m_front = 2;
+}
+
+FrameMailbox::FrameMailbox()
+    : m_publishCount(0)
+    , m_frameBytes(0)
+    , m_charge(MemoryCategory::CONVERTED_FRAMES)
+{
+    for (int i = 0; i < TripleBuffer::SLOTS; i++)
+    {
+        m_frames[i] = nullptr;
+        m_versions[i] = 0;
+        m_infos[i] = FrameInfo{};
+    }
+}
+
+bool FrameMailbox::Allocate(size_t frameBytes, const FrameInfo& initial)
+{
+    Release();
+    if (frameBytes == 0)
+        return false;
+
+    for (int i = 0; i < TripleBuffer::SLOTS; i++)
+    {
+        m_storage[i].assign(frameBytes + ALIGNMENT, 0);
+        uintptr_t address = (uintptr_t)m_storage[i].data();
+        m_frames[i] = (uint8_t*)((address + ALIGNMENT - 1) & ~(uintptr_t)(ALIGNMENT - 1));
+        m_versions[i] = 0;
+        m_infos[i] = initial;
+    }
+
+    m_frameBytes = frameBytes;
+    m_charge.Set(TripleBuffer::SLOTS * (frameBytes + ALIGNMENT));
+    return true;
+}
+
+bool FrameMailbox::Attach(uint8_t* const buffers[TripleBuffer::SLOTS], size_t frameBytes, const FrameInfo& initial)
+{
+    Release();
+    if (frameBytes == 0)
+        return false;
+
+    for (int i = 0; i < TripleBuffer::SLOTS; i++)
+    {
+        if (!buffers[i])
+        {
+            Release();
+            return false;
+        }
+        memset(buffers[i], 0, frameBytes);
+        m_frames[i] = buffers[i];
+        m_versions[i] = 0;
+        m_infos[i] = initial;
+    }
+
+    m_frameBytes = frameBytes;
+    m_charge.Set(TripleBuffer::SLOTS * frameBytes);
+    return true;
+}
+
+void FrameMailbox::Release()
+{
+    for (int i = 0; i < TripleBuffer::SLOTS; i++)
+    {
+        std::vector<uint8_t>().swap(m_storage[i]);
+        m_frames[i] = nullptr;
+        m_versions[i] = 0;
+        m_infos[i] = FrameInfo{};
+    }
+    m_exchange.Reset();
+    m_publishCount = 0;
+    m_frameBytes = 0;
+    m_charge.Set(0);
+}
+
+uint8_t* FrameMailbox::WriteBuffer()
+{
+    return m_frames[m_exchange.WriteIndex()];
+}
+
+void FrameMailbox::Publish(const FrameInfo& info)
+{
+    m_infos[m_exchange.WriteIndex()] = info;
+    m_versions[m_exchange.WriteIndex()] = ++m_publishCount;
+    m_exchange.Publish();
+}
+
+bool FrameMailbox::Acquire()
+{
+    return m_exchange.Acquire();
+}
+
+const uint8_t* FrameMailbox::ReadBuffer() const
+{
+    return m_frames[m_exchange.ReadIndex()];
+}
+
+const FrameInfo& FrameMailbox::ReadInfo() const
+{
+    return m_infos[m_exchange.ReadIndex()];
+}
+
+uint64_t FrameMailbox::ReadVersion() const
+{
+    return m_versions[m_exchange.ReadIndex()];
+}
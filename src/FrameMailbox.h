@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include "FrameStats.h"
+#include "MemoryBudget.h"
+
+// 三缓冲索引交换 - 一个写线程、一个读线程, 双方都不等待对方
+// 三个槽分别为：写端正在写的后缓冲、最近一次提交的中间缓冲、读端正在使用的前缓冲
+// 写端提交时把后缓冲与中间缓冲交换, 读端获取时把前缓冲与中间缓冲交换;
+// 中间缓冲的索引和"有新帧"标记放在同一个原子变量中, 交换即完成所有权转移
+class TripleBuffer {
+public:
+    static const int SLOTS = 3;
+
+    TripleBuffer();
+
+    // 写端：当前可写的槽, 提交后换成另一个空闲槽
+    int WriteIndex() const { return m_back; }
+    void Publish();
+
+    // 读端：有新提交的帧时换到最新的槽并返回 true, 否则保持当前槽
+    bool Acquire();
+    int ReadIndex() const { return m_front; }
+
+    // 恢复初始状态, 只能在两端都空闲时调用
+    void Reset();
+
+private:
+    static const unsigned INDEX_MASK = 0x3;
+    static const unsigned DIRTY_FLAG = 0x4;
+
+    int m_back;                         // 仅写端访问
+    int m_front;                        // 仅读端访问
+    std::atomic<unsigned> m_middle;     // 中间槽索引 | DIRTY_FLAG
+};
+
+// 帧缓冲区中实际图像的尺寸（可小于分配容量, 如按显示尺寸转换时）
+struct FrameInfo {
+    int width;
+    int height;
+    int stride;         // 行字节数
+    FrameTiming timing; // 解码线程填写的解码/转换时间, 供呈现统计使用
+};
+
+// 视频帧邮箱 - 三个等大的帧缓冲区, 解码线程总是写入空闲缓冲区, 呈现端总是取最新的完整帧
+// 缓冲区（包括 Attach 的外部缓冲区）计入内存预算的 CONVERTED_FRAMES
+class FrameMailbox {
+public:
+    FrameMailbox();
+
+    // 分配三个帧缓冲区（清零）, 只能在两端都空闲时调用
+    // 初始帧信息为 initial, 读端在收到第一帧之前看到的是全黑的该尺寸图像
+    bool Allocate(size_t frameBytes, const FrameInfo& initial);
+    // 改用调用方提供的三个缓冲区（如 GDI 的 DIB 段）, 同样清零; 缓冲区由调用方在 Release 之后释放
+    bool Attach(uint8_t* const buffers[TripleBuffer::SLOTS], size_t frameBytes, const FrameInfo& initial);
+    void Release();
+    bool IsAllocated() const { return m_frameBytes > 0; }
+    size_t FrameBytes() const { return m_frameBytes; }
+
+    // 写端：info 描述写入的图像, height * stride 不能超过 FrameBytes()
+    uint8_t* WriteBuffer();
+    void Publish(const FrameInfo& info);
+
+    // 读端：返回是否取到了新帧; ReadBuffer 在下一次 Acquire 之前保持有效且不会被写端修改
+    bool Acquire();
+    const uint8_t* ReadBuffer() const;
+    const FrameInfo& ReadInfo() const;
+    uint64_t ReadVersion() const;       // 读端当前帧的提交序号, 0 表示尚未取到帧
+
+private:
+    static const size_t ALIGNMENT = 64;
+
+    TripleBuffer m_exchange;
+    std::vector<uint8_t> m_storage[TripleBuffer::SLOTS];   // Attach 时为空
+    uint8_t* m_frames[TripleBuffer::SLOTS];     // 按 ALIGNMENT 对齐后的起始地址, 或外部缓冲区
+    uint64_t m_versions[TripleBuffer::SLOTS];
+    FrameInfo m_infos[TripleBuffer::SLOTS];
+    uint64_t m_publishCount;                    // 仅写端访问
+    size_t m_frameBytes;
+    MemoryCharge m_charge;
+};
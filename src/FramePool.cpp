@@ -0,0 +1,250 @@
+#include "FramePool.h"
+#include "MemoryBudget.h"
+#include <new>
+#include <vector>
+
+extern "C" {
+#include "libavutil/imgutils.h"
+#include "libavutil/pixdesc.h"
+}
+
+// 每个平面之后留出的余量（FFmpeg 默认分配为 16 字节加一个 SIMD 步长）, 解码器的向量化写入可以越过平面末尾
+const size_t FramePool::PLANE_PADDING = 128;
+const size_t FramePool::SLAB_FRAMES = 4;
+
+struct FramePool::Slab {
+    explicit Slab(size_t bytes)
+        : frameBytes(bytes)
+        , outstanding(0)
+        , retired(false)
+        , charge(MemoryCategory::DECODED_FRAMES)
+    {
+    }
+
+    ~Slab()
+    {
+        for (uint8_t* block : blocks)
+        {
+            av_free(block);
+        }
+    }
+
+    // 取出一帧, 没有空闲帧时再分配一块
+    uint8_t* Acquire()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (freeFrames.empty())
+        {
+            uint8_t* block = (uint8_t*)av_malloc(frameBytes * SLAB_FRAMES + ALIGNMENT);
+            if (!block)
+                return nullptr;
+            blocks.push_back(block);
+            charge.Set(charge.Bytes() + frameBytes * SLAB_FRAMES + ALIGNMENT);
+
+            uint8_t* first = (uint8_t*)(((uintptr_t)block + ALIGNMENT - 1) & ~(uintptr_t)(ALIGNMENT - 1));
+            freeFrames.reserve(blocks.size() * SLAB_FRAMES);
+            for (size_t i = SLAB_FRAMES; i > 0; i--)
+            {
+                freeFrames.push_back(first + (i - 1) * frameBytes);
+            }
+        }
+
+        // 后进先出：最近归还的帧仍可能在缓存中
+        uint8_t* data = freeFrames.back();
+        freeFrames.pop_back();
+        outstanding++;
+        return data;
+    }
+
+    // 归还一帧; 返回 true 表示已退役且所有帧都已归还, 由调用方删除
+    bool Release(uint8_t* data)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        freeFrames.push_back(data);
+        outstanding--;
+        return retired && outstanding == 0;
+    }
+
+    // 池不再从这里分配; 返回 true 表示没有未归还的帧, 由调用方删除
+    bool Retire()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        retired = true;
+        return outstanding == 0;
+    }
+
+    std::mutex mutex;
+    size_t frameBytes;                  // ALIGNMENT 的倍数
+    std::vector<uint8_t*> blocks;       // av_malloc 返回的地址
+    std::vector<uint8_t*> freeFrames;
+    size_t outstanding;                 // 已取出未归还的帧数
+    bool retired;
+    MemoryCharge charge;
+};
+
+FramePool::FramePool()
+    : m_slab(nullptr)
+    , m_planes(0)
+    , m_format(AV_PIX_FMT_NONE)
+    , m_width(0)
+    , m_height(0)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        m_linesizes[i] = 0;
+        m_offsets[i] = 0;
+    }
+}
+
+FramePool::~FramePool()
+{
+    RetireSlab();
+}
+
+bool FramePool::Install(AVCodecContext* codecContext)
+{
+    if (!codecContext || codecContext->codec_type != AVMEDIA_TYPE_VIDEO || codecContext->opaque)
+        return false;
+
+    FramePool* pool = new (std::nothrow) FramePool();
+    if (!pool)
+        return false;
+    codecContext->opaque = pool;
+    codecContext->get_buffer2 = GetBuffer2;
+    return true;
+}
+
+void FramePool::FreeContext(AVCodecContext** codecContext)
+{
+    if (!codecContext || !*codecContext)
+        return;
+
+    // 解码器（包括帧线程）在 avcodec_free_context 中停止, 之后不会再调用 get_buffer2
+    FramePool* pool = (*codecContext)->get_buffer2 == GetBuffer2 ? static_cast<FramePool*>((*codecContext)->opaque) : nullptr;
+    avcodec_free_context(codecContext);
+    delete pool;
+}
+
+void FramePool::RetireSlab()
+{
+    // 仍被引用的帧（如呈现端持有的 YUV 帧）归还时删除
+    if (m_slab && m_slab->Retire())
+    {
+        delete m_slab;
+    }
+    m_slab = nullptr;
+    m_planes = 0;
+    m_format = AV_PIX_FMT_NONE;
+    m_width = 0;
+    m_height = 0;
+}
+
+void FramePool::ReturnFrame(void* opaque, uint8_t* data)
+{
+    Slab* slab = static_cast<Slab*>(opaque);
+    if (slab->Release(data))
+    {
+        delete slab;
+    }
+}
+
+bool FramePool::UpdateLayout(AVCodecContext* codecContext, const AVFrame* frame)
+{
+    if (m_slab && frame->format == m_format && frame->width == m_width && frame->height == m_height)
+        return true;
+    RetireSlab();
+
+    // 在解码器要求的宽高对齐基础上加宽, 直到每个平面的行字节数都是 ALIGNMENT 的倍数
+    // 不单独对齐各平面的行字节数, 有的解码器依赖平面之间的比例（如 4:2:2 时 linesize[0] == 2 * linesize[1]）
+    AVPixelFormat format = (AVPixelFormat)frame->format;
+    int width = frame->width;
+    int height = frame->height;
+    int strideAlign[AV_NUM_DATA_POINTERS];
+    avcodec_align_dimensions2(codecContext, &width, &height, strideAlign);
+
+    int linesizes[4];
+    bool unaligned = true;
+    while (unaligned)
+    {
+        if (av_image_fill_linesizes(linesizes, format, width) < 0)
+            return false;
+        // 宽度按其最低的非零位加倍
+        width += width & ~(width - 1);
+        unaligned = false;
+        for (int i = 0; i < 4; i++)
+        {
+            int align = strideAlign[i] > ALIGNMENT ? strideAlign[i] : ALIGNMENT;
+            if (linesizes[i] % align != 0)
+                unaligned = true;
+        }
+    }
+
+    ptrdiff_t planeLinesizes[4];
+    size_t planeSizes[4];
+    for (int i = 0; i < 4; i++)
+    {
+        planeLinesizes[i] = linesizes[i];
+    }
+    if (av_image_fill_plane_sizes(planeSizes, format, height, planeLinesizes) < 0)
+        return false;
+
+    // 平面依次排列, 各自带余量并按 ALIGNMENT 对齐
+    size_t frameBytes = 0;
+    int planes = 0;
+    for (int i = 0; i < 4 && planeSizes[i] > 0; i++)
+    {
+        m_offsets[i] = frameBytes;
+        m_linesizes[i] = linesizes[i];
+        frameBytes += (planeSizes[i] + PLANE_PADDING + ALIGNMENT - 1) & ~(size_t)(ALIGNMENT - 1);
+        planes++;
+    }
+    if (planes == 0)
+        return false;
+
+    m_slab = new (std::nothrow) Slab(frameBytes);
+    if (!m_slab)
+        return false;
+    m_planes = planes;
+    m_format = frame->format;
+    m_width = frame->width;
+    m_height = frame->height;
+    return true;
+}
+
+int FramePool::GetBuffer2(AVCodecContext* codecContext, AVFrame* frame, int flags)
+{
+    FramePool* pool = static_cast<FramePool*>(codecContext->opaque);
+    const AVPixFmtDescriptor* descriptor = av_pix_fmt_desc_get((AVPixelFormat)frame->format);
+    if (!pool || !descriptor || !(codecContext->codec->capabilities & AV_CODEC_CAP_DR1) ||
+        (descriptor->flags & (AV_PIX_FMT_FLAG_HWACCEL | AV_PIX_FMT_FLAG_PAL | AV_PIX_FMT_FLAG_BITSTREAM)))
+    {
+        return avcodec_default_get_buffer2(codecContext, frame, flags);
+    }
+
+    std::lock_guard<std::mutex> lock(pool->m_mutex);
+    if (!pool->UpdateLayout(codecContext, frame))
+    {
+        return avcodec_default_get_buffer2(codecContext, frame, flags);
+    }
+
+    Slab* slab = pool->m_slab;
+    uint8_t* data = slab->Acquire();
+    if (!data)
+        return AVERROR(ENOMEM);
+
+    // 整帧一个缓冲区引用, 释放时回到 slab 的空闲表
+    frame->buf[0] = av_buffer_create(data, slab->frameBytes, ReturnFrame, slab, 0);
+    if (!frame->buf[0])
+    {
+        slab->Release(data);
+        return AVERROR(ENOMEM);
+    }
+
+    for (int i = 0; i < AV_NUM_DATA_POINTERS; i++)
+    {
+        frame->data[i] = i < pool->m_planes ? data + pool->m_offsets[i] : nullptr;
+        frame->linesize[i] = i < pool->m_planes ? pool->m_linesizes[i] : 0;
+    }
+    frame->extended_data = frame->data;
+    return 0;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+extern "C" {
+#include "libavcodec/avcodec.h"
+}
+
+// 解码帧缓冲池 - 视频解码器的自定义 get_buffer2：帧缓冲区从按当前帧格式建立的分块内存（slab）中分配,
+// 每块连续容纳 SLAB_FRAMES 帧, 帧释放后回到空闲表; 解码器用到的帧数稳定后播放期间不再分配内存。
+// 一帧的各平面放在同一缓冲区中, 平面起始地址和每个平面的行字节数都按 ALIGNMENT 对齐,
+// SIMD 按行读写不跨缓存行, 纹理行距与之相同时整个平面一次复制。块内存（包括空闲的帧）计入内存预算的 DECODED_FRAMES
+// 硬件帧、调色板格式和不支持自定义缓冲区（没有 AV_CODEC_CAP_DR1）的解码器仍使用 FFmpeg 默认的分配
+// get_buffer2 可能在解码器的帧线程中调用, 布局的重建在锁内完成
+class FramePool {
+public:
+    static const int ALIGNMENT = 64;
+
+    // 为解码器安装缓冲池（avcodec_open2 之前调用）, 之后必须用 FreeContext 释放解码器
+    static bool Install(AVCodecContext* codecContext);
+    // 代替 avcodec_free_context; 仍被引用的帧保持有效, 分块内存在最后一帧释放时归还
+    static void FreeContext(AVCodecContext** codecContext);
+
+private:
+    // 同一布局的帧缓冲区; 格式变化或池释放后由最后归还的帧删除
+    struct Slab;
+
+    FramePool();
+    ~FramePool();
+    FramePool(const FramePool&) = delete;
+    FramePool& operator=(const FramePool&) = delete;
+
+    static int GetBuffer2(AVCodecContext* codecContext, AVFrame* frame, int flags);
+    static void ReturnFrame(void* opaque, uint8_t* data);
+
+    // 帧格式或尺寸变化时重新计算布局并换用新的 slab（调用方持有 m_mutex）
+    bool UpdateLayout(AVCodecContext* codecContext, const AVFrame* frame);
+    void RetireSlab();
+
+    std::mutex m_mutex;
+    Slab* m_slab;
+    int m_planes;
+    int m_linesizes[4];
+    size_t m_offsets[4];        // 各平面在帧缓冲区中的偏移
+    int m_format;
+    int m_width;
+    int m_height;
+
+    static const size_t PLANE_PADDING;
+    static const size_t SLAB_FRAMES;
+};
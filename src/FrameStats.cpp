@@ -0,0 +1,264 @@
+#include "FrameStats.h"
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+
+// 文本直方图的最大条形长度
+static const int REPORT_BAR_WIDTH = 40;
+
+FrameStatsRecorder::FrameStatsRecorder(size_t capacity)
+    : m_frames((std::max)(capacity, (size_t)1))
+{
+    m_vsyncIntervalMs = 0.0;
+    Reset();
+}
+
+void FrameStatsRecorder::Reset()
+{
+    m_next = 0;
+    m_count = 0;
+    m_histogram.assign(HISTOGRAM_MAX_MS + 1, 0);
+    m_lastSequence = 0;
+    m_lastPresentedMs = 0.0;
+    m_baseMs = 0.0;
+    m_presentedFrames = 0;
+    m_droppedFrames = 0;
+    m_repeatedPresents = 0;
+    m_lateFrames = 0;
+    m_missedVsyncs = 0;
+    m_frameTimeSamples = 0;
+    m_totalFrameTimeMs = 0.0;
+    m_maxFrameTimeMs = 0.0;
+    m_totalLatencyMs = 0.0;
+}
+
+void FrameStatsRecorder::RecordPresented(const FrameTiming& timing)
+{
+    FrameTiming frame = timing;
+    frame.frameTimeMs = 0.0;
+    frame.missedVsyncs = 0;
+    frame.late = frame.deadlineMs > 0.0 && frame.presentedMs > frame.deadlineMs;
+
+    if (m_presentedFrames == 0)
+    {
+        m_baseMs = frame.decodeDoneMs;
+    }
+    else
+    {
+        // 序号不连续说明中间的帧被新帧覆盖, 从未呈现
+        uint64_t gap = 1;
+        if (frame.sequence > m_lastSequence)
+        {
+            gap = frame.sequence - m_lastSequence;
+            m_droppedFrames += gap - 1;
+        }
+
+        frame.frameTimeMs = frame.presentedMs - m_lastPresentedMs;
+        m_totalFrameTimeMs += frame.frameTimeMs;
+        m_maxFrameTimeMs = (std::max)(m_maxFrameTimeMs, frame.frameTimeMs);
+        m_frameTimeSamples++;
+
+        int bucket = (int)frame.frameTimeMs;
+        bucket = (std::max)(0, (std::min)(HISTOGRAM_MAX_MS, bucket));
+        m_histogram[bucket]++;
+
+        // 比预期间隔多出半个以上刷新周期, 即错过了垂直同步
+        double nominal = (frame.deadlineMs - frame.decodeDoneMs) * gap;
+        double extra = frame.frameTimeMs - nominal;
+        if (m_vsyncIntervalMs > 0.0 && nominal > 0.0 && extra > m_vsyncIntervalMs * 0.5)
+        {
+            frame.missedVsyncs = (int)((extra + m_vsyncIntervalMs * 0.5) / m_vsyncIntervalMs);
+            m_missedVsyncs += frame.missedVsyncs;
+        }
+    }
+
+    if (frame.late)
+        m_lateFrames++;
+    m_totalLatencyMs += frame.presentedMs - frame.decodeDoneMs;
+    m_presentedFrames++;
+    m_lastSequence = frame.sequence;
+    m_lastPresentedMs = frame.presentedMs;
+
+    m_frames[m_next] = frame;
+    m_next = (m_next + 1) % m_frames.size();
+    if (m_count < m_frames.size())
+        m_count++;
+}
+
+double FrameStatsRecorder::PercentileMs(double fraction) const
+{
+    if (m_frameTimeSamples == 0)
+        return 0.0;
+
+    // 按直方图估计, 精度为 1 毫秒（取所在格的上界, 不超过最大值）
+    uint64_t target = (uint64_t)std::ceil(fraction * m_frameTimeSamples);
+    uint64_t seen = 0;
+    for (int i = 0; i <= HISTOGRAM_MAX_MS; i++)
+    {
+        seen += m_histogram[i];
+        if (seen >= target)
+            return (i < HISTOGRAM_MAX_MS) ? (std::min)((double)(i + 1), m_maxFrameTimeMs) : m_maxFrameTimeMs;
+    }
+    return m_maxFrameTimeMs;
+}
+
+FrameStatsSummary FrameStatsRecorder::GetSummary() const
+{
+    FrameStatsSummary summary;
+    summary.presentedFrames = m_presentedFrames;
+    summary.droppedFrames = m_droppedFrames;
+    summary.repeatedPresents = m_repeatedPresents;
+    summary.lateFrames = m_lateFrames;
+    summary.missedVsyncs = m_missedVsyncs;
+    summary.vsyncIntervalMs = m_vsyncIntervalMs;
+    summary.averageFrameTimeMs = m_frameTimeSamples ? m_totalFrameTimeMs / m_frameTimeSamples : 0.0;
+    summary.p50FrameTimeMs = PercentileMs(0.50);
+    summary.p95FrameTimeMs = PercentileMs(0.95);
+    summary.p99FrameTimeMs = PercentileMs(0.99);
+    summary.maxFrameTimeMs = m_maxFrameTimeMs;
+    summary.averageLatencyMs = m_presentedFrames ? m_totalLatencyMs / m_presentedFrames : 0.0;
+    return summary;
+}
+
+size_t FrameStatsRecorder::GetRecent(FrameTiming* out, size_t maxCount) const
+{
+    size_t count = (std::min)(maxCount, m_count);
+    size_t start = (m_next + m_frames.size() - count) % m_frames.size();
+    for (size_t i = 0; i < count; i++)
+    {
+        out[i] = m_frames[(start + i) % m_frames.size()];
+    }
+    return count;
+}
+
+bool FrameStatsRecorder::ExportCsv(const std::string& path) const
+{
+    std::ofstream out(path, std::ios::trunc);
+    if (!out)
+    {
+        std::cerr << "Failed to open frame stats file: " << path << std::endl;
+        return false;
+    }
+
+    std::vector<FrameTiming> frames(m_count);
+    GetRecent(frames.data(), frames.size());
+
+    out << std::fixed << std::setprecision(3);
+    out << "sequence,pts,decode_done_ms,convert_done_ms,filter_done_ms,presented_ms,deadline_ms,"
+           "frame_time_ms,latency_ms,late,missed_vsyncs\n";
+    for (const FrameTiming& frame : frames)
+    {
+        out << frame.sequence << ','
+            << frame.pts << ','
+            << frame.decodeDoneMs - m_baseMs << ','
+            << frame.convertDoneMs - m_baseMs << ','
+            << frame.filterDoneMs - m_baseMs << ','
+            << frame.presentedMs - m_baseMs << ','
+            << frame.deadlineMs - m_baseMs << ','
+            << frame.frameTimeMs << ','
+            << frame.presentedMs - frame.decodeDoneMs << ','
+            << (frame.late ? 1 : 0) << ','
+            << frame.missedVsyncs << '\n';
+    }
+    return (bool)out;
+}
+
+bool FrameStatsRecorder::ExportJson(const std::string& path) const
+{
+    std::ofstream out(path, std::ios::trunc);
+    if (!out)
+    {
+        std::cerr << "Failed to open frame stats file: " << path << std::endl;
+        return false;
+    }
+
+    FrameStatsSummary summary = GetSummary();
+    std::vector<FrameTiming> frames(m_count);
+    GetRecent(frames.data(), frames.size());
+
+    out << std::fixed << std::setprecision(3);
+    out << "{\n  \"summary\": {"
+        << "\"presented_frames\": " << summary.presentedFrames
+        << ", \"dropped_frames\": " << summary.droppedFrames
+        << ", \"repeated_presents\": " << summary.repeatedPresents
+        << ", \"late_frames\": " << summary.lateFrames
+        << ", \"missed_vsyncs\": " << summary.missedVsyncs
+        << ", \"vsync_interval_ms\": " << summary.vsyncIntervalMs
+        << ", \"average_frame_time_ms\": " << summary.averageFrameTimeMs
+        << ", \"p50_frame_time_ms\": " << summary.p50FrameTimeMs
+        << ", \"p95_frame_time_ms\": " << summary.p95FrameTimeMs
+        << ", \"p99_frame_time_ms\": " << summary.p99FrameTimeMs
+        << ", \"max_frame_time_ms\": " << summary.maxFrameTimeMs
+        << ", \"average_latency_ms\": " << summary.averageLatencyMs
+        << "},\n";
+
+    out << "  \"frame_time_histogram\": {\"bucket_ms\": 1, \"counts\": [";
+    for (size_t i = 0; i < m_histogram.size(); i++)
+    {
+        out << (i ? ", " : "") << m_histogram[i];
+    }
+    out << "]},\n";
+
+    out << "  \"frames\": [\n";
+    for (size_t i = 0; i < frames.size(); i++)
+    {
+        const FrameTiming& frame = frames[i];
+        out << "    {\"sequence\": " << frame.sequence
+            << ", \"pts\": " << frame.pts
+            << ", \"decode_done_ms\": " << frame.decodeDoneMs - m_baseMs
+            << ", \"convert_done_ms\": " << frame.convertDoneMs - m_baseMs
+            << ", \"filter_done_ms\": " << frame.filterDoneMs - m_baseMs
+            << ", \"presented_ms\": " << frame.presentedMs - m_baseMs
+            << ", \"deadline_ms\": " << frame.deadlineMs - m_baseMs
+            << ", \"frame_time_ms\": " << frame.frameTimeMs
+            << ", \"late\": " << (frame.late ? "true" : "false")
+            << ", \"missed_vsyncs\": " << frame.missedVsyncs
+            << "}" << (i + 1 < frames.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+    return (bool)out;
+}
+
+void FrameStatsRecorder::WriteReport(std::ostream& out) const
+{
+    FrameStatsSummary summary = GetSummary();
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+
+    out << std::fixed << std::setprecision(2);
+    out << "Frame pacing: " << summary.presentedFrames << " presented, " << summary.droppedFrames << " dropped, "
+        << summary.repeatedPresents << " repeated, " << summary.lateFrames << " late, "
+        << summary.missedVsyncs << " missed vsyncs";
+    if (summary.vsyncIntervalMs > 0.0)
+        out << " (vsync " << summary.vsyncIntervalMs << " ms)";
+    out << "\n";
+    out << "Frame time: avg " << summary.averageFrameTimeMs << " ms, p50 " << summary.p50FrameTimeMs
+        << " ms, p95 " << summary.p95FrameTimeMs << " ms, p99 " << summary.p99FrameTimeMs
+        << " ms, max " << summary.maxFrameTimeMs << " ms; decode-to-present avg "
+        << summary.averageLatencyMs << " ms\n";
+
+    uint64_t peak = 0;
+    for (uint64_t count : m_histogram)
+        peak = (std::max)(peak, count);
+
+    if (peak > 0)
+    {
+        out << "Frame time histogram (1 ms buckets):\n";
+        for (int i = 0; i <= HISTOGRAM_MAX_MS; i++)
+        {
+            if (m_histogram[i] == 0)
+                continue;
+            int bar = (int)((m_histogram[i] * REPORT_BAR_WIDTH + peak - 1) / peak);
+            if (i < HISTOGRAM_MAX_MS)
+                out << std::setw(5) << i << "-" << std::left << std::setw(4) << i + 1 << std::right;
+            else
+                out << std::setw(5) << HISTOGRAM_MAX_MS << "+   ";
+            out << " ms " << std::setw(8) << m_histogram[i] << " " << std::string(bar, '#') << "\n";
+        }
+    }
+
+    out.flags(flags);
+    out.precision(precision);
+}
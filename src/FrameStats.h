@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// 单帧在呈现流程中各阶段完成的时间（毫秒, 同一时间基）
+// 解码线程填写解码/转换时间并随帧一起交给呈现端, 其余字段由呈现端和统计器填写
+struct FrameTiming {
+    uint64_t sequence;          // 解码序号（从 1 开始, 0 表示无效）
+    double pts;                 // 秒
+    double decodeDoneMs;
+    double convertDoneMs;       // 纹理路径中颜色转换在着色器中完成, 等于解码完成时间
+    double filterDoneMs;        // 滤镜完成（或纹理上传完成）
+    double presentedMs;
+    double deadlineMs;          // 最晚呈现时间：下一帧到期的时间
+    double frameTimeMs;         // 与上一个新帧呈现的间隔
+    int missedVsyncs;           // 相对于预期间隔多等待的垂直同步次数
+    bool late;                  // 呈现时间晚于 deadlineMs
+};
+
+struct FrameStatsSummary {
+    uint64_t presentedFrames;   // 呈现的新帧数
+    uint64_t droppedFrames;     // 解码后未被呈现就被新帧覆盖的帧数（序号间隔）
+    uint64_t repeatedPresents;  // 没有新帧的重复呈现（重绘）次数
+    uint64_t lateFrames;
+    uint64_t missedVsyncs;
+    double vsyncIntervalMs;     // 0 表示未知
+    double averageFrameTimeMs;
+    double p50FrameTimeMs;
+    double p95FrameTimeMs;
+    double p99FrameTimeMs;
+    double maxFrameTimeMs;
+    double averageLatencyMs;    // 解码完成到呈现的平均延迟
+};
+
+// 帧节奏统计 - 记录最近的帧时间线, 统计丢帧/迟到/重复呈现/错过的垂直同步, 生成帧间隔直方图
+// 只由呈现线程访问, 不加锁
+class FrameStatsRecorder {
+public:
+    static const int HISTOGRAM_MAX_MS = 100;    // 直方图按 1 毫秒分格, 最后一格统计所有更长的间隔
+
+    explicit FrameStatsRecorder(size_t capacity = 4096);
+
+    void Reset();
+    void SetVsyncInterval(double intervalMs) { m_vsyncIntervalMs = intervalMs; }
+
+    // 新帧呈现后调用, timing.presentedMs 必须已填写
+    void RecordPresented(const FrameTiming& timing);
+    // 没有新帧的重绘
+    void RecordRepeat() { m_repeatedPresents++; }
+
+    FrameStatsSummary GetSummary() const;
+    const std::vector<uint64_t>& GetHistogram() const { return m_histogram; }
+
+    // 按时间顺序取最近 maxCount 帧（最新的在最后）, 返回实际数量
+    size_t GetRecent(FrameTiming* out, size_t maxCount) const;
+
+    // 导出最近的帧时间线, 时间相对于记录中第一帧的解码完成时间
+    bool ExportCsv(const std::string& path) const;
+    bool ExportJson(const std::string& path) const;
+
+    // 文本报告：汇总和帧间隔直方图
+    void WriteReport(std::ostream& out) const;
+
+private:
+    double PercentileMs(double fraction) const;
+
+    std::vector<FrameTiming> m_frames;      // 环形缓冲区
+    size_t m_next;
+    size_t m_count;
+
+    std::vector<uint64_t> m_histogram;
+    uint64_t m_lastSequence;
+    double m_lastPresentedMs;
+    double m_baseMs;                        // 第一帧的解码完成时间, 导出时作为零点
+    double m_vsyncIntervalMs;
+
+    uint64_t m_presentedFrames;
+    uint64_t m_droppedFrames;
+    uint64_t m_repeatedPresents;
+    uint64_t m_lateFrames;
+    uint64_t m_missedVsyncs;
+    uint64_t m_frameTimeSamples;
+    double m_totalFrameTimeMs;
+    double m_maxFrameTimeMs;
+    double m_totalLatencyMs;
+};
@@ -0,0 +1,132 @@
+#include "FrameStatsOverlay.h"
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+
+static const int OVERLAY_WIDTH = 320;
+static const int OVERLAY_HEIGHT = 130;
+static const int OVERLAY_MARGIN = 8;       // 与进度条的间距
+static const int TEXT_LINE_HEIGHT = 16;
+static const int GRAPH_FRAMES = 150;       // 柱状图显示的帧数
+static const double GRAPH_MAX_MS = 50.0;   // 柱状图纵轴上限
+
+FrameStatsOverlay::FrameStatsOverlay()
+    : m_isVisible(false)
+    , m_font(nullptr)
+{
+    SetRectEmpty(&m_rect);
+    m_recent.resize(GRAPH_FRAMES);
+    m_font = CreateFont(-12, 0, 0, 0, FW_NORMAL, FALSE, FALSE, FALSE, DEFAULT_CHARSET,
+                        OUT_DEFAULT_PRECIS, CLIP_DEFAULT_PRECIS, DEFAULT_QUALITY,
+                        FIXED_PITCH | FF_MODERN, "Consolas");
+}
+
+FrameStatsOverlay::~FrameStatsOverlay()
+{
+    if (m_font)
+    {
+        DeleteObject(m_font);
+        m_font = nullptr;
+    }
+}
+
+void FrameStatsOverlay::OnPaint(HDC hdc, const RECT& anchor, const FrameStatsRecorder& stats)
+{
+    if (!m_isVisible)
+        return;
+
+    m_rect.left = anchor.left;
+    m_rect.bottom = anchor.top - OVERLAY_MARGIN;
+    m_rect.right = m_rect.left + OVERLAY_WIDTH;
+    m_rect.top = m_rect.bottom - OVERLAY_HEIGHT;
+    if (m_rect.top < 0)
+        return;
+
+    // 在内存 DC 中绘制后一次拷贝, 避免与视频画面交替闪烁
+    HDC memDC = CreateCompatibleDC(hdc);
+    HBITMAP bitmap = CreateCompatibleBitmap(hdc, OVERLAY_WIDTH, OVERLAY_HEIGHT);
+    if (!memDC || !bitmap)
+    {
+        if (bitmap) DeleteObject(bitmap);
+        if (memDC) DeleteDC(memDC);
+        return;
+    }
+    HBITMAP oldBitmap = (HBITMAP)SelectObject(memDC, bitmap);
+    HFONT oldFont = (HFONT)SelectObject(memDC, m_font);
+
+    RECT local = { 0, 0, OVERLAY_WIDTH, OVERLAY_HEIGHT };
+    HBRUSH background = CreateSolidBrush(RGB(24, 24, 24));
+    FillRect(memDC, &local, background);
+    DeleteObject(background);
+
+    FrameStatsSummary summary = stats.GetSummary();
+    char lines[3][128];
+    snprintf(lines[0], sizeof(lines[0]), "Frames %llu  drop %llu  late %llu  repeat %llu",
+             (unsigned long long)summary.presentedFrames, (unsigned long long)summary.droppedFrames,
+             (unsigned long long)summary.lateFrames, (unsigned long long)summary.repeatedPresents);
+    snprintf(lines[1], sizeof(lines[1]), "Frame time avg %.1f  p95 %.0f  p99 %.0f  max %.1f ms",
+             summary.averageFrameTimeMs, summary.p95FrameTimeMs, summary.p99FrameTimeMs, summary.maxFrameTimeMs);
+    snprintf(lines[2], sizeof(lines[2]), "Vsync %.2f ms  missed %llu  latency %.1f ms",
+             summary.vsyncIntervalMs, (unsigned long long)summary.missedVsyncs, summary.averageLatencyMs);
+
+    SetBkMode(memDC, TRANSPARENT);
+    SetTextColor(memDC, RGB(230, 230, 230));
+    for (int i = 0; i < 3; i++)
+    {
+        TextOut(memDC, 6, 4 + i * TEXT_LINE_HEIGHT, lines[i], (int)strlen(lines[i]));
+    }
+
+    RECT graph = { 6, 4 + 3 * TEXT_LINE_HEIGHT + 4, OVERLAY_WIDTH - 6, OVERLAY_HEIGHT - 6 };
+    size_t frames = stats.GetRecent(m_recent.data(), m_recent.size());
+    DrawGraph(memDC, graph, summary, frames);
+
+    BitBlt(hdc, m_rect.left, m_rect.top, OVERLAY_WIDTH, OVERLAY_HEIGHT, memDC, 0, 0, SRCCOPY);
+
+    SelectObject(memDC, oldFont);
+    SelectObject(memDC, oldBitmap);
+    DeleteObject(bitmap);
+    DeleteDC(memDC);
+}
+
+void FrameStatsOverlay::DrawGraph(HDC hdc, const RECT& area, const FrameStatsSummary& summary, size_t frames)
+{
+    HBRUSH graphBackground = CreateSolidBrush(RGB(40, 40, 40));
+    FillRect(hdc, &area, graphBackground);
+    DeleteObject(graphBackground);
+
+    int height = area.bottom - area.top;
+
+    // 最近各帧的帧间隔, 迟到的帧标红, 错过垂直同步的帧标黄
+    HBRUSH normalBrush = CreateSolidBrush(RGB(90, 200, 120));
+    HBRUSH lateBrush = CreateSolidBrush(RGB(230, 70, 60));
+    HBRUSH missedBrush = CreateSolidBrush(RGB(230, 190, 60));
+
+    int barWidth = (std::max)(1, (area.right - area.left) / GRAPH_FRAMES);
+    for (size_t i = 0; i < frames; i++)
+    {
+        const FrameTiming& frame = m_recent[i];
+        if (frame.sequence == 0 || frame.frameTimeMs <= 0.0)
+            continue;
+
+        int barHeight = (int)((std::min)(frame.frameTimeMs, GRAPH_MAX_MS) / GRAPH_MAX_MS * height);
+        RECT bar = { area.left + (int)i * barWidth, area.bottom - barHeight,
+                     area.left + (int)(i + 1) * barWidth, area.bottom };
+        FillRect(hdc, &bar, frame.late ? lateBrush : (frame.missedVsyncs > 0 ? missedBrush : normalBrush));
+    }
+
+    DeleteObject(normalBrush);
+    DeleteObject(lateBrush);
+    DeleteObject(missedBrush);
+
+    // 垂直同步间隔参考线
+    if (summary.vsyncIntervalMs > 0.0 && summary.vsyncIntervalMs < GRAPH_MAX_MS)
+    {
+        int y = area.bottom - (int)(summary.vsyncIntervalMs / GRAPH_MAX_MS * height);
+        HPEN pen = CreatePen(PS_DOT, 1, RGB(160, 160, 160));
+        HPEN oldPen = (HPEN)SelectObject(hdc, pen);
+        MoveToEx(hdc, area.left, y, nullptr);
+        LineTo(hdc, area.right, y);
+        SelectObject(hdc, oldPen);
+        DeleteObject(pen);
+    }
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <windows.h>
+#include <vector>
+#include "FrameStats.h"
+
+// 帧节奏统计叠加层 - 绘制在进度条上方, 显示丢帧/迟到/垂直同步统计和最近帧间隔的柱状图
+class FrameStatsOverlay {
+public:
+    FrameStatsOverlay();
+    ~FrameStatsOverlay();
+
+    void Show(bool visible) { m_isVisible = visible; }
+    bool IsVisible() const { return m_isVisible; }
+
+    // anchor 为进度条区域, 叠加层左对齐放在其上方
+    void OnPaint(HDC hdc, const RECT& anchor, const FrameStatsRecorder& stats);
+
+    // 上一次绘制的区域（隐藏时用于刷新）
+    RECT GetRect() const { return m_rect; }
+
+private:
+    void DrawGraph(HDC hdc, const RECT& area, const FrameStatsSummary& summary, size_t frames);
+
+    bool m_isVisible;
+    RECT m_rect;
+    HFONT m_font;
+    std::vector<FrameTiming> m_recent;     // 最近帧的时间线（绘制时从统计器复制）
+};
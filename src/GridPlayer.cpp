@@ -0,0 +1,920 @@
+#include "GridPlayer.h"
+#include "FramePool.h"
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+static const int MAX_GRID_TILES = 64;
+static const int TILE_BORDER = 2;                   // 宫格边框宽度（焦点宫格高亮）
+static const int BYTES_PER_PIXEL = 4;               // 宫格帧为 BGRA
+static const double SKIP_LOOP_FILTER_SCALE = 2.0;   // 缩小到 1/2 以下时环路滤波的效果已不可见
+static const double KEYFRAME_ONLY_SCALE = 6.0;      // 非焦点宫格缩小到 1/6 以下时只解码关键帧
+static const int MAX_SKIPPED_FRAMES = 8;            // 一次解码任务最多连续跳过的落后帧
+static const double RESYNC_MS = 1000.0;             // 落后超过该值时把时钟重新对齐到当前帧
+static const double MAX_AHEAD_MS = 10000.0;         // 时间戳向前跳变超过该值时重新对齐
+static const DWORD MAX_SCHEDULER_WAIT_MS = 10;
+
+static double QpcNowMs()
+{
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart * 1000.0 / frequency.QuadPart;
+}
+
+GridPlayer::Tile::Tile()
+    : index(0)
+    , formatContext(nullptr)
+    , codecContext(nullptr)
+    , codec(nullptr)
+    , packet(nullptr)
+    , frame(nullptr)
+    , swsContext(nullptr)
+    , videoStreamIndex(-1)
+    , videoWidth(0)
+    , videoHeight(0)
+    , frameRate(25.0)
+    , decoderThreads(1)
+    , wantedLowres(0)
+    , wantedKeyframeOnly(false)
+    , wantedSkipLoopFilter(false)
+    , lowres(0)
+    , keyframeOnly(false)
+    , skipLoopFilter(false)
+    , overloaded(false)
+    , waitForKeyframe(true)
+    , audioEnabled(true)
+    , rebase(true)
+    , baseClockMs(0.0)
+    , basePts(0.0)
+    , lastPts(NAN)
+    , lastDueMs(0.0)
+    , sawFrameSinceLoop(false)
+    , state(TILE_IDLE)
+    , draining(false)
+    , readyDueMs(0.0)
+    , convertSize(0)
+    , capacityWidth(0)
+    , capacityHeight(0)
+    , decodedFrames(0)
+    , presentedFrames(0)
+    , skippedFrames(0)
+    , resyncs(0)
+{
+    memset(&readyInfo, 0, sizeof(readyInfo));
+    SetRectEmpty(&rect);
+}
+
+GridPlayer::GridPlayer()
+    : m_columns(1)
+    , m_rows(1)
+    , m_clientWidth(0)
+    , m_clientHeight(0)
+    , m_hwnd(nullptr)
+    , m_schedulerThread(nullptr)
+    , m_wakeEvent(nullptr)
+    , m_shouldStop(false)
+    , m_isPlaying(false)
+    , m_isPaused(false)
+    , m_pauseStartMs(0.0)
+    , m_pausedMs(0.0)
+    , m_focus(-1)
+    , m_audioReady(false)
+{
+    m_wakeEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+}
+
+GridPlayer::~GridPlayer()
+{
+    Close();
+    if (m_wakeEvent)
+    {
+        CloseHandle(m_wakeEvent);
+        m_wakeEvent = nullptr;
+    }
+}
+
+bool GridPlayer::Open(HWND hwnd, const std::vector<std::string>& paths)
+{
+    Close();
+    m_hwnd = hwnd;
+
+    for (size_t i = 0; i < paths.size() && (int)m_tiles.size() < MAX_GRID_TILES; i++)
+    {
+        std::unique_ptr<Tile> tile(new Tile());
+        tile->path = paths[i];
+        if (OpenTile(*tile))
+        {
+            m_tiles.push_back(std::move(tile));
+        }
+        else
+        {
+            CloseTile(*tile);
+            std::cerr << "Grid: skipping " << paths[i] << std::endl;
+        }
+    }
+    if (m_tiles.empty())
+    {
+        return false;
+    }
+
+    int count = (int)m_tiles.size();
+    m_columns = (int)std::ceil(std::sqrt((double)count));
+    m_rows = (count + m_columns - 1) / m_columns;
+
+    // 多路解码的并行度由线程池提供; 路数少于核心数时把剩余核心分给各路解码器自身的线程
+    m_pool.Start(0);
+    int decoderThreads = (std::max)(1, m_pool.ThreadCount() / count);
+
+    // 宫格最大不超过虚拟屏幕的一格, 帧缓冲按此容量分配（16 路 1080p 时每路只需约 1/16 的内存）
+    int screenWidth = GetSystemMetrics(SM_CXVIRTUALSCREEN);
+    int screenHeight = GetSystemMetrics(SM_CYVIRTUALSCREEN);
+
+    for (size_t i = 0; i < m_tiles.size(); )
+    {
+        Tile& tile = *m_tiles[i];
+        tile.decoderThreads = decoderThreads;
+
+        int capacityWidth, capacityHeight, offsetX, offsetY;
+        CalculateDisplayRect(ScalingMode::FIT_TO_WINDOW, screenWidth / m_columns, screenHeight / m_rows,
+                             tile.videoWidth, tile.videoHeight, capacityWidth, capacityHeight, offsetX, offsetY);
+        tile.capacityWidth = (std::max)(1, (std::min)(capacityWidth, tile.videoWidth));
+        tile.capacityHeight = (std::max)(1, (std::min)(capacityHeight, tile.videoHeight));
+
+        FrameInfo initial;
+        memset(&initial, 0, sizeof(initial));
+        initial.width = tile.capacityWidth;
+        initial.height = tile.capacityHeight;
+        initial.stride = tile.capacityWidth * BYTES_PER_PIXEL;
+
+        if (!OpenDecoder(tile, 0) || !tile.mailbox.Allocate((size_t)initial.stride * initial.height, initial))
+        {
+            std::cerr << "Grid: failed to open decoder for " << tile.path << std::endl;
+            CloseTile(tile);
+            m_tiles.erase(m_tiles.begin() + i);
+            continue;
+        }
+        tile.index = (int)i;
+        i++;
+    }
+    if (m_tiles.empty())
+    {
+        m_pool.Stop();
+        return false;
+    }
+
+    std::cout << "Grid: " << m_tiles.size() << " tiles (" << m_columns << "x" << m_rows << "), "
+              << m_pool.ThreadCount() << " pool threads, " << decoderThreads << " decoder threads per tile" << std::endl;
+
+    SetFocus(0);
+
+    RECT clientRect;
+    GetClientRect(m_hwnd, &clientRect);
+    OnResize(clientRect.right - clientRect.left, clientRect.bottom - clientRect.top);
+    return true;
+}
+
+bool GridPlayer::OpenTile(Tile& tile)
+{
+    if (avformat_open_input(&tile.formatContext, tile.path.c_str(), nullptr, nullptr) != 0)
+    {
+        std::cerr << "Failed to open video file: " << tile.path << std::endl;
+        return false;
+    }
+
+    if (avformat_find_stream_info(tile.formatContext, nullptr) < 0)
+    {
+        std::cerr << "Failed to find stream info" << std::endl;
+        return false;
+    }
+
+    tile.videoStreamIndex = av_find_best_stream(tile.formatContext, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+    if (tile.videoStreamIndex < 0)
+    {
+        std::cerr << "No video stream found" << std::endl;
+        return false;
+    }
+
+    AVStream* stream = tile.formatContext->streams[tile.videoStreamIndex];
+    tile.codec = avcodec_find_decoder(stream->codecpar->codec_id);
+    if (!tile.codec)
+    {
+        std::cerr << "Failed to find decoder for codec ID: " << stream->codecpar->codec_id << std::endl;
+        return false;
+    }
+
+    tile.videoWidth = stream->codecpar->width;
+    tile.videoHeight = stream->codecpar->height;
+    if (tile.videoWidth <= 0 || tile.videoHeight <= 0)
+    {
+        return false;
+    }
+
+    AVRational frameRate = stream->r_frame_rate;
+    if (frameRate.num > 0 && frameRate.den > 0)
+    {
+        tile.frameRate = av_q2d(frameRate);
+    }
+    if (tile.frameRate > 240.0 || tile.frameRate < 1.0)
+    {
+        tile.frameRate = 25.0;
+    }
+
+    tile.packet = av_packet_alloc();
+    tile.frame = av_frame_alloc();
+    return tile.packet && tile.frame;
+}
+
+bool GridPlayer::OpenDecoder(Tile& tile, int lowres)
+{
+    if (tile.codecContext)
+    {
+        FramePool::FreeContext(&tile.codecContext);
+    }
+
+    tile.codecContext = avcodec_alloc_context3(tile.codec);
+    if (!tile.codecContext)
+    {
+        return false;
+    }
+    FramePool::Install(tile.codecContext);
+
+    if (avcodec_parameters_to_context(tile.codecContext, tile.formatContext->streams[tile.videoStreamIndex]->codecpar) < 0)
+    {
+        FramePool::FreeContext(&tile.codecContext);
+        return false;
+    }
+
+    // lowres 只能在打开解码器之前设置, 输出帧的宽高按 2^lowres 缩小
+    tile.codecContext->thread_count = tile.decoderThreads;
+    tile.codecContext->lowres = lowres;
+    if (avcodec_open2(tile.codecContext, tile.codec, nullptr) < 0)
+    {
+        FramePool::FreeContext(&tile.codecContext);
+        return false;
+    }
+
+    // 新解码器使用默认的丢弃设置, 由 ApplyTileSettings 重新应用
+    tile.lowres = lowres;
+    tile.keyframeOnly = false;
+    tile.skipLoopFilter = false;
+    tile.formatContext->streams[tile.videoStreamIndex]->discard = AVDISCARD_DEFAULT;
+    tile.waitForKeyframe = true;
+    return true;
+}
+
+void GridPlayer::CloseTile(Tile& tile)
+{
+    if (tile.swsContext)
+    {
+        sws_freeContext(tile.swsContext);
+        tile.swsContext = nullptr;
+    }
+    tile.mailbox.Release();
+
+    if (tile.frame)
+    {
+        av_frame_free(&tile.frame);
+    }
+
+    if (tile.packet)
+    {
+        av_packet_free(&tile.packet);
+    }
+
+    if (tile.codecContext)
+    {
+        FramePool::FreeContext(&tile.codecContext);
+    }
+
+    if (tile.formatContext)
+    {
+        avformat_close_input(&tile.formatContext);
+    }
+}
+
+void GridPlayer::Close()
+{
+    if (m_schedulerThread)
+    {
+        m_shouldStop = true;
+        SetEvent(m_wakeEvent);
+        WaitForSingleObject(m_schedulerThread, INFINITE);
+        CloseHandle(m_schedulerThread);
+        m_schedulerThread = nullptr;
+    }
+
+    // 先停止音频, 让阻塞在音频缓冲区上的解码任务返回
+    // 解码任务检查停止标记后尽快返回, 全部结束后才能释放各路的解码器
+    if (m_audioReady)
+    {
+        m_audioPlayer.Stop();
+    }
+    m_pool.WaitIdle();
+
+    if (!m_tiles.empty())
+    {
+        GridStats stats = GetStats();
+        std::cout << "Grid: " << stats.decodedFrames << " decoded frames, " << stats.presentedFrames << " presented, "
+                  << stats.skippedFrames << " skipped, " << stats.resyncs << " resyncs, "
+                  << stats.stolenTasks << " stolen tasks on " << stats.workerThreads << " threads" << std::endl;
+    }
+    m_pool.Stop();
+
+    {
+        std::lock_guard<std::mutex> lock(m_audioMutex);
+        m_audioReady = false;
+        m_focus = -1;
+    }
+    m_audioPlayer.Close();
+
+    for (std::unique_ptr<Tile>& tile : m_tiles)
+    {
+        CloseTile(*tile);
+    }
+    m_tiles.clear();
+
+    m_isPlaying = false;
+    m_isPaused = false;
+    m_shouldStop = false;
+}
+
+void GridPlayer::Play()
+{
+    if (m_tiles.empty() || m_isPlaying)
+        return;
+
+    m_isPlaying = true;
+    m_isPaused = false;
+    m_shouldStop = false;
+    m_pausedMs = 0.0;
+
+    if (m_audioReady)
+    {
+        m_audioPlayer.Start();
+    }
+
+    m_schedulerThread = CreateThread(nullptr, 0, SchedulerThreadProc, this, 0, nullptr);
+}
+
+void GridPlayer::Pause()
+{
+    if (!m_isPlaying)
+        return;
+
+    if (!m_isPaused)
+    {
+        m_pauseStartMs = QpcNowMs();
+        m_isPaused = true;
+    }
+    else
+    {
+        m_pausedMs = m_pausedMs + (QpcNowMs() - m_pauseStartMs);
+        m_isPaused = false;
+    }
+
+    // m_audioReady 只由 UI 线程修改, 这里不加锁: 解码任务可能正持锁等待音频缓冲区,
+    // 暂停后音频播放器放弃写入, 任务随即释放锁
+    if (m_audioReady)
+    {
+        m_audioPlayer.Pause();
+    }
+}
+
+double GridPlayer::ClockMs() const
+{
+    double pausedMs = m_pausedMs;
+    return (m_isPaused ? (double)m_pauseStartMs : QpcNowMs()) - pausedMs;
+}
+
+void GridPlayer::OnResize(int width, int height)
+{
+    if (width <= 0 || height <= 0)
+        return;
+
+    m_clientWidth = width;
+    m_clientHeight = height;
+    LayoutTiles();
+}
+
+void GridPlayer::LayoutTiles()
+{
+    for (size_t i = 0; i < m_tiles.size(); i++)
+    {
+        Tile& tile = *m_tiles[i];
+        int column = (int)i % m_columns;
+        int row = (int)i / m_columns;
+        tile.rect.left = column * m_clientWidth / m_columns;
+        tile.rect.right = (column + 1) * m_clientWidth / m_columns;
+        tile.rect.top = row * m_clientHeight / m_rows;
+        tile.rect.bottom = (row + 1) * m_clientHeight / m_rows;
+        UpdateTileQuality(tile);
+    }
+}
+
+void GridPlayer::UpdateTileQuality(Tile& tile)
+{
+    int innerWidth = (int)(tile.rect.right - tile.rect.left) - 2 * TILE_BORDER;
+    int innerHeight = (int)(tile.rect.bottom - tile.rect.top) - 2 * TILE_BORDER;
+    int displayWidth, displayHeight, offsetX, offsetY;
+    CalculateDisplayRect(ScalingMode::FIT_TO_WINDOW, innerWidth, innerHeight, tile.videoWidth, tile.videoHeight,
+                         displayWidth, displayHeight, offsetX, offsetY);
+    if (displayWidth <= 0 || displayHeight <= 0)
+        return;
+
+    // 每级 lowres 把解码尺寸减半, 只取不低于显示尺寸的级别
+    double scale = (double)tile.videoWidth / displayWidth;
+    int lowres = 0;
+    while (lowres < tile.codec->max_lowres && scale >= (double)(2 << lowres))
+    {
+        lowres++;
+    }
+    double remainingScale = scale / (1 << lowres);
+    tile.wantedLowres = lowres;
+    tile.wantedSkipLoopFilter = remainingScale >= SKIP_LOOP_FILTER_SCALE;
+    tile.wantedKeyframeOnly = remainingScale >= KEYFRAME_ONLY_SCALE;
+    tile.overloaded = false;
+
+    // 按显示尺寸转换, 超过缓冲区容量时按容量转换后由 GDI 放大
+    int width = displayWidth;
+    int height = displayHeight;
+    if (width > tile.capacityWidth || height > tile.capacityHeight)
+    {
+        width = tile.capacityWidth;
+        height = tile.capacityHeight;
+    }
+    tile.convertSize = ((int64_t)width << 32) | height;
+}
+
+DWORD WINAPI GridPlayer::SchedulerThreadProc(LPVOID lpParam)
+{
+    GridPlayer* player = static_cast<GridPlayer*>(lpParam);
+    player->SchedulerLoop();
+    return 0;
+}
+
+void GridPlayer::SchedulerLoop()
+{
+    while (!m_shouldStop)
+    {
+        if (m_isPaused)
+        {
+            Sleep(10);
+            continue;
+        }
+
+        double now = ClockMs();
+        double nextDueMs = now + MAX_SCHEDULER_WAIT_MS;
+        bool presented = false;
+
+        for (std::unique_ptr<Tile>& tilePtr : m_tiles)
+        {
+            Tile& tile = *tilePtr;
+            int state = tile.state.load(std::memory_order_acquire);
+
+            // 到期的帧提交给呈现端, 之后该路立即开始解码下一帧
+            if (state == TILE_READY)
+            {
+                if (tile.readyDueMs > now)
+                {
+                    nextDueMs = (std::min)(nextDueMs, tile.readyDueMs);
+                    continue;
+                }
+                tile.mailbox.Publish(tile.readyInfo);
+                tile.presentedFrames++;
+                presented = true;
+                state = TILE_IDLE;
+            }
+
+            if (state == TILE_IDLE)
+            {
+                tile.state.store(TILE_DECODING, std::memory_order_relaxed);
+                Tile* target = &tile;
+                m_pool.Submit([this, target] { DecodeTile(*target); });
+            }
+        }
+
+        if (presented)
+        {
+            InvalidateRect(m_hwnd, nullptr, FALSE);
+        }
+
+        // 等到最早的帧到期, 或有解码任务完成
+        double waitMs = nextDueMs - ClockMs();
+        if (waitMs >= 1.0)
+        {
+            WaitForSingleObject(m_wakeEvent, (std::min)((DWORD)waitMs, MAX_SCHEDULER_WAIT_MS));
+        }
+    }
+}
+
+void GridPlayer::DecodeTile(Tile& tile)
+{
+    ApplyTileSettings(tile);
+
+    int skipped = 0;
+    while (!m_shouldStop && tile.codecContext)
+    {
+        // 先取出解码器中已有的帧, 一个数据包可能产生多帧
+        if (ReceiveTileFrame(tile, skipped))
+        {
+            tile.state.store(TILE_READY, std::memory_order_release);
+            SetEvent(m_wakeEvent);
+            return;
+        }
+
+        int ret = av_read_frame(tile.formatContext, tile.packet);
+        if (ret == AVERROR_EOF)
+        {
+            if (!tile.draining)
+            {
+                // 送入空包取出解码器中缓存的最后几帧
+                avcodec_send_packet(tile.codecContext, nullptr);
+                tile.draining = true;
+                continue;
+            }
+
+            // 一轮中没有解出任何帧说明文件无法播放, 否则从头循环（监看多路画面时各路持续播放）
+            if (!tile.sawFrameSinceLoop)
+            {
+                std::cerr << "Grid: no decodable frames in " << tile.path << std::endl;
+                tile.state.store(TILE_FINISHED, std::memory_order_release);
+                return;
+            }
+            av_seek_frame(tile.formatContext, tile.videoStreamIndex, 0, AVSEEK_FLAG_BACKWARD);
+            avcodec_flush_buffers(tile.codecContext);
+            tile.draining = false;
+            tile.waitForKeyframe = true;
+            tile.sawFrameSinceLoop = false;
+            tile.rebase = true;
+            continue;
+        }
+        if (ret < 0)
+        {
+            std::cerr << "Grid: read error in " << tile.path << std::endl;
+            tile.state.store(TILE_FINISHED, std::memory_order_release);
+            return;
+        }
+
+        if (tile.packet->stream_index == tile.videoStreamIndex)
+        {
+            bool usable = true;
+            if (tile.waitForKeyframe)
+            {
+                usable = (tile.packet->flags & AV_PKT_FLAG_KEY) != 0;
+                tile.waitForKeyframe = !usable;
+            }
+            if (usable)
+            {
+                avcodec_send_packet(tile.codecContext, tile.packet);
+            }
+        }
+        else
+        {
+            DecodeFocusAudio(tile);
+        }
+        av_packet_unref(tile.packet);
+    }
+
+    tile.state.store(tile.codecContext ? TILE_IDLE : TILE_FINISHED, std::memory_order_release);
+}
+
+void GridPlayer::ApplyTileSettings(Tile& tile)
+{
+    bool focused = m_focus == tile.index;
+
+    // 音频包只为焦点宫格保留, 其余各路在解复用器层面丢弃
+    if (focused != tile.audioEnabled)
+    {
+        for (unsigned int i = 0; i < tile.formatContext->nb_streams; i++)
+        {
+            AVStream* stream = tile.formatContext->streams[i];
+            if (stream->codecpar->codec_type == AVMEDIA_TYPE_AUDIO)
+            {
+                stream->discard = focused ? AVDISCARD_DEFAULT : AVDISCARD_ALL;
+            }
+        }
+        tile.audioEnabled = focused;
+    }
+
+    int lowres = tile.wantedLowres;
+    if (lowres != tile.lowres && !OpenDecoder(tile, lowres))
+    {
+        std::cerr << "Grid: failed to reopen decoder with lowres " << lowres << std::endl;
+        tile.wantedLowres = 0;
+        if (!OpenDecoder(tile, 0))
+            return;
+    }
+
+    // 仅关键帧：解复用器层面丢弃非关键帧包, 切换后参考帧不完整, 从下一个关键帧开始
+    bool keyframeOnly = !focused && (tile.wantedKeyframeOnly || tile.overloaded);
+    if (keyframeOnly != tile.keyframeOnly)
+    {
+        tile.formatContext->streams[tile.videoStreamIndex]->discard = keyframeOnly ? AVDISCARD_NONKEY : AVDISCARD_DEFAULT;
+        tile.codecContext->skip_frame = keyframeOnly ? AVDISCARD_NONKEY : AVDISCARD_DEFAULT;
+        avcodec_flush_buffers(tile.codecContext);
+        tile.waitForKeyframe = true;
+        tile.keyframeOnly = keyframeOnly;
+    }
+
+    bool skipLoopFilter = tile.wantedSkipLoopFilter;
+    if (skipLoopFilter != tile.skipLoopFilter)
+    {
+        tile.codecContext->skip_loop_filter = skipLoopFilter ? AVDISCARD_ALL : AVDISCARD_DEFAULT;
+        tile.skipLoopFilter = skipLoopFilter;
+    }
+}
+
+bool GridPlayer::ReceiveTileFrame(Tile& tile, int& skipped)
+{
+    AVRational timeBase = tile.formatContext->streams[tile.videoStreamIndex]->time_base;
+    double intervalMs = 1000.0 / tile.frameRate;
+
+    while (avcodec_receive_frame(tile.codecContext, tile.frame) == 0)
+    {
+        tile.decodedFrames++;
+        tile.sawFrameSinceLoop = true;
+
+        double pts;
+        if (tile.frame->best_effort_timestamp != AV_NOPTS_VALUE)
+            pts = tile.frame->best_effort_timestamp * av_q2d(timeBase);
+        else
+            pts = std::isnan(tile.lastPts) ? 0.0 : tile.lastPts + intervalMs / 1000.0;
+
+        // 时间戳映射到宫格时钟; 循环回到开头时接在上一帧之后
+        double now = ClockMs();
+        if (tile.rebase)
+        {
+            tile.baseClockMs = tile.lastDueMs > 0.0 ? tile.lastDueMs + intervalMs : now;
+            tile.basePts = pts;
+            tile.rebase = false;
+        }
+        double dueMs = tile.baseClockMs + (pts - tile.basePts) * 1000.0;
+
+        if (dueMs < now - RESYNC_MS || dueMs > now + MAX_AHEAD_MS)
+        {
+            // 严重落后（CPU 不足）或时间戳跳变：从当前帧重新对齐, 落后时非焦点宫格改为仅关键帧解码
+            if (dueMs < now)
+            {
+                tile.overloaded = true;
+            }
+            tile.resyncs++;
+            tile.baseClockMs = now;
+            tile.basePts = pts;
+            dueMs = now;
+        }
+        else if (dueMs < now - intervalMs && skipped < MAX_SKIPPED_FRAMES)
+        {
+            // 已错过显示时间的帧不做转换（参考帧仍需解码）
+            skipped++;
+            tile.skippedFrames++;
+            tile.lastPts = pts;
+            tile.lastDueMs = dueMs;
+            av_frame_unref(tile.frame);
+            continue;
+        }
+
+        tile.lastPts = pts;
+        tile.lastDueMs = dueMs;
+        bool converted = ConvertTileFrame(tile, dueMs);
+        av_frame_unref(tile.frame);
+        if (!converted)
+            continue;
+
+        // 焦点宫格的视频时间作为音频同步的主时钟
+        if (m_focus == tile.index)
+        {
+            std::lock_guard<std::mutex> lock(m_audioMutex);
+            if (m_audioReady)
+            {
+                m_audioPlayer.SetVideoTime(pts);
+            }
+        }
+        return true;
+    }
+    return false;
+}
+
+bool GridPlayer::ConvertTileFrame(Tile& tile, double dueMs)
+{
+    int64_t size = tile.convertSize;
+    FrameInfo info;
+    memset(&info, 0, sizeof(info));
+    info.width = (int)(size >> 32);
+    info.height = (int)(size & 0xFFFFFFFF);
+    info.stride = info.width * BYTES_PER_PIXEL;
+    if (info.width <= 0 || info.height <= 0 || (size_t)info.stride * info.height > tile.mailbox.FrameBytes())
+    {
+        info.width = tile.capacityWidth;
+        info.height = tile.capacityHeight;
+        info.stride = tile.capacityWidth * BYTES_PER_PIXEL;
+    }
+
+    // 输入尺寸取实际解码帧（lowres 时小于视频尺寸）; 宫格画面较小, 多路同时转换时用双线性
+    tile.swsContext = sws_getCachedContext(
+        tile.swsContext,
+        tile.frame->width, tile.frame->height, (AVPixelFormat)tile.frame->format,
+        info.width, info.height, AV_PIX_FMT_BGRA,
+        SWS_BILINEAR, nullptr, nullptr, nullptr);
+    if (!tile.swsContext)
+    {
+        return false;
+    }
+
+    uint8_t* dstData[4] = { tile.mailbox.WriteBuffer(), nullptr, nullptr, nullptr };
+    int dstLinesize[4] = { info.stride, 0, 0, 0 };
+    sws_scale(tile.swsContext, tile.frame->data, tile.frame->linesize, 0, tile.frame->height, dstData, dstLinesize);
+
+    info.timing.sequence = tile.decodedFrames;
+    info.timing.pts = tile.lastPts;
+    info.timing.convertDoneMs = QpcNowMs();
+    info.timing.deadlineMs = dueMs;
+    tile.readyInfo = info;
+    tile.readyDueMs = dueMs;
+    return true;
+}
+
+void GridPlayer::DecodeFocusAudio(Tile& tile)
+{
+    // 焦点切换与送入音频在同一把锁下进行, 切走后旧焦点的音频包直接丢弃
+    // 音频环形缓冲区满时 ProcessAudioFrame 会等待, 期间占用一个工作线程
+    std::lock_guard<std::mutex> lock(m_audioMutex);
+    if (!m_audioReady || m_focus != tile.index || tile.packet->stream_index != m_audioPlayer.GetAudioStreamIndex())
+        return;
+
+    AVCodecContext* audioContext = m_audioPlayer.GetAudioCodecContext();
+    if (avcodec_send_packet(audioContext, tile.packet) != 0)
+        return;
+
+    AVFrame* audioFrame = av_frame_alloc();
+    while (audioFrame && avcodec_receive_frame(audioContext, audioFrame) == 0)
+    {
+        m_audioPlayer.ProcessAudioFrame(audioFrame);
+        av_frame_unref(audioFrame);
+    }
+    av_frame_free(&audioFrame);
+}
+
+int GridPlayer::HitTest(int x, int y) const
+{
+    POINT point = { x, y };
+    for (size_t i = 0; i < m_tiles.size(); i++)
+    {
+        if (PtInRect(&m_tiles[i]->rect, point))
+            return (int)i;
+    }
+    return -1;
+}
+
+void GridPlayer::SetFocus(int index)
+{
+    if (index < 0 || index >= (int)m_tiles.size() || index == m_focus)
+        return;
+
+    // 先停止播放, 使持锁等待音频缓冲区的解码任务返回
+    if (m_audioReady)
+    {
+        m_audioPlayer.Stop();
+    }
+
+    // 音频解码器按新焦点的文件重建; 新焦点的音频包在它的下一次解码任务开始时恢复读取
+    std::lock_guard<std::mutex> lock(m_audioMutex);
+    m_audioReady = false;
+    m_focus = index;
+
+    if (m_audioPlayer.Initialize(m_tiles[index]->formatContext))
+    {
+        m_audioReady = true;
+        if (m_isPlaying)
+        {
+            m_audioPlayer.Start();
+            if (m_isPaused)
+            {
+                m_audioPlayer.Pause();
+            }
+        }
+    }
+
+    if (m_hwnd)
+    {
+        InvalidateRect(m_hwnd, nullptr, FALSE);
+    }
+}
+
+void GridPlayer::FocusNext()
+{
+    if (!m_tiles.empty())
+    {
+        SetFocus((m_focus + 1) % (int)m_tiles.size());
+    }
+}
+
+void GridPlayer::SetVolume(float volume)
+{
+    m_audioPlayer.SetVolume(volume);
+}
+
+GridStats GridPlayer::GetStats() const
+{
+    GridStats stats;
+    memset(&stats, 0, sizeof(stats));
+    stats.tiles = (int)m_tiles.size();
+    stats.workerThreads = m_pool.ThreadCount();
+    for (const std::unique_ptr<Tile>& tile : m_tiles)
+    {
+        stats.decodedFrames += tile->decodedFrames;
+        stats.presentedFrames += tile->presentedFrames;
+        stats.skippedFrames += tile->skippedFrames;
+        stats.resyncs += tile->resyncs;
+    }
+    stats.stolenTasks = m_pool.GetStats().stolenTasks;
+    return stats;
+}
+
+void GridPlayer::Render(HDC hdc)
+{
+    RECT clientRect = { 0, 0, m_clientWidth, m_clientHeight };
+    if (m_tiles.empty())
+    {
+        FillRect(hdc, &clientRect, (HBRUSH)GetStockObject(BLACK_BRUSH));
+        return;
+    }
+
+    BITMAPINFO bitmapInfo;
+    memset(&bitmapInfo, 0, sizeof(bitmapInfo));
+    bitmapInfo.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+    bitmapInfo.bmiHeader.biPlanes = 1;
+    bitmapInfo.bmiHeader.biBitCount = 32;
+    bitmapInfo.bmiHeader.biCompression = BI_RGB;
+
+    HBRUSH blackBrush = (HBRUSH)GetStockObject(BLACK_BRUSH);
+    HBRUSH borderBrush = CreateSolidBrush(RGB(48, 48, 48));
+    HBRUSH focusBrush = CreateSolidBrush(RGB(255, 190, 40));
+    SetStretchBltMode(hdc, COLORONCOLOR);
+
+    int focus = m_focus;
+    for (size_t i = 0; i < m_tiles.size(); i++)
+    {
+        Tile& tile = *m_tiles[i];
+        tile.mailbox.Acquire();
+        const FrameInfo& info = tile.mailbox.ReadInfo();
+
+        RECT inner = tile.rect;
+        InflateRect(&inner, -TILE_BORDER, -TILE_BORDER);
+        int displayWidth, displayHeight, offsetX, offsetY;
+        CalculateDisplayRect(ScalingMode::FIT_TO_WINDOW, inner.right - inner.left, inner.bottom - inner.top,
+                             tile.videoWidth, tile.videoHeight, displayWidth, displayHeight, offsetX, offsetY);
+        RECT video = { inner.left + offsetX, inner.top + offsetY,
+                       inner.left + offsetX + displayWidth, inner.top + offsetY + displayHeight };
+
+        if (displayWidth > 0 && displayHeight > 0)
+        {
+            bitmapInfo.bmiHeader.biWidth = info.width;
+            bitmapInfo.bmiHeader.biHeight = -info.height;   // 自上而下
+            if (displayWidth == info.width && displayHeight == info.height)
+            {
+                SetDIBitsToDevice(hdc, video.left, video.top, displayWidth, displayHeight,
+                                  0, 0, 0, info.height, tile.mailbox.ReadBuffer(), &bitmapInfo, DIB_RGB_COLORS);
+            }
+            else
+            {
+                StretchDIBits(hdc, video.left, video.top, displayWidth, displayHeight,
+                              0, 0, info.width, info.height, tile.mailbox.ReadBuffer(), &bitmapInfo, DIB_RGB_COLORS, SRCCOPY);
+            }
+        }
+
+        // 黑边只填充画面之外的部分, 避免整格擦除造成闪烁
+        RECT bars[4] = {
+            { inner.left, inner.top, inner.right, video.top },
+            { inner.left, video.bottom, inner.right, inner.bottom },
+            { inner.left, video.top, video.left, video.bottom },
+            { video.right, video.top, inner.right, video.bottom }
+        };
+        for (const RECT& bar : bars)
+        {
+            if (bar.right > bar.left && bar.bottom > bar.top)
+                FillRect(hdc, &bar, blackBrush);
+        }
+
+        RECT border = tile.rect;
+        for (int b = 0; b < TILE_BORDER; b++)
+        {
+            FrameRect(hdc, &border, (int)i == focus ? focusBrush : borderBrush);
+            InflateRect(&border, -1, -1);
+        }
+    }
+
+    // 网格中没有视频的空格
+    for (int i = (int)m_tiles.size(); i < m_columns * m_rows; i++)
+    {
+        int column = i % m_columns;
+        int row = i / m_columns;
+        RECT cell = { column * m_clientWidth / m_columns, row * m_clientHeight / m_rows,
+                      (column + 1) * m_clientWidth / m_columns, (row + 1) * m_clientHeight / m_rows };
+        FillRect(hdc, &cell, blackBrush);
+    }
+
+    DeleteObject(borderBrush);
+    DeleteObject(focusBrush);
+}
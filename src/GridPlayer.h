@@ -0,0 +1,170 @@
+#pragma once
+
+#include <windows.h>
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include "AudioPlayer.h"
+#include "FrameMailbox.h"
+#include "DisplayPipeline.h"
+#include "WorkStealingPool.h"
+
+extern "C" {
+#include "libavcodec/avcodec.h"
+#include "libavformat/avformat.h"
+#include "libswscale/swscale.h"
+}
+
+struct GridStats {
+    int tiles;
+    int workerThreads;
+    uint64_t decodedFrames;     // 所有宫格解码出的视频帧
+    uint64_t presentedFrames;   // 按时提交给呈现端的帧
+    uint64_t skippedFrames;     // 落后时解码后不转换直接跳过的帧
+    uint64_t resyncs;           // 落后过多、重新对齐时钟的次数
+    uint64_t stolenTasks;       // 线程池中被窃取执行的解码任务
+};
+
+// 多路视频宫格播放 - N 个文件按网格平铺在同一窗口中
+// 每路视频独立解复用/解码, 解码任务（每次解出一帧并按宫格尺寸转换）统一调度到共享的工作窃取线程池;
+// 调度线程按各路的时间戳到期提交帧并触发重绘。只有焦点宫格输出音频
+// 宫格远小于视频尺寸时降低解码分辨率（解码器支持 lowres 时）, 否则跳过环路滤波, 很小的非焦点宫格只解码关键帧
+class GridPlayer {
+public:
+    GridPlayer();
+    ~GridPlayer();
+
+    // 打开全部文件, 至少一路成功即返回 true（失败的文件被跳过）
+    bool Open(HWND hwnd, const std::vector<std::string>& paths);
+    void Close();
+    bool IsActive() const { return !m_tiles.empty(); }
+
+    void Play();
+    void Pause();
+    bool IsPlaying() const { return m_isPlaying && !m_isPaused; }
+
+    // 客户区尺寸变化时重新排布宫格并调整各路的解码分辨率
+    void OnResize(int width, int height);
+
+    // 在窗口 DC 上绘制所有宫格的最新帧, 焦点宫格带高亮边框
+    void Render(HDC hdc);
+
+    // 焦点宫格：输出音频, 且不降为仅关键帧解码
+    int HitTest(int x, int y) const;
+    void SetFocus(int index);
+    void FocusNext();
+    int GetFocus() const { return m_focus; }
+    void SetVolume(float volume);
+
+    GridStats GetStats() const;
+
+private:
+    enum TileState {
+        TILE_IDLE,          // 等待调度线程提交解码任务
+        TILE_DECODING,      // 解码任务执行中（只有该任务访问解码器和邮箱写端）
+        TILE_READY,         // 已转换到邮箱写缓冲区, 等待到期后由调度线程提交
+        TILE_FINISHED       // 读取出错, 不再调度
+    };
+
+    struct Tile {
+        Tile();
+
+        int index;
+        std::string path;
+
+        // FFmpeg（只由该路的解码任务访问）
+        AVFormatContext* formatContext;
+        AVCodecContext* codecContext;
+        const AVCodec* codec;
+        AVPacket* packet;
+        AVFrame* frame;
+        struct SwsContext* swsContext;
+        int videoStreamIndex;
+        int videoWidth;
+        int videoHeight;
+        double frameRate;
+        int decoderThreads;
+
+        // 解码质量：UI 线程按宫格尺寸计算期望值, 解码任务开始时应用
+        std::atomic<int> wantedLowres;
+        std::atomic<bool> wantedKeyframeOnly;
+        std::atomic<bool> wantedSkipLoopFilter;
+        int lowres;
+        bool keyframeOnly;
+        bool skipLoopFilter;
+        std::atomic<bool> overloaded;   // 曾经严重落后, 非焦点时改为仅关键帧解码（尺寸变化后重新评估）
+        bool waitForKeyframe;
+        bool audioEnabled;          // 解复用器是否保留音频包（仅焦点宫格）
+
+        // 时间戳到时钟的映射（解码任务写, 状态切换保证可见性）
+        bool rebase;
+        double baseClockMs;
+        double basePts;
+        double lastPts;
+        double lastDueMs;
+        bool sawFrameSinceLoop;
+
+        // 解码任务与调度线程之间的交接
+        std::atomic<int> state;
+        bool draining;              // 文件结束, 正在取出解码器中剩余的帧
+        FrameInfo readyInfo;
+        double readyDueMs;
+
+        // 帧缓冲：容量按该路可能的最大宫格尺寸分配, 转换尺寸由 UI 线程设置 (宽 << 32 | 高)
+        FrameMailbox mailbox;
+        std::atomic<int64_t> convertSize;
+        int capacityWidth;
+        int capacityHeight;
+
+        // 宫格区域（UI 线程）
+        RECT rect;
+
+        std::atomic<uint64_t> decodedFrames;
+        std::atomic<uint64_t> presentedFrames;
+        std::atomic<uint64_t> skippedFrames;
+        std::atomic<uint64_t> resyncs;
+    };
+
+    bool OpenTile(Tile& tile);
+    bool OpenDecoder(Tile& tile, int lowres);
+    void CloseTile(Tile& tile);
+    void LayoutTiles();
+    void UpdateTileQuality(Tile& tile);
+    double ClockMs() const;
+
+    // 解码任务：应用质量设置后解出下一帧要显示的帧, 转换到邮箱写缓冲区并置为 TILE_READY
+    void DecodeTile(Tile& tile);
+    void ApplyTileSettings(Tile& tile);
+    bool ReceiveTileFrame(Tile& tile, int& skipped);
+    bool ConvertTileFrame(Tile& tile, double dueMs);
+    void DecodeFocusAudio(Tile& tile);
+
+    static DWORD WINAPI SchedulerThreadProc(LPVOID lpParam);
+    void SchedulerLoop();
+
+    std::vector<std::unique_ptr<Tile>> m_tiles;
+    int m_columns;
+    int m_rows;
+    int m_clientWidth;
+    int m_clientHeight;
+    HWND m_hwnd;
+
+    WorkStealingPool m_pool;
+    HANDLE m_schedulerThread;
+    HANDLE m_wakeEvent;             // 解码任务完成时唤醒调度线程
+    std::atomic<bool> m_shouldStop;
+    bool m_isPlaying;
+    std::atomic<bool> m_isPaused;
+
+    // 宫格时钟：暂停期间停止走动
+    std::atomic<double> m_pauseStartMs;
+    std::atomic<double> m_pausedMs;
+
+    // 焦点宫格的音频：切换焦点时重建解码器, 解码任务在锁内送入音频帧
+    std::atomic<int> m_focus;
+    AudioPlayer m_audioPlayer;
+    std::mutex m_audioMutex;
+    bool m_audioReady;
+};
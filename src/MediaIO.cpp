@@ -0,0 +1,397 @@
+#include "MediaIO.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+const int MediaIO::IO_BUFFER_SIZE = 64 * 1024;
+const size_t PrefetchIO::FETCH_CHUNK_SIZE = 1024 * 1024;
+const int64_t MappedFileIO::HINT_WINDOW = 8 * 1024 * 1024;
+
+static double ElapsedMs(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// 本地固定磁盘（或内存盘）上的文件; UNC 路径、映射的网络驱动器和可移动介质返回 false
+static bool IsLocalDisk(const std::string& path)
+{
+    if (path.size() >= 2 && (path[0] == '\\' || path[0] == '/') && (path[1] == '\\' || path[1] == '/'))
+        return false;
+
+    char root[MAX_PATH];
+    if (!GetVolumePathNameA(path.c_str(), root, MAX_PATH))
+        return false;
+    UINT type = GetDriveTypeA(root);
+    return type == DRIVE_FIXED || type == DRIVE_RAMDISK;
+}
+
+// PrefetchVirtualMemory 从 Windows 8 开始提供, 运行时查找
+struct MemoryRangeEntry {
+    void* address;
+    size_t size;
+};
+typedef BOOL (WINAPI* PrefetchVirtualMemoryProc)(HANDLE process, ULONG_PTR count, MemoryRangeEntry* ranges, ULONG flags);
+
+static PrefetchVirtualMemoryProc GetPrefetchVirtualMemory()
+{
+    static PrefetchVirtualMemoryProc proc =
+        (PrefetchVirtualMemoryProc)GetProcAddress(GetModuleHandleA("kernel32.dll"), "PrefetchVirtualMemory");
+    return proc;
+}
+
+// 从映射视图复制; 文件所在介质读取失败时缺页会引发 EXCEPTION_IN_PAGE_ERROR, 转换为读取错误
+static bool CopyFromView(uint8_t* destination, const uint8_t* source, size_t size)
+{
+    __try
+    {
+        memcpy(destination, source, size);
+    }
+    __except (GetExceptionCode() == EXCEPTION_IN_PAGE_ERROR ? EXCEPTION_EXECUTE_HANDLER : EXCEPTION_CONTINUE_SEARCH)
+    {
+        return false;
+    }
+    return true;
+}
+
+MediaIO::MediaIO()
+    : m_ioContext(nullptr)
+    , m_owner(nullptr)
+{
+}
+
+MediaIO::~MediaIO()
+{
+    if (m_ioContext)
+    {
+        // FFmpeg 可能替换过内部缓冲区, 释放当前的那一个
+        av_freep(&m_ioContext->buffer);
+        avio_context_free(&m_ioContext);
+    }
+}
+
+bool MediaIO::Attach(AVFormatContext* formatContext)
+{
+    uint8_t* buffer = (uint8_t*)av_malloc(IO_BUFFER_SIZE);
+    if (!buffer)
+        return false;
+
+    m_ioContext = avio_alloc_context(buffer, IO_BUFFER_SIZE, 0, this, ReadPacket, nullptr, SeekPacket);
+    if (!m_ioContext)
+    {
+        av_free(buffer);
+        return false;
+    }
+
+    formatContext->pb = m_ioContext;
+    formatContext->flags |= AVFMT_FLAG_CUSTOM_IO;
+    m_owner = formatContext;
+    return true;
+}
+
+bool MediaIO::Interrupted() const
+{
+    // 格式上下文在播放列表/循环切换时会改换中断回调, 每次都从上下文中读取
+    const AVIOInterruptCB& interrupt = m_owner->interrupt_callback;
+    return interrupt.callback && interrupt.callback(interrupt.opaque);
+}
+
+int MediaIO::ReadPacket(void* opaque, uint8_t* buffer, int size)
+{
+    return static_cast<MediaIO*>(opaque)->Read(buffer, size);
+}
+
+int64_t MediaIO::SeekPacket(void* opaque, int64_t offset, int whence)
+{
+    return static_cast<MediaIO*>(opaque)->Seek(offset, whence);
+}
+
+MediaIO* MediaIO::FromContext(const AVFormatContext* formatContext)
+{
+    if (!formatContext || !formatContext->pb || !(formatContext->flags & AVFMT_FLAG_CUSTOM_IO))
+        return nullptr;
+    return static_cast<MediaIO*>(formatContext->pb->opaque);
+}
+
+int MediaIO::OpenInput(AVFormatContext** formatContext, const std::string& path, MediaInputMode mode, size_t readAhead)
+{
+    MediaIO* io = nullptr;
+    bool localFile = path.find("://") == std::string::npos;
+    if (localFile && mode != MediaInputMode::FFMPEG)
+    {
+        if (mode == MediaInputMode::MAPPED || (mode == MediaInputMode::AUTO && IsLocalDisk(path)))
+        {
+            // 映射失败（例如 32 位进程中的超大文件）时改用预读
+            MappedFileIO* mapped = new MappedFileIO();
+            if (mapped->Open(path) && mapped->Attach(*formatContext))
+            {
+                io = mapped;
+            }
+            else
+            {
+                delete mapped;
+            }
+        }
+
+        if (!io && readAhead > 0)
+        {
+            PrefetchIO* prefetch = new PrefetchIO();
+            if (prefetch->Open(path, readAhead) && prefetch->Attach(*formatContext))
+            {
+                io = prefetch;
+            }
+            else
+            {
+                // 打不开时交给 FFmpeg 的文件协议, 由它报告错误
+                delete prefetch;
+            }
+        }
+    }
+
+    int result = avformat_open_input(formatContext, path.c_str(), nullptr, nullptr);
+    if (result != 0)
+    {
+        // 失败时 avformat_open_input 已释放格式上下文, 但不释放自定义的 AVIOContext
+        delete io;
+    }
+    return result;
+}
+
+void MediaIO::CloseInput(AVFormatContext** formatContext)
+{
+    if (!*formatContext)
+        return;
+
+    MediaIO* io = FromContext(*formatContext);
+    avformat_close_input(formatContext);
+    delete io;
+}
+
+const char* MediaIO::ModeName(MediaInputMode mode)
+{
+    switch (mode)
+    {
+    case MediaInputMode::AUTO:     return "auto";
+    case MediaInputMode::PREFETCH: return "read-ahead";
+    case MediaInputMode::MAPPED:   return "memory-mapped";
+    case MediaInputMode::FFMPEG:   return "ffmpeg file";
+    }
+    return "unknown";
+}
+
+bool MediaIO::BenchmarkDemux(const std::string& path, MediaInputMode mode, size_t readAhead, DemuxBenchmark& result)
+{
+    memset(&result, 0, sizeof(result));
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    AVFormatContext* formatContext = avformat_alloc_context();
+    if (!formatContext)
+        return false;
+    if (OpenInput(&formatContext, path, mode, readAhead) != 0)
+        return false;
+
+    AVPacket* packet = av_packet_alloc();
+    if (!packet)
+    {
+        CloseInput(&formatContext);
+        return false;
+    }
+
+    while (av_read_frame(formatContext, packet) >= 0)
+    {
+        result.packets++;
+        av_packet_unref(packet);
+    }
+    result.bytes = formatContext->pb ? (uint64_t)avio_size(formatContext->pb) : 0;
+    result.elapsedMs = ElapsedMs(start);
+
+    av_packet_free(&packet);
+    CloseInput(&formatContext);
+    return true;
+}
+
+PrefetchIO::PrefetchIO()
+    : m_file(INVALID_HANDLE_VALUE)
+{
+}
+
+PrefetchIO::~PrefetchIO()
+{
+    // 先停止预读线程, 之后才能关闭它读取的文件
+    m_cache.Stop();
+
+    if (m_file != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(m_file);
+    }
+}
+
+bool PrefetchIO::Open(const std::string& path, size_t readAhead)
+{
+    m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                         OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (m_file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(m_file, &size))
+        return false;
+
+    return m_cache.Start(size.QuadPart, readAhead, FETCH_CHUNK_SIZE,
+                         [this](int64_t offset, uint8_t* buffer, size_t count) { return ReadAt(offset, buffer, count); },
+                         [this]() { return Interrupted(); });
+}
+
+int64_t PrefetchIO::ReadAt(int64_t offset, uint8_t* buffer, size_t size)
+{
+    LARGE_INTEGER distance;
+    distance.QuadPart = offset;
+    DWORD bytesRead = 0;
+    if (!SetFilePointerEx(m_file, distance, nullptr, FILE_BEGIN) ||
+        !ReadFile(m_file, buffer, (DWORD)size, &bytesRead, nullptr))
+        return -1;
+    return bytesRead;
+}
+
+int PrefetchIO::Read(uint8_t* buffer, int size)
+{
+    int result = m_cache.Read(buffer, size);
+    switch (result)
+    {
+    case PrefetchCache::READ_EOF: return AVERROR_EOF;
+    case PrefetchCache::READ_INTERRUPTED: return AVERROR_EXIT;
+    case PrefetchCache::READ_ERROR: return AVERROR(EIO);
+    }
+    return result;
+}
+
+int64_t PrefetchIO::Seek(int64_t offset, int whence)
+{
+    if (whence & AVSEEK_SIZE)
+        return m_cache.FileSize();
+
+    int64_t target = m_cache.Seek(offset, whence & ~AVSEEK_FORCE);
+    return target >= 0 ? target : AVERROR(EINVAL);
+}
+
+MediaIOStats PrefetchIO::GetStats() const
+{
+    return m_cache.GetStats();
+}
+
+MappedFileIO::MappedFileIO()
+    : m_file(INVALID_HANDLE_VALUE)
+    , m_mapping(nullptr)
+    , m_view(nullptr)
+    , m_size(0)
+    , m_position(0)
+    , m_hintEnd(0)
+    , m_bytesDelivered(0)
+    , m_seeks(0)
+{
+}
+
+MappedFileIO::~MappedFileIO()
+{
+    if (m_view)
+    {
+        UnmapViewOfFile(m_view);
+    }
+    if (m_mapping)
+    {
+        CloseHandle(m_mapping);
+    }
+    if (m_file != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(m_file);
+    }
+}
+
+bool MappedFileIO::Open(const std::string& path)
+{
+    m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                         OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (m_file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(m_file, &size) || size.QuadPart == 0 || (uint64_t)size.QuadPart > (uint64_t)SIZE_MAX)
+        return false;
+    m_size = size.QuadPart;
+
+    m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!m_mapping)
+        return false;
+
+    m_view = (const uint8_t*)MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+    return m_view != nullptr;
+}
+
+void MappedFileIO::HintSequential(int64_t offset)
+{
+    m_hintEnd = (std::min)(m_size, offset + HINT_WINDOW);
+
+    PrefetchVirtualMemoryProc prefetch = GetPrefetchVirtualMemory();
+    if (prefetch)
+    {
+        MemoryRangeEntry range = { (void*)(m_view + offset), (size_t)(m_hintEnd - offset) };
+        prefetch(GetCurrentProcess(), 1, &range, 0);
+    }
+}
+
+int MappedFileIO::Read(uint8_t* buffer, int size)
+{
+    if (m_position >= m_size)
+        return AVERROR_EOF;
+
+    // 读到已提示范围的后半段时提示下一段, 让系统的读取始终领先于解复用器
+    int count = (int)(std::min)((int64_t)size, m_size - m_position);
+    if (m_position + count > m_hintEnd - HINT_WINDOW / 2)
+    {
+        HintSequential(m_position);
+    }
+
+    if (!CopyFromView(buffer, m_view + m_position, count))
+    {
+        std::cerr << "Mapped read failed at offset " << m_position << std::endl;
+        return AVERROR(EIO);
+    }
+    m_position += count;
+    m_bytesDelivered += count;
+    return count;
+}
+
+int64_t MappedFileIO::Seek(int64_t offset, int whence)
+{
+    if (whence & AVSEEK_SIZE)
+        return m_size;
+
+    int64_t target;
+    switch (whence & ~AVSEEK_FORCE)
+    {
+    case SEEK_SET: target = offset; break;
+    case SEEK_CUR: target = m_position + offset; break;
+    case SEEK_END: target = m_size + offset; break;
+    default: return AVERROR(EINVAL);
+    }
+    if (target < 0)
+        return AVERROR(EINVAL);
+
+    // 跳转后重新从目标处开始提示
+    m_position = target;
+    m_hintEnd = 0;
+    m_seeks++;
+    return target;
+}
+
+MediaIOStats MappedFileIO::GetStats() const
+{
+    // 数据由缺页直接读入, 没有单独的读取耗时和等待; 所有跳转都不需要重新读文件
+    MediaIOStats stats;
+    memset(&stats, 0, sizeof(stats));
+    stats.bytesDelivered = m_bytesDelivered;
+    stats.bytesFetched = stats.bytesDelivered;
+    stats.seeks = m_seeks;
+    stats.cachedSeeks = stats.seeks;
+    return stats;
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <windows.h>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include "PrefetchCache.h"
+
+extern "C" {
+#include "libavformat/avformat.h"
+}
+
+// 本地文件的读取方式
+enum class MediaInputMode {
+    AUTO,           // 本地磁盘内存映射, 网络共享和可移动介质预读
+    PREFETCH,       // 后台线程预读到环形缓存（PrefetchIO）
+    MAPPED,         // 整个文件映射到地址空间（MappedFileIO）
+    FFMPEG          // FFmpeg 自带的 file 协议
+};
+
+// 解复用吞吐量测试结果
+struct DemuxBenchmark {
+    uint64_t bytes;             // 读取的字节数（文件大小）
+    uint64_t packets;
+    double elapsedMs;           // 打开到读完全部数据包
+};
+
+// 自定义 AVIOContext 的基类：read/seek 回调转发到虚函数
+// 通过 OpenInput 打开的输入必须用 CloseInput 关闭, 自定义 I/O 随格式上下文一起释放
+class MediaIO {
+public:
+    virtual ~MediaIO();
+
+    virtual int Read(uint8_t* buffer, int size) = 0;
+    virtual int64_t Seek(int64_t offset, int whence) = 0;
+    virtual MediaIOStats GetStats() const = 0;
+
+    // 打开输入（formatContext 已分配并设置好中断回调）：本地文件按 mode 选择自定义 I/O, 映射失败时改用预读,
+    // readAhead 为预读窗口（0 表示不预读）; URL 使用 FFmpeg 自带的协议。失败时与 avformat_open_input 相同, 上下文被释放
+    static int OpenInput(AVFormatContext** formatContext, const std::string& path, MediaInputMode mode, size_t readAhead);
+    // 代替 avformat_close_input
+    static void CloseInput(AVFormatContext** formatContext);
+    // 格式上下文挂接的自定义 I/O, 使用 FFmpeg 自带的协议时返回 nullptr
+    static MediaIO* FromContext(const AVFormatContext* formatContext);
+
+    // 用指定的读取方式打开文件并读出全部数据包（不解码）, 比较各读取方式的解复用吞吐量
+    static bool BenchmarkDemux(const std::string& path, MediaInputMode mode, size_t readAhead, DemuxBenchmark& result);
+    static const char* ModeName(MediaInputMode mode);
+
+protected:
+    MediaIO();
+
+    // 创建 AVIOContext 并挂到 formatContext（在 avformat_open_input 之前调用）
+    bool Attach(AVFormatContext* formatContext);
+    // 轮询所属格式上下文的中断回调（阻塞等待时调用, 使取消打开和停止能及时返回）
+    bool Interrupted() const;
+
+private:
+    MediaIO(const MediaIO&) = delete;
+    MediaIO& operator=(const MediaIO&) = delete;
+
+    static int ReadPacket(void* opaque, uint8_t* buffer, int size);
+    static int64_t SeekPacket(void* opaque, int64_t offset, int whence);
+
+    AVIOContext* m_ioContext;
+    const AVFormatContext* m_owner;
+
+    static const int IO_BUFFER_SIZE;
+};
+
+// 带后台预读的文件输入：预读线程按顺序把文件读入环形缓存, 领先读取位置最多一个预读窗口,
+// 解复用线程只从缓存复制, 慢速网络共享或机械硬盘的读取延迟不再阻塞解码。
+// 读取位置之前最近的一段数据保留在缓存中, 跳转目标仍在缓存范围内时不重新读文件。
+// 缓存的记账在 PrefetchCache 中, 这里只提供 Win32 文件读取和 FFmpeg 错误码的转换
+class PrefetchIO : public MediaIO {
+public:
+    PrefetchIO();
+    ~PrefetchIO() override;
+
+    bool Open(const std::string& path, size_t readAhead);
+
+    int Read(uint8_t* buffer, int size) override;
+    int64_t Seek(int64_t offset, int whence) override;
+    MediaIOStats GetStats() const override;
+
+private:
+    // 预读线程的读取函数：从 offset 处读取最多 size 字节, 失败时返回 -1
+    int64_t ReadAt(int64_t offset, uint8_t* buffer, size_t size);
+
+    HANDLE m_file;
+    PrefetchCache m_cache;
+
+    static const size_t FETCH_CHUNK_SIZE;
+};
+
+// 内存映射的文件输入：整个文件映射为只读视图, 读取只是从视图复制, 没有系统调用;
+// 缺页由系统按需读入, 顺序读取时用 PrefetchVirtualMemory 提示系统提前读入读取位置之后的一段（相当于 madvise WILLNEED）。
+// 适合本地磁盘上的高码率（ProRes 等帧内编码）文件; 只在解复用线程中读取
+class MappedFileIO : public MediaIO {
+public:
+    MappedFileIO();
+    ~MappedFileIO() override;
+
+    bool Open(const std::string& path);
+
+    int Read(uint8_t* buffer, int size) override;
+    int64_t Seek(int64_t offset, int whence) override;
+    MediaIOStats GetStats() const override;
+
+private:
+    void HintSequential(int64_t offset);
+
+    HANDLE m_file;
+    HANDLE m_mapping;
+    const uint8_t* m_view;
+    int64_t m_size;
+    int64_t m_position;
+    int64_t m_hintEnd;              // 已提示预读到的位置
+
+    std::atomic<uint64_t> m_bytesDelivered;
+    std::atomic<uint64_t> m_seeks;
+
+    static const int64_t HINT_WINDOW;
+};
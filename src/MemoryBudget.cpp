@@ -0,0 +1,99 @@
+#include "MemoryBudget.h"
+
+MemoryBudget& MemoryBudget::Instance()
+{
+    static MemoryBudget instance;
+    return instance;
+}
+
+MemoryBudget::MemoryBudget()
+    : m_limit(0)
+    , m_total(0)
+    , m_peakTotal(0)
+    , m_degradations(0)
+{
+    for (int i = 0; i < (int)MemoryCategory::COUNT; i++)
+    {
+        m_bytes[i] = 0;
+        m_peaks[i] = 0;
+        m_allocations[i] = 0;
+    }
+}
+
+void MemoryBudget::SetLimit(uint64_t bytes)
+{
+    m_limit.store(bytes, std::memory_order_relaxed);
+}
+
+void MemoryBudget::UpdatePeak(std::atomic<uint64_t>& peak, uint64_t value)
+{
+    uint64_t current = peak.load(std::memory_order_relaxed);
+    while (value > current && !peak.compare_exchange_weak(current, value, std::memory_order_relaxed))
+    {
+    }
+}
+
+void MemoryBudget::Add(MemoryCategory category, size_t bytes)
+{
+    int index = (int)category;
+    uint64_t categoryBytes = m_bytes[index].fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    uint64_t total = m_total.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    m_allocations[index].fetch_add(1, std::memory_order_relaxed);
+    UpdatePeak(m_peaks[index], categoryBytes);
+    UpdatePeak(m_peakTotal, total);
+}
+
+void MemoryBudget::Remove(MemoryCategory category, size_t bytes)
+{
+    m_bytes[(int)category].fetch_sub(bytes, std::memory_order_relaxed);
+    m_total.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+bool MemoryBudget::IsOverBudget() const
+{
+    uint64_t limit = GetLimit();
+    return limit > 0 && TotalBytes() > limit;
+}
+
+uint64_t MemoryBudget::Available() const
+{
+    uint64_t limit = GetLimit();
+    if (limit == 0)
+        return UINT64_MAX;
+    uint64_t total = TotalBytes();
+    return total < limit ? limit - total : 0;
+}
+
+void MemoryBudget::RecordDegradation()
+{
+    m_degradations.fetch_add(1, std::memory_order_relaxed);
+}
+
+MemoryBudgetStats MemoryBudget::GetStats() const
+{
+    MemoryBudgetStats stats;
+    stats.limit = GetLimit();
+    stats.totalBytes = TotalBytes();
+    stats.peakTotalBytes = m_peakTotal.load(std::memory_order_relaxed);
+    stats.degradations = m_degradations.load(std::memory_order_relaxed);
+    for (int i = 0; i < (int)MemoryCategory::COUNT; i++)
+    {
+        stats.categories[i].bytes = m_bytes[i].load(std::memory_order_relaxed);
+        stats.categories[i].peakBytes = m_peaks[i].load(std::memory_order_relaxed);
+        stats.categories[i].allocations = m_allocations[i].load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
+const char* MemoryBudget::CategoryName(MemoryCategory category)
+{
+    switch (category)
+    {
+    case MemoryCategory::DECODED_FRAMES:   return "decoded frames";
+    case MemoryCategory::CONVERTED_FRAMES: return "converted frames";
+    case MemoryCategory::AUDIO:            return "audio";
+    case MemoryCategory::PACKETS:          return "packets";
+    case MemoryCategory::INPUT_CACHE:      return "input cache";
+    default:                               return "unknown";
+    }
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// 计入内存预算的内存类别
+enum class MemoryCategory {
+    DECODED_FRAMES,     // 解码帧（FramePool 中的缓冲区, 包括空闲的）
+    CONVERTED_FRAMES,   // 转换后的 RGB 帧（邮箱缓冲区、DIB 段、滤镜输出）
+    AUDIO,              // 音频环形缓冲区
+    PACKETS,            // 排队等待的数据包（打开/预先打开期间读到的音频包）
+    INPUT_CACHE,        // 预读缓存
+    COUNT
+};
+
+struct MemoryCategoryStats {
+    uint64_t bytes;             // 当前使用量
+    uint64_t peakBytes;
+    uint64_t allocations;       // 累计计入次数
+};
+
+struct MemoryBudgetStats {
+    uint64_t limit;             // 0 表示不限制
+    uint64_t totalBytes;
+    uint64_t peakTotalBytes;
+    uint64_t degradations;      // 因超出预算而缩减或放弃可选内存的次数
+    MemoryCategoryStats categories[(int)MemoryCategory::COUNT];
+};
+
+// 进程级内存预算 - 播放器各部分的大块内存按类别记账, 可在任意线程调用（只使用原子操作）
+// 必需的内存（当前文件的解码帧、转换帧、音频缓冲区）总是分配并计入;
+// 可选的内存（预读窗口、排队的数据包、下一个文件和循环起点的预先打开）在超出预算时缩减或放弃, 播放继续
+class MemoryBudget {
+public:
+    static MemoryBudget& Instance();
+
+    void SetLimit(uint64_t bytes);
+    uint64_t GetLimit() const { return m_limit.load(std::memory_order_relaxed); }
+
+    void Add(MemoryCategory category, size_t bytes);
+    void Remove(MemoryCategory category, size_t bytes);
+
+    uint64_t TotalBytes() const { return m_total.load(std::memory_order_relaxed); }
+    bool IsOverBudget() const;
+    // 预算剩余的字节数, 不限制时返回 UINT64_MAX
+    uint64_t Available() const;
+    // 可选的内存因超出预算被缩减或放弃时调用, 计入统计
+    void RecordDegradation();
+
+    MemoryBudgetStats GetStats() const;
+    static const char* CategoryName(MemoryCategory category);
+
+private:
+    MemoryBudget();
+    MemoryBudget(const MemoryBudget&) = delete;
+    MemoryBudget& operator=(const MemoryBudget&) = delete;
+
+    static void UpdatePeak(std::atomic<uint64_t>& peak, uint64_t value);
+
+    std::atomic<uint64_t> m_limit;
+    std::atomic<uint64_t> m_total;
+    std::atomic<uint64_t> m_peakTotal;
+    std::atomic<uint64_t> m_degradations;
+    std::atomic<uint64_t> m_bytes[(int)MemoryCategory::COUNT];
+    std::atomic<uint64_t> m_peaks[(int)MemoryCategory::COUNT];
+    std::atomic<uint64_t> m_allocations[(int)MemoryCategory::COUNT];
+};
+
+// 一块计入预算的内存的记账：大小变化时调用 Set, 析构时归还
+// 不可复制; 所属对象只在一个线程中修改它
+class MemoryCharge {
+public:
+    explicit MemoryCharge(MemoryCategory category)
+        : m_category(category)
+        , m_bytes(0)
+    {
+    }
+
+    ~MemoryCharge()
+    {
+        Set(0);
+    }
+
+    void Set(size_t bytes)
+    {
+        if (bytes == m_bytes)
+            return;
+        MemoryBudget& budget = MemoryBudget::Instance();
+        if (m_bytes > 0)
+            budget.Remove(m_category, m_bytes);
+        if (bytes > 0)
+            budget.Add(m_category, bytes);
+        m_bytes = bytes;
+    }
+
+    size_t Bytes() const { return m_bytes; }
+
+private:
+    MemoryCharge(const MemoryCharge&) = delete;
+    MemoryCharge& operator=(const MemoryCharge&) = delete;
+
+    MemoryCategory m_category;
+    size_t m_bytes;
+};
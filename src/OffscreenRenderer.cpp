@@ -0,0 +1,468 @@
+#include "OffscreenRenderer.h"
+#include <iostream>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+// deflate 存储块的最大长度
+static const size_t PNG_STORED_BLOCK_MAX = 65535;
+
+static uint32_t Crc32(uint32_t crc, const uint8_t* data, size_t size)
+{
+    static uint32_t table[256];
+    static bool tableReady = false;
+    if (!tableReady)
+    {
+        for (uint32_t i = 0; i < 256; i++)
+        {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++)
+            {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            table[i] = c;
+        }
+        tableReady = true;
+    }
+
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++)
+    {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+static void PutBigEndian32(std::vector<uint8_t>& out, uint32_t value)
+{
+    out.push_back((uint8_t)(value >> 24));
+    out.push_back((uint8_t)(value >> 16));
+    out.push_back((uint8_t)(value >> 8));
+    out.push_back((uint8_t)value);
+}
+
+static void WritePngChunk(std::ostream& out, const char type[4], const std::vector<uint8_t>& data)
+{
+    std::vector<uint8_t> chunk;
+    chunk.reserve(data.size() + 12);
+    PutBigEndian32(chunk, (uint32_t)data.size());
+    chunk.insert(chunk.end(), type, type + 4);
+    chunk.insert(chunk.end(), data.begin(), data.end());
+    // CRC 覆盖类型和数据
+    PutBigEndian32(chunk, Crc32(0, chunk.data() + 4, data.size() + 4));
+    out.write((const char*)chunk.data(), chunk.size());
+}
+
+static double ElapsedMs(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+VirtualClock::VirtualClock()
+    : m_num(25)
+    , m_den(1)
+    , m_frameIndex(0)
+{
+}
+
+void VirtualClock::SetFrameRate(int num, int den)
+{
+    if (num <= 0 || den <= 0)
+        return;
+    m_num = num;
+    m_den = den;
+}
+
+void VirtualClock::Seek(double seconds)
+{
+    if (seconds < 0.0)
+        seconds = 0.0;
+    m_frameIndex = (int64_t)llround(seconds * m_num / m_den);
+}
+
+double VirtualClock::Now() const
+{
+    return (double)m_frameIndex * m_den / m_num;
+}
+
+OffscreenRenderer::OffscreenRenderer()
+    : m_width(0)
+    , m_height(0)
+    , m_sourceWidth(0)
+    , m_sourceHeight(0)
+    , m_scalingMode(ScalingMode::FIT_TO_WINDOW)
+    , m_filter(FilterType::NONE)
+    , m_mosaicSize(10)
+    , m_capturing(false)
+    , m_captureFormat(FrameDumpFormat::PNG)
+    , m_captureWidth(0)
+    , m_captureHeight(0)
+    , m_filterDoneMs(0.0)
+    , m_startTime(std::chrono::steady_clock::now())
+{
+    memset(&m_stats, 0, sizeof(m_stats));
+}
+
+OffscreenRenderer::~OffscreenRenderer()
+{
+    StopCapture();
+}
+
+bool OffscreenRenderer::Initialize(int width, int height)
+{
+    if (width <= 0 || height <= 0)
+        return false;
+
+    Resize(width, height);
+    m_clock.Reset();
+    memset(&m_stats, 0, sizeof(m_stats));
+    m_frameStats.Reset();
+    m_startTime = std::chrono::steady_clock::now();
+    return true;
+}
+
+void OffscreenRenderer::Resize(int width, int height)
+{
+    if (width <= 0 || height <= 0)
+        return;
+
+    m_width = width;
+    m_height = height;
+    m_framebuffer.assign((size_t)width * height * 4, 0);
+    for (size_t i = 3; i < m_framebuffer.size(); i += 4)
+    {
+        m_framebuffer[i] = 0xFF;
+    }
+}
+
+void OffscreenRenderer::SetFilter(FilterType filter, int mosaicSize)
+{
+    m_filter = filter;
+    if (mosaicSize > 0)
+        m_mosaicSize = mosaicSize;
+}
+
+bool OffscreenRenderer::Present(const uint8_t* frame, const FrameInfo& info, int bytesPerPixel)
+{
+    if (!frame || info.width <= 0 || info.height <= 0 || (bytesPerPixel != 3 && bytesPerPixel != 4))
+        return false;
+
+    auto start = std::chrono::steady_clock::now();
+
+    // 帧交给呈现端即视为解码/转换完成, 截止时间为一个虚拟帧间隔
+    double frameIntervalMs = 1000.0 * m_clock.FrameRateDen() / m_clock.FrameRateNum();
+    FrameTiming timing;
+    memset(&timing, 0, sizeof(timing));
+    timing.sequence = (uint64_t)m_clock.FrameIndex() + 1;
+    timing.pts = m_clock.Now();
+    timing.decodeDoneMs = ElapsedMs(m_startTime);
+    timing.convertDoneMs = timing.decodeDoneMs;
+    timing.deadlineMs = timing.decodeDoneMs + frameIntervalMs;
+
+    // 统一为 BGRA 副本, 与 D3D9 路径的 X8R8G8B8 布局一致
+    m_sourceWidth = info.width;
+    m_sourceHeight = info.height;
+    m_source.resize((size_t)info.width * info.height * 4);
+    for (int y = 0; y < info.height; y++)
+    {
+        const uint8_t* src = frame + (size_t)y * info.stride;
+        uint8_t* dst = m_source.data() + (size_t)y * info.width * 4;
+        if (bytesPerPixel == 4)
+        {
+            memcpy(dst, src, (size_t)info.width * 4);
+        }
+        else
+        {
+            for (int x = 0; x < info.width; x++)
+            {
+                dst[x * 4 + 0] = src[x * 3 + 0];
+                dst[x * 4 + 1] = src[x * 3 + 1];
+                dst[x * 4 + 2] = src[x * 3 + 2];
+                dst[x * 4 + 3] = 0xFF;
+            }
+        }
+    }
+
+    bool ok = RenderSource();
+    double renderMs = ElapsedMs(start);
+    m_stats.totalRenderMs += renderMs;
+    if (renderMs > m_stats.maxRenderMs)
+        m_stats.maxRenderMs = renderMs;
+
+    if (ok)
+    {
+        timing.filterDoneMs = m_filterDoneMs;
+        timing.presentedMs = ElapsedMs(m_startTime);
+        m_frameStats.SetVsyncInterval(frameIntervalMs);
+        m_frameStats.RecordPresented(timing);
+    }
+
+    if (ok && m_capturing)
+    {
+        if (m_captureFormat == FrameDumpFormat::PNG)
+        {
+            char path[1024];
+            snprintf(path, sizeof(path), m_capturePattern.c_str(), (int)m_clock.FrameIndex());
+            if (SaveFrame(path, FrameDumpFormat::PNG))
+                m_stats.dumpedFrames++;
+        }
+        else if (m_width != m_captureWidth || m_height != m_captureHeight)
+        {
+            // Y4M/RAW 流中所有帧必须等大
+            std::cerr << "Offscreen capture stopped: framebuffer resized to " << m_width << "x" << m_height << std::endl;
+            StopCapture();
+        }
+        else
+        {
+            if (m_captureFormat == FrameDumpFormat::Y4M)
+                WriteY4mFrame(m_captureStream);
+            else
+                WriteRaw(m_captureStream);
+            m_stats.dumpedFrames++;
+        }
+    }
+
+    m_clock.Advance();
+    return ok;
+}
+
+bool OffscreenRenderer::Redraw()
+{
+    if (m_source.empty())
+        return false;
+
+    auto start = std::chrono::steady_clock::now();
+    bool ok = RenderSource();
+    double renderMs = ElapsedMs(start);
+    m_stats.totalRenderMs += renderMs;
+    if (renderMs > m_stats.maxRenderMs)
+        m_stats.maxRenderMs = renderMs;
+    if (ok)
+        m_frameStats.RecordRepeat();
+    return ok;
+}
+
+bool OffscreenRenderer::RenderSource()
+{
+    if (m_framebuffer.empty())
+        return false;
+
+    const uint8_t* image = m_source.data();
+    if (m_filter != FilterType::NONE)
+    {
+        m_filtered = m_source;
+        ApplyFrameFilter(m_filter, m_mosaicSize, m_filtered.data(), m_sourceWidth, m_sourceHeight, m_sourceWidth * 4, 4);
+        image = m_filtered.data();
+        m_stats.filterPasses++;
+    }
+    m_filterDoneMs = ElapsedMs(m_startTime);
+
+    int displayWidth, displayHeight, offsetX, offsetY;
+    CalculateDisplayRect(m_scalingMode, m_width, m_height, m_sourceWidth, m_sourceHeight,
+                         displayWidth, displayHeight, offsetX, offsetY);
+
+    // 清除为黑色（包括黑边）
+    uint32_t black = 0xFF000000u;
+    for (size_t i = 0; i < m_framebuffer.size(); i += 4)
+    {
+        memcpy(&m_framebuffer[i], &black, 4);
+    }
+
+    if (displayWidth > 0 && displayHeight > 0)
+    {
+        uint8_t* dst = m_framebuffer.data() + (size_t)offsetY * Stride() + (size_t)offsetX * 4;
+        if (displayWidth == m_sourceWidth && displayHeight == m_sourceHeight)
+        {
+            for (int y = 0; y < displayHeight; y++)
+            {
+                memcpy(dst + (size_t)y * Stride(), image + (size_t)y * m_sourceWidth * 4, (size_t)displayWidth * 4);
+            }
+        }
+        else
+        {
+            // 与 D3D9 路径相同：整帧缩放到显示区域（原始尺寸模式下窗口较小时同样是整帧缩小）
+            m_scaler.Configure(m_sourceWidth, m_sourceHeight, displayWidth, displayHeight);
+            m_scaler.Scale(image, m_sourceWidth * 4, dst, Stride());
+        }
+    }
+
+    m_stats.presents++;
+    return true;
+}
+
+bool OffscreenRenderer::SaveFrame(const std::string& path, FrameDumpFormat format) const
+{
+    if (m_framebuffer.empty())
+        return false;
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out)
+    {
+        std::cerr << "Failed to open frame dump file: " << path << std::endl;
+        return false;
+    }
+
+    switch (format)
+    {
+    case FrameDumpFormat::PNG:
+        WritePng(out);
+        break;
+    case FrameDumpFormat::Y4M:
+        WriteY4mHeader(out);
+        WriteY4mFrame(out);
+        break;
+    case FrameDumpFormat::RAW:
+        WriteRaw(out);
+        break;
+    }
+
+    if (!out)
+    {
+        std::cerr << "Failed to write frame dump file: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool OffscreenRenderer::StartCapture(const std::string& path, FrameDumpFormat format)
+{
+    StopCapture();
+    if (m_framebuffer.empty())
+        return false;
+
+    if (format == FrameDumpFormat::PNG)
+    {
+        if (path.find('%') == std::string::npos)
+        {
+            std::cerr << "PNG capture needs a file name pattern such as frame_%06d.png" << std::endl;
+            return false;
+        }
+        m_capturePattern = path;
+    }
+    else
+    {
+        m_captureStream.open(path, std::ios::binary | std::ios::trunc);
+        if (!m_captureStream)
+        {
+            std::cerr << "Failed to open capture file: " << path << std::endl;
+            return false;
+        }
+        if (format == FrameDumpFormat::Y4M)
+            WriteY4mHeader(m_captureStream);
+    }
+
+    m_captureFormat = format;
+    m_captureWidth = m_width;
+    m_captureHeight = m_height;
+    m_capturing = true;
+    return true;
+}
+
+void OffscreenRenderer::StopCapture()
+{
+    if (m_captureStream.is_open())
+        m_captureStream.close();
+    m_capturePattern.clear();
+    m_capturing = false;
+}
+
+void OffscreenRenderer::WritePng(std::ostream& out) const
+{
+    static const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    out.write((const char*)signature, sizeof(signature));
+
+    // IHDR：8 位 RGB, 无隔行
+    std::vector<uint8_t> header;
+    PutBigEndian32(header, (uint32_t)m_width);
+    PutBigEndian32(header, (uint32_t)m_height);
+    header.push_back(8);    // 位深
+    header.push_back(2);    // 颜色类型：RGB
+    header.push_back(0);    // 压缩方法
+    header.push_back(0);    // 过滤方法
+    header.push_back(0);    // 隔行方式
+    WritePngChunk(out, "IHDR", header);
+
+    // 扫描线：每行一个过滤类型字节 (0 = None) + RGB 数据
+    size_t rowBytes = (size_t)m_width * 3 + 1;
+    std::vector<uint8_t> scanlines(rowBytes * m_height);
+    for (int y = 0; y < m_height; y++)
+    {
+        const uint8_t* src = m_framebuffer.data() + (size_t)y * Stride();
+        uint8_t* dst = scanlines.data() + y * rowBytes;
+        dst[0] = 0;
+        for (int x = 0; x < m_width; x++)
+        {
+            dst[1 + x * 3 + 0] = src[x * 4 + 2];
+            dst[1 + x * 3 + 1] = src[x * 4 + 1];
+            dst[1 + x * 3 + 2] = src[x * 4 + 0];
+        }
+    }
+
+    // zlib 流：头部 + deflate 存储块 + Adler-32
+    std::vector<uint8_t> data;
+    data.reserve(scanlines.size() + scanlines.size() / PNG_STORED_BLOCK_MAX * 5 + 16);
+    data.push_back(0x78);
+    data.push_back(0x01);
+    size_t offset = 0;
+    do
+    {
+        size_t length = scanlines.size() - offset;
+        if (length > PNG_STORED_BLOCK_MAX)
+            length = PNG_STORED_BLOCK_MAX;
+        bool last = (offset + length == scanlines.size());
+        data.push_back(last ? 1 : 0);
+        data.push_back((uint8_t)length);
+        data.push_back((uint8_t)(length >> 8));
+        data.push_back((uint8_t)~length);
+        data.push_back((uint8_t)(~length >> 8));
+        data.insert(data.end(), scanlines.begin() + offset, scanlines.begin() + offset + length);
+        offset += length;
+    } while (offset < scanlines.size());
+
+    uint32_t a = 1, b = 0;
+    for (size_t i = 0; i < scanlines.size(); i++)
+    {
+        a = (a + scanlines[i]) % 65521;
+        b = (b + a) % 65521;
+    }
+    PutBigEndian32(data, (b << 16) | a);
+    WritePngChunk(out, "IDAT", data);
+
+    WritePngChunk(out, "IEND", std::vector<uint8_t>());
+}
+
+void OffscreenRenderer::WriteY4mHeader(std::ostream& out) const
+{
+    char header[128];
+    snprintf(header, sizeof(header), "YUV4MPEG2 W%d H%d F%d:%d Ip A1:1 C444\n",
+             m_width, m_height, m_clock.FrameRateNum(), m_clock.FrameRateDen());
+    out << header;
+}
+
+void OffscreenRenderer::WriteY4mFrame(std::ostream& out) const
+{
+    // BT.601 有限范围整数转换, 三个平面依次写出
+    size_t planeSize = (size_t)m_width * m_height;
+    std::vector<uint8_t> planes(planeSize * 3);
+    uint8_t* yPlane = planes.data();
+    uint8_t* uPlane = yPlane + planeSize;
+    uint8_t* vPlane = uPlane + planeSize;
+
+    for (size_t i = 0; i < planeSize; i++)
+    {
+        int b = m_framebuffer[i * 4 + 0];
+        int g = m_framebuffer[i * 4 + 1];
+        int r = m_framebuffer[i * 4 + 2];
+        yPlane[i] = (uint8_t)(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+        uPlane[i] = (uint8_t)(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+        vPlane[i] = (uint8_t)(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+    }
+
+    out << "FRAME\n";
+    out.write((const char*)planes.data(), planes.size());
+}
+
+void OffscreenRenderer::WriteRaw(std::ostream& out) const
+{
+    out.write((const char*)m_framebuffer.data(), m_framebuffer.size());
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cstdint>
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "DisplayPipeline.h"
+#include "FrameMailbox.h"
+#include "FrameStats.h"
+#include "SoftwareScaler.h"
+
+// 确定性虚拟时钟：时间只由呈现的帧数决定 (帧序号 * den / num 秒), 与实际耗时无关
+// 无窗口渲染时代替音频时钟/系统时钟, 同一输入每次运行得到相同的时间戳序列
+class VirtualClock {
+public:
+    VirtualClock();
+
+    void SetFrameRate(int num, int den);
+    int FrameRateNum() const { return m_num; }
+    int FrameRateDen() const { return m_den; }
+
+    void Reset() { m_frameIndex = 0; }
+    void Advance() { m_frameIndex++; }
+    void Seek(double seconds);
+
+    int64_t FrameIndex() const { return m_frameIndex; }
+    double Now() const;
+
+private:
+    int m_num;
+    int m_den;
+    int64_t m_frameIndex;
+};
+
+// 帧转储格式
+enum class FrameDumpFormat {
+    PNG,        // 8 位 RGB, 每帧一个文件（未压缩的 deflate 存储块, 不依赖 zlib）
+    Y4M,        // YUV4MPEG2 4:4:4 (BT.601 有限范围), 所有帧写入同一个文件
+    RAW         // BGRA 紧密排列, 所有帧依次写入同一个文件
+};
+
+// 无窗口渲染统计
+struct OffscreenStats {
+    uint64_t presents;          // 呈现次数（包括 Redraw）
+    uint64_t filterPasses;      // 滤镜执行次数
+    uint64_t dumpedFrames;      // 捕获写出的帧数
+    double totalRenderMs;       // 呈现累计耗时（实际耗时, 不含转储）
+    double maxRenderMs;
+};
+
+// 无窗口渲染后端 - 把帧呈现到内存中的 BGRA 帧缓冲区
+// 显示区域计算和滤镜与 VideoPlayer 共用 DisplayPipeline, 缩放使用 SoftwareScaler,
+// 不依赖 HWND/GPU, 可在任何平台上对显示流程做性能回归和参考图像比对
+class OffscreenRenderer {
+public:
+    OffscreenRenderer();
+    ~OffscreenRenderer();
+
+    // 帧缓冲区尺寸相当于窗口客户区尺寸, 内容清为黑色
+    bool Initialize(int width, int height);
+    void Resize(int width, int height);
+
+    int Width() const { return m_width; }
+    int Height() const { return m_height; }
+    int Stride() const { return m_width * 4; }
+    const uint8_t* Framebuffer() const { return m_framebuffer.data(); }
+
+    void SetScalingMode(ScalingMode mode) { m_scalingMode = mode; }
+    void SetFilter(FilterType filter, int mosaicSize);
+
+    VirtualClock& Clock() { return m_clock; }
+    const VirtualClock& Clock() const { return m_clock; }
+
+    // 呈现一帧 BGR24/BGRA 图像：应用滤镜, 清除黑边, 缩放到显示区域; 捕获开启时写出该帧, 之后虚拟时钟前进一帧
+    bool Present(const uint8_t* frame, const FrameInfo& info, int bytesPerPixel);
+
+    // 按当前尺寸/缩放模式/滤镜重新呈现上一帧, 不推进时钟也不写出捕获
+    bool Redraw();
+
+    // 立即把当前帧缓冲区写入文件（Y4M/RAW 为单帧文件）
+    bool SaveFrame(const std::string& path, FrameDumpFormat format) const;
+
+    // 开始捕获每次 Present 的结果; PNG 时 path 为含整数格式符的模式（如 "frame_%06d.png"）, 按帧序号命名
+    bool StartCapture(const std::string& path, FrameDumpFormat format);
+    void StopCapture();
+    bool IsCapturing() const { return m_capturing; }
+
+    OffscreenStats GetStats() const { return m_stats; }
+
+    // 每帧的接收/滤镜/呈现时间和帧间隔直方图; 截止时间为虚拟时钟的一个帧间隔（帧预算）
+    const FrameStatsRecorder& FrameStats() const { return m_frameStats; }
+
+private:
+    bool RenderSource();
+    void WritePng(std::ostream& out) const;
+    void WriteY4mHeader(std::ostream& out) const;
+    void WriteY4mFrame(std::ostream& out) const;
+    void WriteRaw(std::ostream& out) const;
+
+    int m_width;
+    int m_height;
+    std::vector<uint8_t> m_framebuffer;     // BGRA, 步长 = m_width * 4
+
+    // 上一帧的 BGRA 副本（滤镜作用在副本上, Redraw 时从这里重新生成）
+    std::vector<uint8_t> m_source;
+    std::vector<uint8_t> m_filtered;
+    int m_sourceWidth;
+    int m_sourceHeight;
+
+    ScalingMode m_scalingMode;
+    FilterType m_filter;
+    int m_mosaicSize;
+
+    SoftwareScaler m_scaler;
+    VirtualClock m_clock;
+
+    // 捕获状态
+    bool m_capturing;
+    FrameDumpFormat m_captureFormat;
+    std::ofstream m_captureStream;      // Y4M/RAW 流
+    std::string m_capturePattern;       // PNG 文件名模式
+    int m_captureWidth;
+    int m_captureHeight;
+
+    OffscreenStats m_stats;
+    FrameStatsRecorder m_frameStats;
+    double m_filterDoneMs;              // 最近一次 RenderSource 中滤镜完成的时间
+    std::chrono::steady_clock::time_point m_startTime;
+};
@@ -0,0 +1,306 @@
+#include "PlayerMetrics.h"
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+LatencyHistogram::LatencyHistogram()
+    : m_count(0)
+    , m_sumUs(0)
+    , m_minUs(UINT64_MAX)
+    , m_maxUs(0)
+{
+    for (int i = 0; i < BUCKET_COUNT; i++)
+    {
+        m_buckets[i] = 0;
+    }
+}
+
+int LatencyHistogram::BucketIndex(uint64_t us)
+{
+    if (us < (uint64_t)SUB_BUCKETS)
+        return (int)us;
+    if (us >> (MAX_SHIFT + SUB_BUCKET_BITS + 1))
+        return BUCKET_COUNT - 1;
+
+    // 值在 [16 << shift, 32 << shift) 内, 右移 shift 位后落在 16 个桶之一
+    int shift = 0;
+    while ((us >> shift) >= (uint64_t)(2 * SUB_BUCKETS))
+    {
+        shift++;
+    }
+    return SUB_BUCKETS * shift + (int)(us >> shift);
+}
+
+uint64_t LatencyHistogram::BucketUpperBound(int index)
+{
+    if (index < SUB_BUCKETS)
+        return (uint64_t)index;
+    int shift = index / SUB_BUCKETS - 1;
+    uint64_t subBucket = (uint64_t)(index % SUB_BUCKETS + SUB_BUCKETS);
+    return ((subBucket + 1) << shift) - 1;
+}
+
+void LatencyHistogram::Record(uint64_t us)
+{
+    m_buckets[BucketIndex(us)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sumUs.fetch_add(us, std::memory_order_relaxed);
+
+    uint64_t current = m_minUs.load(std::memory_order_relaxed);
+    while (us < current && !m_minUs.compare_exchange_weak(current, us, std::memory_order_relaxed))
+    {
+    }
+    current = m_maxUs.load(std::memory_order_relaxed);
+    while (us > current && !m_maxUs.compare_exchange_weak(current, us, std::memory_order_relaxed))
+    {
+    }
+}
+
+LatencySummary LatencyHistogram::Summarize() const
+{
+    LatencySummary summary = {};
+
+    // 记录可能与快照并发, 分位数按复制出的桶计数计算, 各字段之间允许相差几次记录
+    uint64_t buckets[BUCKET_COUNT];
+    uint64_t total = 0;
+    for (int i = 0; i < BUCKET_COUNT; i++)
+    {
+        buckets[i] = m_buckets[i].load(std::memory_order_relaxed);
+        total += buckets[i];
+    }
+    if (total == 0)
+        return summary;
+
+    uint64_t count = m_count.load(std::memory_order_relaxed);
+    uint64_t minUs = m_minUs.load(std::memory_order_relaxed);
+    uint64_t maxUs = m_maxUs.load(std::memory_order_relaxed);
+    summary.count = count;
+    summary.meanUs = count > 0 ? (double)m_sumUs.load(std::memory_order_relaxed) / (double)count : 0.0;
+    summary.minUs = minUs != UINT64_MAX ? (double)minUs : 0.0;
+    summary.maxUs = (double)maxUs;
+
+    const double quantiles[] = { 0.5, 0.9, 0.99, 0.999 };
+    double* results[] = { &summary.p50Us, &summary.p90Us, &summary.p99Us, &summary.p999Us };
+    for (int q = 0; q < 4; q++)
+    {
+        uint64_t rank = (uint64_t)(quantiles[q] * (double)total + 0.999999);
+        if (rank == 0)
+            rank = 1;
+        uint64_t seen = 0;
+        for (int i = 0; i < BUCKET_COUNT; i++)
+        {
+            seen += buckets[i];
+            if (seen >= rank)
+            {
+                uint64_t upper = BucketUpperBound(i);
+                *results[q] = (double)(upper < maxUs ? upper : maxUs);
+                break;
+            }
+        }
+    }
+    return summary;
+}
+
+void LatencyHistogram::Reset()
+{
+    for (int i = 0; i < BUCKET_COUNT; i++)
+    {
+        m_buckets[i].store(0, std::memory_order_relaxed);
+    }
+    m_count.store(0, std::memory_order_relaxed);
+    m_sumUs.store(0, std::memory_order_relaxed);
+    m_minUs.store(UINT64_MAX, std::memory_order_relaxed);
+    m_maxUs.store(0, std::memory_order_relaxed);
+}
+
+PlayerMetrics& PlayerMetrics::Instance()
+{
+    static PlayerMetrics instance;
+    return instance;
+}
+
+PlayerMetrics::PlayerMetrics()
+    : m_startUs(NowUs())
+    , m_dumpQuit(false)
+{
+    for (int i = 0; i < (int)MetricCounter::COUNT; i++)
+    {
+        m_counters[i] = 0;
+    }
+    for (int i = 0; i < (int)MetricGauge::COUNT; i++)
+    {
+        m_gauges[i] = 0;
+    }
+}
+
+PlayerMetrics::~PlayerMetrics()
+{
+    StopDump();
+}
+
+MetricsSnapshot PlayerMetrics::GetStats() const
+{
+    MetricsSnapshot snapshot = {};
+    snapshot.enabled = IsEnabled();
+    if (!snapshot.enabled)
+        return snapshot;
+
+    snapshot.uptimeMs = (double)(NowUs() - m_startUs.load(std::memory_order_relaxed)) / 1000.0;
+    for (int i = 0; i < (int)MetricStage::COUNT; i++)
+    {
+        snapshot.stages[i] = m_stages[i].Summarize();
+    }
+    for (int i = 0; i < (int)MetricCounter::COUNT; i++)
+    {
+        snapshot.counters[i] = m_counters[i].load(std::memory_order_relaxed);
+    }
+    for (int i = 0; i < (int)MetricGauge::COUNT; i++)
+    {
+        snapshot.gauges[i] = m_gauges[i].load(std::memory_order_relaxed);
+    }
+    return snapshot;
+}
+
+void PlayerMetrics::Reset()
+{
+    for (int i = 0; i < (int)MetricStage::COUNT; i++)
+    {
+        m_stages[i].Reset();
+    }
+    for (int i = 0; i < (int)MetricCounter::COUNT; i++)
+    {
+        m_counters[i].store(0, std::memory_order_relaxed);
+    }
+    m_startUs.store(NowUs(), std::memory_order_relaxed);
+}
+
+bool PlayerMetrics::StartDump(const std::string& path, int intervalMs)
+{
+    if (!IsEnabled())
+    {
+        std::cerr << "Metrics are disabled in this build (PLAYER_METRICS=0)" << std::endl;
+        return false;
+    }
+    StopDump();
+
+    // 先清空文件, 确认可写
+    {
+        std::ofstream out(path, std::ios::trunc);
+        if (!out)
+        {
+            std::cerr << "Failed to open metrics file: " << path << std::endl;
+            return false;
+        }
+    }
+
+    m_dumpQuit = false;
+    m_dumpThread = std::thread(&PlayerMetrics::DumpLoop, this, path, intervalMs > 0 ? intervalMs : 1000);
+    std::cout << "Dumping metrics to " << path << " every " << (intervalMs > 0 ? intervalMs : 1000) << " ms" << std::endl;
+    return true;
+}
+
+void PlayerMetrics::StopDump()
+{
+    if (!m_dumpThread.joinable())
+        return;
+    {
+        std::lock_guard<std::mutex> lock(m_dumpMutex);
+        m_dumpQuit = true;
+    }
+    m_dumpWake.notify_all();
+    m_dumpThread.join();
+}
+
+void PlayerMetrics::DumpLoop(std::string path, int intervalMs)
+{
+    bool quit = false;
+    while (!quit)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_dumpMutex);
+            m_dumpWake.wait_for(lock, std::chrono::milliseconds(intervalMs), [this] { return m_dumpQuit; });
+            quit = m_dumpQuit;
+        }
+
+        // 停止时也写最后一行; 每次追加后关闭, 其他程序可以随时读取
+        std::ofstream out(path, std::ios::app);
+        if (!out)
+        {
+            std::cerr << "Failed to write metrics file: " << path << std::endl;
+            continue;
+        }
+        out << FormatJson(GetStats()) << '\n';
+    }
+}
+
+std::string PlayerMetrics::FormatJson(const MetricsSnapshot& snapshot)
+{
+    char buffer[256];
+    std::string json;
+    snprintf(buffer, sizeof(buffer), "{\"uptimeMs\":%.1f,\"stages\":{", snapshot.uptimeMs);
+    json += buffer;
+    for (int i = 0; i < (int)MetricStage::COUNT; i++)
+    {
+        const LatencySummary& stage = snapshot.stages[i];
+        snprintf(buffer, sizeof(buffer),
+            "%s\"%s\":{\"count\":%llu,\"meanUs\":%.1f,\"minUs\":%.0f,\"p50Us\":%.0f,\"p90Us\":%.0f,\"p99Us\":%.0f,\"p999Us\":%.0f,\"maxUs\":%.0f}",
+            i > 0 ? "," : "", StageName((MetricStage)i), (unsigned long long)stage.count,
+            stage.meanUs, stage.minUs, stage.p50Us, stage.p90Us, stage.p99Us, stage.p999Us, stage.maxUs);
+        json += buffer;
+    }
+    json += "},\"counters\":{";
+    for (int i = 0; i < (int)MetricCounter::COUNT; i++)
+    {
+        snprintf(buffer, sizeof(buffer), "%s\"%s\":%llu",
+            i > 0 ? "," : "", CounterName((MetricCounter)i), (unsigned long long)snapshot.counters[i]);
+        json += buffer;
+    }
+    json += "},\"gauges\":{";
+    for (int i = 0; i < (int)MetricGauge::COUNT; i++)
+    {
+        snprintf(buffer, sizeof(buffer), "%s\"%s\":%lld",
+            i > 0 ? "," : "", GaugeName((MetricGauge)i), (long long)snapshot.gauges[i]);
+        json += buffer;
+    }
+    json += "}}";
+    return json;
+}
+
+const char* PlayerMetrics::StageName(MetricStage stage)
+{
+    switch (stage)
+    {
+    case MetricStage::DEMUX:        return "demux";
+    case MetricStage::DECODE_VIDEO: return "decodeVideo";
+    case MetricStage::DECODE_AUDIO: return "decodeAudio";
+    case MetricStage::CONVERT:      return "convert";
+    case MetricStage::FILTER:       return "filter";
+    case MetricStage::PRESENT:      return "present";
+    case MetricStage::AUDIO_WRITE:  return "audioWrite";
+    default:                        return "unknown";
+    }
+}
+
+const char* PlayerMetrics::CounterName(MetricCounter counter)
+{
+    switch (counter)
+    {
+    case MetricCounter::DEMUX_PACKETS:          return "demuxPackets";
+    case MetricCounter::DEMUX_BYTES:            return "demuxBytes";
+    case MetricCounter::VIDEO_FRAMES:           return "videoFrames";
+    case MetricCounter::AUDIO_FRAMES:           return "audioFrames";
+    case MetricCounter::AUDIO_UNDERRUNS:        return "audioUnderruns";
+    case MetricCounter::AUDIO_SYNC_CORRECTIONS: return "audioSyncCorrections";
+    default:                                    return "unknown";
+    }
+}
+
+const char* PlayerMetrics::GaugeName(MetricGauge gauge)
+{
+    switch (gauge)
+    {
+    case MetricGauge::AUDIO_SYNC_DIFF_US:     return "audioSyncDiffUs";
+    case MetricGauge::AUDIO_SYNC_AVG_DIFF_US: return "audioSyncAvgDiffUs";
+    default:                                  return "unknown";
+    }
+}
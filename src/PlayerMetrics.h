@@ -0,0 +1,195 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// 编译时开关：/DPLAYER_METRICS=0 编译时所有记录调用都是空的内联函数, 不读时钟也不访问原子变量
+#ifndef PLAYER_METRICS
+#define PLAYER_METRICS 1
+#endif
+
+// 计时的处理阶段
+enum class MetricStage {
+    DEMUX,              // av_read_frame
+    DECODE_VIDEO,       // 视频 avcodec_send_packet + avcodec_receive_frame
+    DECODE_AUDIO,
+    CONVERT,            // sws_scale 转换到 RGB 邮箱
+    FILTER,             // CPU 滤镜（复制原始帧并处理）
+    PRESENT,            // UI 线程的一次 Render（上传、绘制、Present/StretchDIBits）
+    AUDIO_WRITE,        // WASAPI 渲染线程填充一次设备缓冲区
+    COUNT
+};
+
+enum class MetricCounter {
+    DEMUX_PACKETS,
+    DEMUX_BYTES,
+    VIDEO_FRAMES,               // 解码出的视频帧
+    AUDIO_FRAMES,
+    AUDIO_UNDERRUNS,            // 设备缓冲区补静音的次数（播放中环形缓冲区数据不足）
+    AUDIO_SYNC_CORRECTIONS,     // 为同步调整音频样本数的次数
+    COUNT
+};
+
+// 最近一次的瞬时值
+enum class MetricGauge {
+    AUDIO_SYNC_DIFF_US,         // 音频时钟 - 视频时钟
+    AUDIO_SYNC_AVG_DIFF_US,     // 加权平均差
+    COUNT
+};
+
+// 一个阶段的耗时分布（微秒）; 分位数为所在桶的上界, 相对误差不超过 1/16
+struct LatencySummary {
+    uint64_t count;
+    double meanUs;
+    double minUs;
+    double p50Us;
+    double p90Us;
+    double p99Us;
+    double p999Us;
+    double maxUs;
+};
+
+struct MetricsSnapshot {
+    bool enabled;               // 编译时关闭指标时为 false, 其余字段为零
+    double uptimeMs;            // 从开始统计（或上一次 Reset）到快照的时间
+    LatencySummary stages[(int)MetricStage::COUNT];
+    uint64_t counters[(int)MetricCounter::COUNT];
+    int64_t gauges[(int)MetricGauge::COUNT];
+};
+
+// 对数-线性分桶的耗时直方图（HdrHistogram 的简化）：每个 2 的幂区间分为 16 个等宽的桶,
+// 16 us 以下精确到 1 us, 超过约 71 分钟的值计入最后一个桶。记录只做原子加, 可在任意线程调用
+class LatencyHistogram {
+public:
+    LatencyHistogram();
+
+    void Record(uint64_t us);
+    LatencySummary Summarize() const;
+    void Reset();
+
+private:
+    static const int SUB_BUCKET_BITS = 4;
+    static const int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static const int MAX_SHIFT = 27;        // 最大值 2^32 us
+    static const int BUCKET_COUNT = SUB_BUCKETS * (MAX_SHIFT + 2);
+
+    static int BucketIndex(uint64_t us);
+    static uint64_t BucketUpperBound(int index);
+
+    std::atomic<uint64_t> m_buckets[BUCKET_COUNT];
+    std::atomic<uint64_t> m_count;
+    std::atomic<uint64_t> m_sumUs;
+    std::atomic<uint64_t> m_minUs;
+    std::atomic<uint64_t> m_maxUs;
+};
+
+// 播放器的运行指标 - 进程级单例：各阶段的耗时直方图、计数器和瞬时值, 记录都是无锁的原子操作;
+// GetStats 取快照, StartDump 启动后台线程定期把快照追加到文件（每行一个 JSON 对象）
+class PlayerMetrics {
+public:
+    static PlayerMetrics& Instance();
+
+    static void Record(MetricStage stage, uint64_t us)
+    {
+#if PLAYER_METRICS
+        Instance().m_stages[(int)stage].Record(us);
+#else
+        (void)stage;
+        (void)us;
+#endif
+    }
+
+    static void Count(MetricCounter counter, uint64_t amount = 1)
+    {
+#if PLAYER_METRICS
+        Instance().m_counters[(int)counter].fetch_add(amount, std::memory_order_relaxed);
+#else
+        (void)counter;
+        (void)amount;
+#endif
+    }
+
+    static void SetGauge(MetricGauge gauge, int64_t value)
+    {
+#if PLAYER_METRICS
+        Instance().m_gauges[(int)gauge].store(value, std::memory_order_relaxed);
+#else
+        (void)gauge;
+        (void)value;
+#endif
+    }
+
+    // 单调时钟（微秒）
+    static uint64_t NowUs()
+    {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    static bool IsEnabled() { return PLAYER_METRICS != 0; }
+
+    MetricsSnapshot GetStats() const;
+    void Reset();
+
+    // 每隔 intervalMs 把快照追加到 path（打开时清空文件）; 关闭指标的构建返回 false
+    bool StartDump(const std::string& path, int intervalMs);
+    void StopDump();
+    bool IsDumping() const { return m_dumpThread.joinable(); }
+
+    static const char* StageName(MetricStage stage);
+    static const char* CounterName(MetricCounter counter);
+    static const char* GaugeName(MetricGauge gauge);
+
+private:
+    PlayerMetrics();
+    ~PlayerMetrics();
+    PlayerMetrics(const PlayerMetrics&) = delete;
+    PlayerMetrics& operator=(const PlayerMetrics&) = delete;
+
+    void DumpLoop(std::string path, int intervalMs);
+    static std::string FormatJson(const MetricsSnapshot& snapshot);
+
+    LatencyHistogram m_stages[(int)MetricStage::COUNT];
+    std::atomic<uint64_t> m_counters[(int)MetricCounter::COUNT];
+    std::atomic<int64_t> m_gauges[(int)MetricGauge::COUNT];
+    std::atomic<uint64_t> m_startUs;
+
+    std::thread m_dumpThread;       // 只由 UI 线程启动和停止
+    std::mutex m_dumpMutex;
+    std::condition_variable m_dumpWake;
+    bool m_dumpQuit;
+};
+
+// 在作用域内计时一个阶段
+class MetricsScope {
+public:
+    explicit MetricsScope(MetricStage stage)
+#if PLAYER_METRICS
+        : m_stage(stage)
+        , m_startUs(PlayerMetrics::NowUs())
+#endif
+    {
+        (void)stage;
+    }
+
+    ~MetricsScope()
+    {
+#if PLAYER_METRICS
+        PlayerMetrics::Record(m_stage, PlayerMetrics::NowUs() - m_startUs);
+#endif
+    }
+
+private:
+    MetricsScope(const MetricsScope&) = delete;
+    MetricsScope& operator=(const MetricsScope&) = delete;
+
+#if PLAYER_METRICS
+    MetricStage m_stage;
+    uint64_t m_startUs;
+#endif
+};
@@ -0,0 +1,223 @@
+#include "PrefetchCache.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+static double ElapsedMs(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+PrefetchCache::PrefetchCache()
+    : m_fileSize(0)
+    , m_capacity(0)
+    , m_chunkSize(0)
+    , m_cacheCharge(MemoryCategory::INPUT_CACHE)
+    , m_keepBehind(0)
+    , m_cacheStart(0)
+    , m_cacheEnd(0)
+    , m_position(0)
+    , m_generation(0)
+    , m_fetchError(false)
+    , m_quit(false)
+{
+    memset(&m_stats, 0, sizeof(m_stats));
+}
+
+PrefetchCache::~PrefetchCache()
+{
+    Stop();
+}
+
+bool PrefetchCache::Start(int64_t fileSize, size_t readAhead, size_t chunkSize, ReadFunction read, InterruptFunction interrupted)
+{
+    if (m_thread.joinable() || chunkSize == 0 || fileSize < 0)
+        return false;
+
+    m_read = read;
+    m_interrupted = interrupted;
+    m_fileSize = fileSize;
+    m_chunkSize = chunkSize;
+
+    // 小文件整个放进缓存; 缓存不清零, 只有写入过的范围会被读取
+    m_capacity = (size_t)(std::max)((int64_t)chunkSize, (std::min)((int64_t)readAhead, fileSize));
+    m_keepBehind = m_capacity / 8;
+    m_cache.reset(new (std::nothrow) uint8_t[m_capacity]);
+    if (!m_cache)
+        return false;
+    m_cacheCharge.Set(m_capacity);
+
+    m_thread = std::thread(&PrefetchCache::FetchLoop, this);
+    return true;
+}
+
+void PrefetchCache::Stop()
+{
+    if (!m_thread.joinable())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
+    }
+    m_spaceReady.notify_all();
+    m_thread.join();
+}
+
+int PrefetchCache::Read(uint8_t* buffer, int size)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (m_position >= m_fileSize)
+        return READ_EOF;
+
+    if (m_cacheEnd <= m_position)
+    {
+        // 预读没有跟上（刚打开、刚跳出缓存或读取速度不足）, 等待并计入停顿
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        while (m_cacheEnd <= m_position && m_position < m_fileSize && !m_fetchError)
+        {
+            if (m_interrupted && m_interrupted())
+            {
+                m_stats.stalls++;
+                m_stats.stallMs += ElapsedMs(start);
+                return READ_INTERRUPTED;
+            }
+            m_dataReady.wait_for(lock, std::chrono::milliseconds(10));
+        }
+        m_stats.stalls++;
+        m_stats.stallMs += ElapsedMs(start);
+
+        if (m_cacheEnd <= m_position)
+            return m_fetchError ? READ_ERROR : READ_EOF;
+    }
+
+    int count = (int)(std::min)((int64_t)size, m_cacheEnd - m_position);
+    int copied = 0;
+    while (copied < count)
+    {
+        size_t offset = (size_t)((m_position + copied) % (int64_t)m_capacity);
+        size_t length = (std::min)((size_t)(count - copied), m_capacity - offset);
+        memcpy(buffer + copied, m_cache.get() + offset, length);
+        copied += (int)length;
+    }
+    m_position += count;
+    m_stats.bytesDelivered += count;
+
+    lock.unlock();
+    m_spaceReady.notify_one();
+    return count;
+}
+
+int64_t PrefetchCache::Seek(int64_t offset, int origin)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    int64_t target;
+    switch (origin)
+    {
+    case SEEK_SET: target = offset; break;
+    case SEEK_CUR: target = m_position + offset; break;
+    case SEEK_END: target = m_fileSize + offset; break;
+    default: return -1;
+    }
+    if (target < 0)
+        return -1;
+
+    m_stats.seeks++;
+    if (target >= m_cacheStart && target <= m_cacheEnd)
+    {
+        m_stats.cachedSeeks++;
+        m_position = target;
+    }
+    else
+    {
+        // 跳出缓存：丢弃缓存, 预读线程从目标位置重新开始
+        m_position = target;
+        m_cacheStart = target;
+        m_cacheEnd = target;
+        m_generation++;
+        m_fetchError = false;
+    }
+
+    lock.unlock();
+    m_spaceReady.notify_one();
+    return target;
+}
+
+int64_t PrefetchCache::FileSize() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_fileSize;
+}
+
+void PrefetchCache::GetRange(int64_t& start, int64_t& end) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    start = m_cacheStart;
+    end = m_cacheEnd;
+}
+
+MediaIOStats PrefetchCache::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+void PrefetchCache::FetchLoop()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_quit)
+    {
+        // 预读窗口已满、读到文件末尾或出错时等待读取线程消耗数据或跳转
+        int64_t ahead = m_cacheEnd - m_position;
+        int64_t window = (int64_t)(m_capacity - m_keepBehind);
+        if (ahead >= window || m_cacheEnd >= m_fileSize || m_fetchError)
+        {
+            m_spaceReady.wait(lock);
+            continue;
+        }
+
+        // 一次读取不超过预读窗口的剩余空间, 也不跨越环形缓存的末尾
+        int64_t fetchOffset = m_cacheEnd;
+        size_t ringOffset = (size_t)(fetchOffset % (int64_t)m_capacity);
+        size_t chunk = (size_t)(std::min)((int64_t)m_chunkSize, window - ahead);
+        chunk = (std::min)(chunk, m_capacity - ringOffset);
+        chunk = (size_t)(std::min)((int64_t)chunk, m_fileSize - fetchOffset);
+
+        // 淘汰最早的数据腾出空间（不会越过读取位置之前保留的 m_keepBehind 字节）
+        m_cacheStart = (std::max)(m_cacheStart, fetchOffset + (int64_t)chunk - (int64_t)m_capacity);
+        uint64_t generation = m_generation;
+        lock.unlock();
+
+        // 读文件时不持锁：写入的区域在有效范围之外, 读取线程不会访问
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        int64_t bytesRead = m_read(fetchOffset, m_cache.get() + ringOffset, chunk);
+        double elapsedMs = ElapsedMs(start);
+
+        lock.lock();
+        if (bytesRead > 0)
+        {
+            m_stats.bytesFetched += bytesRead;
+        }
+        m_stats.fetchMs += elapsedMs;
+        if (generation != m_generation)
+            continue;
+
+        if (bytesRead < 0)
+        {
+            std::cerr << "Prefetch read failed at offset " << fetchOffset << std::endl;
+            m_fetchError = true;
+        }
+        else if (bytesRead == 0)
+        {
+            // 文件比打开时短
+            m_fileSize = m_cacheEnd;
+        }
+        else
+        {
+            m_cacheEnd += (std::min)(bytesRead, (int64_t)chunk);
+        }
+        m_dataReady.notify_all();
+    }
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "MemoryBudget.h"
+
+// 输入统计（累计值）
+struct MediaIOStats {
+    uint64_t bytesFetched;      // 从文件读入缓存的字节数
+    double fetchMs;             // 读文件耗时（后台线程）
+    uint64_t bytesDelivered;    // 交给解复用器的字节数
+    uint64_t stalls;            // 解复用器等待数据的次数
+    double stallMs;             // 等待总时长
+    uint64_t seeks;
+    uint64_t cachedSeeks;       // 目标已在缓存中、不需要重新读文件的跳转
+};
+
+// 预读环形缓存：后台线程通过注入的读取函数按顺序把文件读入缓存, 领先读取位置最多一个预读窗口,
+// 读取线程只从缓存复制。读取位置之前最近的一段数据保留在缓存中, 跳转目标仍在缓存范围内时不重新读文件。
+// 不涉及具体的文件 API（PrefetchIO 提供 Win32 文件读取）, 可以用内存中的数据测试
+class PrefetchCache {
+public:
+    // 从文件 offset 处读取最多 size 字节, 返回读到的字节数（0 表示已到文件末尾）, 失败时返回 -1; 在预读线程中调用
+    typedef std::function<int64_t(int64_t offset, uint8_t* buffer, size_t size)> ReadFunction;
+    // 阻塞等待数据时轮询, 返回 true 时放弃等待
+    typedef std::function<bool()> InterruptFunction;
+
+    // Read 的错误返回值
+    static const int READ_EOF = -1;
+    static const int READ_INTERRUPTED = -2;
+    static const int READ_ERROR = -3;
+
+    PrefetchCache();
+    ~PrefetchCache();
+
+    // 分配缓存并启动预读线程; chunkSize 为单次读取的最大字节数, 也是缓存的最小容量
+    bool Start(int64_t fileSize, size_t readAhead, size_t chunkSize, ReadFunction read, InterruptFunction interrupted);
+    // 停止并等待预读线程（之后不再调用读取函数）
+    void Stop();
+
+    // 从读取位置复制最多 size 字节, 数据尚未读入时等待; 返回复制的字节数或 READ_* 错误
+    int Read(uint8_t* buffer, int size);
+    // origin 为 SEEK_SET/SEEK_CUR/SEEK_END, 返回新的读取位置, 目标无效时返回 -1
+    int64_t Seek(int64_t offset, int origin);
+
+    // 文件大小（读到的数据比打开时少时缩小为实际读到的末尾）
+    int64_t FileSize() const;
+    // 缓存中的有效范围 [start, end)
+    void GetRange(int64_t& start, int64_t& end) const;
+    size_t Capacity() const { return m_capacity; }
+    size_t KeepBehind() const { return m_keepBehind; }
+    MediaIOStats GetStats() const;
+
+private:
+    PrefetchCache(const PrefetchCache&) = delete;
+    PrefetchCache& operator=(const PrefetchCache&) = delete;
+
+    void FetchLoop();
+
+    ReadFunction m_read;
+    InterruptFunction m_interrupted;
+    int64_t m_fileSize;
+
+    // 环形缓存：文件偏移 x 存放在 x % m_capacity 处
+    std::unique_ptr<uint8_t[]> m_cache;
+    size_t m_capacity;
+    size_t m_chunkSize;
+    MemoryCharge m_cacheCharge;     // 计入内存预算的 INPUT_CACHE
+    size_t m_keepBehind;            // 读取位置之前保留的字节数（向后跳转命中缓存）
+
+    // 以下由 m_mutex 保护; [m_cacheStart, m_cacheEnd) 为缓存中的有效数据, 预读线程只写这个范围之外的区域
+    mutable std::mutex m_mutex;
+    std::condition_variable m_dataReady;    // 预读线程 -> 读取线程
+    std::condition_variable m_spaceReady;   // 读取线程消耗或跳转 -> 预读线程
+    int64_t m_cacheStart;
+    int64_t m_cacheEnd;
+    int64_t m_position;             // 读取位置
+    uint64_t m_generation;          // 跳出缓存时加一, 预读线程丢弃进行中的旧读取
+    bool m_fetchError;
+    bool m_quit;
+    MediaIOStats m_stats;
+
+    std::thread m_thread;
+};
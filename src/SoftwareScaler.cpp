@@ -0,0 +1,339 @@
+#include "SoftwareScaler.h"
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <emmintrin.h>
+
+// 每个条带至少处理的输出行数, 小图不值得分发到多个线程
+static const int MIN_ROWS_PER_BAND = 32;
+static const int MAX_THREADS = 8;
+
+static inline int32_t PackWeights(const int16_t weight[2])
+{
+    int32_t packed;
+    memcpy(&packed, weight, sizeof(packed));
+    return packed;
+}
+
+static inline __m128i LoadPixelPair(const uint8_t* left)
+{
+    // 相邻两个 BGRA 像素交错为 b0 b1 g0 g1 r0 r1 a0 a1, 再扩展为 int16
+    int32_t p0, p1;
+    memcpy(&p0, left, 4);
+    memcpy(&p1, left + 4, 4);
+    __m128i pair = _mm_unpacklo_epi8(_mm_cvtsi32_si128(p0), _mm_cvtsi32_si128(p1));
+    return _mm_unpacklo_epi8(pair, _mm_setzero_si128());
+}
+
+SoftwareScaler::SoftwareScaler()
+    : m_srcWidth(0)
+    , m_srcHeight(0)
+    , m_dstWidth(0)
+    , m_dstHeight(0)
+    , m_src(nullptr)
+    , m_srcStride(0)
+    , m_dst(nullptr)
+    , m_dstStride(0)
+    , m_bandCount(1)
+    , m_threadCount(1)
+    , m_generation(0)
+    , m_pending(0)
+    , m_quit(false)
+{
+    SetThreadCount(0);
+}
+
+SoftwareScaler::~SoftwareScaler()
+{
+    StopWorkers();
+}
+
+bool SoftwareScaler::Configure(int srcWidth, int srcHeight, int dstWidth, int dstHeight)
+{
+    if (srcWidth <= 0 || srcHeight <= 0 || dstWidth <= 0 || dstHeight <= 0)
+        return false;
+
+    if (srcWidth == m_srcWidth && srcHeight == m_srcHeight && dstWidth == m_dstWidth && dstHeight == m_dstHeight)
+        return true;
+
+    m_srcWidth = srcWidth;
+    m_srcHeight = srcHeight;
+    m_dstWidth = dstWidth;
+    m_dstHeight = dstHeight;
+
+    BuildTaps(srcWidth, dstWidth, true);
+    BuildTaps(srcHeight, dstHeight, false);
+    PrepareBands();
+    return true;
+}
+
+void SoftwareScaler::SetThreadCount(int threads)
+{
+    if (threads <= 0)
+    {
+        threads = (int)std::thread::hardware_concurrency();
+    }
+    threads = (std::max)(1, (std::min)(MAX_THREADS, threads));
+
+    StopWorkers();
+    m_threadCount = threads;
+    m_bands.resize(threads);
+    PrepareBands();
+    StartWorkers(threads - 1);
+}
+
+void SoftwareScaler::BuildTaps(int srcSize, int dstSize, bool columns)
+{
+    const int one = 1 << WEIGHT_BITS;
+    double ratio = (double)srcSize / dstSize;
+
+    if (columns)
+        m_columnTaps.resize(dstSize);
+    else
+        m_rowTaps.resize(dstSize);
+
+    for (int i = 0; i < dstSize; i++)
+    {
+        // 像素中心对齐映射
+        double pos = (i + 0.5) * ratio - 0.5;
+        if (pos < 0.0)
+            pos = 0.0;
+
+        int index = (int)pos;
+        double frac = pos - index;
+
+        // 右/下边缘：改用 (size - 2, size - 1) 并把权重全部放在后者, 保证两个采样点始终相邻
+        if (index >= srcSize - 1)
+        {
+            index = (srcSize >= 2) ? srcSize - 2 : 0;
+            frac = (srcSize >= 2) ? 1.0 : 0.0;
+        }
+
+        int16_t w1 = (int16_t)lround(frac * one);
+        int16_t w0 = (int16_t)(one - w1);
+
+        if (columns)
+        {
+            m_columnTaps[i].index = index;
+            m_columnTaps[i].weight[0] = w0;
+            m_columnTaps[i].weight[1] = w1;
+        }
+        else
+        {
+            m_rowTaps[i].index = index;
+            m_rowTaps[i].weight[0] = w0;
+            m_rowTaps[i].weight[1] = w1;
+        }
+    }
+}
+
+void SoftwareScaler::PrepareBands()
+{
+    for (BandState& state : m_bands)
+    {
+        for (int slot = 0; slot < 2; slot++)
+        {
+            state.rows[slot].assign((size_t)m_dstWidth * 4, 0);
+            state.cachedRow[slot] = -1;
+        }
+    }
+}
+
+void SoftwareScaler::HorizontalPass(const uint8_t* srcRow, int16_t* out) const
+{
+    const int round = 1 << (WEIGHT_BITS - INTERMEDIATE_SHIFT - 1);
+    const int shift = WEIGHT_BITS - INTERMEDIATE_SHIFT;
+    int x = 0;
+
+    if (m_srcWidth >= 2)
+    {
+        const __m128i roundVec = _mm_set1_epi32(round);
+
+        // 每次输出两个像素：各自的左右像素对与 (w0, w1) 做乘加, 得到 4 个通道的加权和
+        for (; x + 2 <= m_dstWidth; x += 2)
+        {
+            const ColumnTap& t0 = m_columnTaps[x];
+            const ColumnTap& t1 = m_columnTaps[x + 1];
+
+            __m128i s0 = _mm_madd_epi16(LoadPixelPair(srcRow + t0.index * 4), _mm_set1_epi32(PackWeights(t0.weight)));
+            __m128i s1 = _mm_madd_epi16(LoadPixelPair(srcRow + t1.index * 4), _mm_set1_epi32(PackWeights(t1.weight)));
+            s0 = _mm_srai_epi32(_mm_add_epi32(s0, roundVec), shift);
+            s1 = _mm_srai_epi32(_mm_add_epi32(s1, roundVec), shift);
+
+            _mm_storeu_si128((__m128i*)(out + x * 4), _mm_packs_epi32(s0, s1));
+        }
+    }
+
+    // 尾部（以及宽度为 1 的源图像）使用标量实现
+    for (; x < m_dstWidth; x++)
+    {
+        const ColumnTap& t = m_columnTaps[x];
+        const uint8_t* p0 = srcRow + t.index * 4;
+        const uint8_t* p1 = (m_srcWidth >= 2) ? p0 + 4 : p0;
+        for (int c = 0; c < 4; c++)
+        {
+            out[x * 4 + c] = (int16_t)((p0[c] * t.weight[0] + p1[c] * t.weight[1] + round) >> shift);
+        }
+    }
+}
+
+void SoftwareScaler::VerticalPass(const int16_t* top, const int16_t* bottom, const int16_t weight[2], uint8_t* out) const
+{
+    const int shift = WEIGHT_BITS + INTERMEDIATE_SHIFT;
+    const int round = 1 << (shift - 1);
+    const int count = m_dstWidth * 4;
+    int i = 0;
+
+    const __m128i weights = _mm_set1_epi32(PackWeights(weight));
+    const __m128i roundVec = _mm_set1_epi32(round);
+
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i t = _mm_loadu_si128((const __m128i*)(top + i));
+        __m128i b = _mm_loadu_si128((const __m128i*)(bottom + i));
+
+        __m128i lo = _mm_madd_epi16(_mm_unpacklo_epi16(t, b), weights);
+        __m128i hi = _mm_madd_epi16(_mm_unpackhi_epi16(t, b), weights);
+        lo = _mm_srai_epi32(_mm_add_epi32(lo, roundVec), shift);
+        hi = _mm_srai_epi32(_mm_add_epi32(hi, roundVec), shift);
+
+        __m128i words = _mm_packs_epi32(lo, hi);
+        _mm_storel_epi64((__m128i*)(out + i), _mm_packus_epi16(words, words));
+    }
+
+    for (; i < count; i++)
+    {
+        int value = (top[i] * weight[0] + bottom[i] * weight[1] + round) >> shift;
+        out[i] = (uint8_t)(std::min)(255, (std::max)(0, value));
+    }
+}
+
+void SoftwareScaler::FetchRows(BandState& state, int topRow, int bottomRow, const int16_t*& top, const int16_t*& bottom)
+{
+    // 放大时相邻输出行共用源行, 两行缓存可以省去大部分水平计算
+    int topSlot = (state.cachedRow[0] == topRow) ? 0 : (state.cachedRow[1] == topRow) ? 1 : -1;
+    int bottomSlot = (state.cachedRow[0] == bottomRow) ? 0 : (state.cachedRow[1] == bottomRow) ? 1 : -1;
+
+    if (topSlot < 0)
+    {
+        topSlot = (bottomSlot == 0) ? 1 : 0;
+        HorizontalPass(m_src + (size_t)topRow * m_srcStride, state.rows[topSlot].data());
+        state.cachedRow[topSlot] = topRow;
+        if (bottomSlot < 0 && bottomRow == topRow)
+            bottomSlot = topSlot;
+    }
+    if (bottomSlot < 0)
+    {
+        bottomSlot = 1 - topSlot;
+        HorizontalPass(m_src + (size_t)bottomRow * m_srcStride, state.rows[bottomSlot].data());
+        state.cachedRow[bottomSlot] = bottomRow;
+    }
+
+    top = state.rows[topSlot].data();
+    bottom = state.rows[bottomSlot].data();
+}
+
+void SoftwareScaler::ScaleBand(int band, int rowBegin, int rowEnd)
+{
+    BandState& state = m_bands[band];
+
+    // 每帧源数据都可能变化, 缓存只在一次 Scale 内有效
+    state.cachedRow[0] = state.cachedRow[1] = -1;
+
+    for (int y = rowBegin; y < rowEnd; y++)
+    {
+        const RowTap& tap = m_rowTaps[y];
+        int bottomRow = (std::min)(tap.index + 1, m_srcHeight - 1);
+
+        const int16_t* top;
+        const int16_t* bottom;
+        FetchRows(state, tap.index, bottomRow, top, bottom);
+        VerticalPass(top, bottom, tap.weight, m_dst + (size_t)y * m_dstStride);
+    }
+}
+
+void SoftwareScaler::Scale(const uint8_t* src, int srcStride, uint8_t* dst, int dstStride)
+{
+    if (!src || !dst || m_dstWidth <= 0 || m_dstHeight <= 0)
+        return;
+
+    m_src = src;
+    m_srcStride = srcStride;
+    m_dst = dst;
+    m_dstStride = dstStride;
+
+    int bands = (std::min)(m_threadCount, (std::max)(1, m_dstHeight / MIN_ROWS_PER_BAND));
+    m_bandCount = bands;
+
+    if (bands > 1)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pending = bands - 1;
+        m_generation++;
+    }
+    if (bands > 1)
+    {
+        m_wake.notify_all();
+    }
+
+    // 调用线程处理第一个条带
+    ScaleBand(0, 0, m_dstHeight / bands);
+
+    if (bands > 1)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait(lock, [this] { return m_pending == 0; });
+    }
+}
+
+void SoftwareScaler::StartWorkers(int count)
+{
+    m_quit = false;
+    for (int i = 0; i < count; i++)
+    {
+        m_workers.emplace_back(&SoftwareScaler::WorkerProc, this, i + 1, m_generation);
+    }
+}
+
+void SoftwareScaler::StopWorkers()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
+    }
+    m_wake.notify_all();
+    for (std::thread& worker : m_workers)
+    {
+        worker.join();
+    }
+    m_workers.clear();
+}
+
+void SoftwareScaler::WorkerProc(int band, uint64_t seenGeneration)
+{
+    // 起始序号由创建线程传入: 若在线程运行后才读取, 期间提交的第一帧会被漏掉, Scale 将一直等待
+    while (true)
+    {
+        int bands;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [&] { return m_quit || m_generation != seenGeneration; });
+            if (m_quit)
+                return;
+            seenGeneration = m_generation;
+            bands = m_bandCount;
+        }
+
+        // 本次条带数少于线程数时, 多余的线程不参与
+        if (band >= bands)
+            continue;
+
+        ScaleBand(band, m_dstHeight * band / bands, m_dstHeight * (band + 1) / bands);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_pending--;
+        }
+        m_done.notify_one();
+    }
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// BGRA 双线性软件缩放器
+// 系数表在尺寸变化时预先计算（每列/每行的源索引和 14 位定点权重）,
+// 缩放分为水平、垂直两个可分离的 SSE2 处理阶段, 输出行按条带分配给常驻工作线程
+class SoftwareScaler {
+public:
+    SoftwareScaler();
+    ~SoftwareScaler();
+
+    // 设置源/目标尺寸, 尺寸未变化时不重建系数表
+    bool Configure(int srcWidth, int srcHeight, int dstWidth, int dstHeight);
+
+    // 工作线程数（包含调用线程）, 0 表示按 CPU 核心数自动选择
+    void SetThreadCount(int threads);
+
+    // 缩放一帧 BGRA 图像, 步长以字节为单位
+    void Scale(const uint8_t* src, int srcStride, uint8_t* dst, int dstStride);
+
+private:
+    // 权重定点精度：1.0 = 1 << WEIGHT_BITS
+    static const int WEIGHT_BITS = 14;
+    // 中间行精度：8 位样本左移 INTERMEDIATE_SHIFT 位后存为 int16
+    static const int INTERMEDIATE_SHIFT = 7;
+
+    struct ColumnTap {
+        int index;          // 左侧源像素, 右侧为 index + 1
+        int16_t weight[2];  // 左/右权重, 和为 1 << WEIGHT_BITS
+    };
+
+    struct RowTap {
+        int index;          // 上方源行, 下方为 min(index + 1, srcHeight - 1)
+        int16_t weight[2];
+    };
+
+    // 每个条带自己的中间行缓存（两行水平缩放结果）
+    struct BandState {
+        std::vector<int16_t> rows[2];
+        int cachedRow[2];
+    };
+
+    void BuildTaps(int srcSize, int dstSize, bool columns);
+    void PrepareBands();
+    void ScaleBand(int band, int rowBegin, int rowEnd);
+    void FetchRows(BandState& state, int topRow, int bottomRow, const int16_t*& top, const int16_t*& bottom);
+    void HorizontalPass(const uint8_t* srcRow, int16_t* out) const;
+    void VerticalPass(const int16_t* top, const int16_t* bottom, const int16_t weight[2], uint8_t* out) const;
+
+    void StartWorkers(int count);
+    void StopWorkers();
+    void WorkerProc(int band, uint64_t seenGeneration);
+
+    int m_srcWidth;
+    int m_srcHeight;
+    int m_dstWidth;
+    int m_dstHeight;
+    std::vector<ColumnTap> m_columnTaps;
+    std::vector<RowTap> m_rowTaps;
+    std::vector<BandState> m_bands;
+
+    // 当前任务
+    const uint8_t* m_src;
+    int m_srcStride;
+    uint8_t* m_dst;
+    int m_dstStride;
+    int m_bandCount;        // 本次使用的条带数
+
+    // 常驻工作线程：条带 0 由调用线程处理, 条带 i 由 m_workers[i - 1] 处理
+    int m_threadCount;
+    std::vector<std::thread> m_workers;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    uint64_t m_generation;
+    int m_pending;
+    bool m_quit;
+};
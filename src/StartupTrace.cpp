@@ -0,0 +1,222 @@
+#include "StartupTrace.h"
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+// 跟踪文件中所有事件使用同一个进程号
+static const int TRACE_PROCESS_ID = 1;
+
+static std::atomic<int> s_nextThreadId(1);
+static thread_local int t_threadId = 0;
+
+// 文件路径等名称中可能含有反斜杠和引号
+static std::string EscapeJson(const std::string& text)
+{
+    std::string escaped;
+    escaped.reserve(text.size());
+    for (char c : text)
+    {
+        switch (c)
+        {
+        case '"':  escaped += "\\\""; break;
+        case '\\': escaped += "\\\\"; break;
+        case '\n': escaped += "\\n"; break;
+        case '\r': escaped += "\\r"; break;
+        case '\t': escaped += "\\t"; break;
+        default:
+            if ((unsigned char)c < 0x20)
+            {
+                char buffer[8];
+                snprintf(buffer, sizeof(buffer), "\\u%04x", (unsigned char)c);
+                escaped += buffer;
+            }
+            else
+            {
+                escaped += c;
+            }
+            break;
+        }
+    }
+    return escaped;
+}
+
+StartupTrace& StartupTrace::Instance()
+{
+    static StartupTrace instance;
+    return instance;
+}
+
+StartupTrace::StartupTrace()
+    : m_origin(std::chrono::steady_clock::now())
+    , m_processEventCount(0)
+    , m_hasSession(false)
+    , m_recording(true)
+    , m_sessionStartMs(0.0)
+{
+}
+
+int StartupTrace::CurrentThreadId()
+{
+    if (t_threadId == 0)
+    {
+        t_threadId = s_nextThreadId++;
+    }
+    return t_threadId;
+}
+
+double StartupTrace::NowMs() const
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_origin).count();
+}
+
+void StartupTrace::BeginSession(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_hasSession)
+    {
+        m_processEventCount = m_events.size();
+        m_hasSession = true;
+    }
+
+    // 线程名称事件保留, 同一线程在后续打开中不会再次设置
+    std::vector<Event> kept(m_events.begin(), m_events.begin() + m_processEventCount);
+    for (size_t i = m_processEventCount; i < m_events.size(); i++)
+    {
+        if (m_events[i].phase == 'M')
+            kept.push_back(m_events[i]);
+    }
+    m_events.swap(kept);
+
+    m_sessionName = name;
+    m_sessionStartMs = NowMs();
+    m_recording = true;
+}
+
+bool StartupTrace::FinishSession(const std::string& path)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_recording || !m_hasSession)
+            return false;
+
+        Event event;
+        event.name = "time to first frame: " + m_sessionName;
+        event.phase = 'X';
+        event.startMs = m_sessionStartMs;
+        event.durationMs = NowMs() - m_sessionStartMs;
+        event.threadId = CurrentThreadId();
+        m_events.push_back(event);
+        m_recording = false;
+    }
+
+    if (!WriteJson(path))
+        return false;
+
+    std::cout << "Startup trace written to " << path << std::endl;
+    return true;
+}
+
+bool StartupTrace::IsRecording() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_recording;
+}
+
+void StartupTrace::AddEvent(const Event& event)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_recording || event.phase == 'M')
+    {
+        m_events.push_back(event);
+    }
+}
+
+void StartupTrace::Complete(const char* name, double startMs, double endMs)
+{
+    Event event;
+    event.name = name;
+    event.phase = 'X';
+    event.startMs = startMs;
+    event.durationMs = endMs - startMs;
+    event.threadId = CurrentThreadId();
+    AddEvent(event);
+}
+
+void StartupTrace::Instant(const char* name)
+{
+    Event event;
+    event.name = name;
+    event.phase = 'i';
+    event.startMs = NowMs();
+    event.durationMs = 0.0;
+    event.threadId = CurrentThreadId();
+    AddEvent(event);
+}
+
+void StartupTrace::SetThreadName(const char* name)
+{
+    int threadId = CurrentThreadId();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (Event& event : m_events)
+    {
+        if (event.phase == 'M' && event.threadId == threadId)
+        {
+            event.name = name;
+            return;
+        }
+    }
+
+    Event event;
+    event.name = name;
+    event.phase = 'M';
+    event.startMs = 0.0;
+    event.durationMs = 0.0;
+    event.threadId = threadId;
+    m_events.push_back(event);
+}
+
+bool StartupTrace::WriteJson(const std::string& path) const
+{
+    std::vector<Event> events;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        events = m_events;
+    }
+
+    std::ofstream out(path, std::ios::trunc);
+    if (!out)
+    {
+        std::cerr << "Failed to open startup trace file: " << path << std::endl;
+        return false;
+    }
+
+    // 时间单位为微秒
+    out << std::fixed << std::setprecision(3);
+    out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+    for (size_t i = 0; i < events.size(); i++)
+    {
+        const Event& event = events[i];
+        out << "  {\"pid\": " << TRACE_PROCESS_ID << ", \"tid\": " << event.threadId;
+        if (event.phase == 'M')
+        {
+            out << ", \"ph\": \"M\", \"name\": \"thread_name\", \"args\": {\"name\": \""
+                << EscapeJson(event.name) << "\"}}";
+        }
+        else
+        {
+            out << ", \"ph\": \"" << event.phase << "\", \"cat\": \"startup\", \"name\": \""
+                << EscapeJson(event.name) << "\", \"ts\": " << event.startMs * 1000.0;
+            if (event.phase == 'X')
+                out << ", \"dur\": " << event.durationMs * 1000.0;
+            else
+                out << ", \"s\": \"p\"";
+            out << "}";
+        }
+        out << (i + 1 < events.size() ? ",\n" : "\n");
+    }
+    out << "]}\n";
+    return (bool)out;
+}
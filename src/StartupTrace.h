@@ -0,0 +1,82 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// 启动过程跟踪 - 记录打开文件各阶段的起止时间, 导出为 Chrome trace event JSON（chrome://tracing 或 Perfetto 中打开）
+// 进程级单例：第一次打开文件之前记录的事件（进程启动阶段）保留在每一次导出中
+// 可在任意线程记录; 第一帧呈现并导出后停止记录, 直到下一次打开文件
+class StartupTrace {
+public:
+    static StartupTrace& Instance();
+
+    // 开始跟踪一次打开：丢弃上一次打开的事件, 保留进程启动阶段的事件
+    void BeginSession(const std::string& name);
+    // 记录从 BeginSession 到现在的总耗时并导出, 之后停止记录
+    bool FinishSession(const std::string& path);
+    bool IsRecording() const;
+
+    // 毫秒, 以第一次调用 Instance 的时间为零点
+    double NowMs() const;
+
+    // 已完成的阶段（起止时间由调用方测量）
+    void Complete(const char* name, double startMs, double endMs);
+    // 时间点事件（第一个数据包、第一帧解码完成等）
+    void Instant(const char* name);
+    // 在跟踪中显示的当前线程名称
+    void SetThreadName(const char* name);
+
+    bool WriteJson(const std::string& path) const;
+
+private:
+    struct Event {
+        std::string name;
+        char phase;             // 'X' 阶段, 'i' 时间点, 'M' 线程名
+        double startMs;
+        double durationMs;
+        int threadId;
+    };
+
+    StartupTrace();
+    StartupTrace(const StartupTrace&) = delete;
+    StartupTrace& operator=(const StartupTrace&) = delete;
+
+    static int CurrentThreadId();
+    void AddEvent(const Event& event);
+
+    std::chrono::steady_clock::time_point m_origin;
+
+    mutable std::mutex m_mutex;
+    std::vector<Event> m_events;
+    size_t m_processEventCount;     // 第一次打开之前记录的事件数（进程启动阶段）
+    bool m_hasSession;
+    bool m_recording;
+    std::string m_sessionName;
+    double m_sessionStartMs;
+};
+
+// 在作用域内计时一个阶段
+class StartupTraceScope {
+public:
+    explicit StartupTraceScope(const char* name)
+        : m_name(name)
+        , m_startMs(StartupTrace::Instance().NowMs())
+    {
+    }
+
+    ~StartupTraceScope()
+    {
+        StartupTrace& trace = StartupTrace::Instance();
+        trace.Complete(m_name, m_startMs, trace.NowMs());
+    }
+
+private:
+    StartupTraceScope(const StartupTraceScope&) = delete;
+    StartupTraceScope& operator=(const StartupTraceScope&) = delete;
+
+    const char* m_name;
+    double m_startMs;
+};
@@ -0,0 +1,180 @@
+#include "TimeStretcher.h"
+#include <cmath>
+#include <algorithm>
+
+TimeStretcher::TimeStretcher()
+    : m_sampleRate(0)
+    , m_speed(1.0)
+    , m_hopSize(0)
+    , m_windowSize(0)
+    , m_searchRange(0)
+    , m_inputStartPts(NAN)
+    , m_nominalPos(0.0)
+    , m_prevSegment(-1)
+{
+    Configure(44100);
+}
+
+void TimeStretcher::Configure(int sampleRate)
+{
+    m_sampleRate = sampleRate;
+
+    // 30ms 窗口, 50% 重叠, ±8ms 搜索范围
+    m_hopSize = sampleRate * 15 / 1000;
+    m_windowSize = m_hopSize * 2;
+    m_searchRange = sampleRate * 8 / 1000;
+
+    // 汉宁窗：50% 重叠时相邻窗口之和恒为 1
+    m_window.resize(m_windowSize);
+    for (int i = 0; i < m_windowSize; i++)
+    {
+        m_window[i] = (float)(0.5 - 0.5 * cos(2.0 * 3.14159265358979323846 * i / m_windowSize));
+    }
+
+    Reset();
+}
+
+void TimeStretcher::SetSpeed(double speed)
+{
+    speed = (std::max)(0.5, (std::min)(4.0, speed));
+    if (speed != m_speed)
+    {
+        m_speed = speed;
+        Reset();
+    }
+}
+
+void TimeStretcher::Reset()
+{
+    m_inLeft.clear();
+    m_inRight.clear();
+    m_overlapLeft.assign(m_hopSize, 0.0f);
+    m_overlapRight.assign(m_hopSize, 0.0f);
+    m_inputStartPts = NAN;
+    m_nominalPos = 0.0;
+    m_prevSegment = -1;
+}
+
+int TimeStretcher::FindBestOffset(int searchStart, int searchEnd, int reference) const
+{
+    // 归一化互相关（左右声道混合后比较）
+    auto score = [&](int candidate) {
+        double corr = 0.0, energy = 1e-9;
+        for (int i = 0; i < m_hopSize; i++)
+        {
+            float c = m_inLeft[candidate + i] + m_inRight[candidate + i];
+            float r = m_inLeft[reference + i] + m_inRight[reference + i];
+            corr += c * r;
+            energy += c * c;
+        }
+        return corr / sqrt(energy);
+    };
+
+    // 先以 4 个样本为步长粗搜, 再在最优点附近逐样本精搜
+    int best = searchStart;
+    double bestScore = -1e30;
+    for (int k = searchStart; k <= searchEnd; k += 4)
+    {
+        double s = score(k);
+        if (s > bestScore)
+        {
+            bestScore = s;
+            best = k;
+        }
+    }
+
+    int fineStart = (std::max)(searchStart, best - 3);
+    int fineEnd = (std::min)(searchEnd, best + 3);
+    for (int k = fineStart; k <= fineEnd; k++)
+    {
+        double s = score(k);
+        if (s > bestScore)
+        {
+            bestScore = s;
+            best = k;
+        }
+    }
+
+    return best;
+}
+
+int TimeStretcher::Process(const float* left, const float* right, int frames, double pts, double& outPts)
+{
+    outPts = NAN;
+    m_outLeft.clear();
+    m_outRight.clear();
+
+    // 缓冲区为空时以本次输入的时间戳作为起点
+    if (m_inLeft.empty())
+    {
+        m_inputStartPts = pts;
+    }
+
+    if (!right)
+    {
+        right = left;
+    }
+    m_inLeft.insert(m_inLeft.end(), left, left + frames);
+    m_inRight.insert(m_inRight.end(), right, right + frames);
+
+    int inputSize = (int)m_inLeft.size();
+
+    while (true)
+    {
+        int nominal = (int)m_nominalPos;
+        int searchStart = (std::max)(0, nominal - m_searchRange);
+        int searchEnd = nominal + m_searchRange;
+        if (searchEnd + m_windowSize > inputSize)
+            break;
+
+        // 第一段直接使用名义位置, 之后搜索与上一段自然延续最相似的位置
+        int segment = nominal;
+        if (m_prevSegment >= 0)
+        {
+            segment = FindBestOffset(searchStart, searchEnd, m_prevSegment + m_hopSize);
+        }
+
+        if (std::isnan(outPts) && !std::isnan(m_inputStartPts))
+        {
+            outPts = m_inputStartPts + (double)segment / m_sampleRate;
+        }
+
+        // 重叠相加：前半窗与上一段的尾部相加输出, 后半窗保存为新的尾部
+        for (int i = 0; i < m_hopSize; i++)
+        {
+            m_outLeft.push_back(m_overlapLeft[i] + m_inLeft[segment + i] * m_window[i]);
+            m_outRight.push_back(m_overlapRight[i] + m_inRight[segment + i] * m_window[i]);
+            m_overlapLeft[i] = m_inLeft[segment + m_hopSize + i] * m_window[m_hopSize + i];
+            m_overlapRight[i] = m_inRight[segment + m_hopSize + i] * m_window[m_hopSize + i];
+        }
+
+        m_prevSegment = segment;
+        m_nominalPos += m_hopSize * m_speed;
+    }
+
+    // 丢弃不再需要的输入（搜索窗口和自然延续都不会再访问）
+    // 保留上一段的起点, 使 m_prevSegment 不会变为负数被当作尚未输出: 高倍速时名义位置远超自然延续,
+    // 若丢弃到 m_prevSegment + m_hopSize, 下一段会跳过相似度搜索直接取名义位置, 造成相位断裂和音调偏移
+    int discard = (int)m_nominalPos - m_searchRange;
+    if (m_prevSegment >= 0)
+    {
+        discard = (std::min)(discard, m_prevSegment);
+    }
+    discard = (std::min)(discard, inputSize);
+    if (discard > 0)
+    {
+        m_inLeft.erase(m_inLeft.begin(), m_inLeft.begin() + discard);
+        m_inRight.erase(m_inRight.begin(), m_inRight.begin() + discard);
+        m_nominalPos -= discard;
+        if (m_prevSegment >= 0)
+        {
+            m_prevSegment -= discard;
+        }
+        if (!std::isnan(m_inputStartPts))
+        {
+            m_inputStartPts += (double)discard / m_sampleRate;
+        }
+    }
+
+    return (int)m_outLeft.size();
+}
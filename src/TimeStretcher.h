@@ -0,0 +1,49 @@
+#pragma once
+
+#include <vector>
+
+// WSOLA (Waveform Similarity Overlap-Add) 变速不变调处理器
+// 输入输出均为平面格式立体声 float 样本, 采样率不变, 输出时长 = 输入时长 / speed
+// 每次合成一个跳跃 (hop) 时, 在名义分析位置附近搜索与上一段"自然延续"最相似的
+// 输入片段, 再用汉宁窗重叠相加, 避免相位断裂造成的咔嗒声
+class TimeStretcher {
+public:
+    TimeStretcher();
+
+    void Configure(int sampleRate);
+
+    // 设置速度 (0.5 - 4.0), 速度改变时重置内部状态
+    void SetSpeed(double speed);
+    double GetSpeed() const { return m_speed; }
+
+    // 丢弃缓存的输入和重叠尾部（跳转时调用）
+    void Reset();
+
+    // 处理一段输入, right 为空时按单声道处理; pts 为首个输入样本的媒体时间（NAN 表示连续）
+    // 返回本次产生的输出帧数, outPts 为首个输出样本对应的媒体时间
+    int Process(const float* left, const float* right, int frames, double pts, double& outPts);
+
+    const float* OutputLeft() const { return m_outLeft.data(); }
+    const float* OutputRight() const { return m_outRight.data(); }
+
+private:
+    int FindBestOffset(int searchStart, int searchEnd, int reference) const;
+
+    int m_sampleRate;
+    double m_speed;
+    int m_hopSize;          // 合成跳跃长度（窗口长度的一半）
+    int m_windowSize;       // 窗口长度
+    int m_searchRange;      // 相似度搜索范围（单侧）
+
+    std::vector<float> m_window;
+    std::vector<float> m_inLeft;
+    std::vector<float> m_inRight;
+    std::vector<float> m_overlapLeft;
+    std::vector<float> m_overlapRight;
+    std::vector<float> m_outLeft;
+    std::vector<float> m_outRight;
+
+    double m_inputStartPts;     // m_inLeft[0] 对应的媒体时间
+    double m_nominalPos;        // 下一个分析帧的名义位置（相对输入缓冲区起点）
+    int m_prevSegment;          // 上一个选中片段的起点, -1 表示尚未输出
+};
@@ -1,6 +1,77 @@
 #include "VideoPlayer.h"
+#include "StartupTrace.h"
+#include "PlayerMetrics.h"
 #include <iostream>
 #include <algorithm>
+#include <cmath>
+
+const double VideoPlayer::KEYFRAME_ONLY_SPEED = 2.0;
+const double VideoPlayer::RESIZE_DEBOUNCE_MS = 80.0;
+const size_t VideoPlayer::DEFAULT_READ_AHEAD = 64 * 1024 * 1024;
+const int64_t VideoPlayer::FAST_PROBE_SIZE = 512 * 1024;
+const int64_t VideoPlayer::FAST_ANALYZE_DURATION = 500000;     // 微秒
+const size_t VideoPlayer::MAX_STARTUP_PACKETS = 256;
+const size_t VideoPlayer::DEGRADED_STARTUP_PACKETS = 32;
+const size_t VideoPlayer::MIN_BUDGETED_READ_AHEAD = 1024 * 1024;
+const double VideoPlayer::OPEN_PROGRESS_INTERVAL_MS = 100.0;
+
+// 每次打开文件的启动跟踪, 第一帧呈现时写入当前目录
+static const char* STARTUP_TRACE_PATH = "startup_trace.json";
+
+static double QpcNowMs()
+{
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart * 1000.0 / frequency.QuadPart;
+}
+
+static double StreamFrameRate(const AVStream* stream)
+{
+    AVRational frameRate = stream->r_frame_rate;
+    if (frameRate.num > 0 && frameRate.den > 0)
+    {
+        return (double)frameRate.num / frameRate.den;
+    }
+    
+    // 如果没有帧率信息，使用时间基准来估算
+    double estimated = 1.0 / av_q2d(stream->time_base);
+    if (estimated > 60.0 || estimated < 1.0)
+    {
+        estimated = 25.0; // 默认值
+    }
+    return estimated;
+}
+
+// 帧的 YUV 颜色空间和范围（取自帧本身, 播放列表中相邻文件可以不同）
+// 未标注颜色空间时按分辨率推断（高清默认 BT.709）, yuvj 格式为全范围
+static void DetectYuvColor(const AVFrame* frame, YuvColorSpace& colorSpace, bool& fullRange)
+{
+    AVPixelFormat format = (AVPixelFormat)frame->format;
+    bool hd = frame->colorspace == AVCOL_SPC_BT709 || (frame->colorspace == AVCOL_SPC_UNSPECIFIED && frame->height >= 720);
+    colorSpace = hd ? YuvColorSpace::BT709 : YuvColorSpace::BT601;
+    fullRange = frame->color_range == AVCOL_RANGE_JPEG ||
+                format == AV_PIX_FMT_YUVJ420P || format == AV_PIX_FMT_YUVJ422P || format == AV_PIX_FMT_YUVJ444P;
+}
+
+// 让 sws 的 YUV → RGB 系数与纹理路径的着色器矩阵一致; 系数已相同时不重新设置（设置会重建查找表）
+static void ApplySwsColorDetails(SwsContext* context, const AVFrame* frame)
+{
+    int* invTable;
+    int* table;
+    int srcRange, dstRange, brightness, contrast, saturation;
+    if (sws_getColorspaceDetails(context, &invTable, &srcRange, &table, &dstRange, &brightness, &contrast, &saturation) < 0)
+        return;     // 源不是 YUV
+    
+    YuvColorSpace colorSpace;
+    bool fullRange;
+    DetectYuvColor(frame, colorSpace, fullRange);
+    const int* coefficients = sws_getCoefficients(colorSpace == YuvColorSpace::BT709 ? SWS_CS_ITU709 : SWS_CS_ITU601);
+    int range = fullRange ? 1 : 0;
+    if (srcRange == range && memcmp(invTable, coefficients, 4 * sizeof(int)) == 0)
+        return;
+    sws_setColorspaceDetails(context, coefficients, range, table, dstRange, brightness, contrast, saturation);
+}
 
 VideoPlayer::VideoPlayer()
     : m_formatContext(nullptr)
@@ -10,27 +81,90 @@ VideoPlayer::VideoPlayer()
     , m_frameRGB(nullptr)
     , m_packet(nullptr)
     , m_swsContext(nullptr)
+    , m_presentSwsContext(nullptr)
     , m_videoStreamIndex(-1)
     , m_duration(0.0)
     , m_currentTime(0.0)
     , m_frameRate(25.0)  // 默认帧率
     , m_isPlaying(false)
     , m_isPaused(false)
+    , m_playbackSpeed(1.0)
+    , m_keyframeOnly(false)
+    , m_waitForKeyframe(false)
+    , m_videoVisible(true)
+    , m_videoTrackEnabled(true)
+    , m_audioOnly(false)
     , m_hwnd(nullptr)
-    , m_hdcMem(nullptr)
-    , m_hBitmap(nullptr)
     , m_useD3D9(true)  // 默认使用 D3D9
+    , m_yuvSupported(false)
+    , m_yuvTexturesActive(false)
+    , m_chromaShiftX(1)
+    , m_chromaShiftY(1)
+    , m_yuvTexturesStale(true)
+    , m_resizePending(false)
+    , m_pendingWidth(0)
+    , m_pendingHeight(0)
+    , m_resizeEventCount(0)
+    , m_resizeRequestTime(0.0)
+    , m_resizeResetTime(0.0)
     , m_windowWidth(0)
     , m_windowHeight(0)
     , m_videoWidth(0)
     , m_videoHeight(0)
-    , m_buffer(nullptr)
+    , m_filterBuffer(nullptr)
+    , m_filterCharge(MemoryCategory::CONVERTED_FRAMES)
+    , m_outputFrame(nullptr)
+    , m_outputFromYuv(false)
+    , m_rgbFormat(AV_PIX_FMT_BGRA)
+    , m_rgbBytesPerPixel(4)
+    , m_rgbStrideAlign(4)
+    , m_convertSize(0)
+    , m_filterVersion(0)
+    , m_outputFilterVersion(0)
+    , m_outputSerial(0)
+    , m_surfaceSerial(0)
+    , m_decodedFrames(0)
+    , m_filterPasses(0)
+    , m_frameUploads(0)
+    , m_presents(0)
+    , m_timingPending(false)
     , m_playThread(nullptr)
     , m_renderEvent(nullptr)    , m_shouldStop(false)
     , m_scalingMode(ScalingMode::FIT_TO_WINDOW)  // 默认适应窗口
     , m_currentFilter(FilterType::NONE)         // 默认无滤镜
     , m_mosaicSize(8)                          // 马赛克块大小
     , m_audioOffset(0.0)                       // 音频偏移初始化
+    , m_openThread(nullptr)
+    , m_openCancel(false)
+    , m_openAsync(false)
+    , m_openSucceeded(false)
+    , m_openStage((int)OpenStage::OPENING_INPUT)
+    , m_openProgressMs(0.0)
+    , m_openStartMs(0.0)
+    , m_inputOpenedMs(0.0)
+    , m_streamInfoMs(0.0)
+    , m_firstDecodeMs(0.0)
+    , m_deviceReadyMs(0.0)
+    , m_firstFramePending(false)
+    , m_hasStartupFrame(false)
+    , m_nextThread(nullptr)
+    , m_nextCancel(false)
+    , m_nextState(NEXT_NONE)
+    , m_loopEnabled(false)
+    , m_loopStart(0.0)
+    , m_loopEnd(0.0)
+    , m_loopVersion(0)
+    , m_loopAppliedVersion(0)
+    , m_loopActive(false)
+    , m_loopActiveStart(0.0)
+    , m_loopActiveEnd(0.0)
+    , m_loopSkipUntil(NAN)
+    , m_loopThread(nullptr)
+    , m_loopCancel(false)
+    , m_loopState(NEXT_NONE)
+    , m_seekRequest(NAN)
+    , m_inputMode(MediaInputMode::AUTO)
+    , m_readAhead(DEFAULT_READ_AHEAD)
 {
     // 初始化 FFmpeg
     av_log_set_level(AV_LOG_QUIET);
@@ -38,6 +172,14 @@ VideoPlayer::VideoPlayer()
     // 初始化 D3D9 表面描述
     memset(&m_d3d9SurfaceDesc, 0, sizeof(m_d3d9SurfaceDesc));
     memset(&m_d3dpp, 0, sizeof(m_d3dpp));
+    memset(&m_outputInfo, 0, sizeof(m_outputInfo));
+    memset(&m_pendingTiming, 0, sizeof(m_pendingTiming));
+    memset(m_yuvTimings, 0, sizeof(m_yuvTimings));
+    for (int i = 0; i < TripleBuffer::SLOTS; i++)
+    {
+        m_yuvFrames[i] = nullptr;
+        m_dibSections[i] = nullptr;
+    }
     
     // 创建渲染事件
     m_renderEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
@@ -45,7 +187,9 @@ VideoPlayer::VideoPlayer()
 
 VideoPlayer::~VideoPlayer()
 {
+    CancelOpen();
     Stop();
+    CancelNext();
     CleanupFFmpeg();
     CleanupGDI();
     CleanupD3D9();
@@ -58,15 +202,15 @@ VideoPlayer::~VideoPlayer()
 
 bool VideoPlayer::Initialize(HWND hwnd, const std::string& videoPath)
 {
+    CancelOpen();
     m_hwnd = hwnd;
+    m_openStartMs = QpcNowMs();
+    StartupTrace::Instance().SetThreadName("UI thread");
+    StartupTrace::Instance().BeginSession(videoPath);
     
-    // 获取窗口尺寸
-    RECT rect;
-    GetClientRect(hwnd, &rect);
-    m_windowWidth = rect.right - rect.left;
-    m_windowHeight = rect.bottom - rect.top;
-    
-    // 清理之前的渲染资源（关键修复）
+    // 清理之前的渲染资源（关键修复）; 音频设备保留, 只释放上一个文件的音频解码器
+    CancelNext();
+    m_audioPlayer.Close();
     CleanupD3D9();
     CleanupGDI();
     
@@ -76,17 +220,549 @@ bool VideoPlayer::Initialize(HWND hwnd, const std::string& videoPath)
         return false;
     }
     
+    return SetupRenderer();
+}
+
+bool VideoPlayer::BeginOpen(HWND hwnd, const std::string& videoPath)
+{
+    CancelOpen();
+    m_hwnd = hwnd;
+    m_openStartMs = QpcNowMs();
+    StartupTrace::Instance().SetThreadName("UI thread");
+    StartupTrace::Instance().BeginSession(videoPath);
+    
+    // 渲染资源在 UI 线程释放, 打开线程只访问 FFmpeg 状态; 音频设备保留, 只释放上一个文件的音频解码器
+    CancelNext();
+    m_audioPlayer.Close();
+    CleanupD3D9();
+    CleanupGDI();
+    CleanupFFmpeg();
+    
+    m_openPath = videoPath;
+    m_openCancel = false;
+    m_openAsync = true;
+    m_openSucceeded = false;
+    m_openProgressMs = 0.0;
+    m_openThread = CreateThread(nullptr, 0, OpenThreadProc, this, 0, nullptr);
+    if (!m_openThread)
+    {
+        m_openAsync = false;
+        return false;
+    }
+    return true;
+}
+
+DWORD WINAPI VideoPlayer::OpenThreadProc(LPVOID lpParam)
+{
+    VideoPlayer* player = static_cast<VideoPlayer*>(lpParam);
+    StartupTrace::Instance().SetThreadName("open thread");
+    player->m_openSucceeded = player->OpenVideo(player->m_openPath);
+    PostMessage(player->m_hwnd, WM_VIDEO_OPENED, player->m_openSucceeded ? 1 : 0, 0);
+    return 0;
+}
+
+bool VideoPlayer::FinishOpen()
+{
+    if (!m_openThread)
+        return false;
+    
+    WaitForSingleObject(m_openThread, INFINITE);
+    CloseHandle(m_openThread);
+    m_openThread = nullptr;
+    m_openAsync = false;
+    
+    if (!m_openSucceeded)
+    {
+        CleanupFFmpeg();
+        return false;
+    }
+    return SetupRenderer();
+}
+
+void VideoPlayer::CancelOpen()
+{
+    if (!m_openThread)
+        return;
+    
+    m_openCancel = true;
+    WaitForSingleObject(m_openThread, INFINITE);
+    CloseHandle(m_openThread);
+    m_openThread = nullptr;
+    m_openAsync = false;
+    
+    // 线程已结束, 它投递的消息都已在队列中, 一并移除以免被当作下一次打开的结果
+    MSG msg;
+    while (PeekMessage(&msg, m_hwnd, WM_VIDEO_OPENED, WM_VIDEO_OPEN_PROGRESS, PM_REMOVE))
+    {
+    }
+    
+    CleanupFFmpeg();
+    m_openCancel = false;
+    std::cout << "Open cancelled after " << QpcNowMs() - m_openStartMs << " ms" << std::endl;
+}
+
+int VideoPlayer::OpenInterruptCallback(void* opaque)
+{
+    VideoPlayer* player = static_cast<VideoPlayer*>(opaque);
+    if (player->m_openCancel)
+        return 1;
+    
+    player->PostOpenProgress((OpenStage)player->m_openStage.load(), false);
+    return 0;
+}
+
+void VideoPlayer::PostOpenProgress(OpenStage stage, bool force)
+{
+    // 只在异步打开期间汇报（回调在播放期间仍会被调用）
+    if (!m_openAsync)
+        return;
+    
+    double now = QpcNowMs();
+    if (!force && now - m_openProgressMs < OPEN_PROGRESS_INTERVAL_MS)
+        return;
+    m_openProgressMs = now;
+    m_openStage = (int)stage;
+    
+    int64_t bytes = (m_formatContext && m_formatContext->pb) ? m_formatContext->pb->pos : 0;
+    PostMessage(m_hwnd, WM_VIDEO_OPEN_PROGRESS, (WPARAM)stage, (LPARAM)(bytes / 1024));
+}
+
+VideoPlayer::PreparedMedia::PreparedMedia()
+    : formatContext(nullptr)
+    , codecContext(nullptr)
+    , packet(nullptr)
+    , frame(nullptr)
+    , hasFrame(false)
+    , videoStreamIndex(-1)
+    , frameRate(25.0)
+    , duration(0.0)
+{
+}
+
+void VideoPlayer::SetNextFile(const std::string& path)
+{
+    CancelNext();
+    if (path.empty())
+        return;
+    
+    // 预先打开要再占用一套解码器和帧缓冲区; 超出内存预算时放弃, 读完后由 UI 线程重新打开
+    if (MemoryBudget::Instance().IsOverBudget())
+    {
+        MemoryBudget::Instance().RecordDegradation();
+        std::cout << "Memory budget exceeded, not preparing next file: " << path << std::endl;
+        return;
+    }
+    
+    m_next.path = path;
+    m_nextState = NEXT_PREPARING;
+    m_nextThread = CreateThread(nullptr, 0, PrepareThreadProc, this, 0, nullptr);
+    if (!m_nextThread)
+    {
+        m_nextState = NEXT_NONE;
+    }
+}
+
+void VideoPlayer::CancelNext()
+{
+    if (m_nextThread)
+    {
+        m_nextCancel = true;
+        WaitForSingleObject(m_nextThread, INFINITE);
+        CloseHandle(m_nextThread);
+        m_nextThread = nullptr;
+    }
+    
+    std::lock_guard<std::mutex> lock(m_nextMutex);
+    ReleaseMedia(m_next);
+    m_next.path.clear();
+    m_nextState = NEXT_NONE;
+    m_nextCancel = false;
+}
+
+DWORD WINAPI VideoPlayer::PrepareThreadProc(LPVOID lpParam)
+{
+    VideoPlayer* player = static_cast<VideoPlayer*>(lpParam);
+    double startMs = QpcNowMs();
+    bool prepared = player->PrepareMedia(player->m_next);
+    if (!prepared)
+    {
+        ReleaseMedia(player->m_next);
+        if (!player->m_nextCancel)
+        {
+            std::cerr << "Failed to prepare next file: " << player->m_next.path << std::endl;
+        }
+    }
+    else
+    {
+        std::cout << "Prepared next file in " << QpcNowMs() - startMs << " ms: " << player->m_next.path << std::endl;
+    }
+    player->m_nextState = prepared ? NEXT_READY : NEXT_FAILED;
+    return 0;
+}
+
+int VideoPlayer::CancelInterruptCallback(void* opaque)
+{
+    const std::atomic<bool>* cancel = static_cast<const std::atomic<bool>*>(opaque);
+    return *cancel ? 1 : 0;
+}
+
+bool VideoPlayer::OpenMedia(PreparedMedia& media, const std::atomic<bool>& cancel)
+{
+    // 与 OpenVideo 相同的打开流程, 但结果放在独立的上下文中, 不影响正在播放的文件
+    media.formatContext = avformat_alloc_context();
+    if (!media.formatContext)
+        return false;
+    media.formatContext->interrupt_callback.callback = CancelInterruptCallback;
+    media.formatContext->interrupt_callback.opaque = const_cast<std::atomic<bool>*>(&cancel);
+    
+    if (MediaIO::OpenInput(&media.formatContext, media.path, m_inputMode, BudgetedReadAhead()) != 0)
+        return false;
+    
+    if (!ProbeStreams(media.formatContext, media.videoStreamIndex, cancel))
+        return false;
+    
+    AVStream* stream = media.formatContext->streams[media.videoStreamIndex];
+    const AVCodec* codec = avcodec_find_decoder(stream->codecpar->codec_id);
+    if (!codec)
+        return false;
+    
+    media.codecContext = avcodec_alloc_context3(codec);
+    if (!media.codecContext)
+        return false;
+    FramePool::Install(media.codecContext);
+    if (avcodec_parameters_to_context(media.codecContext, stream->codecpar) < 0)
+        return false;
+    if (avcodec_open2(media.codecContext, codec, nullptr) < 0)
+        return false;
+    
+    media.frameRate = StreamFrameRate(stream);
+    media.duration = media.formatContext->duration != AV_NOPTS_VALUE ?
+                     (double)media.formatContext->duration / AV_TIME_BASE : 0.0;
+    
+    media.packet = av_packet_alloc();
+    media.frame = av_frame_alloc();
+    return media.packet && media.frame && !cancel;
+}
+
+bool VideoPlayer::PrepareMedia(PreparedMedia& media)
+{
+    if (!OpenMedia(media, m_nextCancel))
+        return false;
+    
+    // 预先解出第一帧; 期间读到的音频包在换入后最先送入音频解码器, 紧接着上一个文件的音频填充环形缓冲区
+    media.hasFrame = ReadFirstVideoFrame(media.formatContext, media.codecContext, media.videoStreamIndex,
+                                         media.packet, media.frame, media.audioPackets, m_nextCancel);
+    return !m_nextCancel;
+}
+
+bool VideoPlayer::SeekMedia(PreparedMedia& media, double seconds, const std::atomic<bool>& cancel)
+{
+    ClearPacketQueue(media.audioPackets);
+    media.hasFrame = false;
+    
+    // 换出的上下文可能带着仅关键帧或纯音频模式的丢弃设置
+    AVStream* stream = media.formatContext->streams[media.videoStreamIndex];
+    stream->discard = AVDISCARD_DEFAULT;
+    media.codecContext->skip_frame = AVDISCARD_DEFAULT;
+    
+    AVRational timeBase = stream->time_base;
+    int64_t target = av_rescale_q((int64_t)(seconds * AV_TIME_BASE), AV_TIME_BASE_Q, timeBase);
+    if (av_seek_frame(media.formatContext, media.videoStreamIndex, target, AVSEEK_FLAG_BACKWARD) < 0)
+        return false;
+    avcodec_flush_buffers(media.codecContext);
+    
+    // 从关键帧一直解码到目标位置, 之前的帧只作为参考帧, 不显示
+    // 目标之前的音频包丢弃, 之后的留给换入后的播放线程
+    double halfFrame = 0.5 / media.frameRate;
+    AVPacket* packet = media.packet;
+    while (!cancel && av_read_frame(media.formatContext, packet) >= 0)
+    {
+        int streamIndex = packet->stream_index;
+        if (streamIndex == media.videoStreamIndex)
+        {
+            if (avcodec_send_packet(media.codecContext, packet) == 0)
+            {
+                while (avcodec_receive_frame(media.codecContext, media.frame) == 0)
+                {
+                    int64_t pts = media.frame->best_effort_timestamp;
+                    if (pts == AV_NOPTS_VALUE || pts * av_q2d(timeBase) >= seconds - halfFrame)
+                    {
+                        media.hasFrame = true;
+                        break;
+                    }
+                }
+            }
+        }
+        else if (media.formatContext->streams[streamIndex]->codecpar->codec_type == AVMEDIA_TYPE_AUDIO &&
+                 packet->pts != AV_NOPTS_VALUE &&
+                 packet->pts * av_q2d(media.formatContext->streams[streamIndex]->time_base) >= seconds)
+        {
+            QueueAudioPacket(media.audioPackets, packet);
+        }
+        av_packet_unref(packet);
+        
+        if (media.hasFrame)
+            return true;
+    }
+    return false;
+}
+
+void VideoPlayer::ReleaseMedia(PreparedMedia& media)
+{
+    ClearPacketQueue(media.audioPackets);
+    
+    av_frame_free(&media.frame);
+    av_packet_free(&media.packet);
+    FramePool::FreeContext(&media.codecContext);
+    MediaIO::CloseInput(&media.formatContext);
+    media.hasFrame = false;
+    media.videoStreamIndex = -1;
+}
+
+bool VideoPlayer::SwitchToNext()
+{
+    // 下一个文件仍在准备时等待, 仍比读完后重新打开快
+    while (m_nextState == NEXT_PREPARING && !m_shouldStop)
+    {
+        Sleep(5);
+    }
+    
+    PreparedMedia media;
+    {
+        std::lock_guard<std::mutex> lock(m_nextMutex);
+        if (m_nextState != NEXT_READY)
+            return false;
+        
+        // 邮箱缓冲区、SwsContext 和 YUV 纹理按当前视频的尺寸和格式创建, 不同时由 UI 线程重新打开
+        if (m_next.codecContext->width != m_videoWidth || m_next.codecContext->height != m_videoHeight ||
+            m_next.codecContext->pix_fmt != m_codecContext->pix_fmt)
+        {
+            std::cout << "Next file has a different video format, reopening: " << m_next.path << std::endl;
+            return false;
+        }
+        
+        std::swap(media, m_next);
+        m_nextState = NEXT_NONE;
+    }
+    
+    // 换入新文件的上下文, 旧文件的上下文随 media 一起释放（已提交的帧各自持有引用, 不受影响）
+    AdoptMedia(media);
+    ReleaseMedia(media);
+    
+    // 换成新文件的音频解码器; 设备和环形缓冲区保持不变, 上一个文件已排队的音频继续播放
+    // 设备尚未创建（上一个文件没有音频）时不在播放线程中初始化 COM 和设备, 新文件静音播放
+    if (m_audioPlayer.IsDeviceReady())
+    {
+        m_audioPlayer.Initialize(m_formatContext);
+    }
+    
+    std::cout << "Switched to next file: " << m_currentPath << std::endl;
+    PostMessage(m_hwnd, WM_VIDEO_NEXT_STARTED, 0, 0);
+    return true;
+}
+
+void VideoPlayer::AdoptMedia(PreparedMedia& media)
+{
+    {
+        // 换出的上下文随后在播放线程中释放, UI 线程只在持有锁时读取当前上下文
+        std::lock_guard<std::mutex> lock(m_mediaMutex);
+        std::swap(m_formatContext, media.formatContext);
+        std::swap(m_codecContext, media.codecContext);
+        std::swap(m_frame, media.frame);
+        std::swap(m_videoStreamIndex, media.videoStreamIndex);
+        std::swap(m_frameRate, media.frameRate);
+        std::swap(m_duration, media.duration);
+        std::swap(m_currentPath, media.path);
+    }
+    m_codec = m_codecContext->codec;
+    m_formatContext->interrupt_callback.callback = OpenInterruptCallback;
+    m_formatContext->interrupt_callback.opaque = this;
+    
+    ClearStartupPackets();
+    m_startupPackets.swap(media.audioPackets);
+    m_hasStartupFrame = media.hasFrame;
+    media.hasFrame = false;
+    m_currentTime = 0.0;
+    if (m_hasStartupFrame && m_frame->best_effort_timestamp != AV_NOPTS_VALUE)
+    {
+        m_currentTime = m_frame->best_effort_timestamp * av_q2d(m_formatContext->streams[m_videoStreamIndex]->time_base);
+    }
+    
+    UpdateVideoDiscard();
+    m_waitForKeyframe = false;
+    m_loopSkipUntil = NAN;
+}
+
+void VideoPlayer::SetLoop(bool enabled, double start, double end)
+{
+    m_loopStart = (std::max)(0.0, start);
+    m_loopEnd = end;
+    m_loopEnabled = enabled;
+    m_loopVersion++;
+}
+
+void VideoPlayer::UpdateLoop()
+{
+    m_loopAppliedVersion = m_loopVersion;
+    CancelLoopHead();
+    
+    m_loopActive = m_loopEnabled;
+    m_loopActiveStart = m_loopStart;
+    m_loopActiveEnd = m_loopEnd;
+    
+    // 没有终点时在文件结束处循环, 音频不截断
+    bool hasEnd = m_loopActive && m_loopActiveEnd > m_loopActiveStart;
+    m_audioPlayer.SetLoopEnd(hasEnd ? m_loopActiveEnd : NAN);
+    
+    if (m_loopActive)
+    {
+        StartLoopHead();
+    }
+}
+
+bool VideoPlayer::LoopEndReached(double mediaTime) const
+{
+    return m_loopActive && m_loopActiveEnd > m_loopActiveStart && mediaTime >= m_loopActiveEnd;
+}
+
+void VideoPlayer::StartLoopHead()
+{
+    if (!m_loopHead.formatContext)
+    {
+        // 第一次准备要重新打开文件; 超出内存预算时不准备, 循环点上退回到跳转
+        if (MemoryBudget::Instance().IsOverBudget())
+        {
+            MemoryBudget::Instance().RecordDegradation();
+            m_loopState = NEXT_FAILED;
+            return;
+        }
+        m_loopHead.path = m_currentPath;
+    }
+    
+    m_loopState = NEXT_PREPARING;
+    m_loopThread = CreateThread(nullptr, 0, LoopThreadProc, this, 0, nullptr);
+    if (!m_loopThread)
+    {
+        m_loopState = NEXT_FAILED;
+    }
+}
+
+void VideoPlayer::CancelLoopHead()
+{
+    if (m_loopThread)
+    {
+        m_loopCancel = true;
+        WaitForSingleObject(m_loopThread, INFINITE);
+        CloseHandle(m_loopThread);
+        m_loopThread = nullptr;
+    }
+    
+    ReleaseMedia(m_loopHead);
+    m_loopHead.path.clear();
+    m_loopState = NEXT_NONE;
+    m_loopCancel = false;
+}
+
+DWORD WINAPI VideoPlayer::LoopThreadProc(LPVOID lpParam)
+{
+    VideoPlayer* player = static_cast<VideoPlayer*>(lpParam);
+    PreparedMedia& media = player->m_loopHead;
+    
+    // 第一次重新打开当前文件, 之后复用上一轮换出的上下文（停在循环终点）
+    bool ready = media.formatContext ? true : player->OpenMedia(media, player->m_loopCancel);
+    if (ready)
+    {
+        media.formatContext->interrupt_callback.callback = CancelInterruptCallback;
+        media.formatContext->interrupt_callback.opaque = &player->m_loopCancel;
+        ready = SeekMedia(media, player->m_loopActiveStart, player->m_loopCancel);
+    }
+    if (!ready && !player->m_loopCancel)
+    {
+        std::cerr << "Failed to prepare loop start at " << player->m_loopActiveStart << "s: " << media.path << std::endl;
+    }
+    player->m_loopState = ready ? NEXT_READY : NEXT_FAILED;
+    return 0;
+}
+
+bool VideoPlayer::SpliceLoop()
+{
+    // 循环起点通常早已准备好; 区间很短时仍在准备则等待, 仍比在循环点上跳转快
+    while (m_loopState == NEXT_PREPARING && !m_shouldStop)
+    {
+        Sleep(1);
+    }
+    if (m_shouldStop)
+        return false;
+    
+    if (m_loopThread)
+    {
+        WaitForSingleObject(m_loopThread, INFINITE);
+        CloseHandle(m_loopThread);
+        m_loopThread = nullptr;
+    }
+    
+    if (m_loopState == NEXT_READY)
+    {
+        // 换入定位在循环起点的上下文, 换出的上下文留作下一轮的循环起点
+        AdoptMedia(m_loopHead);
+    }
+    else
+    {
+        // 准备失败时退回到在当前上下文中跳转（会在循环点上解码一个 GOP）
+        std::cout << "Loop start not prepared, seeking to " << m_loopActiveStart << "s" << std::endl;
+        ReleaseMedia(m_loopHead);
+        int64_t target = (int64_t)(m_loopActiveStart * AV_TIME_BASE);
+        if (av_seek_frame(m_formatContext, -1, target, AVSEEK_FLAG_BACKWARD) < 0)
+        {
+            m_loopState = NEXT_NONE;
+            return false;
+        }
+        avcodec_flush_buffers(m_codecContext);
+        ClearStartupPackets();
+        m_hasStartupFrame = false;
+        m_currentTime = m_loopActiveStart;
+        
+        // 回退跳转落在起点之前的关键帧上, 与预先准备时一样丢弃起点之前的帧和音频
+        m_loopSkipUntil = m_loopActiveStart;
+    }
+    m_loopState = NEXT_NONE;
+    
+    // 同一文件继续使用原来的音频解码器, 只丢弃其内部缓存的循环终点之后的数据
+    if (m_audioPlayer.IsInitialized())
+    {
+        avcodec_flush_buffers(m_audioPlayer.GetAudioCodecContext());
+    }
+    m_audioPlayer.SpliceLoop();
+    
+    StartLoopHead();
+    return true;
+}
+
+bool VideoPlayer::SetupRenderer()
+{
+    // 打开期间窗口尺寸可能已变化
+    RECT rect;
+    GetClientRect(m_hwnd, &rect);
+    m_windowWidth = rect.right - rect.left;
+    m_windowHeight = rect.bottom - rect.top;
+    
     // 设置渲染方式
+    StartupTrace& trace = StartupTrace::Instance();
+    double setupStartMs = trace.NowMs();
     if (m_useD3D9)
     {
-        if (!SetupD3D9())
+        bool ready = SetupD3D9();
+        trace.Complete("SetupD3D9", setupStartMs, trace.NowMs());
+        if (!ready)
         {
             std::cerr << "Failed to initialize D3D9, falling back to GDI" << std::endl;
             m_useD3D9 = false;
+            setupStartMs = trace.NowMs();
             if (!SetupGDI())
             {
                 return false;
             }
+            trace.Complete("SetupGDI", setupStartMs, trace.NowMs());
         }
     }
     else
@@ -95,7 +771,29 @@ bool VideoPlayer::Initialize(HWND hwnd, const std::string& videoPath)
         {
             return false;
         }
+        trace.Complete("SetupGDI", setupStartMs, trace.NowMs());
+    }
+    
+    // 渲染后端确定后再决定转换目标尺寸
+    UpdateConversionTarget();
+    m_frameStats.Reset();
+    m_timingPending = false;
+    m_deviceReadyMs = QpcNowMs();
+    
+    // 预先解出的第一帧立即显示, 不等待音频初始化和播放线程启动
+    if (m_hasStartupFrame)
+    {
+        FrameTiming timing;
+        memset(&timing, 0, sizeof(timing));
+        timing.sequence = m_decodedFrames + 1;
+        timing.pts = m_currentTime;
+        timing.decodeDoneMs = m_firstDecodeMs;
+        timing.deadlineMs = m_deviceReadyMs + 1000.0 / m_frameRate;
+        PublishDecodedFrame(timing);
+        m_hasStartupFrame = false;
     }
+    m_firstFramePending = true;
+    InvalidateRect(m_hwnd, nullptr, FALSE);
       // 初始化音频播放器
     if (m_audioPlayer.Initialize(m_formatContext))
     {
@@ -110,6 +808,7 @@ bool VideoPlayer::OpenVideo(const std::string& videoPath)
 {
     // 首先清理之前的资源
     CleanupFFmpeg();
+    m_currentPath = videoPath;
     
     // 分配格式上下文
     m_formatContext = avformat_alloc_context();
@@ -119,37 +818,32 @@ bool VideoPlayer::OpenVideo(const std::string& videoPath)
         return false;
     }
     
+    // 中断回调：取消打开时让阻塞的读取立即返回, 同时汇报读取进度
+    m_formatContext->interrupt_callback.callback = OpenInterruptCallback;
+    m_formatContext->interrupt_callback.opaque = this;
+    
     // 打开输入文件
-    if (avformat_open_input(&m_formatContext, videoPath.c_str(), nullptr, nullptr) != 0)
+    PostOpenProgress(OpenStage::OPENING_INPUT, true);
+    StartupTrace& trace = StartupTrace::Instance();
+    double traceStartMs = trace.NowMs();
+    int openResult = MediaIO::OpenInput(&m_formatContext, videoPath, m_inputMode, BudgetedReadAhead());
+    trace.Complete("avformat_open_input", traceStartMs, trace.NowMs());
+    if (openResult != 0)
     {
         std::cerr << "Failed to open video file: " << videoPath << std::endl;
         return false;
     }
+    m_inputOpenedMs = QpcNowMs();
     
-    // 获取流信息
-    if (avformat_find_stream_info(m_formatContext, nullptr) < 0)
-    {
-        std::cerr << "Failed to find stream info" << std::endl;
-        return false;
-    }
-    
-    // 查找视频流
-    m_videoStreamIndex = -1;
-    for (unsigned int i = 0; i < m_formatContext->nb_streams; i++)
-    {
-        if (m_formatContext->streams[i]->codecpar->codec_type == AVMEDIA_TYPE_VIDEO)
-        {
-            m_videoStreamIndex = i;
-            break;
-        }
-    }
-      if (m_videoStreamIndex == -1)
+    // 获取流信息并查找视频流
+    if (!ProbeStreams(m_formatContext, m_videoStreamIndex, m_openCancel))
     {
-        std::cerr << "No video stream found" << std::endl;
         return false;
     }
+    m_streamInfoMs = QpcNowMs();
     
     std::cout << "Found video stream at index: " << m_videoStreamIndex << std::endl;
+    PostOpenProgress(OpenStage::OPENING_DECODER, true);
     
     // 获取解码器参数
     AVCodecParameters* codecPar = m_formatContext->streams[m_videoStreamIndex]->codecpar;
@@ -169,6 +863,8 @@ bool VideoPlayer::OpenVideo(const std::string& videoPath)
     {
         return false;
     }
+    // 解码帧从缓冲池分配, 播放期间循环使用并计入内存预算
+    FramePool::Install(m_codecContext);
     
     // 复制解码器参数
     if (avcodec_parameters_to_context(m_codecContext, codecPar) < 0)
@@ -177,7 +873,10 @@ bool VideoPlayer::OpenVideo(const std::string& videoPath)
     }
     
     // 打开解码器
-    if (avcodec_open2(m_codecContext, m_codec, nullptr) < 0)
+    traceStartMs = trace.NowMs();
+    openResult = avcodec_open2(m_codecContext, m_codec, nullptr);
+    trace.Complete("avcodec_open2 (video)", traceStartMs, trace.NowMs());
+    if (openResult < 0)
     {
         return false;
     }    // 获取视频信息
@@ -186,101 +885,299 @@ bool VideoPlayer::OpenVideo(const std::string& videoPath)
     
     std::cout << "Video dimensions: " << m_videoWidth << "x" << m_videoHeight << std::endl;
     
+    // 8 位平面 YUV 可以直接上传为纹理, 由着色器完成颜色转换
+    AVPixelFormat pixFmt = m_codecContext->pix_fmt;
+    m_yuvSupported = pixFmt == AV_PIX_FMT_YUV420P || pixFmt == AV_PIX_FMT_YUVJ420P ||
+                     pixFmt == AV_PIX_FMT_YUV422P || pixFmt == AV_PIX_FMT_YUVJ422P ||
+                     pixFmt == AV_PIX_FMT_YUV444P || pixFmt == AV_PIX_FMT_YUVJ444P;
+    // 颜色空间和范围按每一帧确定（DetectYuvColor）, 无缝切换到下一个文件时随帧更新
+    if (m_yuvSupported)
+    {
+        av_pix_fmt_get_chroma_sub_sample(pixFmt, &m_chromaShiftX, &m_chromaShiftY);
+    }
+    std::cout << "Pixel format: " << av_get_pix_fmt_name(pixFmt)
+              << (m_yuvSupported ? " (GPU color conversion)" : " (CPU color conversion)") << std::endl;
+    
     // 获取帧率
-    AVRational frameRate = m_formatContext->streams[m_videoStreamIndex]->r_frame_rate;
-    if (frameRate.num > 0 && frameRate.den > 0)
+    m_frameRate = StreamFrameRate(m_formatContext->streams[m_videoStreamIndex]);
+    
+    std::cout << "Frame rate: " << m_frameRate << " FPS" << std::endl;
+    
+    // 计算时长
+    if (m_formatContext->duration != AV_NOPTS_VALUE)
     {
-        m_frameRate = (double)frameRate.num / frameRate.den;
+        m_duration = (double)m_formatContext->duration / AV_TIME_BASE;
     }
-    else
+    
+    // 分配帧
+    m_frame = av_frame_alloc();
+    m_frameRGB = av_frame_alloc();
+    m_packet = av_packet_alloc();
+    
+    if (!m_frame || !m_frameRGB || !m_packet)
     {
-        // 如果没有帧率信息，使用时间基准来估算
-        AVRational timeBase = m_formatContext->streams[m_videoStreamIndex]->time_base;
-        m_frameRate = 1.0 / av_q2d(timeBase);
-        if (m_frameRate > 60.0 || m_frameRate < 1.0)
+        return false;
+    }
+    
+    for (int i = 0; i < TripleBuffer::SLOTS; i++)
+    {
+        m_yuvFrames[i] = av_frame_alloc();
+        if (!m_yuvFrames[i])
+        {
+            return false;
+        }
+    }
+    m_yuvExchange.Reset();
+      // 分配图像缓冲区
+    m_rgbFormat = m_useD3D9 ? AV_PIX_FMT_BGRA : AV_PIX_FMT_BGR24;
+    m_rgbBytesPerPixel = m_useD3D9 ? 4 : 3;
+    
+    // GDI 的行按 4 字节对齐（DIB 的要求）, D3D9 按 64 字节对齐, 滤镜的 SIMD 读写和表面上传按整行进行
+    // 转换目标不超过视频尺寸, 因此按视频尺寸分配即可
+    m_rgbStrideAlign = m_useD3D9 ? FramePool::ALIGNMENT : 4;
+    FrameInfo fullSize = { m_videoWidth, m_videoHeight, RgbStride(m_videoWidth) };
+    size_t numBytes = (size_t)fullSize.stride * fullSize.height;
+    m_filterBuffer = (uint8_t*)av_malloc(numBytes);
+    if (!m_rgbMailbox.Allocate(numBytes, fullSize) || !m_filterBuffer)
+    {
+        return false;
+    }
+    m_filterCharge.Set(numBytes);
+    m_convertSize = ((int64_t)m_videoWidth << 32) | m_videoHeight;
+    
+    // SwsContext 在解码线程中按转换目标尺寸惰性创建 (sws_getCachedContext)
+    
+    // 离屏表面和 YUV 纹理依赖设备, 在 SetupD3D9 中创建
+    
+    // 预先解出第一帧, 渲染设备就绪后立即显示
+    return DecodeStartupFrame();
+}
+
+bool VideoPlayer::ProbeStreams(AVFormatContext* formatContext, int& videoStreamIndex, const std::atomic<bool>& cancel)
+{
+    PostOpenProgress(OpenStage::PROBING_STREAMS, true);
+    
+    // 先用较小的探测量快速开始（默认会读取 5 MB / 5 秒）, 视频流的尺寸或像素格式仍未知时按默认限制重新探测
+    int64_t defaultProbeSize = formatContext->probesize;
+    int64_t defaultAnalyzeDuration = formatContext->max_analyze_duration;
+    formatContext->probesize = FAST_PROBE_SIZE;
+    formatContext->max_analyze_duration = FAST_ANALYZE_DURATION;
+    
+    for (int attempt = 0; attempt < 2; attempt++)
+    {
+        StartupTrace& trace = StartupTrace::Instance();
+        double traceStartMs = trace.NowMs();
+        int probeResult = avformat_find_stream_info(formatContext, nullptr);
+        trace.Complete(attempt == 0 ? "avformat_find_stream_info (fast probe)" : "avformat_find_stream_info",
+                       traceStartMs, trace.NowMs());
+        if (probeResult < 0)
+        {
+            std::cerr << "Failed to find stream info" << std::endl;
+            return false;
+        }
+        
+        // 查找视频流
+        videoStreamIndex = -1;
+        for (unsigned int i = 0; i < formatContext->nb_streams; i++)
+        {
+            if (formatContext->streams[i]->codecpar->codec_type == AVMEDIA_TYPE_VIDEO)
+            {
+                videoStreamIndex = i;
+                break;
+            }
+        }
+        
+        if (videoStreamIndex >= 0)
+        {
+            AVCodecParameters* codecPar = formatContext->streams[videoStreamIndex]->codecpar;
+            if (codecPar->width > 0 && codecPar->height > 0 && codecPar->format != AV_PIX_FMT_NONE)
+            {
+                return true;
+            }
+        }
+        if (cancel || attempt > 0)
         {
-            m_frameRate = 25.0; // 默认值
+            break;
         }
+        
+        std::cout << "Fast stream probe incomplete, probing with default limits" << std::endl;
+        formatContext->probesize = defaultProbeSize;
+        formatContext->max_analyze_duration = defaultAnalyzeDuration;
     }
     
-    std::cout << "Frame rate: " << m_frameRate << " FPS" << std::endl;
-    
-    // 计算时长
-    if (m_formatContext->duration != AV_NOPTS_VALUE)
+    if (videoStreamIndex == -1)
     {
-        m_duration = (double)m_formatContext->duration / AV_TIME_BASE;
+        std::cerr << "No video stream found" << std::endl;
+        return false;
     }
+    return !cancel;
+}
+
+bool VideoPlayer::DecodeStartupFrame()
+{
+    PostOpenProgress(OpenStage::DECODING_FIRST_FRAME, true);
     
-    // 分配帧
-    m_frame = av_frame_alloc();
-    m_frameRGB = av_frame_alloc();
-    m_packet = av_packet_alloc();
-    
-    if (!m_frame || !m_frameRGB || !m_packet)
+    // 读到第一个视频帧为止; 期间的音频包保留下来, 由播放线程在读取新数据包之前处理
+    m_hasStartupFrame = ReadFirstVideoFrame(m_formatContext, m_codecContext, m_videoStreamIndex, m_packet, m_frame,
+                                            m_startupPackets, m_openCancel);
+    if (m_hasStartupFrame && m_frame->best_effort_timestamp != AV_NOPTS_VALUE)
     {
-        return false;
+        AVRational timeBase = m_formatContext->streams[m_videoStreamIndex]->time_base;
+        m_currentTime = m_frame->best_effort_timestamp * av_q2d(timeBase);
     }
-      // 分配图像缓冲区
-    AVPixelFormat targetFormat = m_useD3D9 ? AV_PIX_FMT_BGRA : AV_PIX_FMT_BGR24;
-    int bytesPerPixel = m_useD3D9 ? 4 : 3;
-    
-    int numBytes = av_image_get_buffer_size(targetFormat, m_videoWidth, m_videoHeight, 1);
-    m_buffer = (uint8_t*)av_malloc(numBytes * sizeof(uint8_t));
+    m_firstDecodeMs = QpcNowMs();
     
-    av_image_fill_arrays(m_frameRGB->data, m_frameRGB->linesize, m_buffer, targetFormat, m_videoWidth, m_videoHeight, 1);    // 初始化图像转换上下文，使用高质量缩放参数
-    m_swsContext = sws_getContext(
-        m_videoWidth, m_videoHeight, m_codecContext->pix_fmt,
-        m_videoWidth, m_videoHeight, targetFormat,
-        SWS_LANCZOS | SWS_FULL_CHR_H_INT | SWS_FULL_CHR_H_INP | SWS_ACCURATE_RND, 
-        nullptr, nullptr, nullptr  // 使用Lanczos缩放算法，启用全色度插值和精确舍入
-    );
-    
-    // 如果使用 D3D9，创建离屏表面
-    if (m_useD3D9 && m_d3d9Device) {
-        // 释放现有表面
-        if (m_d3d9Surface) {
-            m_d3d9Surface.Reset();
+    // 没有解出视频帧（如只有音频数据的开头）时仍然可以播放, 只有取消才算失败
+    return !m_openCancel;
+}
+
+bool VideoPlayer::ReadFirstVideoFrame(AVFormatContext* formatContext, AVCodecContext* codecContext, int videoStreamIndex,
+                                      AVPacket* packet, AVFrame* frame, std::deque<AVPacket*>& audioPackets,
+                                      const std::atomic<bool>& cancel)
+{
+    bool firstPacket = true;
+    while (!cancel && av_read_frame(formatContext, packet) >= 0)
+    {
+        if (firstPacket)
+        {
+            StartupTrace::Instance().Instant("first packet");
+            firstPacket = false;
         }
-        memset(&m_d3d9SurfaceDesc, 0, sizeof(m_d3d9SurfaceDesc));
-
-        // 创建离屏普通表面用于视频帧
-        HRESULT hr = m_d3d9Device->CreateOffscreenPlainSurface(
-            m_videoWidth,
-            m_videoHeight,
-            D3DFMT_X8R8G8B8, // 对应 AV_PIX_FMT_BGRA 格式
-            D3DPOOL_DEFAULT,
-            &m_d3d9Surface,
-            nullptr
-        );
+        
+        int streamIndex = packet->stream_index;
+        if (streamIndex == videoStreamIndex)
+        {
+            if (avcodec_send_packet(codecContext, packet) == 0 && avcodec_receive_frame(codecContext, frame) == 0)
+            {
+                StartupTrace::Instance().Instant("first decoded frame");
+                av_packet_unref(packet);
+                return true;
+            }
+        }
+        else if (formatContext->streams[streamIndex]->codecpar->codec_type == AVMEDIA_TYPE_AUDIO)
+        {
+            QueueAudioPacket(audioPackets, packet);
+        }
+        av_packet_unref(packet);
+    }
+    return false;
+}
+
+void VideoPlayer::ClearStartupPackets()
+{
+    ClearPacketQueue(m_startupPackets);
+}
+
+// 排队数据包按其缓冲区的实际大小（含填充）记账
+static size_t QueuedPacketBytes(const AVPacket* packet)
+{
+    return packet->buf ? packet->buf->size : (size_t)packet->size;
+}
 
-        if (FAILED(hr)) {
-            std::cerr << "Failed to create D3D9 offscreen surface." << std::endl;
-            // 可以考虑回退到 GDI 或报告错误
-        } else {
-            m_d3d9Surface->GetDesc(&m_d3d9SurfaceDesc);
+void VideoPlayer::QueueAudioPacket(std::deque<AVPacket*>& queue, AVPacket* packet)
+{
+    // 超出内存预算时只保留少量音频包, 换入或开始播放时开头的音频可能缺一段, 视频不受影响
+    MemoryBudget& budget = MemoryBudget::Instance();
+    size_t limit = budget.IsOverBudget() ? DEGRADED_STARTUP_PACKETS : MAX_STARTUP_PACKETS;
+    if (queue.size() >= limit)
+    {
+        if (limit < MAX_STARTUP_PACKETS)
+        {
+            budget.RecordDegradation();
         }
+        return;
     }
     
-    return true;
+    AVPacket* queued = av_packet_alloc();
+    if (!queued)
+        return;
+    av_packet_move_ref(queued, packet);
+    budget.Add(MemoryCategory::PACKETS, QueuedPacketBytes(queued));
+    queue.push_back(queued);
+}
+
+void VideoPlayer::TakeQueuedPacket(std::deque<AVPacket*>& queue, AVPacket* destination)
+{
+    AVPacket* packet = queue.front();
+    queue.pop_front();
+    MemoryBudget::Instance().Remove(MemoryCategory::PACKETS, QueuedPacketBytes(packet));
+    av_packet_move_ref(destination, packet);
+    av_packet_free(&packet);
+}
+
+void VideoPlayer::ClearPacketQueue(std::deque<AVPacket*>& queue)
+{
+    for (AVPacket* packet : queue)
+    {
+        MemoryBudget::Instance().Remove(MemoryCategory::PACKETS, QueuedPacketBytes(packet));
+        av_packet_free(&packet);
+    }
+    queue.clear();
+}
+
+size_t VideoPlayer::BudgetedReadAhead() const
+{
+    // 预读窗口最多占预算剩余量的一半; 不足最小窗口时不预读, 改用 FFmpeg 的文件协议
+    uint64_t available = MemoryBudget::Instance().Available();
+    if (m_readAhead == 0 || available / 2 >= m_readAhead)
+        return m_readAhead;
+    
+    size_t readAhead = (size_t)(available / 2);
+    if (readAhead < MIN_BUDGETED_READ_AHEAD)
+    {
+        readAhead = 0;
+    }
+    MemoryBudget::Instance().RecordDegradation();
+    std::cout << "Memory budget: read-ahead reduced to " << readAhead / 1024 << " KB" << std::endl;
+    return readAhead;
 }
 
 bool VideoPlayer::SetupGDI()
 {
+    CleanupGDI();
+    
     HDC hdc = GetDC(m_hwnd);
-    m_hdcMem = CreateCompatibleDC(hdc);
+    if (!hdc)
+        return false;
     
-    // 设置位图信息
-    ZeroMemory(&m_bitmapInfo, sizeof(BITMAPINFO));
-    m_bitmapInfo.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
-    m_bitmapInfo.bmiHeader.biWidth = m_videoWidth;
-    m_bitmapInfo.bmiHeader.biHeight = -m_videoHeight; // 负值表示从上到下
-    m_bitmapInfo.bmiHeader.biPlanes = 1;
-    m_bitmapInfo.bmiHeader.biBitCount = 24;
-    m_bitmapInfo.bmiHeader.biCompression = BI_RGB;
+    // 邮箱的三个帧缓冲区改为 DIB 段：解码线程的 sws_scale 直接写入, 呈现时不再经过中间拷贝
+    // 位图格式与转换格式一致（D3D9 初始化失败回退到这里时为 BGRA）; DIB 行按 4 字节对齐, 转换步长随之改变
+    m_rgbStrideAlign = 4;
+    FrameInfo fullSize = { m_videoWidth, m_videoHeight, RgbStride(m_videoWidth) };
+    BITMAPINFO bitmapInfo;
+    ZeroMemory(&bitmapInfo, sizeof(BITMAPINFO));
+    bitmapInfo.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+    bitmapInfo.bmiHeader.biWidth = m_videoWidth;
+    bitmapInfo.bmiHeader.biHeight = -m_videoHeight; // 负值表示从上到下
+    bitmapInfo.bmiHeader.biPlanes = 1;
+    bitmapInfo.bmiHeader.biBitCount = (WORD)(m_rgbBytesPerPixel * 8);
+    bitmapInfo.bmiHeader.biCompression = BI_RGB;
+    
+    uint8_t* bits[TripleBuffer::SLOTS] = {};
+    bool created = true;
+    for (int i = 0; i < TripleBuffer::SLOTS && created; i++)
+    {
+        void* pixels = nullptr;
+        m_dibSections[i] = CreateDIBSection(hdc, &bitmapInfo, DIB_RGB_COLORS, &pixels, nullptr, 0);
+        bits[i] = (uint8_t*)pixels;
+        created = m_dibSections[i] != nullptr && pixels != nullptr;
+    }
+    
+    // 显示器刷新间隔, 用于统计错过的垂直同步（0/1 表示硬件默认值, 无法得知）
+    int refreshRate = GetDeviceCaps(hdc, VREFRESH);
+    m_frameStats.SetVsyncInterval(refreshRate > 1 ? 1000.0 / refreshRate : 0.0);
     
     ReleaseDC(m_hwnd, hdc);
     
-    return m_hdcMem != nullptr;
+    if (!created || !m_rgbMailbox.Attach(bits, (size_t)fullSize.stride * fullSize.height, fullSize))
+    {
+        std::cerr << "Failed to create GDI DIB sections" << std::endl;
+        CleanupGDI();
+        return false;
+    }
+    
+    std::cout << "Using GDI rendering with " << m_rgbBytesPerPixel * 8 << "-bit DIB sections" << std::endl;
+    return true;
 }
 
 bool VideoPlayer::SetupD3D9()
@@ -370,15 +1267,110 @@ bool VideoPlayer::SetupD3D9()
         (msaaType == D3DMULTISAMPLE_NONE ? "no MSAA" : 
          (msaaType == D3DMULTISAMPLE_2_SAMPLES ? "2x MSAA" :
           (msaaType == D3DMULTISAMPLE_4_SAMPLES ? "4x MSAA" : "8x MSAA"))) << std::endl;
+    
     std::cout << "Using D3D9 rendering with format: " << (m_useD3D9 ? "BGRA" : "BGR24") << std::endl;
+    
+    // 垂直同步开启, 刷新间隔用于统计错过的垂直同步
+    D3DDISPLAYMODE displayMode;
+    if (SUCCEEDED(m_d3d9->GetAdapterDisplayMode(D3DADAPTER_DEFAULT, &displayMode)) && displayMode.RefreshRate > 0)
+    {
+        m_frameStats.SetVsyncInterval(1000.0 / displayMode.RefreshRate);
+    }
+    
+    CreateVideoResources();
+    return true;
+}
+
+void VideoPlayer::CreateVideoResources()
+{
+    if (!m_d3d9Device || m_videoWidth <= 0 || m_videoHeight <= 0)
+        return;
+    
+    // 创建离屏普通表面用于 RGB 视频帧
+    memset(&m_d3d9SurfaceDesc, 0, sizeof(m_d3d9SurfaceDesc));
+    m_surfaceSerial = 0;    // 新表面需要重新上传
+    HRESULT hr = m_d3d9Device->CreateOffscreenPlainSurface(
+        m_videoWidth,
+        m_videoHeight,
+        D3DFMT_X8R8G8B8, // 对应 AV_PIX_FMT_BGRA 格式
+        D3DPOOL_DEFAULT,
+        m_d3d9Surface.ReleaseAndGetAddressOf(),
+        nullptr
+    );
+    
+    if (FAILED(hr))
+    {
+        std::cerr << "Failed to create D3D9 offscreen surface." << std::endl;
+    }
+    else
+    {
+        m_d3d9Surface->GetDesc(&m_d3d9SurfaceDesc);
+    }
+    
+    // 创建 YUV 纹理渲染器, 失败时继续使用 RGB 表面路径
+    if (m_yuvSupported)
+    {
+        m_yuvTexturesActive = m_yuvRenderer.Create(m_d3d9Device.Get(), m_videoWidth, m_videoHeight,
+                                                   m_chromaShiftX, m_chromaShiftY);
+        m_yuvTexturesStale = true;  // 新纹理需要重新上传当前帧
+    }
+}
+
+void VideoPlayer::ReleaseVideoResources()
+{
+    // D3DPOOL_DEFAULT 资源必须在设备 Reset 之前全部释放
+    m_yuvTexturesActive = false;
+    m_yuvRenderer.Release();
+    m_d3d9Surface.Reset();
+}
+
+bool VideoPlayer::ResetD3D9Device()
+{
+    // 设备丢失（如全屏程序占用、锁屏）期间无法 Reset, 稍后重试
+    HRESULT hr = m_d3d9Device->TestCooperativeLevel();
+    if (hr == D3DERR_DEVICELOST)
+    {
+        return false;
+    }
+    
+    ReleaseVideoResources();
+    
+    m_d3dpp.BackBufferWidth = m_pendingWidth;
+    m_d3dpp.BackBufferHeight = m_pendingHeight;
+    hr = m_d3d9Device->Reset(&m_d3dpp);
+    if (hr == D3DERR_DEVICELOST)
+    {
+        return false;
+    }
+    
+    m_windowWidth = m_pendingWidth;
+    m_windowHeight = m_pendingHeight;
+    
+    if (FAILED(hr))
+    {
+        // Reset 失败时退回到完整重建设备
+        std::cerr << "D3D9 device reset failed, HRESULT: 0x" << std::hex << hr << std::dec
+                  << ", recreating device" << std::endl;
+        return SetupD3D9();
+    }
+    
+    CreateVideoResources();
     return true;
 }
 
 void VideoPlayer::Play()
 {
-    if (m_isPlaying)
+    if (m_isPlaying || m_openThread)
         return;
     
+    // 播放到文件末尾时线程自行退出, 句柄在这里回收
+    if (m_playThread)
+    {
+        WaitForSingleObject(m_playThread, INFINITE);
+        CloseHandle(m_playThread);
+        m_playThread = nullptr;
+    }
+    
     m_isPlaying = true;
     m_isPaused = false;
     m_shouldStop = false;
@@ -393,44 +1385,117 @@ void VideoPlayer::Pause()
 {
     m_isPaused = !m_isPaused;
     m_audioPlayer.Pause();
+    
+    // GDI 暂停后用 HALFTONE 重绘当前画面
+    if (!m_useD3D9 && m_isPaused && m_hwnd)
+    {
+        InvalidateRect(m_hwnd, nullptr, FALSE);
+    }
 }
 
 void VideoPlayer::Stop()
 {
+    if (m_openThread)
+    {
+        CancelOpen();
+        return;
+    }
+    
     if (!m_isPlaying)
         return;
     
     m_shouldStop = true;
     m_isPlaying = false;
     m_isPaused = false;
+    m_seekRequest = NAN;
     
     // 停止音频播放
     m_audioPlayer.Stop();
     
-    // 等待播放线程结束
+    // 等待播放线程结束; 它可能正在换入下一个文件的上下文, 退出之前不能在当前上下文中回绕
     if (m_playThread)
     {
-        WaitForSingleObject(m_playThread, 2000);
+        WaitForSingleObject(m_playThread, INFINITE);
         CloseHandle(m_playThread);
         m_playThread = nullptr;
     }
     
     // 重置到开始位置
+    ClearStartupPackets();
+    m_hasStartupFrame = false;
     if (m_formatContext)
     {
         av_seek_frame(m_formatContext, m_videoStreamIndex, 0, AVSEEK_FLAG_BACKWARD);
     }
     m_currentTime = 0.0;
+    
+    PresenterStats stats = GetPresenterStats();
+    std::cout << "Presenter: " << stats.decodedFrames << " decoded frames, " << stats.filterPasses
+              << " filter passes, " << stats.frameUploads << " uploads, " << stats.presents << " presents" << std::endl;
+    m_frameStats.WriteReport(std::cout);
 }
 
 void VideoPlayer::Seek(double seconds)
 {
-    if (!m_formatContext || m_videoStreamIndex < 0)
+    if (m_openThread)
+        return;
+    
+    // 播放线程运行中（包括暂停）：交给它在两次读包之间执行, 连续拖动时只执行最后一次
+    if (m_playThread && WaitForSingleObject(m_playThread, 0) == WAIT_TIMEOUT)
+    {
+        m_seekRequest = seconds;
         return;
+    }
     
+    m_seekRequest = NAN;
+    if (m_formatContext && m_videoStreamIndex >= 0)
+    {
+        SeekTo(seconds);
+    }
+}
+
+void VideoPlayer::SeekTo(double seconds)
+{
     int64_t timestamp = (int64_t)(seconds * AV_TIME_BASE);
     av_seek_frame(m_formatContext, -1, timestamp, AVSEEK_FLAG_BACKWARD);
+    avcodec_flush_buffers(m_codecContext);
+    if (m_audioPlayer.IsInitialized())
+    {
+        avcodec_flush_buffers(m_audioPlayer.GetAudioCodecContext());
+    }
+    
+    // 打开或换入时预先读到的包和解出的帧都在跳转之前
+    ClearStartupPackets();
+    m_hasStartupFrame = false;
+    m_loopSkipUntil = NAN;
     m_currentTime = seconds;
+    
+    // 丢弃跳转前已排队的音频
+    m_audioPlayer.Flush(seconds);
+}
+
+void VideoPlayer::SetPlaybackSpeed(double speed)
+{
+    m_playbackSpeed = (std::max)(0.5, (std::min)(4.0, speed));
+    m_audioPlayer.SetPlaybackSpeed(m_playbackSpeed);
+}
+
+void VideoPlayer::SetVideoVisible(bool visible)
+{
+    m_videoVisible = visible;
+}
+
+void VideoPlayer::SetVideoTrackEnabled(bool enabled)
+{
+    m_videoTrackEnabled = enabled;
+}
+
+void VideoPlayer::UpdateVideoDiscard()
+{
+    // 纯音频模式丢弃全部视频包, 高倍速模式只保留关键帧
+    AVDiscard discard = m_audioOnly ? AVDISCARD_ALL : (m_keyframeOnly ? AVDISCARD_NONKEY : AVDISCARD_DEFAULT);
+    m_formatContext->streams[m_videoStreamIndex]->discard = discard;  // 解复用器层面丢弃
+    m_codecContext->skip_frame = m_keyframeOnly ? AVDISCARD_NONKEY : AVDISCARD_DEFAULT;
 }
 
 DWORD WINAPI VideoPlayer::PlayThreadProc(LPVOID lpParam)
@@ -442,12 +1507,24 @@ DWORD WINAPI VideoPlayer::PlayThreadProc(LPVOID lpParam)
 
 void VideoPlayer::PlayLoop()
 {
-    LARGE_INTEGER frequency, lastTime, currentTime;
+    LARGE_INTEGER frequency, lastTime;
     QueryPerformanceFrequency(&frequency);
     QueryPerformanceCounter(&lastTime);
+    double lastFramePts = NAN;
+    
+    // 循环起点的准备线程只在播放期间存在
+    UpdateLoop();
     
     while (!m_shouldStop)
     {
+        // UI 线程的跳转请求（暂停时同样执行, 恢复后从新位置开始）
+        double seekTarget = m_seekRequest.exchange(NAN);
+        if (!std::isnan(seekTarget))
+        {
+            SeekTo(seekTarget);
+            lastFramePts = NAN;
+        }
+        
         if (m_isPaused)
         {
             Sleep(10);
@@ -455,85 +1532,249 @@ void VideoPlayer::PlayLoop()
             continue;
         }
         
-        // 读取数据包
-        int ret = av_read_frame(m_formatContext, m_packet);
+        if (m_loopVersion != m_loopAppliedVersion)
+        {
+            UpdateLoop();
+        }
+        
+        // 根据播放速度切换仅关键帧解码模式, 使高倍速下的 CPU 开销不随速度增长
+        // 窗口不可见或视频轨道关闭时进入纯音频模式（需要音频来驱动播放节奏）
+        bool keyframeOnly = m_playbackSpeed >= KEYFRAME_ONLY_SPEED;
+        bool audioOnly = !(m_videoVisible && m_videoTrackEnabled) && m_audioPlayer.IsInitialized();
+        if (keyframeOnly != m_keyframeOnly || audioOnly != m_audioOnly)
+        {
+            m_keyframeOnly = keyframeOnly;
+            m_audioOnly = audioOnly;
+            m_audioPlayer.SetAudioMaster(audioOnly);
+            UpdateVideoDiscard();
+            
+            // 切换后参考帧不完整, 从下一个关键帧重新开始解码
+            avcodec_flush_buffers(m_codecContext);
+            m_waitForKeyframe = true;
+            lastFramePts = NAN;
+        }
+        
+        // 切换到播放列表下一个文件后, 先按节奏显示它预先解出的第一帧
+        if (m_hasStartupFrame)
+        {
+            m_hasStartupFrame = false;
+            if (!m_audioOnly)
+            {
+                ShowDecodedFrame(true, lastFramePts, lastTime, frequency);
+            }
+            continue;
+        }
+        
+        // 读取数据包（先处理打开时寻找第一帧读到的音频包）
+        int ret = 0;
+        if (!m_startupPackets.empty())
+        {
+            TakeQueuedPacket(m_startupPackets, m_packet);
+        }
+        else
+        {
+            MetricsScope demuxScope(MetricStage::DEMUX);
+            ret = av_read_frame(m_formatContext, m_packet);
+            if (ret >= 0)
+            {
+                PlayerMetrics::Count(MetricCounter::DEMUX_PACKETS);
+                PlayerMetrics::Count(MetricCounter::DEMUX_BYTES, (uint64_t)m_packet->size);
+            }
+        }
         if (ret < 0)
         {
-            // 文件结束或错误
+            // 文件结束或错误; 循环播放时换入循环起点, 否则播放列表的下一个文件已预先打开时直接换入
+            if (!m_shouldStop && m_loopActive && SpliceLoop())
+            {
+                lastFramePts = NAN;
+                continue;
+            }
+            if (!m_shouldStop && SwitchToNext())
+            {
+                lastFramePts = NAN;
+                continue;
+            }
             break;
         }        if (m_packet->stream_index == m_videoStreamIndex)
         {
-            // 发送数据包到解码器
-            ret = avcodec_send_packet(m_codecContext, m_packet);
-            if (ret < 0)
+            // 部分解复用器不支持 AVDISCARD_ALL, 在这里兜底丢弃
+            if (m_audioOnly)
             {
                 av_packet_unref(m_packet);
                 continue;
             }
             
-            // 接收解码后的帧
-            ret = avcodec_receive_frame(m_codecContext, m_frame);
-            if (ret == 0)
+            if (m_waitForKeyframe)
             {
-                // 转换像素格式
-                sws_scale(m_swsContext, m_frame->data, m_frame->linesize, 0, m_videoHeight,
-                         m_frameRGB->data, m_frameRGB->linesize);
-                  // 更新当前时间
-                if (m_packet->pts != AV_NOPTS_VALUE)
+                if (!(m_packet->flags & AV_PKT_FLAG_KEY))
                 {
-                    m_currentTime = m_packet->pts * av_q2d(m_formatContext->streams[m_videoStreamIndex]->time_base);
-                    
-                    // 设置视频时钟作为主时钟
-                    m_audioPlayer.SetVideoTime(m_currentTime);
+                    av_packet_unref(m_packet);
+                    continue;
                 }
+                m_waitForKeyframe = false;
+            }
+            
+            // 发送数据包到解码器并接收解码后的帧（计时不包括之后等待显示的时间）
+            {
+                MetricsScope decodeScope(MetricStage::DECODE_VIDEO);
+                ret = avcodec_send_packet(m_codecContext, m_packet);
+                if (ret >= 0)
+                {
+                    ret = avcodec_receive_frame(m_codecContext, m_frame);
+                }
+            }
+            if (ret == 0)
+            {
+                PlayerMetrics::Count(MetricCounter::VIDEO_FRAMES);
                 
-                // 触发渲染
-                InvalidateRect(m_hwnd, nullptr, FALSE);
-                
-                // 控制播放速度 - 使用实际帧率
-                QueryPerformanceCounter(&currentTime);
-                double elapsed = (double)(currentTime.QuadPart - lastTime.QuadPart) / frequency.QuadPart;
-                double frameTime = 1.0 / m_frameRate;
+                // 循环起点之前的帧只作为参考帧解码, 不显示也不更新进度
+                AVRational timeBase = m_formatContext->streams[m_videoStreamIndex]->time_base;
+                int64_t framePts = m_frame->best_effort_timestamp;
+                if (!std::isnan(m_loopSkipUntil) && framePts != AV_NOPTS_VALUE &&
+                    framePts * av_q2d(timeBase) < m_loopSkipUntil - 0.5 / m_frameRate)
+                {
+                    av_packet_unref(m_packet);
+                    continue;
+                }
                 
-                if (elapsed < frameTime)
+                // 更新当前时间
+                bool hasPts = m_packet->pts != AV_NOPTS_VALUE;
+                if (hasPts)
                 {
-                    DWORD sleepTime = (DWORD)((frameTime - elapsed) * 1000);
-                    if (sleepTime > 0 && sleepTime < 100) // 避免过长的睡眠时间
-                    {
-                        Sleep(sleepTime);
-                    }
+                    m_currentTime = m_packet->pts * av_q2d(timeBase);
                 }
                 
-                QueryPerformanceCounter(&lastTime);
+                // 到达循环终点：这一帧不显示, 换入循环起点后下一轮先显示其预先解出的帧
+                if (hasPts && LoopEndReached(m_currentTime) && SpliceLoop())
+                {
+                    lastFramePts = NAN;
+                }
+                else
+                {
+                    ShowDecodedFrame(hasPts, lastFramePts, lastTime, frequency);
+                }
             }
         }        else if (m_audioPlayer.IsInitialized() && m_packet->stream_index == m_audioPlayer.GetAudioStreamIndex())
         {
+            // 循环起点之前的音频包不解码
+            if (!std::isnan(m_loopSkipUntil) && m_packet->pts != AV_NOPTS_VALUE &&
+                m_packet->pts * av_q2d(m_formatContext->streams[m_packet->stream_index]->time_base) < m_loopSkipUntil)
+            {
+                av_packet_unref(m_packet);
+                continue;
+            }
+            
             // 处理音频帧
-            ret = avcodec_send_packet(m_audioPlayer.GetAudioCodecContext(), m_packet);
+            AVFrame* audioFrame = av_frame_alloc();
+            {
+                MetricsScope decodeScope(MetricStage::DECODE_AUDIO);
+                ret = avcodec_send_packet(m_audioPlayer.GetAudioCodecContext(), m_packet);
+                if (ret == 0)
+                {
+                    ret = avcodec_receive_frame(m_audioPlayer.GetAudioCodecContext(), audioFrame);
+                }
+            }
             if (ret == 0)
             {
-                AVFrame* audioFrame = av_frame_alloc();
-                ret = avcodec_receive_frame(m_audioPlayer.GetAudioCodecContext(), audioFrame);
-                if (ret == 0)
-                {
-                    // 使用新的音频处理方法（带音视频同步）
-                    m_audioPlayer.ProcessAudioFrame(audioFrame);
-                }
-                av_frame_free(&audioFrame);
+                PlayerMetrics::Count(MetricCounter::AUDIO_FRAMES);
+                
+                // 使用新的音频处理方法（带音视频同步）
+                m_audioPlayer.ProcessAudioFrame(audioFrame);
+                
+                // 纯音频模式下播放进度由音频时钟提供
+                if (m_audioOnly)
+                {
+                    m_currentTime = m_audioPlayer.GetAudioClock();
+                }
+            }
+            av_frame_free(&audioFrame);
+            
+            // 纯音频模式没有视频帧, 按音频包的时间戳判断循环终点（终点之后的样本已留作淡出尾巴）
+            if (m_audioOnly && m_packet->pts != AV_NOPTS_VALUE)
+            {
+                AVRational timeBase = m_formatContext->streams[m_packet->stream_index]->time_base;
+                if (LoopEndReached(m_packet->pts * av_q2d(timeBase)))
+                {
+                    SpliceLoop();
+                }
+            }
+        }
+        
+        av_packet_unref(m_packet);
+    }
+    
+    CancelLoopHead();
+    m_loopActive = false;
+    m_audioPlayer.SetLoopEnd(NAN);
+    
+    m_isPlaying = false;
+    if (!m_shouldStop)
+    {
+        PostMessage(m_hwnd, WM_VIDEO_ENDED, 0, 0);
+    }
+}
+
+void VideoPlayer::ShowDecodedFrame(bool hasPts, double& lastFramePts, LARGE_INTEGER& lastTime, const LARGE_INTEGER& frequency)
+{
+    // 帧间隔 - 使用实际帧率, 按播放速度缩放
+    // 仅关键帧模式下相邻两帧间隔一个 GOP, 按 pts 差值调度
+    double frameTime = 1.0 / m_frameRate;
+    if (m_keyframeOnly && !std::isnan(lastFramePts) && m_currentTime > lastFramePts)
+    {
+        frameTime = m_currentTime - lastFramePts;
+    }
+    lastFramePts = m_currentTime;
+    frameTime /= m_playbackSpeed;
+    
+    // 帧节奏统计：下一帧到期之前必须呈现
+    FrameTiming timing;
+    memset(&timing, 0, sizeof(timing));
+    timing.sequence = m_decodedFrames + 1;
+    timing.pts = m_currentTime;
+    timing.decodeDoneMs = QpcNowMs();
+    timing.deadlineMs = timing.decodeDoneMs + frameTime * 1000.0;
+    
+    PublishDecodedFrame(timing);
+    
+    // 设置视频时钟作为主时钟
+    if (hasPts)
+    {
+        m_audioPlayer.SetVideoTime(m_currentTime);
+    }
+    
+    // 触发渲染
+    InvalidateRect(m_hwnd, nullptr, FALSE);
+    
+    // 控制播放速度
+    LARGE_INTEGER currentTime;
+    QueryPerformanceCounter(&currentTime);
+    double elapsed = (double)(currentTime.QuadPart - lastTime.QuadPart) / frequency.QuadPart;
+    
+    if (elapsed < frameTime)
+    {
+        DWORD sleepTime = (DWORD)((frameTime - elapsed) * 1000);
+        DWORD maxSleepTime = m_keyframeOnly ? 2000 : 100; // 避免过长的睡眠时间
+        if (sleepTime > 0 && sleepTime < maxSleepTime)
+        {
+            // 分片睡眠, 以便及时响应停止和跳转请求
+            while (sleepTime > 0 && !m_shouldStop && std::isnan(m_seekRequest.load()))
+            {
+                DWORD slice = (std::min)(sleepTime, (DWORD)10);
+                Sleep(slice);
+                sleepTime -= slice;
             }
         }
-        
-        av_packet_unref(m_packet);
     }
     
-    m_isPlaying = false;
+    QueryPerformanceCounter(&lastTime);
 }
 
 void VideoPlayer::Render()
 {
-    if (!m_buffer)
+    if (m_openThread || !m_rgbMailbox.IsAllocated())
         return;
     
+    MetricsScope presentScope(MetricStage::PRESENT);
     if (m_useD3D9)
     {
         RenderWithD3D9();
@@ -552,15 +1793,55 @@ void VideoPlayer::OnResize(int width, int height)
         return;
     }
     
-    m_windowWidth = width;
-    m_windowHeight = height;
+    // 打开期间还没有渲染资源, 尺寸在 FinishOpen 时重新读取
+    if (m_openThread)
+    {
+        return;
+    }
+    
+    // GDI 直接绘制到窗口 DC, 没有与尺寸相关的资源
+    if (!m_useD3D9 || !m_d3d9Device)
+    {
+        m_windowWidth = width;
+        m_windowHeight = height;
+        UpdateConversionTarget();
+        return;
+    }
     
-    // 如果使用 D3D9，需要重新设置设备
-    if (m_useD3D9 && m_d3d9Device)
+    if (width == m_windowWidth && height == m_windowHeight && !m_resizePending)
     {
-        // 重新设置 D3D9 设备
-        SetupD3D9();
+        return;
     }
+    
+    // D3D9：记录新尺寸, 合并后统一 Reset
+    m_pendingWidth = width;
+    m_pendingHeight = height;
+    m_resizePending = true;
+    m_resizeEventCount++;
+    m_resizeRequestTime = QpcNowMs();
+}
+
+void VideoPlayer::ApplyPendingResize(bool force)
+{
+    if (!m_resizePending || !m_d3d9Device)
+        return;
+    
+    double now = QpcNowMs();
+    if (!force && now - m_resizeRequestTime < RESIZE_DEBOUNCE_MS)
+        return;
+    
+    if (!ResetD3D9Device())
+        return;
+    
+    UpdateConversionTarget();
+    m_resizeResetTime = QpcNowMs();
+    std::cout << "Resize to " << m_windowWidth << "x" << m_windowHeight << ": " << m_resizeEventCount
+              << " resize events coalesced, reset took " << (m_resizeResetTime - now) << " ms" << std::endl;
+    m_resizePending = false;
+    m_resizeEventCount = 0;
+    
+    // 立即用新尺寸重绘当前帧
+    InvalidateRect(m_hwnd, nullptr, FALSE);
 }
 
 void VideoPlayer::CleanupFFmpeg()
@@ -570,12 +1851,26 @@ void VideoPlayer::CleanupFFmpeg()
         sws_freeContext(m_swsContext);
         m_swsContext = nullptr;
     }
+    if (m_presentSwsContext)
+    {
+        sws_freeContext(m_presentSwsContext);
+        m_presentSwsContext = nullptr;
+    }
     
-    if (m_buffer)
+    m_rgbMailbox.Release();
+    ClearStartupPackets();
+    m_hasStartupFrame = false;
+    
+    if (m_filterBuffer)
     {
-        av_free(m_buffer);
-        m_buffer = nullptr;
+        av_free(m_filterBuffer);
+        m_filterBuffer = nullptr;
     }
+    m_filterCharge.Set(0);
+    m_outputFrame = nullptr;
+    m_outputFromYuv = false;
+    m_surfaceSerial = 0;
+    m_outputSerial++;   // 新文件的帧序号重新开始, 强制重新生成输出
     
     if (m_frame)
     {
@@ -587,6 +1882,15 @@ void VideoPlayer::CleanupFFmpeg()
         av_frame_free(&m_frameRGB);
     }
     
+    for (int i = 0; i < TripleBuffer::SLOTS; i++)
+    {
+        if (m_yuvFrames[i])
+        {
+            av_frame_free(&m_yuvFrames[i]);
+        }
+    }
+    m_yuvExchange.Reset();
+    
     if (m_packet)
     {
         av_packet_free(&m_packet);
@@ -594,33 +1898,69 @@ void VideoPlayer::CleanupFFmpeg()
     
     if (m_codecContext)
     {
-        avcodec_free_context(&m_codecContext);
+        FramePool::FreeContext(&m_codecContext);
     }
     
     if (m_formatContext)
     {
-        avformat_close_input(&m_formatContext);
+        MediaIOStats ioStats;
+        if (GetInputStats(ioStats))
+        {
+            double fetchedMB = ioStats.bytesFetched / (1024.0 * 1024.0);
+            std::cout << "Input: " << fetchedMB << " MB read in " << ioStats.fetchMs << " ms ("
+                      << (ioStats.fetchMs > 0.0 ? fetchedMB * 1000.0 / ioStats.fetchMs : 0.0) << " MB/s), "
+                      << ioStats.stalls << " demuxer stalls (" << ioStats.stallMs << " ms), "
+                      << ioStats.seeks << " seeks (" << ioStats.cachedSeeks << " from cache)" << std::endl;
+        }
+        MediaIO::CloseInput(&m_formatContext);
     }
 }
 
+double VideoPlayer::GetDuration() const
+{
+    std::lock_guard<std::mutex> lock(m_mediaMutex);
+    return m_duration;
+}
+
+double VideoPlayer::GetFrameRate() const
+{
+    std::lock_guard<std::mutex> lock(m_mediaMutex);
+    return m_frameRate;
+}
+
+bool VideoPlayer::GetInputStats(MediaIOStats& stats) const
+{
+    std::lock_guard<std::mutex> lock(m_mediaMutex);
+    MediaIO* io = MediaIO::FromContext(m_formatContext);
+    if (!io)
+        return false;
+    stats = io->GetStats();
+    return true;
+}
+
 void VideoPlayer::CleanupGDI()
 {
-    if (m_hBitmap)
-    {
-        DeleteObject(m_hBitmap);
-        m_hBitmap = nullptr;
-    }
+    if (!m_dibSections[0] && !m_dibSections[1] && !m_dibSections[2])
+        return;
     
-    if (m_hdcMem)
+    // 邮箱引用的是 DIB 段内存, 先解除引用再删除位图
+    m_rgbMailbox.Release();
+    m_outputFrame = nullptr;
+    m_outputSerial++;
+    
+    for (int i = 0; i < TripleBuffer::SLOTS; i++)
     {
-        DeleteDC(m_hdcMem);
-        m_hdcMem = nullptr;
+        if (m_dibSections[i])
+        {
+            DeleteObject(m_dibSections[i]);
+            m_dibSections[i] = nullptr;
+        }
     }
 }
 
 void VideoPlayer::CleanupD3D9()
 {
-    m_d3d9Surface.Reset();
+    ReleaseVideoResources();
     m_swapChain.Reset();
     m_d3d9Device.Reset();
     m_d3d9.Reset();
@@ -639,194 +1979,241 @@ bool VideoPlayer::HasAudio() const
 void VideoPlayer::SetScalingMode(ScalingMode mode)
 {
     m_scalingMode = mode;
+    UpdateConversionTarget();
 }
 
 void VideoPlayer::SetFilter(FilterType filter)
 {
-    m_currentFilter = filter;
+    if (filter != m_currentFilter)
+    {
+        m_currentFilter = filter;
+        m_filterVersion++;
+    }
 }
 
 void VideoPlayer::SetMosaicSize(int size)
 {
     // Clamp size to valid range (2-32 pixels)
-    m_mosaicSize = (std::max)(2, (std::min)(32, size));
+    int clamped = (std::max)(2, (std::min)(32, size));
+    if (clamped != m_mosaicSize)
+    {
+        m_mosaicSize = clamped;
+        m_filterVersion++;
+    }
 }
 
-void VideoPlayer::CalculateDisplayRect(int& displayWidth, int& displayHeight, int& offsetX, int& offsetY)
+PresenterStats VideoPlayer::GetPresenterStats() const
 {
-    // 安全检查：确保窗口和视频尺寸有效
-    if (m_windowWidth <= 0 || m_windowHeight <= 0 || m_videoWidth <= 0 || m_videoHeight <= 0)
-    {
-        displayWidth = 0;
-        displayHeight = 0;
-        offsetX = 0;
-        offsetY = 0;
-        return;
-    }
-    
-    switch (m_scalingMode)
+    PresenterStats stats;
+    stats.decodedFrames = m_decodedFrames;
+    stats.filterPasses = m_filterPasses;
+    stats.frameUploads = m_frameUploads;
+    stats.presents = m_presents;
+    return stats;
+}
+
+void VideoPlayer::UpdateConversionTarget()
+{
+    // GPU 路径 (StretchRect / 纹理采样) 缩放几乎没有开销, 按视频原始尺寸转换;
+    // GDI 和无离屏表面的 D3D9 回退路径在 CPU 上缩放, 直接按显示尺寸转换以减少像素量
+    int width = m_videoWidth;
+    int height = m_videoHeight;
+    bool gpuScales = m_useD3D9 && m_d3d9Device && m_d3d9Surface;
+    if (!gpuScales)
     {
-    case ScalingMode::FIT_TO_WINDOW:
+        int displayWidth, displayHeight, offsetX, offsetY;
+        CalculateDisplayRect(displayWidth, displayHeight, offsetX, offsetY);
+        
+        // 只在缩小时按显示尺寸转换, 放大仍由呈现端完成（缓冲区容量按视频尺寸分配）
+        if (displayWidth > 0 && displayHeight > 0 && displayWidth <= m_videoWidth && displayHeight <= m_videoHeight)
         {
-            // 保持宽高比，适应窗口，用黑边填充
-            double scaleX = (double)m_windowWidth / m_videoWidth;
-            double scaleY = (double)m_windowHeight / m_videoHeight;
-            double scale = (scaleX < scaleY) ? scaleX : scaleY; // 选择较小的缩放比例以确保视频完全显示
-            
-            // 确保缩放不会产生无效尺寸
-            if (scale <= 0.0)
-            {
-                displayWidth = 0;
-                displayHeight = 0;
-                offsetX = 0;
-                offsetY = 0;
-                return;
-            }
-            
-            displayWidth = (int)(m_videoWidth * scale);
-            displayHeight = (int)(m_videoHeight * scale);
-            
-            // 确保计算结果不为负
-            if (displayWidth < 0) displayWidth = 0;
-            if (displayHeight < 0) displayHeight = 0;
-            
-            offsetX = (m_windowWidth - displayWidth) / 2;
-            offsetY = (m_windowHeight - displayHeight) / 2;
+            width = displayWidth;
+            height = displayHeight;
         }
-        break;
-          case ScalingMode::ORIGINAL_SIZE:
+    }
+    m_convertSize = ((int64_t)width << 32) | height;
+}
+
+void VideoPlayer::PublishDecodedFrame(const FrameTiming& timing)
+{
+    // 发布路径只取决于纹理是否可用, 与滤镜无关：滤镜在呈现端切换, 暂停时也能从保留的解码帧重新生成画面
+    if (m_yuvTexturesActive && m_frame->format == m_codecContext->pix_fmt)
+    {
+        // 纹理路径：在空闲槽中保留解码帧的引用, 由渲染线程直接上传平面数据
+        int slotIndex = m_yuvExchange.WriteIndex();
+        AVFrame* slot = m_yuvFrames[slotIndex];
+        av_frame_unref(slot);
+        if (av_frame_ref(slot, m_frame) == 0)
         {
-            // 原始尺寸，居中显示
-            displayWidth = m_videoWidth;
-            displayHeight = m_videoHeight;
-            
-            // 确保视频不会超出窗口边界
-            if (displayWidth > m_windowWidth) {
-                displayWidth = m_windowWidth;
-            }
-            if (displayHeight > m_windowHeight) {
-                displayHeight = m_windowHeight;
-            }
-            
-            offsetX = (m_windowWidth - displayWidth) / 2;
-            offsetY = (m_windowHeight - displayHeight) / 2;
-            
-            // 确保偏移不为负
-            if (offsetX < 0) offsetX = 0;
-            if (offsetY < 0) offsetY = 0;
+            m_yuvTimings[slotIndex] = timing;
+            m_yuvTimings[slotIndex].convertDoneMs = timing.decodeDoneMs;
+            m_yuvExchange.Publish();
         }
-        break;
     }
+    else
+    {
+        ConvertFrameToRgb(timing);
+    }
+    m_decodedFrames++;
+}
+
+int VideoPlayer::RgbStride(int width) const
+{
+    return (width * m_rgbBytesPerPixel + m_rgbStrideAlign - 1) & ~(m_rgbStrideAlign - 1);
 }
 
-void VideoPlayer::ApplyFilter(uint8_t* buffer, int width, int height, int bytesPerPixel)
+void VideoPlayer::ConvertFrameToRgb(const FrameTiming& timing)
 {
-    switch (m_currentFilter)
+    int64_t size = m_convertSize;
+    FrameInfo info;
+    info.timing = timing;
+    info.width = (int)(size >> 32);
+    info.height = (int)(size & 0xFFFFFFFF);
+    info.stride = RgbStride(info.width);
+    if (info.width <= 0 || info.height <= 0 || (size_t)info.stride * info.height > m_rgbMailbox.FrameBytes())
+    {
+        info.width = m_videoWidth;
+        info.height = m_videoHeight;
+        info.stride = RgbStride(m_videoWidth);
+    }
+    
+    // 目标尺寸不变时直接复用现有上下文, 窗口尺寸变化后才重建
+    m_swsContext = sws_getCachedContext(
+        m_swsContext,
+        m_videoWidth, m_videoHeight, (AVPixelFormat)m_frame->format,
+        info.width, info.height, m_rgbFormat,
+        SWS_LANCZOS | SWS_FULL_CHR_H_INT | SWS_FULL_CHR_H_INP | SWS_ACCURATE_RND,
+        nullptr, nullptr, nullptr  // 使用Lanczos缩放算法，启用全色度插值和精确舍入
+    );
+    if (!m_swsContext)
+    {
+        return;
+    }
+    ApplySwsColorDetails(m_swsContext, m_frame);
+    
+    // 转换像素格式到邮箱的空闲缓冲区, 完成后提交
+    m_frameRGB->data[0] = m_rgbMailbox.WriteBuffer();
+    m_frameRGB->linesize[0] = info.stride;
     {
-    case FilterType::NONE:
-        // 不应用任何滤镜
-        break;
-    case FilterType::GRAYSCALE:
-        ApplyGrayscaleFilter(buffer, width, height, bytesPerPixel);
-        break;
-    case FilterType::MOSAIC:
-        ApplyMosaicFilter(buffer, width, height, bytesPerPixel);
-        break;
+        MetricsScope convertScope(MetricStage::CONVERT);
+        sws_scale(m_swsContext, m_frame->data, m_frame->linesize, 0, m_videoHeight,
+                 m_frameRGB->data, m_frameRGB->linesize);
     }
+    info.timing.convertDoneMs = QpcNowMs();
+    m_rgbMailbox.Publish(info);
 }
 
-void VideoPlayer::ApplyGrayscaleFilter(uint8_t* buffer, int width, int height, int bytesPerPixel)
+bool VideoPlayer::UpdateOutputFrame()
 {
-    for (int y = 0; y < height; y++)
+    // 同一帧、同一滤镜参数只处理一次, 其余重绘直接使用缓存的输出
+    // 读缓冲区在下一次 Acquire 之前归呈现端所有, 解码线程不会修改它
+    bool newFrame = m_rgbMailbox.Acquire();
+    if (m_outputFrame && !newFrame && m_filterVersion == m_outputFilterVersion)
     {
-        for (int x = 0; x < width; x++)
-        {
-            int idx = (y * width + x) * bytesPerPixel;
-            
-            if (bytesPerPixel == 4) // BGRA
-            {
-                uint8_t b = buffer[idx + 0];
-                uint8_t g = buffer[idx + 1];
-                uint8_t r = buffer[idx + 2];
-                
-                // 使用标准灰度公式: 0.299*R + 0.587*G + 0.114*B
-                uint8_t gray = (uint8_t)(0.299 * r + 0.587 * g + 0.114 * b);
-                
-                buffer[idx + 0] = gray; // B
-                buffer[idx + 1] = gray; // G
-                buffer[idx + 2] = gray; // R
-                // Alpha 通道保持不变
-            }
-            else if (bytesPerPixel == 3) // BGR
-            {
-                uint8_t b = buffer[idx + 0];
-                uint8_t g = buffer[idx + 1];
-                uint8_t r = buffer[idx + 2];
-                
-                uint8_t gray = (uint8_t)(0.299 * r + 0.587 * g + 0.114 * b);
-                
-                buffer[idx + 0] = gray; // B
-                buffer[idx + 1] = gray; // G
-                buffer[idx + 2] = gray; // R
-            }
-        }
+        return false;
+    }
+    
+    const uint8_t* source = m_rgbMailbox.ReadBuffer();
+    m_outputInfo = m_rgbMailbox.ReadInfo();
+    m_outputFromYuv = false;
+    if (m_currentFilter == FilterType::NONE)
+    {
+        m_outputFrame = source;
+    }
+    else
+    {
+        // 滤镜作用在副本上, 原始帧保持不变, 马赛克不会在重绘中叠加
+        MetricsScope filterScope(MetricStage::FILTER);
+        memcpy(m_filterBuffer, source, (size_t)m_outputInfo.stride * m_outputInfo.height);
+        ApplyFrameFilter(m_currentFilter, m_mosaicSize, m_filterBuffer,
+                         m_outputInfo.width, m_outputInfo.height, m_outputInfo.stride, m_rgbBytesPerPixel);
+        m_outputFrame = m_filterBuffer;
+        m_filterPasses++;
+    }
+    
+    m_outputFilterVersion = m_filterVersion;
+    m_outputSerial++;
+    
+    // 只有新帧计入帧节奏统计, 滤镜参数变化引起的重新生成不算
+    if (newFrame)
+    {
+        m_pendingTiming = m_outputInfo.timing;
+        m_pendingTiming.filterDoneMs = QpcNowMs();
+        m_timingPending = m_pendingTiming.sequence != 0;
     }
+    return true;
 }
 
-void VideoPlayer::ApplyMosaicFilter(uint8_t* buffer, int width, int height, int bytesPerPixel)
+bool VideoPlayer::UpdateOutputFrameFromYuv()
 {
-    for (int y = 0; y < height; y += m_mosaicSize)
+    // 纹理可用时解码线程只发布 YUV 帧引用; 需要 CPU 滤镜（马赛克）时在呈现端把读端槽中的帧转换到滤镜缓冲区
+    // 读端槽中的帧在下一次 Acquire 之前归呈现端所有, 暂停时切换滤镜也能从它重新生成
+    bool newFrame = m_yuvExchange.Acquire();
+    int slotIndex = m_yuvExchange.ReadIndex();
+    const AVFrame* frame = m_yuvFrames[slotIndex];
+    if (!frame || !frame->data[0] || !m_filterBuffer)
     {
-        for (int x = 0; x < width; x += m_mosaicSize)
-        {
-            // 计算马赛克块的平均颜色
-            int totalR = 0, totalG = 0, totalB = 0;
-            int count = 0;
-            
-            // 采样块内的像素
-            for (int dy = 0; dy < m_mosaicSize && (y + dy) < height; dy++)
-            {
-                for (int dx = 0; dx < m_mosaicSize && (x + dx) < width; dx++)
-                {
-                    int idx = ((y + dy) * width + (x + dx)) * bytesPerPixel;
-                    
-                    if (bytesPerPixel == 4) // BGRA
-                    {
-                        totalB += buffer[idx + 0];
-                        totalG += buffer[idx + 1];
-                        totalR += buffer[idx + 2];
-                    }
-                    else if (bytesPerPixel == 3) // BGR
-                    {
-                        totalB += buffer[idx + 0];
-                        totalG += buffer[idx + 1];
-                        totalR += buffer[idx + 2];
-                    }
-                    count++;
-                }
-            }
-            
-            if (count > 0)
-            {
-                uint8_t avgR = totalR / count;
-                uint8_t avgG = totalG / count;
-                uint8_t avgB = totalB / count;
-                
-                // 将平均颜色应用到整个块
-                for (int dy = 0; dy < m_mosaicSize && (y + dy) < height; dy++)
-                {
-                    for (int dx = 0; dx < m_mosaicSize && (x + dx) < width; dx++)
-                    {
-                        int idx = ((y + dy) * width + (x + dx)) * bytesPerPixel;
-                        
-                        buffer[idx + 0] = avgB; // B
-                        buffer[idx + 1] = avgG; // G
-                        buffer[idx + 2] = avgR; // R
-                    }
-                }
-            }
-        }
+        return false;
+    }
+    if (newFrame)
+    {
+        // 纹理中的画面已落后于当前帧, 切回纹理绘制时重新上传
+        m_yuvTexturesStale = true;
+    }
+    if (m_outputFrame && m_outputFromYuv && !newFrame && m_filterVersion == m_outputFilterVersion)
+    {
+        return false;
+    }
+    
+    m_presentSwsContext = sws_getCachedContext(
+        m_presentSwsContext,
+        frame->width, frame->height, (AVPixelFormat)frame->format,
+        m_videoWidth, m_videoHeight, m_rgbFormat,
+        SWS_LANCZOS | SWS_FULL_CHR_H_INT | SWS_FULL_CHR_H_INP | SWS_ACCURATE_RND,
+        nullptr, nullptr, nullptr
+    );
+    if (!m_presentSwsContext)
+    {
+        return false;
+    }
+    ApplySwsColorDetails(m_presentSwsContext, frame);
+    
+    m_outputInfo = FrameInfo{};
+    m_outputInfo.width = m_videoWidth;
+    m_outputInfo.height = m_videoHeight;
+    m_outputInfo.stride = RgbStride(m_videoWidth);
+    m_outputInfo.timing = m_yuvTimings[slotIndex];
+    uint8_t* dstData[4] = { m_filterBuffer, nullptr, nullptr, nullptr };
+    int dstStrides[4] = { m_outputInfo.stride, 0, 0, 0 };
+    {
+        MetricsScope convertScope(MetricStage::CONVERT);
+        sws_scale(m_presentSwsContext, frame->data, frame->linesize, 0, frame->height, dstData, dstStrides);
+    }
+    if (m_currentFilter != FilterType::NONE)
+    {
+        MetricsScope filterScope(MetricStage::FILTER);
+        ApplyFrameFilter(m_currentFilter, m_mosaicSize, m_filterBuffer,
+                         m_outputInfo.width, m_outputInfo.height, m_outputInfo.stride, m_rgbBytesPerPixel);
+        m_filterPasses++;
+    }
+    m_outputFrame = m_filterBuffer;
+    m_outputFromYuv = true;
+    m_outputFilterVersion = m_filterVersion;
+    m_outputSerial++;
+    
+    if (newFrame)
+    {
+        m_pendingTiming = m_outputInfo.timing;
+        m_pendingTiming.filterDoneMs = QpcNowMs();
+        m_timingPending = m_pendingTiming.sequence != 0;
     }
+    return true;
+}
+
+void VideoPlayer::CalculateDisplayRect(int& displayWidth, int& displayHeight, int& offsetX, int& offsetY)
+{
+    ::CalculateDisplayRect(m_scalingMode, m_windowWidth, m_windowHeight, m_videoWidth, m_videoHeight,
+                           displayWidth, displayHeight, offsetX, offsetY);
 }
 
 void VideoPlayer::RenderWithD3D9()
@@ -837,14 +2224,29 @@ void VideoPlayer::RenderWithD3D9()
         return;
     }
     
-    if (!m_buffer)
+    // 尺寸变化静止后在绘制前完成 Reset
+    ApplyPendingResize(false);
+    
+    if (!m_rgbMailbox.IsAllocated())
     {
         std::cerr << "Video buffer is null" << std::endl;
         return;
     }
     
-    // 应用滤镜到缓冲区
-    ApplyFilter(m_buffer, m_videoWidth, m_videoHeight, 4);
+    // 纹理路径中黑白滤镜由着色器矩阵完成, 其余情况在 CPU 上生成滤镜后的输出帧（每帧一次）
+    // 纹理可用时解码帧在 YUV 交换区中（与滤镜无关）, 由呈现端转换; 否则取 RGB 邮箱中的帧
+    bool useYuvTextures = UseYuvTextures();
+    if (!useYuvTextures)
+    {
+        if (m_yuvTexturesActive)
+        {
+            UpdateOutputFrameFromYuv();
+        }
+        else
+        {
+            UpdateOutputFrame();
+        }
+    }
     
     // 获取后备缓冲区
     ComPtr<IDirect3DSurface9> backBuffer;
@@ -868,25 +2270,49 @@ void VideoPlayer::RenderWithD3D9()
     // 清除后备缓冲区为黑色
     m_d3d9Device->Clear(0, nullptr, D3DCLEAR_TARGET, D3DCOLOR_XRGB(0, 0, 0), 1.0f, 0);
     
+    if (useYuvTextures)
+    {
+        RECT dstRect = { offsetX, offsetY, offsetX + displayWidth, offsetY + displayHeight };
+        DrawYuvTextures(dstRect);
+    }
     // 如果有离屏表面可用，使用它进行高质量缩放
-    if (m_d3d9Surface)
+    else if (m_d3d9Surface)
     {
-        // 锁定离屏表面并更新视频数据
-        D3DLOCKED_RECT lockedRect;
-        hr = m_d3d9Surface->LockRect(&lockedRect, nullptr, 0);
-        if (SUCCEEDED(hr))
+        // 只有输出帧变化时才锁定离屏表面并上传, 重绘直接使用表面中的缓存画面
+        hr = S_OK;
+        // 尺寸变化后到新尺寸帧到达之前, 输出帧可能与表面尺寸不同, 此时保留表面中的旧画面
+        bool frameFitsSurface = m_outputInfo.width == m_videoWidth && m_outputInfo.height == m_videoHeight;
+        if (m_surfaceSerial != m_outputSerial && frameFitsSurface)
         {
-            // 将视频数据复制到离屏表面
-            uint8_t* srcPtr = m_buffer;
-            uint8_t* dstPtr = (uint8_t*)lockedRect.pBits;
-            
-            for (int y = 0; y < m_videoHeight; y++)
+            D3DLOCKED_RECT lockedRect;
+            hr = m_d3d9Surface->LockRect(&lockedRect, nullptr, 0);
+            if (SUCCEEDED(hr))
             {
-                memcpy(dstPtr + y * lockedRect.Pitch, srcPtr + y * m_videoWidth * 4, m_videoWidth * 4);
+                // 将视频数据复制到离屏表面
+                const uint8_t* srcPtr = m_outputFrame;
+                uint8_t* dstPtr = (uint8_t*)lockedRect.pBits;
+                
+                if (lockedRect.Pitch == m_outputInfo.stride)
+                {
+                    // 行距相同时连同行尾填充一次复制
+                    memcpy(dstPtr, srcPtr, (size_t)lockedRect.Pitch * (m_videoHeight - 1) + m_videoWidth * 4);
+                }
+                else
+                {
+                    for (int y = 0; y < m_videoHeight; y++)
+                    {
+                        memcpy(dstPtr + y * lockedRect.Pitch, srcPtr + y * m_outputInfo.stride, m_videoWidth * 4);
+                    }
+                }
+                
+                m_d3d9Surface->UnlockRect();
+                m_surfaceSerial = m_outputSerial;
+                m_frameUploads++;
             }
-            
-            m_d3d9Surface->UnlockRect();
-            
+        }
+        
+        if (SUCCEEDED(hr))
+        {
             // 使用 StretchRect 进行高质量缩放
             RECT srcRect = { 0, 0, m_videoWidth, m_videoHeight };
             RECT dstRect = { offsetX, offsetY, offsetX + displayWidth, offsetY + displayHeight };
@@ -920,72 +2346,141 @@ void VideoPlayer::RenderWithD3D9()
         }
         
         // 使用双线性插值进行软件缩放（比最近邻插值质量更好）
-        if (m_videoWidth > 0 && m_videoHeight > 0 && m_buffer && 
+        if (m_outputInfo.width > 0 && m_outputInfo.height > 0 && m_outputFrame && 
             offsetX >= 0 && offsetY >= 0 && 
             offsetX + displayWidth <= m_windowWidth && 
             offsetY + displayHeight <= m_windowHeight)
         {
-            uint8_t* srcPtr = m_buffer;
+            const uint8_t* srcPtr = m_outputFrame;
             uint8_t* dstPtr = (uint8_t*)lockedRect.pBits + offsetY * lockedRect.Pitch + offsetX * 4;
             
-            // 计算缩放比例
-            double scaleX = (double)m_videoWidth / displayWidth;
-            double scaleY = (double)m_videoHeight / displayHeight;
-            
-            // 双线性插值缩放
-            for (int y = 0; y < displayHeight; y++)
+            if (m_outputInfo.width == displayWidth && m_outputInfo.height == displayHeight)
             {
-                double srcY = y * scaleY;
-                int srcY1 = (int)srcY;
-                int srcY2 = (srcY1 + 1 < m_videoHeight) ? srcY1 + 1 : m_videoHeight - 1;
-                double deltaY = srcY - srcY1;
-                
-                uint8_t* dstLinePtr = dstPtr + y * lockedRect.Pitch;
-                
-                for (int x = 0; x < displayWidth; x++)
+                // 已按显示尺寸转换, 逐行拷贝即可
+                for (int y = 0; y < displayHeight; y++)
                 {
-                    double srcX = x * scaleX;
-                    int srcX1 = (int)srcX;
-                    int srcX2 = (srcX1 + 1 < m_videoWidth) ? srcX1 + 1 : m_videoWidth - 1;
-                    double deltaX = srcX - srcX1;
-                    
-                    // 获取四个相邻像素
-                    uint8_t* p11 = srcPtr + (srcY1 * m_videoWidth + srcX1) * 4;
-                    uint8_t* p21 = srcPtr + (srcY1 * m_videoWidth + srcX2) * 4;
-                    uint8_t* p12 = srcPtr + (srcY2 * m_videoWidth + srcX1) * 4;
-                    uint8_t* p22 = srcPtr + (srcY2 * m_videoWidth + srcX2) * 4;
-                    
-                    // 双线性插值计算每个颜色分量
-                    for (int c = 0; c < 3; c++) // B, G, R
-                    {
-                        double top = p11[c] * (1.0 - deltaX) + p21[c] * deltaX;
-                        double bottom = p12[c] * (1.0 - deltaX) + p22[c] * deltaX;
-                        double result = top * (1.0 - deltaY) + bottom * deltaY;
-                        // 手动实现 clamp 功能
-                        int clampedResult = (int)result;
-                        if (clampedResult < 0) clampedResult = 0;
-                        if (clampedResult > 255) clampedResult = 255;
-                        dstLinePtr[x * 4 + c] = (uint8_t)clampedResult;
-                    }
-                    dstLinePtr[x * 4 + 3] = 255; // Alpha
+                    memcpy(dstPtr + y * lockedRect.Pitch, srcPtr + y * m_outputInfo.stride, displayWidth * 4);
                 }
             }
+            else
+            {
+                // 定点系数表 + SSE2 + 多线程条带的双线性缩放
+                m_scaler.Configure(m_outputInfo.width, m_outputInfo.height, displayWidth, displayHeight);
+                m_scaler.Scale(srcPtr, m_outputInfo.stride, dstPtr, lockedRect.Pitch);
+            }
         }
         
         backBuffer->UnlockRect();
     }
     
-    // 呈现到屏幕
+    // 呈现到屏幕（尺寸变化挂起期间, 旧尺寸的后备缓冲区会被拉伸到当前客户区）
     hr = m_d3d9Device->Present(nullptr, nullptr, nullptr, nullptr);
-    if (FAILED(hr))
+    m_presents++;
+    RecordPresent();
+    if (hr == D3DERR_DEVICELOST)
+    {
+        // 设备丢失后需要 Reset 才能继续渲染, 走与尺寸变化相同的路径
+        if (!m_resizePending)
+        {
+            m_pendingWidth = m_windowWidth;
+            m_pendingHeight = m_windowHeight;
+            m_resizePending = true;
+        }
+    }
+    else if (FAILED(hr))
     {
         std::cerr << "Failed to present frame" << std::endl;
     }
+    else if (m_resizeResetTime > 0.0)
+    {
+        // 尺寸变化后的首帧延迟：从最后一次尺寸变化消息到新尺寸首帧呈现
+        double now = QpcNowMs();
+        std::cout << "Resize-to-first-frame latency: " << (now - m_resizeRequestTime) << " ms ("
+                  << (now - m_resizeResetTime) << " ms after reset)" << std::endl;
+        m_resizeResetTime = 0.0;
+    }
+}
+
+void VideoPlayer::RecordPresent()
+{
+    if (m_timingPending)
+    {
+        m_pendingTiming.presentedMs = QpcNowMs();
+        if (m_firstFramePending)
+        {
+            // 启动耗时：从开始打开到第一帧呈现
+            std::cout << "Time to first frame: " << m_pendingTiming.presentedMs - m_openStartMs << " ms (open input "
+                      << m_inputOpenedMs - m_openStartMs << " ms, stream probe " << m_streamInfoMs - m_inputOpenedMs
+                      << " ms, first decode " << m_firstDecodeMs - m_streamInfoMs << " ms, device setup "
+                      << m_deviceReadyMs - m_firstDecodeMs << " ms)" << std::endl;
+            m_firstFramePending = false;
+            
+            StartupTrace::Instance().Instant("first present");
+            StartupTrace::Instance().FinishSession(STARTUP_TRACE_PATH);
+        }
+        m_frameStats.RecordPresented(m_pendingTiming);
+        m_timingPending = false;
+    }
+    else
+    {
+        m_frameStats.RecordRepeat();
+    }
+}
+
+bool VideoPlayer::ExportFrameStats(const std::string& basePath) const
+{
+    bool csv = m_frameStats.ExportCsv(basePath + ".csv");
+    bool json = m_frameStats.ExportJson(basePath + ".json");
+    if (csv && json)
+    {
+        std::cout << "Frame stats exported to " << basePath << ".csv and " << basePath << ".json" << std::endl;
+    }
+    return csv && json;
+}
+
+bool VideoPlayer::UseYuvTextures() const
+{
+    // 呈现端的绘制方式：马赛克需要块平均, 在 CPU 的 RGB 缓冲区上处理（见 UpdateOutputFrameFromYuv）
+    return m_yuvTexturesActive && m_currentFilter != FilterType::MOSAIC;
+}
+
+bool VideoPlayer::DrawYuvTextures(const RECT& dstRect)
+{
+    // 只有解码出新帧（或纹理重建）时才上传, 重绘直接使用已上传的纹理
+    // 读端槽中的帧引用在下一次 Acquire 之前不会被解码线程释放
+    bool newFrame = m_yuvExchange.Acquire();
+    const AVFrame* frame = m_yuvFrames[m_yuvExchange.ReadIndex()];
+    if ((newFrame || m_yuvTexturesStale) && frame && frame->data[0])
+    {
+        const uint8_t* planes[3] = { frame->data[0], frame->data[1], frame->data[2] };
+        const int strides[3] = { frame->linesize[0], frame->linesize[1], frame->linesize[2] };
+        if (m_yuvRenderer.Upload(planes, strides))
+        {
+            m_yuvTexturesStale = false;
+            m_frameUploads++;
+            if (newFrame)
+            {
+                m_pendingTiming = m_yuvTimings[m_yuvExchange.ReadIndex()];
+                m_pendingTiming.filterDoneMs = QpcNowMs();
+                m_timingPending = m_pendingTiming.sequence != 0;
+            }
+        }
+    }
+    
+    // 矩阵取自正在显示的帧, 切换到颜色空间不同的下一个文件时不会沿用上一个文件的矩阵
+    if (frame && frame->data[0])
+    {
+        YuvColorSpace colorSpace;
+        bool fullRange;
+        DetectYuvColor(frame, colorSpace, fullRange);
+        m_yuvRenderer.SetMatrix(MakeYuvToRgbMatrix(colorSpace, fullRange, m_currentFilter == FilterType::GRAYSCALE));
+    }
+    return m_yuvRenderer.Draw(dstRect);
 }
 
 void VideoPlayer::RenderWithGDI()
 {
-    if (!m_buffer || !m_hwnd)
+    if (!m_rgbMailbox.IsAllocated() || !m_hwnd)
         return;
 
     HDC hdc = GetDC(m_hwnd);
@@ -1006,29 +2501,6 @@ void VideoPlayer::RenderWithGDI()
         return;
     }
 
-    // 更新GDI位图，如果视频帧已准备好
-    // 注意：m_frameRGB->data[0] 应该包含最新的视频帧数据
-    // UpdateBitmap() 应该使用 m_frameRGB->data[0] 来更新 m_hBitmap
-    // 这里假设 UpdateBitmap 内部会处理 m_frameRGB 的有效性
-    // 并且 m_buffer 是指向 m_frameRGB->data[0] 的指针，或者 UpdateBitmap 使用 m_frameRGB
-    
-    // 确保 m_frameRGB 和其数据有效
-    if (!m_frameRGB || !m_frameRGB->data[0]) {
-        ReleaseDC(m_hwnd, hdc);
-        return;
-    }
-    
-    // 更新GDI位图 (假设 UpdateBitmap 使用 m_frameRGB->data[0])
-    // 或者直接在这里准备数据
-    // 为了清晰，我们假设 UpdateBitmap 负责从 m_frameRGB 更新 m_hBitmap
-    // 如果 UpdateBitmap 使用 m_buffer，确保 m_buffer 是最新的
-    // UpdateBitmap(); // 这行可能需要，取决于 UpdateBitmap 的实现
-
-    // 如果 UpdateBitmap 还没有被调用，或者需要在这里直接操作数据
-    // 我们需要确保 m_hBitmap 是最新的
-    // 这里我们假设 m_frameRGB->data[0] 包含了解码和滤镜处理后的数据
-    // 并且 m_bitmapInfo 描述的是这个数据的格式 (BGRA)
-
     // 填充黑边
     RECT clientRect;
     GetClientRect(m_hwnd, &clientRect);
@@ -1058,45 +2530,47 @@ void VideoPlayer::RenderWithGDI()
         FillRect(hdc, &rightBlackBar, (HBRUSH)GetStockObject(BLACK_BRUSH));
     }
     
-    // 创建或更新GDI位图
-    if (!m_hBitmap || m_bitmapInfo.bmiHeader.biWidth != m_videoWidth || m_bitmapInfo.bmiHeader.biHeight != -m_videoHeight)
+    // 无滤镜时输出帧就是邮箱读端的 DIB 段, 直接交给 GDI, 中间没有拷贝
+    UpdateOutputFrame();
+    if (m_outputFrame && m_outputInfo.width > 0 && m_outputInfo.height > 0)
     {
-        CleanupGDI(); // 清理旧的GDI资源
-        if (!SetupGDI()) // 重新创建GDI资源以匹配视频尺寸
+        BITMAPINFO frameInfo;
+        ZeroMemory(&frameInfo, sizeof(frameInfo));
+        frameInfo.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+        frameInfo.bmiHeader.biWidth = m_outputInfo.width;
+        frameInfo.bmiHeader.biHeight = -m_outputInfo.height; // 负值表示从上到下
+        frameInfo.bmiHeader.biPlanes = 1;
+        frameInfo.bmiHeader.biBitCount = (WORD)(m_rgbBytesPerPixel * 8);
+        frameInfo.bmiHeader.biCompression = BI_RGB;
+        
+        if (m_outputInfo.width == displayWidth && m_outputInfo.height == displayHeight)
+        {
+            // 已按显示尺寸转换（缩小）, 1:1 输出
+            SetDIBitsToDevice(hdc, offsetX, offsetY, displayWidth, displayHeight,
+                0, 0, 0, displayHeight, m_outputFrame, &frameInfo, DIB_RGB_COLORS);
+        }
+        else
         {
-            ReleaseDC(m_hwnd, hdc);
-            return; // 如果创建失败则返回
+            // 播放时用 COLORONCOLOR 快速缩放; 暂停/停止时画面静止, 改用 HALFTONE 获得更好的抗锯齿效果
+            if (m_isPlaying && !m_isPaused)
+            {
+                SetStretchBltMode(hdc, COLORONCOLOR);
+            }
+            else
+            {
+                SetStretchBltMode(hdc, HALFTONE);
+                SetBrushOrgEx(hdc, 0, 0, nullptr); // HALFTONE 模式需要设置画刷原点
+            }
+            StretchDIBits(hdc, offsetX, offsetY, displayWidth, displayHeight,
+                0, 0, m_outputInfo.width, m_outputInfo.height,
+                m_outputFrame, &frameInfo, DIB_RGB_COLORS, SRCCOPY);
         }
+        m_presents++;
+        RecordPresent();
     }
-
-    // 将视频帧数据复制到GDI位图的缓冲区
-    // m_frameRGB->data[0] 包含 BGRA 数据
-    // m_bitmapInfo.bmiHeader.biHeight 是负数，表示顶向下位图
-    // SetDIBitsToDevice 直接使用视频帧数据进行绘制，如果视频尺寸和目标区域尺寸一致
-    // StretchDIBits 用于缩放绘制
-    
-    // 将 m_frameRGB->data[0] 的内容设置到 m_hBitmap
-    // 注意：m_frameRGB 的行大小可能与 GDI 位图期望的不同，需要小心处理
-    // SetBitmapBits(m_hBitmap, m_videoHeight * m_videoWidth * 4, m_frameRGB->data[0]); // 这是一个简化，实际可能需要按行拷贝
-
-    // 使用 StretchDIBits 进行缩放和绘制
-    // m_frameRGB->data[0] 包含的是原始视频尺寸的图像数据
-    // 我们需要将其缩放到 displayWidth, displayHeight 并绘制到 (offsetX, offsetY)
     
-    // 确保 m_swsContext 用于将解码帧转换为 m_frameRGB (AV_PIX_FMT_BGRA)
-    // 并且 m_frameRGB->linesize[0] 是正确的行字节数
-
-    if (m_hBitmap && m_frameRGB && m_frameRGB->data[0])
-    {
-        // 更新位图数据
-        SetDIBits(m_hdcMem, m_hBitmap, 0, m_videoHeight, m_frameRGB->data[0], &m_bitmapInfo, DIB_RGB_COLORS);
-          // 使用 StretchBlt 进行缩放绘制
-        // 从内存DC (m_hdcMem) 中的位图 (m_hBitmap) 绘制到窗口DC (hdc)
-        SetStretchBltMode(hdc, HALFTONE); // 使用 HALFTONE 模式以获得更好的抗锯齿效果
-        SetBrushOrgEx(hdc, 0, 0, nullptr); // HALFTONE 模式需要设置画刷原点
-        StretchBlt(hdc, offsetX, offsetY, displayWidth, displayHeight,
-            m_hdcMem, 0, 0, m_videoWidth, m_videoHeight, SRCCOPY);
-    }
+    // GDI 批处理完成后 DIB 段才能交还给解码线程写入（下一次 Acquire 可能把它换出）
+    GdiFlush();
 
     ReleaseDC(m_hwnd, hdc);
 }
@@ -3,31 +3,53 @@
 #include <windows.h>
 #include <string>
 #include <memory>
+#include <atomic>
+#include <deque>
+#include <mutex>
 #include <d3d9.h>
 #include <wrl.h>
 #include "AudioPlayer.h"
+#include "D3D9YuvRenderer.h"
+#include "FrameMailbox.h"
+#include "SoftwareScaler.h"
+#include "DisplayPipeline.h"
+#include "MediaIO.h"
+#include "FramePool.h"
+#include "MemoryBudget.h"
 
 extern "C" {
 #include "libavcodec/avcodec.h"
 #include "libavformat/avformat.h"
 #include "libswscale/swscale.h"
 #include "libavutil/imgutils.h"
+#include "libavutil/pixdesc.h"
 #include "libavutil/time.h"
 }
 
 using Microsoft::WRL::ComPtr;
 
-// 缩放模式枚举
-enum class ScalingMode {
-    FIT_TO_WINDOW,      // 适应窗口（保持宽高比，黑边填充）
-    ORIGINAL_SIZE       // 原始尺寸
+// 异步打开完成时投递给窗口的消息, wParam 为是否成功
+#define WM_VIDEO_OPENED (WM_APP + 1)
+// 异步打开的进度, wParam 为 OpenStage, lParam 为已读取的字节数 (KB)
+#define WM_VIDEO_OPEN_PROGRESS (WM_APP + 2)
+// 播放线程已无缝切换到预先打开的下一个文件
+#define WM_VIDEO_NEXT_STARTED (WM_APP + 3)
+// 文件播放结束且没有切换到下一个文件（未预先打开或格式不同）
+#define WM_VIDEO_ENDED (WM_APP + 4)
+
+enum class OpenStage {
+    OPENING_INPUT,          // avformat_open_input
+    PROBING_STREAMS,        // avformat_find_stream_info
+    OPENING_DECODER,
+    DECODING_FIRST_FRAME    // 预先解出第一帧
 };
 
-// 滤镜类型枚举
-enum class FilterType {
-    NONE,           // 无滤镜
-    GRAYSCALE,      // 黑白
-    MOSAIC          // 马赛克
+// 呈现统计：滤镜和上传只在出现新帧（或滤镜参数变化）时执行, 重绘只重新呈现缓存的画面
+struct PresenterStats {
+    uint64_t decodedFrames;     // 解码线程提交的 RGB/YUV 帧数
+    uint64_t filterPasses;      // 滤镜执行次数
+    uint64_t frameUploads;      // 上传到 GPU 表面/纹理的次数
+    uint64_t presents;          // 呈现次数（包含无新帧的重绘）
 };
 
 class VideoPlayer {
@@ -35,9 +57,38 @@ public:
     VideoPlayer();
     ~VideoPlayer();
     
-    // 初始化播放器
+    // 初始化播放器（同步）
     bool Initialize(HWND hwnd, const std::string& videoPath);
     
+    // 异步打开：后台线程完成解复用器探测、解码器打开并预先解出第一帧, 完成后投递 WM_VIDEO_OPENED;
+    // UI 线程收到后调用 FinishOpen 创建渲染设备并立即显示第一帧。打开期间其余接口不访问 FFmpeg 状态
+    bool BeginOpen(HWND hwnd, const std::string& videoPath);
+    bool FinishOpen();
+    // 中断正在进行的打开（通过 AVIOInterruptCB 中止阻塞的读取）, 并丢弃已投递的打开消息
+    void CancelOpen();
+    bool IsOpening() const { return m_openThread != nullptr; }
+    
+    // 播放列表：在后台预先打开下一个文件（探测流、打开解码器、解出第一帧并保留期间的音频包）,
+    // 当前文件读完时播放线程直接换入, 渲染设备和音频设备保持不变, 上一个文件排队的音频播放完后紧接着播放新文件
+    // 视频尺寸或像素格式与当前文件不同时不能换入, 改为投递 WM_VIDEO_ENDED 由调用方重新打开。空路径取消预先打开
+    void SetNextFile(const std::string& path);
+    
+    // 循环播放：在 [start, end) 区间内循环, end <= start 表示到文件末尾（start 为 0 时即整个文件循环）
+    // 后台线程预先把第二个解码上下文定位到循环起点并解出第一帧, 从关键帧解码到起点的开销不落在循环点上;
+    // 到达循环终点时播放线程直接换入, 音频在循环点交叉淡化。循环优先于播放列表的下一个文件
+    void SetLoop(bool enabled, double start, double end);
+    bool IsLoopEnabled() const { return m_loopEnabled; }
+    double GetLoopStart() const { return m_loopStart; }
+    double GetLoopEnd() const { return m_loopEnd; }
+    
+    // 本地文件的读取方式（默认本地磁盘内存映射、其余预读）和预读窗口（字节, 0 表示不预读）; 下一次打开文件时生效
+    void SetInputMode(MediaInputMode mode) { m_inputMode = mode; }
+    MediaInputMode GetInputMode() const { return m_inputMode; }
+    void SetReadAhead(size_t bytes) { m_readAhead = bytes; }
+    size_t GetReadAhead() const { return m_readAhead; }
+    // 当前文件的输入统计（读取吞吐量、解复用等待、跳转命中缓存次数）, 使用 FFmpeg 的文件协议时返回 false
+    bool GetInputStats(MediaIOStats& stats) const;
+    
     // 播放控制
     void Play();
     void Pause();
@@ -45,9 +96,18 @@ public:
     void Seek(double seconds);
       // 获取状态
     bool IsPlaying() const { return m_isPlaying; }
-    double GetDuration() const { return m_duration; }
+    double GetDuration() const;
     double GetCurrentTime() const { return m_currentTime; }
-    double GetFrameRate() const { return m_frameRate; }
+    double GetFrameRate() const;
+    
+    // 变速播放 (0.5x - 4x), 高倍速时只解码关键帧
+    void SetPlaybackSpeed(double speed);
+    double GetPlaybackSpeed() const { return m_playbackSpeed; }
+    
+    // 视频可见性：窗口最小化或关闭视频轨道时只解码音频, 恢复后从下一个关键帧继续
+    void SetVideoVisible(bool visible);
+    void SetVideoTrackEnabled(bool enabled);
+    bool IsVideoTrackEnabled() const { return m_videoTrackEnabled; }
       // 音频控制
     void SetVolume(float volume);
     bool HasAudio() const;
@@ -61,8 +121,12 @@ public:
     void Render();
     
     // 窗口尺寸改变时调用
+    // D3D9 下只记录新尺寸, 连续的尺寸变化合并为一次设备 Reset（拖动期间旧后备缓冲区由 Present 拉伸显示）
     void OnResize(int width, int height);
     
+    // 执行挂起的尺寸变化; force 为 false 时仅在最后一次尺寸变化后静止一段时间才执行
+    void ApplyPendingResize(bool force);
+    
     // 缩放模式控制
     void SetScalingMode(ScalingMode mode);
     ScalingMode GetScalingMode() const { return m_scalingMode; }
@@ -71,6 +135,12 @@ public:
     FilterType GetCurrentFilter() const { return m_currentFilter; }
     void SetMosaicSize(int size);
     int GetMosaicSize() const { return m_mosaicSize; }
+    
+    PresenterStats GetPresenterStats() const;
+    
+    // 帧节奏统计（只在 UI 线程访问）, 导出时写入 basePath.csv 和 basePath.json
+    const FrameStatsRecorder& GetFrameStats() const { return m_frameStats; }
+    bool ExportFrameStats(const std::string& basePath) const;
 
 private:    // FFmpeg 相关
     AVFormatContext* m_formatContext;
@@ -80,6 +150,7 @@ private:    // FFmpeg 相关
     AVFrame* m_frameRGB;
     AVPacket* m_packet;
     struct SwsContext* m_swsContext;
+    struct SwsContext* m_presentSwsContext; // 呈现端把 YUV 交换区中的帧转换为 RGB（纹理路径下的 CPU 滤镜）
       // 视频信息
     int m_videoStreamIndex;
     double m_duration;
@@ -89,11 +160,17 @@ private:    // FFmpeg 相关
     // 播放状态
     bool m_isPlaying;
     bool m_isPaused;
+    double m_playbackSpeed;     // 播放速度
+    bool m_keyframeOnly;        // 当前是否处于仅关键帧解码模式（播放线程）
+    bool m_waitForKeyframe;     // 丢弃视频包直到下一个关键帧
+    bool m_videoVisible;        // 窗口是否可见（未最小化）
+    bool m_videoTrackEnabled;   // 用户是否启用视频轨道
+    bool m_audioOnly;           // 当前是否处于纯音频模式（播放线程）
+    
+    static const double KEYFRAME_ONLY_SPEED;   // 达到该速度后只解码关键帧
       // Win32 相关
     HWND m_hwnd;
-    HDC m_hdcMem;
-    HBITMAP m_hBitmap;
-    BITMAPINFO m_bitmapInfo;
+    HBITMAP m_dibSections[TripleBuffer::SLOTS];    // GDI：邮箱的三个帧缓冲区, sws_scale 直接写入
       // Direct3D 9 相关
     ComPtr<IDirect3D9> m_d3d9;
     ComPtr<IDirect3DDevice9> m_d3d9Device;
@@ -103,16 +180,65 @@ private:    // FFmpeg 相关
     D3DPRESENT_PARAMETERS m_d3dpp;
     bool m_useD3D9;
     
+    // YUV 纹理渲染路径（着色器完成颜色转换和缩放）
+    D3D9YuvRenderer m_yuvRenderer;
+    bool m_yuvSupported;            // 源像素格式是否为 8 位平面 YUV
+    std::atomic<bool> m_yuvTexturesActive;  // 纹理路径是否可用（设备创建成功）; UI 线程设置, 解码线程据此选择发布路径
+    int m_chromaShiftX;
+    int m_chromaShiftY;
+    AVFrame* m_yuvFrames[TripleBuffer::SLOTS];  // 解码帧引用, 三缓冲交换
+    FrameTiming m_yuvTimings[TripleBuffer::SLOTS];  // 与 m_yuvFrames 同槽的时间戳
+    TripleBuffer m_yuvExchange;
+    bool m_yuvTexturesStale;        // 纹理重建后需要重新上传当前帧
+    
+    // 尺寸变化合并（m_windowWidth/Height 始终等于当前后备缓冲区尺寸）
+    bool m_resizePending;
+    int m_pendingWidth;
+    int m_pendingHeight;
+    int m_resizeEventCount;         // 本次合并的尺寸变化消息数
+    double m_resizeRequestTime;     // 最后一次尺寸变化的时间（毫秒）
+    double m_resizeResetTime;       // Reset 完成的时间, 0 表示无待统计的首帧
+    
+    static const double RESIZE_DEBOUNCE_MS;
+    
     // 显示相关
     int m_windowWidth;
     int m_windowHeight;
     int m_videoWidth;
     int m_videoHeight;
-    uint8_t* m_buffer;
+    // 解码线程与 UI 线程之间的 RGB 帧交换：解码端写空闲缓冲区, 呈现端取最新完整帧, 互不阻塞
+    FrameMailbox m_rgbMailbox;
+    uint8_t* m_filterBuffer;        // 滤镜输出（不修改原始帧, 滤镜变化时可从原始帧重新生成）
+    MemoryCharge m_filterCharge;
+    const uint8_t* m_outputFrame;   // 当前用于呈现的帧：无滤镜时指向邮箱的读缓冲区, 否则指向 m_filterBuffer
+    FrameInfo m_outputInfo;         // m_outputFrame 的尺寸（按显示尺寸转换时小于视频尺寸）
+    bool m_outputFromYuv;           // m_outputFrame 由呈现端从 YUV 交换区的帧转换而来
+    AVPixelFormat m_rgbFormat;      // BGRA (D3D9) 或 BGR24 (GDI)
+    int m_rgbBytesPerPixel;
+    int m_rgbStrideAlign;           // RGB 帧行字节数的对齐：GDI DIB 段为 4, 其余为 64（每行从缓存行开始）
+    
+    // 转换目标尺寸 (宽 << 32 | 高), 由 UI 线程设置, 解码线程据此惰性重建 SwsContext
+    std::atomic<int64_t> m_convertSize;
+    int m_filterVersion;            // 滤镜参数每变化一次加一
+    int m_outputFilterVersion;
+    uint64_t m_outputSerial;        // 输出内容每更新一次加一
+    uint64_t m_surfaceSerial;       // 离屏表面中内容对应的输出序号
+    
+    std::atomic<uint64_t> m_decodedFrames;
+    uint64_t m_filterPasses;
+    uint64_t m_frameUploads;
+    uint64_t m_presents;
+    
+    SoftwareScaler m_scaler;        // 没有离屏表面时的软件缩放
+    
+    // 帧节奏统计：新帧的时间戳在取帧时暂存, 呈现完成后提交
+    FrameStatsRecorder m_frameStats;
+    FrameTiming m_pendingTiming;
+    bool m_timingPending;
       // 线程相关
     HANDLE m_playThread;
     HANDLE m_renderEvent;
-    bool m_shouldStop;
+    std::atomic<bool> m_shouldStop;
       // 音频播放器
     AudioPlayer m_audioPlayer;
     double m_audioOffset;  // 音频偏移量（秒）
@@ -121,21 +247,151 @@ private:    // FFmpeg 相关
     FilterType m_currentFilter;
     int m_mosaicSize;  // 马赛克块大小
     
+    // 异步打开（m_openThread 只由 UI 线程修改）
+    HANDLE m_openThread;
+    std::string m_openPath;
+    std::atomic<bool> m_openCancel;
+    bool m_openAsync;               // 打开线程运行期间为 true, 此时投递进度消息
+    bool m_openSucceeded;
+    std::atomic<int> m_openStage;
+    double m_openProgressMs;        // 上一次投递进度消息的时间（打开线程）
+    
+    // 启动耗时（毫秒, QPC 时间）, 第一帧呈现时输出
+    double m_openStartMs;
+    double m_inputOpenedMs;
+    double m_streamInfoMs;
+    double m_firstDecodeMs;
+    double m_deviceReadyMs;
+    bool m_firstFramePending;
+    
+    // 打开阶段预先解出的第一帧保存在 m_frame 中; 寻找第一帧时读到的音频包留给播放线程
+    bool m_hasStartupFrame;
+    std::deque<AVPacket*> m_startupPackets;
+    
+    // 播放列表中预先打开的下一个文件
+    struct PreparedMedia {
+        PreparedMedia();
+        
+        std::string path;
+        AVFormatContext* formatContext;
+        AVCodecContext* codecContext;
+        AVPacket* packet;
+        AVFrame* frame;                 // 预先解出的第一帧
+        bool hasFrame;
+        int videoStreamIndex;
+        double frameRate;
+        double duration;
+        std::deque<AVPacket*> audioPackets;
+    };
+    
+    // 预先准备的状态（下一个文件和循环起点共用）
+    enum NextState {
+        NEXT_NONE,
+        NEXT_PREPARING,     // 准备线程独占 m_next / m_loopHead
+        NEXT_READY,         // 播放线程可以取走（m_next 需在 m_nextMutex 下）
+        NEXT_FAILED
+    };
+    
+    HANDLE m_nextThread;            // 只由 UI 线程创建和回收
+    std::atomic<bool> m_nextCancel;
+    std::atomic<int> m_nextState;
+    std::mutex m_nextMutex;
+    PreparedMedia m_next;
+    
+    // 循环播放：区间由 UI 线程设置后递增版本号, 播放线程据此重新应用
+    // 循环起点上下文只由播放线程和它创建的准备线程访问, 准备期间由准备线程独占
+    std::atomic<bool> m_loopEnabled;
+    std::atomic<double> m_loopStart;
+    std::atomic<double> m_loopEnd;
+    std::atomic<int> m_loopVersion;
+    int m_loopAppliedVersion;       // 以下为播放线程状态
+    bool m_loopActive;
+    double m_loopActiveStart;
+    double m_loopActiveEnd;
+    double m_loopSkipUntil;         // 回退跳转到循环起点后, 此前的视频帧和音频包丢弃（NAN 表示不丢弃）
+    HANDLE m_loopThread;
+    std::atomic<bool> m_loopCancel;
+    std::atomic<int> m_loopState;
+    PreparedMedia m_loopHead;
+    std::string m_currentPath;      // 正在播放的文件（循环起点第一次准备时重新打开）
+    
+    // 播放线程可能随时换入下一个文件或循环起点的上下文, UI 线程不直接操作当前上下文:
+    // 跳转作为请求交给播放线程在两次读包之间执行（NAN 表示没有请求）, 读取上下文信息时持有 m_mediaMutex
+    std::atomic<double> m_seekRequest;
+    mutable std::mutex m_mediaMutex;    // 换入上下文 / UI 线程读取时长、帧率和输入统计
+    
+    MediaInputMode m_inputMode;     // UI 线程设置, 打开时读取
+    size_t m_readAhead;
+    
+    static const size_t DEFAULT_READ_AHEAD;
+    static const int64_t FAST_PROBE_SIZE;
+    static const int64_t FAST_ANALYZE_DURATION;
+    static const size_t MAX_STARTUP_PACKETS;
+    static const size_t DEGRADED_STARTUP_PACKETS;
+    static const size_t MIN_BUDGETED_READ_AHEAD;
+    static const double OPEN_PROGRESS_INTERVAL_MS;
+    
     // 私有方法
     bool OpenVideo(const std::string& videoPath);
+    bool ProbeStreams(AVFormatContext* formatContext, int& videoStreamIndex, const std::atomic<bool>& cancel);
+    bool DecodeStartupFrame();
+    static bool ReadFirstVideoFrame(AVFormatContext* formatContext, AVCodecContext* codecContext, int videoStreamIndex,
+                                    AVPacket* packet, AVFrame* frame, std::deque<AVPacket*>& audioPackets,
+                                    const std::atomic<bool>& cancel);
+    void ClearStartupPackets();
+    // 暂存的音频包计入内存预算的 PACKETS; 超出预算时队列上限降低
+    static void QueueAudioPacket(std::deque<AVPacket*>& queue, AVPacket* packet);
+    static void TakeQueuedPacket(std::deque<AVPacket*>& queue, AVPacket* destination);
+    static void ClearPacketQueue(std::deque<AVPacket*>& queue);
+    // 按内存预算剩余量缩减的预读窗口
+    size_t BudgetedReadAhead() const;
+    bool SetupRenderer();
+    void PublishDecodedFrame(const FrameTiming& timing);
+    void PostOpenProgress(OpenStage stage, bool force);
+    static int OpenInterruptCallback(void* opaque);
+    static DWORD WINAPI OpenThreadProc(LPVOID lpParam);
+    bool OpenMedia(PreparedMedia& media, const std::atomic<bool>& cancel);
+    bool PrepareMedia(PreparedMedia& media);
+    static bool SeekMedia(PreparedMedia& media, double seconds, const std::atomic<bool>& cancel);
+    static void ReleaseMedia(PreparedMedia& media);
+    static int CancelInterruptCallback(void* opaque);
+    static DWORD WINAPI PrepareThreadProc(LPVOID lpParam);
+    void CancelNext();
+    // 换入预先准备的上下文, 换出的上下文留在 media 中
+    void AdoptMedia(PreparedMedia& media);
+    bool SwitchToNext();
+    void UpdateLoop();
+    bool LoopEndReached(double mediaTime) const;
+    void StartLoopHead();
+    void CancelLoopHead();
+    static DWORD WINAPI LoopThreadProc(LPVOID lpParam);
+    bool SpliceLoop();
+    // 在当前上下文中跳转：播放线程执行请求时, 或播放线程不存在时由 UI 线程直接调用
+    void SeekTo(double seconds);
     void CleanupFFmpeg();
+    void UpdateVideoDiscard();
     void CleanupGDI();
     void CleanupD3D9();
     bool SetupGDI();
     bool SetupD3D9();
+    bool ResetD3D9Device();
+    void CreateVideoResources();
+    void ReleaseVideoResources();
     void RenderWithGDI();
     void RenderWithD3D9();
-    void UpdateBitmap();
-    void CalculateDisplayRect(int& displayWidth, int& displayHeight, int& offsetX, int& offsetY);    void ApplyFilter(uint8_t* buffer, int width, int height, int bytesPerPixel);
-    void ApplyGrayscaleFilter(uint8_t* buffer, int width, int height, int bytesPerPixel);
-    void ApplyMosaicFilter(uint8_t* buffer, int width, int height, int bytesPerPixel);
+    bool UseYuvTextures() const;
+    bool DrawYuvTextures(const RECT& dstRect);
+    bool UpdateOutputFrame();
+    bool UpdateOutputFrameFromYuv();
+    void UpdateConversionTarget();
+    int RgbStride(int width) const;
+    void ConvertFrameToRgb(const FrameTiming& timing);
+    void RecordPresent();
+    void CalculateDisplayRect(int& displayWidth, int& displayHeight, int& offsetX, int& offsetY);
     
     // 静态线程函数
     static DWORD WINAPI PlayThreadProc(LPVOID lpParam);
     void PlayLoop();
+    // 提交刚解出的视频帧并等待到下一帧的时间（m_currentTime 已更新）
+    void ShowDecodedFrame(bool hasPts, double& lastFramePts, LARGE_INTEGER& lastTime, const LARGE_INTEGER& frequency);
 };
\ No newline at end of file
@@ -0,0 +1,173 @@
+#include "WorkStealingPool.h"
+#include <algorithm>
+
+static const int MAX_THREADS = 64;
+
+// 当前线程所属的线程池和队列序号, 用于把工作线程内提交的任务放入自己的队列
+static thread_local const WorkStealingPool* t_ownerPool = nullptr;
+static thread_local int t_workerIndex = -1;
+
+WorkStealingPool::WorkStealingPool()
+    : m_queued(0)
+    , m_pending(0)
+    , m_nextQueue(0)
+    , m_quit(false)
+    , m_executedTasks(0)
+    , m_stolenTasks(0)
+{
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    Stop();
+}
+
+void WorkStealingPool::Start(int threads)
+{
+    Stop();
+
+    if (threads <= 0)
+    {
+        threads = (int)std::thread::hardware_concurrency();
+    }
+    threads = (std::max)(1, (std::min)(MAX_THREADS, threads));
+
+    m_queues.clear();
+    for (int i = 0; i < threads; i++)
+    {
+        m_queues.emplace_back(new Queue());
+    }
+    m_quit = false;
+    for (int i = 0; i < threads; i++)
+    {
+        m_threads.emplace_back(&WorkStealingPool::WorkerProc, this, i);
+    }
+}
+
+void WorkStealingPool::Stop()
+{
+    if (m_threads.empty())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_quit = true;
+    }
+    m_wake.notify_all();
+    for (std::thread& thread : m_threads)
+    {
+        thread.join();
+    }
+    m_threads.clear();
+    m_queues.clear();
+    m_quit = false;
+}
+
+void WorkStealingPool::Submit(Task task)
+{
+    if (m_threads.empty())
+    {
+        // 未启动时在调用线程中直接执行
+        task();
+        m_executedTasks++;
+        return;
+    }
+
+    int index;
+    if (t_ownerPool == this)
+    {
+        index = t_workerIndex;
+    }
+    else
+    {
+        index = (int)(m_nextQueue++ % m_queues.size());
+    }
+
+    m_pending++;
+    {
+        std::lock_guard<std::mutex> lock(m_queues[index]->mutex);
+        m_queues[index]->tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_queued++;
+    }
+    m_wake.notify_one();
+}
+
+void WorkStealingPool::WaitIdle()
+{
+    std::unique_lock<std::mutex> lock(m_wakeMutex);
+    m_idle.wait(lock, [this] { return m_pending == 0; });
+}
+
+WorkStealingPoolStats WorkStealingPool::GetStats() const
+{
+    WorkStealingPoolStats stats;
+    stats.executedTasks = m_executedTasks;
+    stats.stolenTasks = m_stolenTasks;
+    return stats;
+}
+
+bool WorkStealingPool::PopLocal(int index, Task& task)
+{
+    Queue& queue = *m_queues[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty())
+        return false;
+
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    m_queued--;
+    return true;
+}
+
+bool WorkStealingPool::Steal(int thief, Task& task)
+{
+    // 从下一个线程开始依次尝试, 取队列头部（最早提交、最可能已经到期的任务）
+    int count = (int)m_queues.size();
+    for (int i = 1; i < count; i++)
+    {
+        Queue& queue = *m_queues[(thief + i) % count];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty())
+            continue;
+
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        m_queued--;
+        m_stolenTasks++;
+        return true;
+    }
+    return false;
+}
+
+void WorkStealingPool::WorkerProc(int index)
+{
+    t_ownerPool = this;
+    t_workerIndex = index;
+
+    for (;;)
+    {
+        Task task;
+        if (PopLocal(index, task) || Steal(index, task))
+        {
+            task();
+            m_executedTasks++;
+            if (--m_pending == 0)
+            {
+                std::lock_guard<std::mutex> lock(m_wakeMutex);
+                m_idle.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_wakeMutex);
+        m_wake.wait(lock, [this] { return m_queued > 0 || m_quit; });
+        if (m_quit && m_queued == 0)
+            break;
+    }
+
+    t_ownerPool = nullptr;
+    t_workerIndex = -1;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct WorkStealingPoolStats {
+    uint64_t executedTasks;
+    uint64_t stolenTasks;       // 从其它工作线程队列中窃取执行的任务数
+};
+
+// 工作窃取线程池 - 每个工作线程有自己的任务队列
+// 工作线程从自己队列的尾部取任务（后进先出, 缓存局部性好）, 队列为空时从其它线程队列的头部窃取;
+// 外部线程提交的任务轮流放入各队列, 工作线程内提交的任务放入自己的队列
+// 同一个对象上的任务是否串行由调用方保证（如每路视频同时最多一个解码任务）
+class WorkStealingPool {
+public:
+    using Task = std::function<void()>;
+
+    WorkStealingPool();
+    ~WorkStealingPool();
+
+    // 启动工作线程, 0 表示按 CPU 核心数自动选择; 已启动时先停止
+    void Start(int threads);
+    // 执行完已提交的任务后退出工作线程
+    void Stop();
+    int ThreadCount() const { return (int)m_threads.size(); }
+
+    void Submit(Task task);
+
+    // 等待已提交的任务全部执行完毕（不能在工作线程中调用）
+    void WaitIdle();
+
+    WorkStealingPoolStats GetStats() const;
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    bool PopLocal(int index, Task& task);
+    bool Steal(int thief, Task& task);
+    void WorkerProc(int index);
+
+    std::vector<std::unique_ptr<Queue>> m_queues;
+    std::vector<std::thread> m_threads;
+
+    // 队列中的任务数在 m_wakeMutex 下递增, 保证空闲线程不会错过唤醒
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_idle;
+    std::atomic<int> m_queued;          // 已入队尚未被取走的任务数
+    std::atomic<int> m_pending;         // 已提交尚未执行完的任务数
+    std::atomic<unsigned> m_nextQueue;  // 外部提交的轮转位置
+    bool m_quit;
+
+    std::atomic<uint64_t> m_executedTasks;
+    std::atomic<uint64_t> m_stolenTasks;
+};
@@ -0,0 +1,112 @@
+#include "YuvConvert.h"
+#include <cmath>
+#include <algorithm>
+
+YuvToRgbMatrix MakeYuvToRgbMatrix(YuvColorSpace colorSpace, bool fullRange, bool grayscale)
+{
+    // 亮度系数 Kr / Kb
+    double kr = (colorSpace == YuvColorSpace::BT709) ? 0.2126 : 0.299;
+    double kb = (colorSpace == YuvColorSpace::BT709) ? 0.0722 : 0.114;
+    double kg = 1.0 - kr - kb;
+
+    // 归一化样本到 Y' ∈ [0,1], U'/V' ∈ [-0.5,0.5] 的缩放和偏移
+    double yScale = fullRange ? 1.0 : 255.0 / 219.0;
+    double yOffset = fullRange ? 0.0 : 16.0 / 255.0;
+    double cScale = fullRange ? 1.0 : 255.0 / 224.0;
+    double cOffset = 128.0 / 255.0;
+
+    // 每行的 U/V 系数
+    double coef[3][2] = {
+        { 0.0,                          2.0 * (1.0 - kr) },                 // R
+        { -2.0 * kb * (1.0 - kb) / kg,  -2.0 * kr * (1.0 - kr) / kg },      // G
+        { 2.0 * (1.0 - kb),             0.0 }                               // B
+    };
+
+    YuvToRgbMatrix m;
+    for (int row = 0; row < 3; row++)
+    {
+        double cu = grayscale ? 0.0 : coef[row][0] * cScale;
+        double cv = grayscale ? 0.0 : coef[row][1] * cScale;
+        m.rows[row][0] = (float)yScale;
+        m.rows[row][1] = (float)cu;
+        m.rows[row][2] = (float)cv;
+        m.rows[row][3] = (float)(-yScale * yOffset - (cu + cv) * cOffset);
+    }
+    return m;
+}
+
+// 模拟 D3D 纹理双线性采样（钳位寻址, 纹素中心位于 (i + 0.5) / size）
+static float SampleBilinear(const uint8_t* plane, int stride, int width, int height, float u, float v)
+{
+    float tx = u * width - 0.5f;
+    float ty = v * height - 0.5f;
+    int x0 = (int)floorf(tx);
+    int y0 = (int)floorf(ty);
+    float fx = tx - x0;
+    float fy = ty - y0;
+
+    int x1 = (std::min)(x0 + 1, width - 1);
+    int y1 = (std::min)(y0 + 1, height - 1);
+    x0 = (std::max)(0, (std::min)(x0, width - 1));
+    y0 = (std::max)(0, (std::min)(y0, height - 1));
+    x1 = (std::max)(0, x1);
+    y1 = (std::max)(0, y1);
+
+    const uint8_t* row0 = plane + y0 * stride;
+    const uint8_t* row1 = plane + y1 * stride;
+    float top = row0[x0] + (row0[x1] - row0[x0]) * fx;
+    float bottom = row1[x0] + (row1[x1] - row1[x0]) * fx;
+    return (top + (bottom - top) * fy) / 255.0f;
+}
+
+void ConvertYuvToBgraReference(const uint8_t* const planes[3], const int strides[3],
+                               int srcWidth, int srcHeight, int chromaShiftX, int chromaShiftY,
+                               const YuvToRgbMatrix& matrix,
+                               uint8_t* dst, int dstStride, int dstWidth, int dstHeight)
+{
+    if (srcWidth <= 0 || srcHeight <= 0 || dstWidth <= 0 || dstHeight <= 0)
+        return;
+
+    int chromaWidth = -((-srcWidth) >> chromaShiftX);
+    int chromaHeight = -((-srcHeight) >> chromaShiftY);
+
+    for (int y = 0; y < dstHeight; y++)
+    {
+        float v = (y + 0.5f) / dstHeight;
+        uint8_t* out = dst + y * dstStride;
+
+        for (int x = 0; x < dstWidth; x++)
+        {
+            float u = (x + 0.5f) / dstWidth;
+            float yuv[4] = {
+                SampleBilinear(planes[0], strides[0], srcWidth, srcHeight, u, v),
+                SampleBilinear(planes[1], strides[1], chromaWidth, chromaHeight, u, v),
+                SampleBilinear(planes[2], strides[2], chromaWidth, chromaHeight, u, v),
+                1.0f
+            };
+
+            // 渲染目标为 BGRA, 行顺序为 R/G/B
+            for (int c = 0; c < 3; c++)
+            {
+                const float* row = matrix.rows[c];
+                float value = yuv[0] * row[0] + yuv[1] * row[1] + yuv[2] * row[2] + yuv[3] * row[3];
+                value = (std::max)(0.0f, (std::min)(1.0f, value));     // saturate
+                out[x * 4 + 2 - c] = (uint8_t)(value * 255.0f + 0.5f);
+            }
+            out[x * 4 + 3] = 255;
+        }
+    }
+}
+
+const char* const YUV_PIXEL_SHADER_SOURCE =
+    "sampler2D texY : register(s0);\n"
+    "sampler2D texU : register(s1);\n"
+    "sampler2D texV : register(s2);\n"
+    "float4 rowR : register(c0);\n"
+    "float4 rowG : register(c1);\n"
+    "float4 rowB : register(c2);\n"
+    "float4 main(float2 uv : TEXCOORD0) : COLOR0\n"
+    "{\n"
+    "    float4 yuv = float4(tex2D(texY, uv).r, tex2D(texU, uv).r, tex2D(texV, uv).r, 1.0);\n"
+    "    return float4(saturate(float3(dot(yuv, rowR), dot(yuv, rowG), dot(yuv, rowB))), 1.0);\n"
+    "}\n";
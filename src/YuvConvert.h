@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+
+// YUV → RGB 颜色转换
+// D3D9 纹理渲染路径把 Y/U/V 平面作为三张 L8 纹理上传, 在像素着色器中完成颜色转换和缩放;
+// 这里提供同一套矩阵以及着色器数学的软件参考实现（逐像素模拟纹理双线性采样和矩阵运算）,
+// 不依赖 Windows/D3D, 可在任何平台上对比验证着色器的转换结果
+
+enum class YuvColorSpace {
+    BT601,      // 标清
+    BT709       // 高清
+};
+
+// 3x4 转换矩阵, 每行对应一个输出通道: (Y, U, V, 1) · row
+// 输入输出均为 [0, 1] 归一化值（即 8 位样本 / 255）, 与着色器常量寄存器 c0-c2 布局一致
+struct YuvToRgbMatrix {
+    float rows[3][4];
+};
+
+// fullRange 为 true 表示 JPEG 全范围 (0-255), 否则为广播有限范围 (Y 16-235, UV 16-240)
+// grayscale 为 true 时去掉色度分量, 只输出亮度（黑白滤镜）
+YuvToRgbMatrix MakeYuvToRgbMatrix(YuvColorSpace colorSpace, bool fullRange, bool grayscale = false);
+
+// 软件参考实现：把 srcWidth x srcHeight 的平面 YUV 图像转换并缩放到 dstWidth x dstHeight 的 BGRA
+// 色度平面尺寸为 ceil(srcWidth >> chromaShiftX) x ceil(srcHeight >> chromaShiftY)
+// 采样方式与着色器相同：输出像素中心映射到归一化纹理坐标, 三个平面各自按钳位寻址做双线性采样
+void ConvertYuvToBgraReference(const uint8_t* const planes[3], const int strides[3],
+                               int srcWidth, int srcHeight, int chromaShiftX, int chromaShiftY,
+                               const YuvToRgbMatrix& matrix,
+                               uint8_t* dst, int dstStride, int dstWidth, int dstHeight);
+
+// ps_2_0 像素着色器源码（HLSL）, 入口函数 main
+// s0/s1/s2 为 Y/U/V 纹理, c0-c2 为 YuvToRgbMatrix 的三行
+extern const char* const YUV_PIXEL_SHADER_SOURCE;
@@ -1,10 +1,16 @@
 #include <windows.h>
 #include <commdlg.h>
 #include <string>
+#include <vector>
 #include <iostream>
+#include <algorithm>
+#include <cstdlib>
 #include "VideoPlayer.h"
+#include "GridPlayer.h"
 #include "ProgressBar.h"
 #include "ControlPanel.h"
+#include "FrameStatsOverlay.h"
+#include "PlayerMetrics.h"
 
 // 窗口类名和标题
 const char* g_className = "FFmpegVideoPlayer";
@@ -14,14 +20,48 @@ const char* g_windowTitle = "FFmpeg Video Player";
 VideoPlayer* g_player = nullptr;
 ProgressBar* g_progressBar = nullptr;
 ControlPanel* g_controlPanel = nullptr;
+FrameStatsOverlay* g_statsOverlay = nullptr;
+GridPlayer* g_grid = nullptr;      // 多路宫格播放（激活时代替单路播放器绘制和响应按键）
 HWND g_hwnd = nullptr;
 UINT_PTR g_timerId = 0;
+bool g_inSizeMove = false;  // 是否正在拖动窗口边框
+std::string g_openingFile;  // 后台打开中（或最近打开）的文件
+std::vector<std::string> g_playlist;    // 播放列表（单文件播放时为空）
+size_t g_playlistIndex = 0;             // 当前播放的列表项
+bool g_playlistLoop = true;             // 列表播放完后从头循环
 
 // 菜单ID
 #define ID_FILE_OPEN 1001
+#define ID_FILE_OPEN_GRID 1002
+#define ID_FILE_OPEN_PLAYLIST 1003
+#define ID_FILE_BENCHMARK_INPUT 1004
 #define ID_PLAY_PLAY 2001
 #define ID_PLAY_PAUSE 2002
 #define ID_PLAY_STOP 2003
+#define ID_PLAY_VIDEO_TRACK 2004
+#define ID_PLAY_FRAME_STATS 2005
+#define ID_PLAY_EXPORT_STATS 2006
+#define ID_PLAY_LOOP_PLAYLIST 2007
+#define ID_PLAY_LOOP_FILE 2008
+#define ID_PLAY_LOOP_START 2009
+#define ID_PLAY_LOOP_END 2010
+#define ID_PLAY_LOOP_CLEAR 2011
+#define ID_PLAY_MEMORY_STATS 2012
+#define ID_PLAY_METRICS 2013
+#define ID_PLAY_METRICS_DUMP 2014
+
+// 文件读取方式菜单ID（顺序与 MediaInputMode 相同）
+#define ID_INPUT_AUTO 2201
+#define ID_INPUT_PREFETCH 2202
+#define ID_INPUT_MAPPED 2203
+#define ID_INPUT_FFMPEG 2204
+
+// 播放速度菜单ID
+#define ID_SPEED_050 2101
+#define ID_SPEED_100 2102
+#define ID_SPEED_150 2103
+#define ID_SPEED_200 2104
+#define ID_SPEED_400 2105
 
 // 缩放模式菜单ID
 #define ID_SCALE_FIT 3001
@@ -32,6 +72,12 @@ UINT_PTR g_timerId = 0;
 #define ID_FILTER_GRAYSCALE 4002
 #define ID_FILTER_MOSAIC 4003
 
+// 音频延迟菜单ID
+#define ID_AUDIO_LATENCY_10 5001
+#define ID_AUDIO_LATENCY_20 5002
+#define ID_AUDIO_LATENCY_50 5003
+#define ID_AUDIO_LATENCY_200 5004
+
 // 窗口过程函数声明
 LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam);
 
@@ -49,6 +95,11 @@ void OnControlPanelChanged(ControlType type, double value, void* userData)
 {
     if (!g_player) return;
     
+    if (type == CONTROL_VOLUME && g_grid)
+    {
+        g_grid->SetVolume((float)(value / 100.0));
+    }
+    
     switch (type)
     {
     case CONTROL_AUDIO_OFFSET:
@@ -57,7 +108,8 @@ void OnControlPanelChanged(ControlType type, double value, void* userData)
     case CONTROL_VOLUME:
         if (g_player->GetAudioPlayer())
         {
-            g_player->GetAudioPlayer()->SetVolume((float)value);
+            // 控制面板回调的音量单位为百分比
+            g_player->GetAudioPlayer()->SetVolume((float)(value / 100.0));
         }
         break;
     case CONTROL_MOSAIC_SIZE:
@@ -84,6 +136,9 @@ HMENU CreateMenuBar()
     // 文件菜单
     HMENU hFileMenu = CreatePopupMenu();
     AppendMenu(hFileMenu, MF_STRING, ID_FILE_OPEN, "&Open Video...");
+    AppendMenu(hFileMenu, MF_STRING, ID_FILE_OPEN_PLAYLIST, "Open &Playlist...");
+    AppendMenu(hFileMenu, MF_STRING, ID_FILE_OPEN_GRID, "Open &Grid...");
+    AppendMenu(hFileMenu, MF_STRING, ID_FILE_BENCHMARK_INPUT, "&Benchmark Input...");
     AppendMenu(hMenuBar, MF_POPUP, (UINT_PTR)hFileMenu, "&File");
     
     // 播放菜单
@@ -91,6 +146,32 @@ HMENU CreateMenuBar()
     AppendMenu(hPlayMenu, MF_STRING, ID_PLAY_PLAY, "&Play");
     AppendMenu(hPlayMenu, MF_STRING, ID_PLAY_PAUSE, "&Pause");
     AppendMenu(hPlayMenu, MF_STRING, ID_PLAY_STOP, "&Stop");
+    AppendMenu(hPlayMenu, MF_STRING | MF_CHECKED, ID_PLAY_VIDEO_TRACK, "&Video Track");
+    AppendMenu(hPlayMenu, MF_STRING | MF_CHECKED, ID_PLAY_LOOP_PLAYLIST, "&Loop Playlist");
+    AppendMenu(hPlayMenu, MF_STRING, ID_PLAY_LOOP_FILE, "Loop &File");
+    AppendMenu(hPlayMenu, MF_STRING, ID_PLAY_LOOP_START, "Set Loop Start (&A)\t[");
+    AppendMenu(hPlayMenu, MF_STRING, ID_PLAY_LOOP_END, "Set Loop End (&B)\t]");
+    AppendMenu(hPlayMenu, MF_STRING, ID_PLAY_LOOP_CLEAR, "&Clear Loop\t\\");
+    AppendMenu(hPlayMenu, MF_STRING, ID_PLAY_FRAME_STATS, "Frame &Statistics\tF3");
+    AppendMenu(hPlayMenu, MF_STRING, ID_PLAY_EXPORT_STATS, "&Export Frame Statistics");
+    AppendMenu(hPlayMenu, MF_STRING, ID_PLAY_MEMORY_STATS, "&Memory Usage");
+    AppendMenu(hPlayMenu, MF_STRING, ID_PLAY_METRICS, "Pipeline Me&trics");
+    AppendMenu(hPlayMenu, MF_STRING, ID_PLAY_METRICS_DUMP, "&Dump Metrics to File");
+    
+    HMENU hSpeedMenu = CreatePopupMenu();
+    AppendMenu(hSpeedMenu, MF_STRING, ID_SPEED_050, "0.5x");
+    AppendMenu(hSpeedMenu, MF_STRING | MF_CHECKED, ID_SPEED_100, "1x");
+    AppendMenu(hSpeedMenu, MF_STRING, ID_SPEED_150, "1.5x");
+    AppendMenu(hSpeedMenu, MF_STRING, ID_SPEED_200, "2x");
+    AppendMenu(hSpeedMenu, MF_STRING, ID_SPEED_400, "4x");
+    AppendMenu(hPlayMenu, MF_POPUP, (UINT_PTR)hSpeedMenu, "Spee&d");
+    
+    HMENU hInputMenu = CreatePopupMenu();
+    AppendMenu(hInputMenu, MF_STRING | MF_CHECKED, ID_INPUT_AUTO, "&Auto");
+    AppendMenu(hInputMenu, MF_STRING, ID_INPUT_PREFETCH, "&Read-Ahead Cache");
+    AppendMenu(hInputMenu, MF_STRING, ID_INPUT_MAPPED, "&Memory-Mapped");
+    AppendMenu(hInputMenu, MF_STRING, ID_INPUT_FFMPEG, "&FFmpeg File Protocol");
+    AppendMenu(hPlayMenu, MF_POPUP, (UINT_PTR)hInputMenu, "&Input");
     AppendMenu(hMenuBar, MF_POPUP, (UINT_PTR)hPlayMenu, "&Playback");
       // 缩放模式菜单
     HMENU hScaleMenu = CreatePopupMenu();
@@ -105,6 +186,14 @@ HMENU CreateMenuBar()
     AppendMenu(hFilterMenu, MF_STRING, ID_FILTER_MOSAIC, "&Mosaic");
     AppendMenu(hMenuBar, MF_POPUP, (UINT_PTR)hFilterMenu, "F&ilters");
     
+    // 音频延迟菜单
+    HMENU hAudioMenu = CreatePopupMenu();
+    AppendMenu(hAudioMenu, MF_STRING, ID_AUDIO_LATENCY_10, "Latency &10 ms");
+    AppendMenu(hAudioMenu, MF_STRING, ID_AUDIO_LATENCY_20, "Latency &20 ms");
+    AppendMenu(hAudioMenu, MF_STRING | MF_CHECKED, ID_AUDIO_LATENCY_50, "Latency &50 ms");
+    AppendMenu(hAudioMenu, MF_STRING, ID_AUDIO_LATENCY_200, "Latency 2&00 ms");
+    AppendMenu(hMenuBar, MF_POPUP, (UINT_PTR)hAudioMenu, "&Audio");
+    
     return hMenuBar;
 }
 
@@ -134,9 +223,235 @@ std::string OpenFileDialog(HWND hwnd)
     return "";
 }
 
+// 多选打开文件对话框（宫格播放）
+std::vector<std::string> OpenMultipleFilesDialog(HWND hwnd)
+{
+    std::vector<std::string> files;
+    std::vector<char> buffer(32768, 0);
+    
+    OPENFILENAME ofn;
+    ZeroMemory(&ofn, sizeof(ofn));
+    ofn.lStructSize = sizeof(ofn);
+    ofn.hwndOwner = hwnd;
+    ofn.lpstrFile = buffer.data();
+    ofn.nMaxFile = (DWORD)buffer.size();
+    ofn.lpstrFilter = "Video Files\0*.mp4;*.avi;*.mkv;*.mov;*.wmv;*.flv\0All Files\0*.*\0";
+    ofn.nFilterIndex = 1;
+    ofn.lpstrInitialDir = "demo_video";
+    ofn.Flags = OFN_PATHMUSTEXIST | OFN_FILEMUSTEXIST | OFN_ALLOWMULTISELECT | OFN_EXPLORER;
+    
+    if (!GetOpenFileName(&ofn))
+    {
+        return files;
+    }
+    
+    // 多选时缓冲区依次为目录和各文件名（以空字符分隔, 双空字符结束）; 单选时只有完整路径
+    const char* p = buffer.data();
+    std::string directory = p;
+    p += directory.size() + 1;
+    if (*p == '\0')
+    {
+        files.push_back(directory);
+        return files;
+    }
+    while (*p)
+    {
+        std::string name = p;
+        files.push_back(directory + "\\" + name);
+        p += name.size() + 1;
+    }
+    return files;
+}
+
+// 在后台打开文件, 完成后收到 WM_VIDEO_OPENED; 打开期间按 Esc 取消
+// 循环区间变化后更新菜单勾选状态
+void UpdateLoopMenu(HWND hwnd)
+{
+    bool enabled = g_player && g_player->IsLoopEnabled();
+    CheckMenuItem(GetMenu(hwnd), ID_PLAY_LOOP_FILE, enabled ? MF_CHECKED : MF_UNCHECKED);
+    if (enabled)
+    {
+        double end = g_player->GetLoopEnd();
+        std::cout << "Loop: " << g_player->GetLoopStart() << "s - ";
+        if (end > g_player->GetLoopStart())
+            std::cout << end << "s" << std::endl;
+        else
+            std::cout << "end of file" << std::endl;
+    }
+    else
+    {
+        std::cout << "Loop: off" << std::endl;
+    }
+}
+
+// 在控制台输出内存预算和各类别的使用量（进程内所有播放器合计）
+void PrintMemoryStats()
+{
+    MemoryBudgetStats stats = MemoryBudget::Instance().GetStats();
+    const double MB = 1024.0 * 1024.0;
+    std::cout << "Memory: " << stats.totalBytes / MB << " MB in use, peak " << stats.peakTotalBytes / MB << " MB, budget ";
+    if (stats.limit > 0)
+        std::cout << stats.limit / MB << " MB";
+    else
+        std::cout << "unlimited";
+    std::cout << ", " << stats.degradations << " degradations" << std::endl;
+    for (int i = 0; i < (int)MemoryCategory::COUNT; i++)
+    {
+        const MemoryCategoryStats& category = stats.categories[i];
+        std::cout << "  " << MemoryBudget::CategoryName((MemoryCategory)i) << ": " << category.bytes / MB
+                  << " MB (peak " << category.peakBytes / MB << " MB, " << category.allocations << " allocations)" << std::endl;
+    }
+}
+
+// 在控制台输出各阶段的耗时分布和计数（进程内所有播放器合计）
+void PrintMetrics()
+{
+    MetricsSnapshot snapshot = PlayerMetrics::Instance().GetStats();
+    if (!snapshot.enabled)
+    {
+        std::cout << "Metrics are disabled in this build (PLAYER_METRICS=0)" << std::endl;
+        return;
+    }
+    std::cout << "Metrics over " << snapshot.uptimeMs / 1000.0 << " s (us: mean / p50 / p99 / max):" << std::endl;
+    for (int i = 0; i < (int)MetricStage::COUNT; i++)
+    {
+        const LatencySummary& stage = snapshot.stages[i];
+        std::cout << "  " << PlayerMetrics::StageName((MetricStage)i) << ": " << stage.count << " x "
+                  << stage.meanUs << " / " << stage.p50Us << " / " << stage.p99Us << " / " << stage.maxUs << std::endl;
+    }
+    for (int i = 0; i < (int)MetricCounter::COUNT; i++)
+    {
+        std::cout << "  " << PlayerMetrics::CounterName((MetricCounter)i) << ": " << snapshot.counters[i] << std::endl;
+    }
+    for (int i = 0; i < (int)MetricGauge::COUNT; i++)
+    {
+        std::cout << "  " << PlayerMetrics::GaugeName((MetricGauge)i) << ": " << snapshot.gauges[i] << std::endl;
+    }
+}
+
+// 开始或停止每秒把指标快照追加到当前目录下的 metrics.jsonl
+void ToggleMetricsDump(HWND hwnd)
+{
+    PlayerMetrics& metrics = PlayerMetrics::Instance();
+    if (metrics.IsDumping())
+    {
+        metrics.StopDump();
+        std::cout << "Metrics dump stopped" << std::endl;
+    }
+    else
+    {
+        metrics.StartDump("metrics.jsonl", 1000);
+    }
+    if (hwnd)
+    {
+        CheckMenuItem(GetMenu(hwnd), ID_PLAY_METRICS_DUMP, metrics.IsDumping() ? MF_CHECKED : MF_UNCHECKED);
+    }
+}
+
+// 命令行 --memory-budget=<MB> 设置进程的内存预算（默认不限制）
+// --metrics-dump 启动时开始把指标写入 metrics.jsonl
+void ApplyCommandLine(const std::string& commandLine)
+{
+    if (commandLine.find("--metrics-dump") != std::string::npos)
+    {
+        PlayerMetrics::Instance().StartDump("metrics.jsonl", 1000);
+    }
+    
+
+    static const std::string budgetOption = "--memory-budget=";
+    size_t pos = commandLine.find(budgetOption);
+    if (pos != std::string::npos)
+    {
+        long long megabytes = atoll(commandLine.c_str() + pos + budgetOption.size());
+        if (megabytes > 0)
+        {
+            MemoryBudget::Instance().SetLimit((uint64_t)megabytes * 1024 * 1024);
+            std::cout << "Memory budget: " << megabytes << " MB" << std::endl;
+        }
+    }
+}
+
+// 依次用各读取方式读出文件的全部数据包（不解码）, 在控制台输出解复用吞吐量
+// 第一遍只用于把文件读入系统缓存, 使各方式在相同条件下比较
+void RunInputBenchmark(const std::string& filename)
+{
+    static const MediaInputMode modes[] = { MediaInputMode::FFMPEG, MediaInputMode::PREFETCH, MediaInputMode::MAPPED };
+    HCURSOR oldCursor = SetCursor(LoadCursor(nullptr, IDC_WAIT));
+    
+    DemuxBenchmark result;
+    MediaIO::BenchmarkDemux(filename, MediaInputMode::FFMPEG, 0, result);
+    
+    std::cout << "Demux benchmark: " << filename << std::endl;
+    for (MediaInputMode mode : modes)
+    {
+        if (!MediaIO::BenchmarkDemux(filename, mode, g_player->GetReadAhead(), result))
+        {
+            std::cerr << "  " << MediaIO::ModeName(mode) << ": failed to open" << std::endl;
+            continue;
+        }
+        double megabytes = result.bytes / (1024.0 * 1024.0);
+        std::cout << "  " << MediaIO::ModeName(mode) << ": " << result.packets << " packets, " << megabytes
+                  << " MB in " << result.elapsedMs << " ms ("
+                  << (result.elapsedMs > 0.0 ? megabytes * 1000.0 / result.elapsedMs : 0.0) << " MB/s)" << std::endl;
+    }
+    
+    SetCursor(oldCursor);
+}
+
+void StartOpenFile(HWND hwnd, const std::string& filename)
+{
+    // A-B 区间属于上一个文件, 整个文件循环保持
+    if (g_player->IsLoopEnabled())
+    {
+        g_player->SetLoop(true, 0.0, 0.0);
+    }
+    
+    if (g_player->BeginOpen(hwnd, filename))
+    {
+        g_openingFile = filename;
+        SetWindowText(hwnd, (g_windowTitle + std::string(" - Opening ") + filename).c_str());
+        InvalidateRect(hwnd, nullptr, TRUE);
+    }
+    else
+    {
+        MessageBox(hwnd, "Failed to open video file!", "Error", MB_ICONERROR | MB_OK);
+    }
+}
+
+// 播放列表中当前项之后的一项, 没有时返回 -1
+int NextPlaylistIndex()
+{
+    if (g_playlist.size() < 2)
+        return -1;
+    if (g_playlistIndex + 1 < g_playlist.size())
+        return (int)g_playlistIndex + 1;
+    return g_playlistLoop ? 0 : -1;
+}
+
+// 当前项开始播放后预先打开下一项, 读完时无缝切换
+void PrepareNextPlaylistItem()
+{
+    int next = NextPlaylistIndex();
+    g_player->SetNextFile(next >= 0 ? g_playlist[next] : std::string());
+}
+
+// 播放列表切换到另一项后更新标题和进度条
+void OnPlaylistItemStarted(HWND hwnd)
+{
+    SetWindowText(hwnd, (g_windowTitle + std::string(" - [") + std::to_string(g_playlistIndex + 1) + "/" +
+                         std::to_string(g_playlist.size()) + "] " + g_playlist[g_playlistIndex]).c_str());
+    if (g_progressBar)
+    {
+        g_progressBar->SetRange(0.0, g_player->GetDuration());
+    }
+    PrepareNextPlaylistItem();
+}
+
 // 程序入口点
 int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nCmdShow)
 {
+    ApplyCommandLine(lpCmdLine ? lpCmdLine : "");
+    
     // 注册窗口类
     WNDCLASSEX wc = { 0 };
     wc.cbSize = sizeof(WNDCLASSEX);
@@ -173,11 +488,17 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
     
     // 设置菜单
     HMENU hMenu = CreateMenuBar();
+    if (PlayerMetrics::Instance().IsDumping())
+    {
+        CheckMenuItem(hMenu, ID_PLAY_METRICS_DUMP, MF_CHECKED);
+    }
     SetMenu(g_hwnd, hMenu);    // 创建视频播放器
     g_player = new VideoPlayer();
+    g_grid = new GridPlayer();
     
     // 创建进度条
     g_progressBar = new ProgressBar();
+    g_statsOverlay = new FrameStatsOverlay();
     
     // 显示窗口
     ShowWindow(g_hwnd, nCmdShow);
@@ -213,12 +534,19 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
         KillTimer(g_hwnd, g_timerId);
     }
     delete g_controlPanel;
+    delete g_grid;
+    delete g_statsOverlay;
     delete g_progressBar;
     delete g_player;
     g_controlPanel = nullptr;
+    g_grid = nullptr;
+    g_statsOverlay = nullptr;
     g_progressBar = nullptr;
     g_player = nullptr;
     
+    // 停止时写入最后一次快照
+    PlayerMetrics::Instance().StopDump();
+    
     return (int)msg.wParam;
 }
 
@@ -236,48 +564,209 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
             std::string filename = OpenFileDialog(hwnd);
             if (!filename.empty() && g_player)
             {
+                if (g_grid)
+                {
+                    g_grid->Close();
+                }
                 g_player->Stop();
-                if (g_player->Initialize(hwnd, filename))
+                g_playlist.clear();
+                StartOpenFile(hwnd, filename);
+            }
+            break;
+        }
+        case ID_FILE_BENCHMARK_INPUT:
+        {
+            std::string filename = OpenFileDialog(hwnd);
+            if (!filename.empty() && g_player)
+            {
+                RunInputBenchmark(filename);
+            }
+            break;
+        }
+        case ID_FILE_OPEN_PLAYLIST:
+        {
+            std::vector<std::string> files = OpenMultipleFilesDialog(hwnd);
+            if (!files.empty() && g_player)
+            {
+                if (g_grid)
                 {
-                    SetWindowText(hwnd, (g_windowTitle + std::string(" - ") + filename).c_str());
-                    
-                    // 设置进度条范围
-                    if (g_progressBar)
-                    {
-                        g_progressBar->SetRange(0.0, g_player->GetDuration());
-                        g_progressBar->SetSeekCallback(OnProgressBarSeek, nullptr);
-                    }
-                    
-                    // 自动开始播放
-                    g_player->Play();
-                    
-                    std::cout << "Video loaded and playing automatically" << std::endl;
+                    g_grid->Close();
+                }
+                g_player->Stop();
+                
+                // 对话框返回的顺序不固定, 按文件名排序
+                std::sort(files.begin(), files.end());
+                g_playlist = files;
+                g_playlistIndex = 0;
+                StartOpenFile(hwnd, g_playlist[0]);
+            }
+            break;
+        }
+        case ID_FILE_OPEN_GRID:
+        {
+            std::vector<std::string> files = OpenMultipleFilesDialog(hwnd);
+            if (!files.empty() && g_grid)
+            {
+                if (g_player)
+                {
+                    g_player->Stop();
+                    g_player->SetNextFile(std::string());
+                }
+                g_playlist.clear();
+                if (g_grid->Open(hwnd, files))
+                {
+                    SetWindowText(hwnd, (g_windowTitle + std::string(" - Grid (") +
+                                         std::to_string(g_grid->GetStats().tiles) + " videos)").c_str());
+                    g_grid->Play();
+                    InvalidateRect(hwnd, nullptr, TRUE);
                 }
                 else
                 {
-                    MessageBox(hwnd, "Failed to open video file!", "Error", MB_ICONERROR | MB_OK);
+                    MessageBox(hwnd, "Failed to open video files!", "Error", MB_ICONERROR | MB_OK);
                 }
             }
             break;
         }
         case ID_PLAY_PLAY:
-            if (g_player)
+            if (g_grid && g_grid->IsActive())
+            {
+                g_grid->Play();
+            }
+            else if (g_player)
             {
                 g_player->Play();
             }
             break;
         case ID_PLAY_PAUSE:
-            if (g_player)
+            if (g_grid && g_grid->IsActive())
+            {
+                g_grid->Pause();
+            }
+            else if (g_player)
             {
                 g_player->Pause();
             }
             break;        case ID_PLAY_STOP:
-            if (g_player)
+            if (g_grid && g_grid->IsActive())
             {
+                g_grid->Close();
+                SetWindowText(hwnd, g_windowTitle);
+                InvalidateRect(hwnd, nullptr, TRUE);
+            }
+            else if (g_player)
+            {
+                if (g_player->IsOpening())
+                {
+                    SetWindowText(hwnd, g_windowTitle);
+                }
                 g_player->Stop();
                 InvalidateRect(hwnd, nullptr, TRUE);
             }
             break;
+        case ID_PLAY_LOOP_PLAYLIST:
+            g_playlistLoop = !g_playlistLoop;
+            CheckMenuItem(GetMenu(hwnd), ID_PLAY_LOOP_PLAYLIST, g_playlistLoop ? MF_CHECKED : MF_UNCHECKED);
+            if (g_player && !g_playlist.empty() && g_player->IsPlaying())
+            {
+                PrepareNextPlaylistItem();
+            }
+            break;
+        case ID_PLAY_LOOP_FILE:
+            if (g_player)
+            {
+                g_player->SetLoop(!g_player->IsLoopEnabled(), 0.0, 0.0);
+                UpdateLoopMenu(hwnd);
+            }
+            break;
+        case ID_PLAY_LOOP_START:
+            if (g_player)
+            {
+                // 保留已设置且在新起点之后的终点, 否则循环到文件末尾
+                double start = g_player->GetCurrentTime();
+                double end = g_player->IsLoopEnabled() ? g_player->GetLoopEnd() : 0.0;
+                g_player->SetLoop(true, start, end > start ? end : 0.0);
+                UpdateLoopMenu(hwnd);
+            }
+            break;
+        case ID_PLAY_LOOP_END:
+            if (g_player)
+            {
+                double start = g_player->IsLoopEnabled() ? g_player->GetLoopStart() : 0.0;
+                double end = g_player->GetCurrentTime();
+                if (end > start)
+                {
+                    g_player->SetLoop(true, start, end);
+                    UpdateLoopMenu(hwnd);
+                }
+            }
+            break;
+        case ID_PLAY_LOOP_CLEAR:
+            if (g_player)
+            {
+                g_player->SetLoop(false, 0.0, 0.0);
+                UpdateLoopMenu(hwnd);
+            }
+            break;
+        case ID_INPUT_AUTO:
+        case ID_INPUT_PREFETCH:
+        case ID_INPUT_MAPPED:
+        case ID_INPUT_FFMPEG:
+            if (g_player)
+            {
+                // 下一次打开文件时生效
+                g_player->SetInputMode((MediaInputMode)(wmId - ID_INPUT_AUTO));
+                CheckMenuRadioItem(GetMenu(hwnd), ID_INPUT_AUTO, ID_INPUT_FFMPEG, wmId, MF_BYCOMMAND);
+            }
+            break;
+        case ID_PLAY_VIDEO_TRACK:
+            if (g_player)
+            {
+                bool enabled = !g_player->IsVideoTrackEnabled();
+                g_player->SetVideoTrackEnabled(enabled);
+                CheckMenuItem(GetMenu(hwnd), ID_PLAY_VIDEO_TRACK, enabled ? MF_CHECKED : MF_UNCHECKED);
+            }
+            break;
+        case ID_PLAY_FRAME_STATS:
+            if (g_statsOverlay)
+            {
+                bool visible = !g_statsOverlay->IsVisible();
+                g_statsOverlay->Show(visible);
+                CheckMenuItem(GetMenu(hwnd), ID_PLAY_FRAME_STATS, visible ? MF_CHECKED : MF_UNCHECKED);
+                InvalidateRect(hwnd, nullptr, TRUE);
+            }
+            break;
+        case ID_PLAY_MEMORY_STATS:
+            PrintMemoryStats();
+            break;
+        case ID_PLAY_METRICS:
+            PrintMetrics();
+            break;
+        case ID_PLAY_METRICS_DUMP:
+            ToggleMetricsDump(hwnd);
+            break;
+        case ID_PLAY_EXPORT_STATS:
+            if (g_player)
+            {
+                // 写入当前目录下的 frame_stats.csv 和 frame_stats.json
+                if (!g_player->ExportFrameStats("frame_stats"))
+                {
+                    MessageBox(hwnd, "Failed to export frame statistics!", "Error", MB_ICONERROR | MB_OK);
+                }
+            }
+            break;
+          // 播放速度菜单处理
+        case ID_SPEED_050:
+        case ID_SPEED_100:
+        case ID_SPEED_150:
+        case ID_SPEED_200:
+        case ID_SPEED_400:
+            if (g_player)
+            {
+                static const double speeds[] = { 0.5, 1.0, 1.5, 2.0, 4.0 };
+                g_player->SetPlaybackSpeed(speeds[wmId - ID_SPEED_050]);
+                CheckMenuRadioItem(GetMenu(hwnd), ID_SPEED_050, ID_SPEED_400, wmId, MF_BYCOMMAND);
+            }
+            break;
           // 缩放模式菜单处理
         case ID_SCALE_FIT:
             if (g_player)
@@ -328,15 +817,46 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
                 InvalidateRect(hwnd, nullptr, TRUE);
             }
             break;
+          // 音频延迟菜单处理
+        case ID_AUDIO_LATENCY_10:
+        case ID_AUDIO_LATENCY_20:
+        case ID_AUDIO_LATENCY_50:
+        case ID_AUDIO_LATENCY_200:
+            if (g_player && g_player->GetAudioPlayer())
+            {
+                LatencyProfile profile = (LatencyProfile)(wmId - ID_AUDIO_LATENCY_10);
+                if (SUCCEEDED(g_player->GetAudioPlayer()->SetLatencyProfile(profile)))
+                {
+                    CheckMenuRadioItem(GetMenu(hwnd), ID_AUDIO_LATENCY_10, ID_AUDIO_LATENCY_200, wmId, MF_BYCOMMAND);
+                }
+            }
+            break;
         }
         break;
     }case WM_SIZE:
     {
+        if (g_grid && wParam != SIZE_MINIMIZED)
+        {
+            g_grid->OnResize(LOWORD(lParam), HIWORD(lParam));
+        }
         if (g_player)
         {
+            // 最小化时没有画面可显示, 播放器切换到只解码音频
+            g_player->SetVideoVisible(wParam != SIZE_MINIMIZED);
+            if (wParam == SIZE_MINIMIZED)
+            {
+                break;
+            }
+            
             int width = LOWORD(lParam);
             int height = HIWORD(lParam);
             g_player->OnResize(width, height);
+            
+            // 拖动边框时尺寸变化由播放器合并处理, 最大化/还原等一次性变化立即生效
+            if (!g_inSizeMove)
+            {
+                g_player->ApplyPendingResize(true);
+            }
               // 重新定位进度条 - 为时间显示留出空间
             if (g_progressBar)
             {
@@ -348,12 +868,33 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
             }
         }
         break;
-    }    case WM_TIMER:
+    }
+    case WM_ENTERSIZEMOVE:
+    {
+        g_inSizeMove = true;
+        break;
+    }
+    case WM_EXITSIZEMOVE:
+    {
+        g_inSizeMove = false;
+        if (g_player)
+        {
+            g_player->ApplyPendingResize(true);
+        }
+        break;
+    }
+    case WM_TIMER:
     {
         if (wParam == 1) // 进度条更新定时器
         {
             UpdateProgressBar();
             
+            // 暂停时没有新帧触发重绘, 由定时器完成挂起的尺寸变化
+            if (g_player)
+            {
+                g_player->ApplyPendingResize(false);
+            }
+            
             // 检查进度条自动隐藏
             if (g_progressBar)
             {
@@ -364,6 +905,12 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
     }
     case WM_LBUTTONDOWN:
     {
+        // 宫格模式下点击选择焦点宫格（音频来源）
+        if (g_grid && g_grid->IsActive())
+        {
+            g_grid->SetFocus(g_grid->HitTest(LOWORD(lParam), HIWORD(lParam)));
+            break;
+        }
         if (g_progressBar)
         {
             int x = LOWORD(lParam);
@@ -395,7 +942,24 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
     {
         PAINTSTRUCT ps;
         HDC hdc = BeginPaint(hwnd, &ps);
-          if (g_player)
+        if (g_grid && g_grid->IsActive())
+        {
+            g_grid->Render(hdc);
+            EndPaint(hwnd, &ps);
+            break;
+        }
+        
+        if (g_player && g_player->IsOpening())
+        {
+            RECT rect;
+            GetClientRect(hwnd, &rect);
+            FillRect(hdc, &rect, (HBRUSH)GetStockObject(BLACK_BRUSH));
+            
+            SetTextColor(hdc, RGB(255, 255, 255));
+            SetBkMode(hdc, TRANSPARENT);
+            DrawText(hdc, "Opening video... (Esc to cancel)", -1, &rect, DT_CENTER | DT_VCENTER | DT_SINGLELINE);
+        }
+        else if (g_player)
         {
             g_player->Render();
         }
@@ -418,10 +982,32 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
             g_progressBar->OnPaint(hdc);
         }
         
+        // 绘制帧节奏统计（进度条上方）
+        if (g_statsOverlay && g_statsOverlay->IsVisible() && g_player && g_progressBar)
+        {
+            g_statsOverlay->OnPaint(hdc, g_progressBar->GetRect(), g_player->GetFrameStats());
+        }
+        
         EndPaint(hwnd, &ps);
         break;
     }    case WM_KEYDOWN:
     {
+        if (g_grid && g_grid->IsActive())
+        {
+            switch (wParam)
+            {
+            case VK_SPACE:
+                g_grid->Pause();
+                break;
+            case VK_TAB:
+                g_grid->FocusNext();
+                break;
+            case VK_ESCAPE:
+                PostMessage(hwnd, WM_COMMAND, ID_PLAY_STOP, 0);
+                break;
+            }
+            break;
+        }
         if (g_player)
         {
             switch (wParam)
@@ -433,8 +1019,7 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
                     g_player->Play();
                 break;
             case VK_ESCAPE:
-                g_player->Stop();
-                InvalidateRect(hwnd, nullptr, TRUE);
+                PostMessage(hwnd, WM_COMMAND, ID_PLAY_STOP, 0);
                 break;
             case VK_LEFT:
                 // 后退5秒
@@ -469,6 +1054,22 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
                 PostMessage(hwnd, WM_COMMAND, ID_SCALE_ORIGINAL, 0);
                 break;
             
+            // 循环区间快捷键 ([ 设置起点, ] 设置终点, \ 取消循环)
+            case VK_OEM_4:
+                PostMessage(hwnd, WM_COMMAND, ID_PLAY_LOOP_START, 0);
+                break;
+            case VK_OEM_6:
+                PostMessage(hwnd, WM_COMMAND, ID_PLAY_LOOP_END, 0);
+                break;
+            case VK_OEM_5:
+                PostMessage(hwnd, WM_COMMAND, ID_PLAY_LOOP_CLEAR, 0);
+                break;
+            
+            // 帧节奏统计快捷键 (F3)
+            case VK_F3:
+                PostMessage(hwnd, WM_COMMAND, ID_PLAY_FRAME_STATS, 0);
+                break;
+            
             // 控制面板快捷键 (F6)
             case VK_F6:
                 if (g_controlPanel)
@@ -487,6 +1088,78 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
         }
         break;
     }
+    case WM_VIDEO_OPEN_PROGRESS:
+    {
+        // 后台打开的进度：当前阶段和已读取的数据量
+        if (g_player && g_player->IsOpening())
+        {
+            static const char* stageNames[] = { "opening", "probing streams", "opening decoder", "decoding first frame" };
+            int stage = (std::min)((int)wParam, 3);
+            std::string title = g_windowTitle + std::string(" - Opening ") + g_openingFile + " (" +
+                                stageNames[stage] + ", " + std::to_string((long long)lParam) + " KB)";
+            SetWindowText(hwnd, title.c_str());
+        }
+        break;
+    }
+    case WM_VIDEO_OPENED:
+    {
+        if (!g_player || !g_player->IsOpening())
+        {
+            break;
+        }
+        
+        if (g_player->FinishOpen())
+        {
+            SetWindowText(hwnd, (g_windowTitle + std::string(" - ") + g_openingFile).c_str());
+            
+            // 设置进度条范围
+            if (g_progressBar)
+            {
+                g_progressBar->SetRange(0.0, g_player->GetDuration());
+                g_progressBar->SetSeekCallback(OnProgressBarSeek, nullptr);
+            }
+            
+            // 自动开始播放
+            g_player->Play();
+            
+            std::cout << "Video loaded and playing automatically" << std::endl;
+            
+            if (!g_playlist.empty())
+            {
+                OnPlaylistItemStarted(hwnd);
+            }
+        }
+        else
+        {
+            SetWindowText(hwnd, g_windowTitle);
+            InvalidateRect(hwnd, nullptr, TRUE);
+            MessageBox(hwnd, "Failed to open video file!", "Error", MB_ICONERROR | MB_OK);
+        }
+        break;
+    }
+    case WM_VIDEO_NEXT_STARTED:
+    {
+        // 播放线程已无缝切换到预先打开的下一项
+        int next = NextPlaylistIndex();
+        if (g_player && next >= 0)
+        {
+            g_playlistIndex = next;
+            g_openingFile = g_playlist[next];
+            OnPlaylistItemStarted(hwnd);
+        }
+        break;
+    }
+    case WM_VIDEO_ENDED:
+    {
+        // 没能无缝切换（下一项打开失败或视频格式不同）时重新打开下一项
+        int next = NextPlaylistIndex();
+        if (g_player && next >= 0)
+        {
+            g_playlistIndex = next;
+            StartOpenFile(hwnd, g_playlist[next]);
+        }
+        break;
+    }
     case WM_DESTROY:
         PostQuitMessage(0);
         break;
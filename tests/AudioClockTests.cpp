@@ -0,0 +1,109 @@
+#include "TestHarness.h"
+#include "AudioClock.h"
+
+TEST_CASE(AudioClock, HoldsResetValueWithoutSamples)
+{
+    AudioClock clock;
+    clock.SetSampleRate(48000.0);
+    clock.Reset(12.5);
+    CHECK_NEAR(clock.Get(100.0), 12.5, 1e-12);
+
+    // 有段但尚无位置采样时仍返回保持值
+    clock.QueueSegment(0, 12.5, 4800, 0.1);
+    CHECK_NEAR(clock.Get(200.0), 12.5, 1e-12);
+}
+
+TEST_CASE(AudioClock, ExtrapolatesBetweenSamples)
+{
+    AudioClock clock;
+    clock.SetSampleRate(48000.0);
+    clock.Reset(0.0);
+    clock.SetRunning(true, 0.0);
+    clock.QueueSegment(0, 10.0, 48000, 1.0);
+    clock.QueueSegment(48000, 11.0, 48000, 1.0);
+
+    clock.UpdatePosition(12000.0, 1.0);
+    CHECK_NEAR(clock.Get(1.0), 10.25, 1e-9);
+    CHECK_NEAR(clock.Get(1.1), 10.35, 1e-9);
+
+    // 第二段
+    clock.UpdatePosition(60000.0, 2.0);
+    CHECK_NEAR(clock.Get(2.0), 11.25, 1e-9);
+}
+
+TEST_CASE(AudioClock, SpeedChangesRate)
+{
+    AudioClock clock;
+    clock.SetSampleRate(48000.0);
+    clock.Reset(0.0);
+    clock.SetRunning(true, 0.0);
+    // 两倍速：48000 设备帧覆盖 2 秒媒体时间
+    clock.QueueSegment(0, 0.0, 48000, 2.0);
+    clock.UpdatePosition(0.0, 5.0);
+    CHECK_NEAR(clock.Get(5.25), 0.5, 1e-9);
+}
+
+TEST_CASE(AudioClock, ClampsToSubmittedAudio)
+{
+    AudioClock clock;
+    clock.SetSampleRate(48000.0);
+    clock.Reset(0.0);
+    clock.SetRunning(true, 0.0);
+    clock.QueueSegment(0, 3.0, 4800, 0.1);
+    clock.UpdatePosition(0.0, 0.0);
+    // 外推不能超过已提交数据的终点
+    CHECK_NEAR(clock.Get(10.0), 3.1, 1e-9);
+}
+
+TEST_CASE(AudioClock, GapAndUnderrunHoldPosition)
+{
+    AudioClock clock;
+    clock.SetSampleRate(1000.0);
+    clock.Reset(0.0);
+    clock.SetRunning(true, 0.0);
+    clock.QueueSegment(100, 7.0, 100, 0.1);
+
+    // 段之前（设备在播放静音）停在段的起点
+    clock.UpdatePosition(50.0, 0.05);
+    CHECK_NEAR(clock.Get(0.06), 7.0, 1e-9);
+
+    // 超过所有段（欠载）停在终点
+    clock.UpdatePosition(400.0, 0.4);
+    CHECK_NEAR(clock.Get(0.5), 7.1, 1e-9);
+}
+
+TEST_CASE(AudioClock, PauseFreezesValue)
+{
+    AudioClock clock;
+    clock.SetSampleRate(1000.0);
+    clock.Reset(0.0);
+    clock.SetRunning(true, 0.0);
+    clock.QueueSegment(0, 0.0, 10000, 10.0);
+    clock.UpdatePosition(0.0, 0.0);
+
+    clock.SetRunning(false, 2.0);
+    CHECK_NEAR(clock.Get(5.0), 2.0, 1e-9);
+
+    // 恢复后从暂停时的值继续
+    clock.SetRunning(true, 5.0);
+    CHECK_NEAR(clock.Get(6.0), 3.0, 1e-9);
+}
+
+TEST_CASE(AudioClock, MeasuresDeviceDrift)
+{
+    AudioClock clock;
+    clock.SetSampleRate(48000.0);
+    clock.Reset(0.0);
+    clock.SetRunning(true, 0.0);
+    clock.QueueSegment(0, 0.0, 48000 * 20, 20.0);
+
+    // 设备每秒实际推进 48048 帧, 比标称快 1000 ppm
+    for (int i = 0; i <= 10; i++)
+    {
+        clock.UpdatePosition(48048.0 * i, (double)i);
+    }
+    AudioClockStats stats = clock.GetStats();
+    CHECK_NEAR(stats.driftPpm, 1000.0, 1e-6);
+    CHECK_NEAR(stats.observedSeconds, 10.0, 1e-9);
+    CHECK(stats.sampleCount == 10);
+}
@@ -0,0 +1,213 @@
+#include "TestHarness.h"
+#include "AudioDSP.h"
+#include <cmath>
+#include <vector>
+
+// 长度不是 4 的倍数, 同时覆盖向量部分和标量尾部
+static const int ODD_COUNT = 1027;
+
+TEST_CASE(AudioDSP, ApplyGainMatchesScalar)
+{
+    std::vector<float> buffer(ODD_COUNT);
+    for (int i = 0; i < ODD_COUNT; i++)
+    {
+        buffer[i] = (float)(i % 37) / 37.0f - 0.5f;
+    }
+    std::vector<float> expected = buffer;
+    for (float& sample : expected)
+    {
+        sample *= 0.3f;
+    }
+
+    AudioDSP::ApplyGain(buffer.data(), ODD_COUNT, 0.3f);
+    for (int i = 0; i < ODD_COUNT; i++)
+    {
+        CHECK_NEAR(buffer[i], expected[i], 1e-7);
+    }
+}
+
+TEST_CASE(AudioDSP, ApplyGainRampIsLinear)
+{
+    std::vector<float> buffer(ODD_COUNT, 1.0f);
+    float step = -1.0f / ODD_COUNT;
+    AudioDSP::ApplyGainRamp(buffer.data(), ODD_COUNT, 1.0f, step);
+    for (int i = 0; i < ODD_COUNT; i++)
+    {
+        CHECK_NEAR(buffer[i], 1.0 + step * i, 1e-5);
+    }
+}
+
+TEST_CASE(AudioDSP, MixIntoAddsScaledSource)
+{
+    std::vector<float> dst(ODD_COUNT, 0.25f);
+    std::vector<float> src(ODD_COUNT);
+    for (int i = 0; i < ODD_COUNT; i++)
+    {
+        src[i] = (float)i / ODD_COUNT;
+    }
+    AudioDSP::MixInto(dst.data(), src.data(), ODD_COUNT, 0.5f);
+    for (int i = 0; i < ODD_COUNT; i++)
+    {
+        CHECK_NEAR(dst[i], 0.25 + 0.5 * src[i], 1e-6);
+    }
+}
+
+TEST_CASE(AudioDSP, SoftLimitKeepsQuietSamplesAndBoundsLoudOnes)
+{
+    const float threshold = 0.89f;
+    std::vector<float> buffer(ODD_COUNT);
+    for (int i = 0; i < ODD_COUNT; i++)
+    {
+        buffer[i] = -4.0f + 8.0f * i / (ODD_COUNT - 1);
+    }
+    std::vector<float> input = buffer;
+    AudioDSP::SoftLimit(buffer.data(), ODD_COUNT, threshold);
+
+    for (int i = 0; i < ODD_COUNT; i++)
+    {
+        if (std::fabs(input[i]) <= threshold)
+        {
+            CHECK(buffer[i] == input[i]);
+        }
+        else
+        {
+            CHECK(std::fabs(buffer[i]) > threshold);
+            CHECK(std::fabs(buffer[i]) <= 1.0f);
+            CHECK((buffer[i] < 0.0f) == (input[i] < 0.0f));
+        }
+        // 单调, 输入递增时输出不减
+        if (i > 0)
+        {
+            CHECK(buffer[i] >= buffer[i - 1]);
+        }
+    }
+}
+
+TEST_CASE(AudioDSP, SoftLimitVectorAndScalarPathsAgree)
+{
+    // 同一个值分别落在向量部分（下标 0）和标量尾部（下标 4）
+    const float values[] = { 0.95f, 1.5f, -2.0f, 3.5f };
+    for (float value : values)
+    {
+        float buffer[5] = { value, 0.0f, 0.0f, 0.0f, value };
+        AudioDSP::SoftLimit(buffer, 5, 0.89f);
+        CHECK_NEAR(buffer[0], buffer[4], 1e-6);
+    }
+}
+
+// 以 1.0 的输入逐块处理, 返回每帧实际使用的增益
+static std::vector<float> ProcessBlocks(AudioDSP& dsp, int blockFrames, int totalFrames)
+{
+    std::vector<float> gains;
+    std::vector<float> left(blockFrames), right(blockFrames);
+    while ((int)gains.size() < totalFrames)
+    {
+        left.assign(blockFrames, 1.0f);
+        right.assign(blockFrames, 1.0f);
+        dsp.Process(left.data(), right.data(), blockFrames);
+        for (int i = 0; i < blockFrames; i++)
+        {
+            CHECK(left[i] == right[i]);
+            gains.push_back(left[i]);
+        }
+    }
+    return gains;
+}
+
+TEST_CASE(AudioDSP, RampSpanningBlocksIsLinear)
+{
+    // 44100 Hz 时渐变 441 帧, 每块 64 帧, 渐变跨越 7 块
+    AudioDSP dsp;
+    dsp.Configure(44100);
+    dsp.SetLimiterEnabled(false);
+    dsp.SetVolume(0.5f);
+
+    std::vector<float> gains = ProcessBlocks(dsp, 64, 640);
+    for (int i = 0; i < 441; i++)
+    {
+        CHECK_NEAR(gains[i], 1.0 - 0.5 * i / 441.0, 1e-4);
+    }
+    for (int i = 441; i < 640; i++)
+    {
+        CHECK(gains[i] == 0.5f);
+    }
+}
+
+TEST_CASE(AudioDSP, RetargetDuringRampHasNoJump)
+{
+    AudioDSP dsp;
+    dsp.Configure(44100);
+    dsp.SetLimiterEnabled(false);
+    dsp.SetVolume(0.0f);
+    std::vector<float> gains = ProcessBlocks(dsp, 100, 200);
+
+    // 渐变中途改回 1.0：从当前增益开始新的渐变, 相邻帧的变化不超过一个步长
+    dsp.SetVolume(1.0f);
+    std::vector<float> more = ProcessBlocks(dsp, 100, 600);
+    gains.insert(gains.end(), more.begin(), more.end());
+
+    for (size_t i = 1; i < gains.size(); i++)
+    {
+        CHECK(std::fabs(gains[i] - gains[i - 1]) <= 1.0f / 441.0f + 1e-5f);
+    }
+    CHECK(gains.back() == 1.0f);
+}
+
+TEST_CASE(AudioDSP, StreamGainScalesOutput)
+{
+    AudioDSP dsp;
+    dsp.Configure(44100);
+    dsp.SetLimiterEnabled(false);
+    dsp.SetStreamGainDb(-6.0f);
+    std::vector<float> gains = ProcessBlocks(dsp, 512, 1024);
+    CHECK_NEAR(gains.back(), 0.501187, 1e-5);
+}
+
+// 基准：每个内核反复处理同一块缓冲区约 0.2 秒, 输出每秒处理的样本数
+static const int BENCH_FRAMES = 4096;
+static const double BENCH_SECONDS = 0.2;
+
+template <typename Kernel>
+static void RunKernelBenchmark(const char* label, int samplesPerCall, Kernel kernel)
+{
+    double samples = 0.0;
+    double start = BenchNowSeconds();
+    double elapsed = 0.0;
+    while (elapsed < BENCH_SECONDS)
+    {
+        for (int i = 0; i < 64; i++)
+        {
+            kernel();
+        }
+        samples += 64.0 * samplesPerCall;
+        elapsed = BenchNowSeconds() - start;
+    }
+    ReportThroughput(label, samples, elapsed, "samples");
+}
+
+BENCHMARK(AudioDSP, Kernels)
+{
+    std::vector<float> buffer(BENCH_FRAMES), source(BENCH_FRAMES);
+    for (int i = 0; i < BENCH_FRAMES; i++)
+    {
+        // 一半样本超过限幅阈值, 限幅器不能跳过整组
+        buffer[i] = (i & 1) ? 0.5f : -0.95f;
+        source[i] = 0.25f;
+    }
+
+    // 增益为 1 时数值不变, 反复处理不会溢出或变成非规格化数
+    RunKernelBenchmark("ApplyGain", BENCH_FRAMES, [&]() { AudioDSP::ApplyGain(buffer.data(), BENCH_FRAMES, 1.0f); });
+    RunKernelBenchmark("ApplyGainRamp", BENCH_FRAMES, [&]() { AudioDSP::ApplyGainRamp(buffer.data(), BENCH_FRAMES, 1.0f, 0.0f); });
+    RunKernelBenchmark("MixInto", BENCH_FRAMES, [&]() { AudioDSP::MixInto(buffer.data(), source.data(), BENCH_FRAMES, 0.0f); });
+    RunKernelBenchmark("SoftLimit", BENCH_FRAMES, [&]() { AudioDSP::SoftLimit(buffer.data(), BENCH_FRAMES, 0.89f); });
+
+    // 整个处理级（立体声, 每帧两个样本）, 音量交替变化使渐变始终进行
+    AudioDSP dsp;
+    dsp.Configure(48000);
+    std::vector<float> left(BENCH_FRAMES, 0.5f), right(BENCH_FRAMES, -0.5f);
+    int toggle = 0;
+    RunKernelBenchmark("Process (stereo)", 2 * BENCH_FRAMES, [&]() {
+        dsp.SetVolume((toggle++ & 1) ? 1.0f : 0.9f);
+        dsp.Process(left.data(), right.data(), BENCH_FRAMES);
+    });
+}
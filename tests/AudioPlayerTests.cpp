@@ -0,0 +1,162 @@
+#include "TestHarness.h"
+#include "AudioPlayer.h"
+#include <psapi.h>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 仅 Windows：需要 FFmpeg 和一个可用的音频输出设备, 没有设备时跳过
+
+static const int SAMPLE_RATE = 44100;
+
+// 在临时目录生成 1 秒 16 位立体声 440 Hz 正弦波 WAV
+static std::string WriteTestWav()
+{
+    char directory[MAX_PATH];
+    GetTempPathA(MAX_PATH, directory);
+    std::string path = std::string(directory) + "audio_player_test.wav";
+
+    const int frames = SAMPLE_RATE;
+    std::vector<int16_t> samples(frames * 2);
+    for (int i = 0; i < frames; i++)
+    {
+        int16_t value = (int16_t)(8000.0 * sin(2.0 * 3.14159265358979 * 440.0 * i / SAMPLE_RATE));
+        samples[i * 2] = value;
+        samples[i * 2 + 1] = value;
+    }
+
+    uint32_t dataBytes = (uint32_t)(samples.size() * sizeof(int16_t));
+    uint32_t riffBytes = 36 + dataBytes;
+    uint32_t fmtBytes = 16;
+    uint16_t format = 1, channels = 2, blockAlign = 4, bits = 16;
+    uint32_t rate = SAMPLE_RATE, byteRate = SAMPLE_RATE * 4;
+
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file)
+        return std::string();
+    fwrite("RIFF", 1, 4, file);
+    fwrite(&riffBytes, 4, 1, file);
+    fwrite("WAVEfmt ", 1, 8, file);
+    fwrite(&fmtBytes, 4, 1, file);
+    fwrite(&format, 2, 1, file);
+    fwrite(&channels, 2, 1, file);
+    fwrite(&rate, 4, 1, file);
+    fwrite(&byteRate, 4, 1, file);
+    fwrite(&blockAlign, 2, 1, file);
+    fwrite(&bits, 2, 1, file);
+    fwrite("data", 1, 4, file);
+    fwrite(&dataBytes, 4, 1, file);
+    fwrite(samples.data(), 1, dataBytes, file);
+    fclose(file);
+    return path;
+}
+
+static AVFormatContext* OpenTestFile(const std::string& path)
+{
+    AVFormatContext* formatContext = nullptr;
+    if (avformat_open_input(&formatContext, path.c_str(), nullptr, nullptr) < 0)
+        return nullptr;
+    if (avformat_find_stream_info(formatContext, nullptr) < 0)
+    {
+        avformat_close_input(&formatContext);
+        return nullptr;
+    }
+    return formatContext;
+}
+
+static SIZE_T PrivateBytes()
+{
+    PROCESS_MEMORY_COUNTERS_EX counters = {};
+    counters.cb = sizeof(counters);
+    GetProcessMemoryInfo(GetCurrentProcess(), (PROCESS_MEMORY_COUNTERS*)&counters, sizeof(counters));
+    return counters.PrivateUsage;
+}
+
+TEST_CASE(AudioPlayer, OpenCloseDoesNotLeak)
+{
+    std::string path = WriteTestWav();
+    AVFormatContext* formatContext = OpenTestFile(path);
+    CHECK(formatContext != nullptr);
+    if (!formatContext)
+        return;
+
+    AudioPlayer player;
+    if (!player.Initialize(formatContext))
+    {
+        std::cout << "  no audio output device, skipped" << std::endl;
+        avformat_close_input(&formatContext);
+        return;
+    }
+    player.Close();
+
+    // 预热让分配器和驱动的一次性分配稳定下来, 之后每次打开/关闭只重建解码器和重采样器
+    for (int i = 0; i < 20; i++)
+    {
+        player.Initialize(formatContext);
+        player.Close();
+    }
+    SIZE_T before = PrivateBytes();
+    for (int i = 0; i < 200; i++)
+    {
+        CHECK(player.Initialize(formatContext));
+        CHECK(player.GetAudioCodecContext() != nullptr);
+        player.Close();
+        CHECK(player.GetAudioCodecContext() == nullptr);
+        CHECK(player.IsDeviceReady());
+    }
+    SIZE_T after = PrivateBytes();
+
+    // 每次泄漏一个解码器上下文就有数十 KB, 200 次合计远超 1 MB
+    double growthKb = ((double)after - (double)before) / 1024.0;
+    std::cout << "  private bytes growth over 200 cycles: " << growthKb << " KB" << std::endl;
+    CHECK(growthKb < 1024.0);
+
+    avformat_close_input(&formatContext);
+    remove(path.c_str());
+}
+
+// 在已打开的设备上写入 pts 开始的 0.5 秒音频, 播放一段时间后返回音频时钟
+static double PlayFrom(AudioPlayer& player, double pts)
+{
+    std::vector<float> left(SAMPLE_RATE / 2, 0.0f), right(SAMPLE_RATE / 2, 0.0f);
+    player.Start();
+    player.WriteFLTP(left.data(), right.data(), (UINT32)left.size(), pts);
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    return player.GetAudioClock();
+}
+
+TEST_CASE(AudioPlayer, ClockRunsAfterReopen)
+{
+    std::string path = WriteTestWav();
+    AVFormatContext* formatContext = OpenTestFile(path);
+    CHECK(formatContext != nullptr);
+    if (!formatContext)
+        return;
+
+    AudioPlayer player;
+    if (!player.Initialize(formatContext))
+    {
+        std::cout << "  no audio output device, skipped" << std::endl;
+        avformat_close_input(&formatContext);
+        return;
+    }
+
+    // 第一个文件
+    double first = PlayFrom(player, 0.0);
+    CHECK(first > 0.1);
+    player.Close();
+
+    // 复用设备打开下一个文件: Close 重置了设备位置, 时钟必须从新文件的时间继续走
+    CHECK(player.Initialize(formatContext));
+    double second = PlayFrom(player, 10.0);
+    CHECK(second > 10.1);
+    CHECK(second < 10.6);
+    player.Close();
+
+    avformat_close_input(&formatContext);
+    remove(path.c_str());
+}
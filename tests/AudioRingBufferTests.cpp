@@ -0,0 +1,115 @@
+#include "TestHarness.h"
+#include "AudioRingBuffer.h"
+#include <vector>
+
+TEST_CASE(AudioRingBuffer, WriteReadInterleaves)
+{
+    AudioRingBuffer ring;
+    ring.Allocate(16, 2, 48000);
+    const float left[] = { 1.0f, 2.0f, 3.0f };
+    const float right[] = { -1.0f, -2.0f, -3.0f };
+    CHECK(ring.Write(left, right, 3) == 3);
+    CHECK(ring.AvailableToRead() == 3);
+    CHECK(ring.AvailableToWrite() == 13);
+
+    float out[6] = {};
+    CHECK(ring.Read(out, 8) == 3);
+    const float expected[] = { 1.0f, -1.0f, 2.0f, -2.0f, 3.0f, -3.0f };
+    for (int i = 0; i < 6; i++)
+    {
+        CHECK(out[i] == expected[i]);
+    }
+    CHECK(ring.AvailableToRead() == 0);
+}
+
+TEST_CASE(AudioRingBuffer, MonoAndSilence)
+{
+    AudioRingBuffer ring;
+    ring.Allocate(8, 2, 48000);
+    const float mono[] = { 0.5f, 0.25f };
+    ring.Write(mono, nullptr, 2);
+    ring.Write(nullptr, nullptr, 1);
+
+    float out[6] = { 9.0f, 9.0f, 9.0f, 9.0f, 9.0f, 9.0f };
+    CHECK(ring.Read(out, 3) == 3);
+    const float expected[] = { 0.5f, 0.5f, 0.25f, 0.25f, 0.0f, 0.0f };
+    for (int i = 0; i < 6; i++)
+    {
+        CHECK(out[i] == expected[i]);
+    }
+}
+
+TEST_CASE(AudioRingBuffer, FullBufferAndWrapAround)
+{
+    AudioRingBuffer ring;
+    ring.Allocate(5, 1, 48000);
+    std::vector<float> data(8);
+    for (int i = 0; i < 8; i++)
+    {
+        data[i] = (float)i;
+    }
+
+    // 写满后多余的帧被拒绝
+    CHECK(ring.Write(data.data(), nullptr, 8) == 5);
+    CHECK(ring.AvailableToWrite() == 0);
+
+    float out[5] = {};
+    CHECK(ring.Read(out, 3) == 3);
+    CHECK(out[0] == 0.0f && out[2] == 2.0f);
+
+    // 再写 3 帧跨越缓冲区末尾
+    CHECK(ring.Write(data.data() + 5, nullptr, 3) == 3);
+    CHECK(ring.Read(out, 5) == 5);
+    for (int i = 0; i < 5; i++)
+    {
+        CHECK(out[i] == (float)(i + 3));
+    }
+}
+
+TEST_CASE(AudioRingBuffer, PtsMarkersFollowReads)
+{
+    AudioRingBuffer ring;
+    ring.Allocate(1000, 2, 100);
+    std::vector<float> samples(200, 0.1f);
+
+    ring.Write(samples.data(), nullptr, 100, 5.0);
+    ring.Write(samples.data(), nullptr, 100);           // 紧接上一次写入
+    ring.Write(samples.data(), nullptr, 100, 20.0, 2.0); // 跳转后变速
+
+    std::vector<float> out(400);
+    double pts = 0.0;
+    double duration = 0.0;
+    ring.Read(out.data(), 50, &pts, &duration);
+    CHECK_NEAR(pts, 5.0, 1e-9);
+    CHECK_NEAR(duration, 0.5, 1e-9);
+
+    ring.Read(out.data(), 100, &pts, &duration);
+    CHECK_NEAR(pts, 5.5, 1e-9);
+
+    ring.Read(out.data(), 50, &pts, &duration);
+    CHECK_NEAR(pts, 6.5, 1e-9);
+
+    // 两倍速的数据每帧代表 2 帧的媒体时长
+    ring.Read(out.data(), 40, &pts, &duration);
+    CHECK_NEAR(pts, 20.0, 1e-9);
+    CHECK_NEAR(duration, 0.8, 1e-9);
+    ring.Read(out.data(), 10, &pts, &duration);
+    CHECK_NEAR(pts, 20.8, 1e-9);
+}
+
+TEST_CASE(AudioRingBuffer, ClearDropsDataAndMarkers)
+{
+    AudioRingBuffer ring;
+    ring.Allocate(100, 2, 100);
+    std::vector<float> samples(50, 0.1f);
+    ring.Write(samples.data(), nullptr, 50, 1.0);
+    ring.Clear();
+    CHECK(ring.AvailableToRead() == 0);
+
+    // 清空后没有标记, 未带时间戳的数据首帧时间未知
+    ring.Write(samples.data(), nullptr, 10);
+    std::vector<float> out(20);
+    double pts = 0.0;
+    ring.Read(out.data(), 10, &pts);
+    CHECK(std::isnan(pts));
+}
@@ -0,0 +1,136 @@
+#include "TestHarness.h"
+#include "DisplayPipeline.h"
+#include <vector>
+
+struct DisplayRect {
+    int width, height, x, y;
+};
+
+static DisplayRect Calculate(ScalingMode mode, int windowWidth, int windowHeight, int videoWidth, int videoHeight)
+{
+    DisplayRect rect;
+    CalculateDisplayRect(mode, windowWidth, windowHeight, videoWidth, videoHeight, rect.width, rect.height, rect.x, rect.y);
+    return rect;
+}
+
+static bool Equals(const DisplayRect& rect, int width, int height, int x, int y)
+{
+    return rect.width == width && rect.height == height && rect.x == x && rect.y == y;
+}
+
+TEST_CASE(DisplayPipeline, FitToWindowKeepsAspectRatio)
+{
+    // 窗口更宽：左右黑边
+    CHECK(Equals(Calculate(ScalingMode::FIT_TO_WINDOW, 1920, 1080, 640, 480), 1440, 1080, 240, 0));
+    // 窗口更高：上下黑边
+    CHECK(Equals(Calculate(ScalingMode::FIT_TO_WINDOW, 800, 800, 1280, 720), 800, 450, 0, 175));
+    // 同宽高比放大和缩小都铺满
+    CHECK(Equals(Calculate(ScalingMode::FIT_TO_WINDOW, 1280, 720, 640, 360), 1280, 720, 0, 0));
+    CHECK(Equals(Calculate(ScalingMode::FIT_TO_WINDOW, 320, 180, 1920, 1080), 320, 180, 0, 0));
+}
+
+TEST_CASE(DisplayPipeline, OriginalSizeCentresAndClamps)
+{
+    CHECK(Equals(Calculate(ScalingMode::ORIGINAL_SIZE, 1920, 1080, 640, 480), 640, 480, 640, 300));
+    // 视频大于窗口时裁到窗口尺寸, 偏移不为负
+    CHECK(Equals(Calculate(ScalingMode::ORIGINAL_SIZE, 800, 600, 1920, 1080), 800, 600, 0, 0));
+    CHECK(Equals(Calculate(ScalingMode::ORIGINAL_SIZE, 800, 2000, 1920, 1080), 800, 1080, 0, 460));
+}
+
+TEST_CASE(DisplayPipeline, InvalidSizesGiveEmptyRect)
+{
+    const ScalingMode modes[] = { ScalingMode::FIT_TO_WINDOW, ScalingMode::ORIGINAL_SIZE };
+    for (ScalingMode mode : modes)
+    {
+        CHECK(Equals(Calculate(mode, 0, 600, 640, 480), 0, 0, 0, 0));
+        CHECK(Equals(Calculate(mode, 800, -1, 640, 480), 0, 0, 0, 0));
+        CHECK(Equals(Calculate(mode, 800, 600, 0, 480), 0, 0, 0, 0));
+        CHECK(Equals(Calculate(mode, 800, 600, 640, 0), 0, 0, 0, 0));
+    }
+}
+
+TEST_CASE(DisplayPipeline, GrayscaleUsesBt601WeightsAndKeepsAlpha)
+{
+    // BGRA: 红、绿、蓝、白, Alpha 各不相同
+    uint8_t pixels[] = {
+        0, 0, 255, 10,
+        0, 255, 0, 20,
+        255, 0, 0, 30,
+        255, 255, 255, 40,
+    };
+    ApplyFrameFilter(FilterType::GRAYSCALE, 8, pixels, 4, 1, 16, 4);
+    const uint8_t expected[] = { 76, 149, 29, 255 };
+    for (int i = 0; i < 4; i++)
+    {
+        CHECK(pixels[i * 4 + 0] == expected[i]);
+        CHECK(pixels[i * 4 + 1] == expected[i]);
+        CHECK(pixels[i * 4 + 2] == expected[i]);
+        CHECK(pixels[i * 4 + 3] == 10 * (i + 1));
+    }
+}
+
+TEST_CASE(DisplayPipeline, MosaicAveragesBlocksIncludingPartialEdges)
+{
+    // 5x3 的 BGR24 图像, 行尾有 1 字节填充; 每个像素的 B = x*10 + y, G = 100, R = 200 - x
+    const int width = 5, height = 3, stride = width * 3 + 1;
+    std::vector<uint8_t> image((size_t)stride * height, 0xEE);
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            uint8_t* pixel = image.data() + y * stride + x * 3;
+            pixel[0] = (uint8_t)(x * 10 + y);
+            pixel[1] = 100;
+            pixel[2] = (uint8_t)(200 - x);
+        }
+    }
+    ApplyFrameFilter(FilterType::MOSAIC, 2, image.data(), width, height, stride, 3);
+
+    // 块 [x0, x1) x [y0, y1) 内全部像素等于块平均值（整数截断）
+    auto checkBlock = [&](int x0, int x1, int y0, int y1) {
+        int sumB = 0, sumR = 0, count = 0;
+        for (int y = y0; y < y1; y++)
+        {
+            for (int x = x0; x < x1; x++)
+            {
+                sumB += x * 10 + y;
+                sumR += 200 - x;
+                count++;
+            }
+        }
+        for (int y = y0; y < y1; y++)
+        {
+            for (int x = x0; x < x1; x++)
+            {
+                const uint8_t* pixel = image.data() + y * stride + x * 3;
+                CHECK(pixel[0] == sumB / count);
+                CHECK(pixel[1] == 100);
+                CHECK(pixel[2] == sumR / count);
+            }
+        }
+    };
+    checkBlock(0, 2, 0, 2);
+    checkBlock(2, 4, 0, 2);
+    checkBlock(4, 5, 0, 2);
+    checkBlock(0, 2, 2, 3);
+    checkBlock(4, 5, 2, 3);
+
+    // 行尾填充不被修改
+    for (int y = 0; y < height; y++)
+    {
+        CHECK(image[y * stride + width * 3] == 0xEE);
+    }
+}
+
+TEST_CASE(DisplayPipeline, NoneAndInvalidParametersLeaveImage)
+{
+    uint8_t pixels[] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    const uint8_t original[] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    ApplyFrameFilter(FilterType::NONE, 8, pixels, 2, 1, 8, 4);
+    ApplyFrameFilter(FilterType::MOSAIC, 0, pixels, 2, 1, 8, 4);
+    ApplyFrameFilter(FilterType::GRAYSCALE, 8, pixels, 2, 1, 8, 2);
+    for (int i = 0; i < 8; i++)
+    {
+        CHECK(pixels[i] == original[i]);
+    }
+}
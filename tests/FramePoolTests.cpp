@@ -0,0 +1,159 @@
+#include "TestHarness.h"
+#include "FramePool.h"
+#include <cstring>
+#include <vector>
+
+extern "C" {
+#include "libavutil/pixdesc.h"
+}
+
+// 不打开解码器：get_buffer2 只需要编解码器类型、能力和像素格式, 直接调用即可检查缓冲区布局
+static AVCodecContext* CreateContext()
+{
+    const AVCodec* codec = avcodec_find_decoder(AV_CODEC_ID_H264);
+    if (!codec)
+        return nullptr;
+    AVCodecContext* context = avcodec_alloc_context3(codec);
+    if (context && !FramePool::Install(context))
+    {
+        avcodec_free_context(&context);
+    }
+    return context;
+}
+
+static AVFrame* GetFrame(AVCodecContext* context, AVPixelFormat format, int width, int height)
+{
+    AVFrame* frame = av_frame_alloc();
+    frame->format = format;
+    frame->width = width;
+    frame->height = height;
+    context->pix_fmt = format;
+    context->width = width;
+    context->height = height;
+    if (context->get_buffer2(context, frame, 0) < 0)
+    {
+        av_frame_free(&frame);
+    }
+    return frame;
+}
+
+// 各平面起始地址和行字节数按 64 字节对齐, 平面按顺序排列且互不重叠, 全部位于帧缓冲区内
+static void CheckLayout(const AVFrame* frame)
+{
+    const AVPixFmtDescriptor* descriptor = av_pix_fmt_desc_get((AVPixelFormat)frame->format);
+    int planes = av_pix_fmt_count_planes((AVPixelFormat)frame->format);
+    CHECK(frame->buf[0] != nullptr);
+    for (int i = 0; i < planes; i++)
+    {
+        CHECK(frame->data[i] != nullptr);
+        CHECK(((uintptr_t)frame->data[i] % FramePool::ALIGNMENT) == 0);
+        CHECK(frame->linesize[i] % FramePool::ALIGNMENT == 0);
+
+        int planeHeight = (i == 0 || i == 3) ? frame->height : -((-frame->height) >> descriptor->log2_chroma_h);
+        const uint8_t* planeEnd = frame->data[i] + (size_t)frame->linesize[i] * planeHeight;
+        const uint8_t* bufferEnd = frame->buf[0]->data + frame->buf[0]->size;
+        CHECK(planeEnd <= bufferEnd);
+        if (i + 1 < planes)
+        {
+            CHECK(planeEnd <= frame->data[i + 1]);
+        }
+    }
+    for (int i = planes; i < AV_NUM_DATA_POINTERS; i++)
+    {
+        CHECK(frame->data[i] == nullptr);
+    }
+}
+
+TEST_CASE(FramePool, PlanesAreAlignedAndDisjoint)
+{
+    AVCodecContext* context = CreateContext();
+    CHECK(context != nullptr);
+    if (!context)
+        return;
+
+    const AVPixelFormat formats[] = { AV_PIX_FMT_YUV420P, AV_PIX_FMT_YUV422P, AV_PIX_FMT_YUV444P, AV_PIX_FMT_NV12, AV_PIX_FMT_YUV420P10LE };
+    const int sizes[][2] = { { 1920, 1080 }, { 853, 481 }, { 176, 144 }, { 2, 2 } };
+    for (AVPixelFormat format : formats)
+    {
+        for (const int* size : sizes)
+        {
+            AVFrame* frame = GetFrame(context, format, size[0], size[1]);
+            CHECK(frame != nullptr);
+            if (!frame)
+                continue;
+            CheckLayout(frame);
+
+            // 4:2:2 时有的解码器依赖亮度与色度行距的比例
+            if (format == AV_PIX_FMT_YUV422P || format == AV_PIX_FMT_YUV420P)
+            {
+                CHECK(frame->linesize[0] == 2 * frame->linesize[1]);
+            }
+            av_frame_free(&frame);
+        }
+    }
+    FramePool::FreeContext(&context);
+}
+
+TEST_CASE(FramePool, FramesInFlightDoNotOverlapAndAreReused)
+{
+    AVCodecContext* context = CreateContext();
+    CHECK(context != nullptr);
+    if (!context)
+        return;
+
+    std::vector<AVFrame*> frames;
+    for (int i = 0; i < 12; i++)
+    {
+        AVFrame* frame = GetFrame(context, AV_PIX_FMT_YUV420P, 640, 360);
+        CHECK(frame != nullptr);
+        if (frame)
+            frames.push_back(frame);
+    }
+    for (size_t i = 0; i < frames.size(); i++)
+    {
+        for (size_t j = i + 1; j < frames.size(); j++)
+        {
+            const AVBufferRef* a = frames[i]->buf[0];
+            const AVBufferRef* b = frames[j]->buf[0];
+            CHECK(a->data + a->size <= b->data || b->data + b->size <= a->data);
+        }
+    }
+
+    // 释放后再取回到同一个缓冲区, 不重新分配
+    uint8_t* released = frames.back()->buf[0]->data;
+    av_frame_free(&frames.back());
+    frames.pop_back();
+    AVFrame* again = GetFrame(context, AV_PIX_FMT_YUV420P, 640, 360);
+    CHECK(again != nullptr && again->buf[0]->data == released);
+    frames.push_back(again);
+
+    for (AVFrame*& frame : frames)
+    {
+        av_frame_free(&frame);
+    }
+    FramePool::FreeContext(&context);
+}
+
+TEST_CASE(FramePool, FramesOutliveContextAndFormatChange)
+{
+    AVCodecContext* context = CreateContext();
+    CHECK(context != nullptr);
+    if (!context)
+        return;
+
+    // 格式变化后旧布局的帧仍然有效, 释放解码器后同样有效（由最后归还的帧释放分块内存）
+    AVFrame* oldFrame = GetFrame(context, AV_PIX_FMT_YUV420P, 320, 240);
+    AVFrame* newFrame = GetFrame(context, AV_PIX_FMT_YUV420P, 1280, 720);
+    CHECK(oldFrame != nullptr && newFrame != nullptr);
+    FramePool::FreeContext(&context);
+    CHECK(context == nullptr);
+
+    if (oldFrame && newFrame)
+    {
+        memset(oldFrame->data[0], 0x10, (size_t)oldFrame->linesize[0] * oldFrame->height);
+        memset(newFrame->data[2], 0x80, (size_t)newFrame->linesize[2] * (newFrame->height / 2));
+        CHECK(oldFrame->data[0][0] == 0x10);
+    }
+    av_frame_free(&oldFrame);
+    av_frame_free(&newFrame);
+}
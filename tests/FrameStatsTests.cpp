@@ -0,0 +1,188 @@
+#include "TestHarness.h"
+#include "FrameStats.h"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+static const double VSYNC_MS = 1000.0 / 60.0;
+
+// 按 60 Hz 节奏解码的帧：第 sequence 帧在 (sequence - 1) 个刷新周期处解码完成, 截止时间为下一个周期
+static FrameTiming MakeFrame(uint64_t sequence, double presentedMs)
+{
+    FrameTiming timing = FrameTiming{};
+    timing.sequence = sequence;
+    timing.pts = (sequence - 1) / 60.0;
+    timing.decodeDoneMs = (sequence - 1) * VSYNC_MS;
+    timing.convertDoneMs = timing.decodeDoneMs;
+    timing.filterDoneMs = timing.decodeDoneMs;
+    timing.deadlineMs = timing.decodeDoneMs + VSYNC_MS;
+    timing.presentedMs = presentedMs;
+    return timing;
+}
+
+TEST_CASE(FrameStats, SequenceGapsCountAsDropped)
+{
+    FrameStatsRecorder recorder;
+    recorder.RecordPresented(MakeFrame(1, 5.0));
+    recorder.RecordPresented(MakeFrame(2, 5.0 + VSYNC_MS));
+    recorder.RecordPresented(MakeFrame(5, 5.0 + 4 * VSYNC_MS));     // 3、4 被覆盖
+    recorder.RecordPresented(MakeFrame(6, 5.0 + 5 * VSYNC_MS));
+    recorder.RecordRepeat();
+    recorder.RecordRepeat();
+
+    FrameStatsSummary summary = recorder.GetSummary();
+    CHECK(summary.presentedFrames == 4);
+    CHECK(summary.droppedFrames == 2);
+    CHECK(summary.repeatedPresents == 2);
+    CHECK(summary.lateFrames == 0);
+    CHECK_NEAR(summary.averageLatencyMs, 5.0, 1e-9);
+
+    // 序号回退（跳转后重新开始）不算丢帧
+    recorder.RecordPresented(MakeFrame(1, 200.0));
+    CHECK(recorder.GetSummary().droppedFrames == 2);
+}
+
+TEST_CASE(FrameStats, LateFramesPassTheirDeadline)
+{
+    FrameStatsRecorder recorder;
+    recorder.RecordPresented(MakeFrame(1, VSYNC_MS - 1.0));
+    recorder.RecordPresented(MakeFrame(2, 2 * VSYNC_MS));            // 恰好在截止时间, 不算迟到
+    recorder.RecordPresented(MakeFrame(3, 3 * VSYNC_MS + 0.5));
+    FrameTiming noDeadline = MakeFrame(4, 1000.0);
+    noDeadline.deadlineMs = 0.0;                                      // 没有截止时间的帧不判定迟到
+    recorder.RecordPresented(noDeadline);
+
+    CHECK(recorder.GetSummary().lateFrames == 1);
+    FrameTiming recent[4];
+    CHECK(recorder.GetRecent(recent, 4) == 4);
+    CHECK(!recent[0].late && !recent[1].late && recent[2].late && !recent[3].late);
+}
+
+TEST_CASE(FrameStats, MissedVsyncsNeedAKnownInterval)
+{
+    FrameStatsRecorder recorder;
+    recorder.SetVsyncInterval(VSYNC_MS);
+    recorder.RecordPresented(MakeFrame(1, 10.0));
+    recorder.RecordPresented(MakeFrame(2, 10.0 + VSYNC_MS));         // 准时
+    recorder.RecordPresented(MakeFrame(3, 10.0 + 4 * VSYNC_MS));     // 多等了 2 个周期
+    recorder.RecordPresented(MakeFrame(5, 10.0 + 6 * VSYNC_MS));     // 跳过一帧, 预期间隔按 2 帧计, 准时
+    recorder.RecordPresented(MakeFrame(6, 10.0 + 7.4 * VSYNC_MS));   // 多 0.4 个周期, 不足半个周期
+
+    FrameStatsSummary summary = recorder.GetSummary();
+    CHECK(summary.missedVsyncs == 2);
+    CHECK_NEAR(summary.vsyncIntervalMs, VSYNC_MS, 1e-12);
+    FrameTiming recent[5];
+    recorder.GetRecent(recent, 5);
+    CHECK(recent[1].missedVsyncs == 0);
+    CHECK(recent[2].missedVsyncs == 2);
+    CHECK(recent[3].missedVsyncs == 0);
+    CHECK(recent[4].missedVsyncs == 0);
+    CHECK_NEAR(recent[2].frameTimeMs, 3 * VSYNC_MS, 1e-9);
+
+    // 刷新周期未知时不统计
+    FrameStatsRecorder unknown;
+    unknown.RecordPresented(MakeFrame(1, 10.0));
+    unknown.RecordPresented(MakeFrame(2, 10.0 + 4 * VSYNC_MS));
+    CHECK(unknown.GetSummary().missedVsyncs == 0);
+}
+
+TEST_CASE(FrameStats, PercentilesFromHistogram)
+{
+    FrameStatsRecorder recorder;
+    CHECK(recorder.GetSummary().p50FrameTimeMs == 0.0);
+
+    // 180 个 10.2ms、17 个 20.5ms、3 个 150ms 的帧间隔
+    double now = 0.0;
+    uint64_t sequence = 1;
+    recorder.RecordPresented(MakeFrame(sequence++, now));
+    for (int i = 0; i < 200; i++)
+    {
+        now += (i < 180) ? 10.2 : (i < 197) ? 20.5 : 150.0;
+        recorder.RecordPresented(MakeFrame(sequence++, now));
+    }
+
+    // 分位数取所在 1ms 格的上界, 超出直方图范围时取最大值
+    FrameStatsSummary summary = recorder.GetSummary();
+    CHECK(summary.p50FrameTimeMs == 11.0);
+    CHECK(summary.p95FrameTimeMs == 21.0);
+    CHECK(summary.p99FrameTimeMs == 150.0);
+    CHECK(summary.maxFrameTimeMs == 150.0);
+    CHECK_NEAR(summary.averageFrameTimeMs, (180 * 10.2 + 17 * 20.5 + 3 * 150.0) / 200.0, 1e-9);
+
+    const std::vector<uint64_t>& histogram = recorder.GetHistogram();
+    CHECK(histogram.size() == FrameStatsRecorder::HISTOGRAM_MAX_MS + 1);
+    CHECK(histogram[10] == 180);
+    CHECK(histogram[20] == 17);
+    CHECK(histogram[FrameStatsRecorder::HISTOGRAM_MAX_MS] == 3);
+
+    // 上界不超过最大值
+    FrameStatsRecorder steady;
+    for (int i = 0; i < 10; i++)
+    {
+        steady.RecordPresented(MakeFrame(i + 1, i * 10.0));
+    }
+    CHECK(steady.GetSummary().p99FrameTimeMs == 10.0);
+}
+
+TEST_CASE(FrameStats, RecentFramesWrapAround)
+{
+    FrameStatsRecorder recorder(4);
+    for (uint64_t i = 1; i <= 6; i++)
+    {
+        recorder.RecordPresented(MakeFrame(i, i * VSYNC_MS));
+    }
+    FrameTiming recent[8];
+    CHECK(recorder.GetRecent(recent, 8) == 4);
+    for (int i = 0; i < 4; i++)
+    {
+        CHECK(recent[i].sequence == (uint64_t)(i + 3));
+    }
+    CHECK(recorder.GetRecent(recent, 2) == 2);
+    CHECK(recent[0].sequence == 5 && recent[1].sequence == 6);
+
+    recorder.Reset();
+    CHECK(recorder.GetRecent(recent, 8) == 0);
+    CHECK(recorder.GetSummary().presentedFrames == 0);
+}
+
+TEST_CASE(FrameStats, ReportAndExports)
+{
+    FrameStatsRecorder recorder;
+    recorder.SetVsyncInterval(VSYNC_MS);
+    recorder.RecordPresented(MakeFrame(1, 5.0));
+    recorder.RecordPresented(MakeFrame(2, 5.0 + VSYNC_MS));
+    recorder.RecordPresented(MakeFrame(4, 5.0 + 3 * VSYNC_MS));
+
+    std::ostringstream report;
+    report.precision(3);
+    recorder.WriteReport(report);
+    std::string text = report.str();
+    CHECK(text.find("Frame pacing: 3 presented, 1 dropped, 0 repeated, 0 late, 0 missed vsyncs (vsync 16.67 ms)") == 0);
+    CHECK(text.find("   16-17   ms        1 ") != std::string::npos);
+    CHECK(text.find("   33-34   ms        1 ") != std::string::npos);
+    CHECK(report.precision() == 3);     // 不改变调用方的流格式
+
+    std::string csvPath = "frame_stats_test.csv";
+    CHECK(recorder.ExportCsv(csvPath));
+    std::ifstream csv(csvPath);
+    std::string line;
+    int lines = 0;
+    while (std::getline(csv, line))
+    {
+        lines++;
+    }
+    csv.close();
+    remove(csvPath.c_str());
+    CHECK(lines == 4);
+
+    std::string jsonPath = "frame_stats_test.json";
+    CHECK(recorder.ExportJson(jsonPath));
+    std::ifstream json(jsonPath);
+    std::stringstream content;
+    content << json.rdbuf();
+    json.close();
+    remove(jsonPath.c_str());
+    CHECK(content.str().find("\"dropped_frames\": 1") != std::string::npos);
+    CHECK(content.str().find("\"sequence\": 4") != std::string::npos);
+}
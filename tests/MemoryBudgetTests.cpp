@@ -0,0 +1,197 @@
+#include "TestHarness.h"
+#include "MemoryBudget.h"
+#include <cstring>
+#include <thread>
+#include <vector>
+
+// MemoryBudget 是进程级单例, 测试只比较前后的差值, 结束时恢复不限制
+
+static MemoryCategoryStats CategoryStats(MemoryCategory category)
+{
+    return MemoryBudget::Instance().GetStats().categories[(int)category];
+}
+
+TEST_CASE(MemoryBudget, AddRemovePerCategory)
+{
+    MemoryBudget& budget = MemoryBudget::Instance();
+    MemoryBudgetStats before = budget.GetStats();
+
+    budget.Add(MemoryCategory::DECODED_FRAMES, 1000);
+    budget.Add(MemoryCategory::AUDIO, 300);
+    budget.Add(MemoryCategory::DECODED_FRAMES, 500);
+
+    MemoryBudgetStats during = budget.GetStats();
+    int decoded = (int)MemoryCategory::DECODED_FRAMES;
+    int audio = (int)MemoryCategory::AUDIO;
+    int packets = (int)MemoryCategory::PACKETS;
+    CHECK(during.categories[decoded].bytes == before.categories[decoded].bytes + 1500);
+    CHECK(during.categories[audio].bytes == before.categories[audio].bytes + 300);
+    CHECK(during.categories[packets].bytes == before.categories[packets].bytes);
+    CHECK(during.categories[decoded].allocations == before.categories[decoded].allocations + 2);
+    CHECK(during.categories[audio].allocations == before.categories[audio].allocations + 1);
+    CHECK(during.totalBytes == before.totalBytes + 1800);
+    CHECK(budget.TotalBytes() == during.totalBytes);
+
+    budget.Remove(MemoryCategory::DECODED_FRAMES, 1500);
+    budget.Remove(MemoryCategory::AUDIO, 300);
+
+    // 归还不减少累计计入次数
+    MemoryBudgetStats after = budget.GetStats();
+    CHECK(after.categories[decoded].bytes == before.categories[decoded].bytes);
+    CHECK(after.categories[audio].bytes == before.categories[audio].bytes);
+    CHECK(after.categories[decoded].allocations == during.categories[decoded].allocations);
+    CHECK(after.totalBytes == before.totalBytes);
+}
+
+TEST_CASE(MemoryBudget, PeakTracking)
+{
+    MemoryBudget& budget = MemoryBudget::Instance();
+    MemoryBudgetStats before = budget.GetStats();
+    int index = (int)MemoryCategory::CONVERTED_FRAMES;
+
+    // 超过之前的峰值, 峰值等于当前使用量
+    size_t bytes = (size_t)(before.peakTotalBytes + 4096);
+    budget.Add(MemoryCategory::CONVERTED_FRAMES, bytes);
+    MemoryBudgetStats during = budget.GetStats();
+    CHECK(during.categories[index].peakBytes == before.categories[index].bytes + bytes);
+    CHECK(during.peakTotalBytes == before.totalBytes + bytes);
+
+    // 归还后峰值保持; 较小的再次计入不改变峰值
+    budget.Remove(MemoryCategory::CONVERTED_FRAMES, bytes);
+    budget.Add(MemoryCategory::CONVERTED_FRAMES, 100);
+    MemoryBudgetStats after = budget.GetStats();
+    CHECK(after.categories[index].peakBytes == during.categories[index].peakBytes);
+    CHECK(after.peakTotalBytes == during.peakTotalBytes);
+    CHECK(after.categories[index].bytes == before.categories[index].bytes + 100);
+    budget.Remove(MemoryCategory::CONVERTED_FRAMES, 100);
+}
+
+TEST_CASE(MemoryBudget, AvailableWithoutLimit)
+{
+    MemoryBudget& budget = MemoryBudget::Instance();
+    budget.SetLimit(0);
+    CHECK(budget.GetLimit() == 0);
+
+    budget.Add(MemoryCategory::PACKETS, (size_t)1 << 30);
+    CHECK(budget.Available() == UINT64_MAX);
+    CHECK(!budget.IsOverBudget());
+    CHECK(budget.GetStats().limit == 0);
+    budget.Remove(MemoryCategory::PACKETS, (size_t)1 << 30);
+}
+
+TEST_CASE(MemoryBudget, AvailableWithLimit)
+{
+    MemoryBudget& budget = MemoryBudget::Instance();
+    uint64_t total = budget.TotalBytes();
+    budget.SetLimit(total + 1000);
+    CHECK(budget.GetStats().limit == total + 1000);
+    CHECK(budget.Available() == 1000);
+    CHECK(!budget.IsOverBudget());
+
+    // 恰好用满不算超出
+    budget.Add(MemoryCategory::INPUT_CACHE, 1000);
+    CHECK(budget.Available() == 0);
+    CHECK(!budget.IsOverBudget());
+
+    // 超出时剩余为 0 而不是回绕
+    budget.Add(MemoryCategory::INPUT_CACHE, 500);
+    CHECK(budget.Available() == 0);
+    CHECK(budget.IsOverBudget());
+
+    budget.Remove(MemoryCategory::INPUT_CACHE, 1200);
+    CHECK(budget.Available() == 700);
+    CHECK(!budget.IsOverBudget());
+
+    budget.Remove(MemoryCategory::INPUT_CACHE, 300);
+    budget.SetLimit(0);
+    CHECK(budget.TotalBytes() == total);
+    CHECK(!budget.IsOverBudget());
+}
+
+TEST_CASE(MemoryBudget, ChargeSetResizesAndReleases)
+{
+    MemoryBudget& budget = MemoryBudget::Instance();
+    MemoryCategoryStats before = CategoryStats(MemoryCategory::AUDIO);
+    uint64_t total = budget.TotalBytes();
+
+    {
+        MemoryCharge charge(MemoryCategory::AUDIO);
+        CHECK(charge.Bytes() == 0);
+
+        charge.Set(4096);
+        CHECK(charge.Bytes() == 4096);
+        CHECK(CategoryStats(MemoryCategory::AUDIO).bytes == before.bytes + 4096);
+        CHECK(CategoryStats(MemoryCategory::AUDIO).allocations == before.allocations + 1);
+
+        // 改变大小：归还旧的大小再计入新的大小, 总量只反映新的大小
+        charge.Set(10000);
+        CHECK(charge.Bytes() == 10000);
+        CHECK(CategoryStats(MemoryCategory::AUDIO).bytes == before.bytes + 10000);
+        CHECK(CategoryStats(MemoryCategory::AUDIO).allocations == before.allocations + 2);
+        CHECK(budget.TotalBytes() == total + 10000);
+
+        // 大小不变时不记账
+        charge.Set(10000);
+        CHECK(CategoryStats(MemoryCategory::AUDIO).allocations == before.allocations + 2);
+
+        charge.Set(2000);
+        CHECK(CategoryStats(MemoryCategory::AUDIO).bytes == before.bytes + 2000);
+    }
+
+    // 析构时归还
+    CHECK(CategoryStats(MemoryCategory::AUDIO).bytes == before.bytes);
+    CHECK(budget.TotalBytes() == total);
+
+    {
+        MemoryCharge charge(MemoryCategory::AUDIO);
+        charge.Set(500);
+        charge.Set(0);
+        CHECK(charge.Bytes() == 0);
+        CHECK(CategoryStats(MemoryCategory::AUDIO).bytes == before.bytes);
+    }
+    CHECK(budget.TotalBytes() == total);
+}
+
+TEST_CASE(MemoryBudget, ConcurrentChargesBalance)
+{
+    static const int THREADS = 8;
+    static const int ITERATIONS = 20000;
+    MemoryBudget& budget = MemoryBudget::Instance();
+    uint64_t total = budget.TotalBytes();
+    uint64_t peakBefore = budget.GetStats().peakTotalBytes;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; t++)
+    {
+        threads.emplace_back([t]() {
+            MemoryCategory category = (MemoryCategory)(t % (int)MemoryCategory::COUNT);
+            MemoryCharge charge(category);
+            for (int i = 0; i < ITERATIONS; i++)
+            {
+                charge.Set((size_t)(i % 64 + 1) * 1024);
+            }
+        });
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    MemoryBudgetStats stats = budget.GetStats();
+    CHECK(stats.totalBytes == total);
+    CHECK(stats.peakTotalBytes >= peakBefore);
+    CHECK(stats.peakTotalBytes >= total + 64 * 1024);
+}
+
+TEST_CASE(MemoryBudget, DegradationsAndNames)
+{
+    MemoryBudget& budget = MemoryBudget::Instance();
+    uint64_t before = budget.GetStats().degradations;
+    budget.RecordDegradation();
+    budget.RecordDegradation();
+    CHECK(budget.GetStats().degradations == before + 2);
+
+    CHECK(strcmp(MemoryBudget::CategoryName(MemoryCategory::DECODED_FRAMES), "decoded frames") == 0);
+    CHECK(strcmp(MemoryBudget::CategoryName(MemoryCategory::INPUT_CACHE), "input cache") == 0);
+    CHECK(strcmp(MemoryBudget::CategoryName(MemoryCategory::COUNT), "unknown") == 0);
+}
@@ -0,0 +1,380 @@
+#include "TestHarness.h"
+#include "OffscreenRenderer.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+// 测试图像：BGRA, 每个像素颜色不同
+static std::vector<uint8_t> MakeImage(int width, int height, FrameInfo& info)
+{
+    info = FrameInfo{};
+    info.width = width;
+    info.height = height;
+    info.stride = width * 4;
+    std::vector<uint8_t> image((size_t)info.stride * height);
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            uint8_t* pixel = image.data() + (size_t)y * info.stride + x * 4;
+            pixel[0] = (uint8_t)(x * 37 + y * 11);
+            pixel[1] = (uint8_t)(x * 5 + y * 71);
+            pixel[2] = (uint8_t)(255 - x * 13 - y * 3);
+            pixel[3] = 0xFF;
+        }
+    }
+    return image;
+}
+
+static std::vector<uint8_t> ReadFile(const std::string& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    return std::vector<uint8_t>((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+}
+
+static uint32_t ReadBigEndian32(const uint8_t* data)
+{
+    return ((uint32_t)data[0] << 24) | ((uint32_t)data[1] << 16) | ((uint32_t)data[2] << 8) | data[3];
+}
+
+static uint32_t ReferenceCrc32(const uint8_t* data, size_t size)
+{
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < size; i++)
+    {
+        crc ^= data[i];
+        for (int k = 0; k < 8; k++)
+        {
+            crc = (crc & 1) ? 0xEDB88320u ^ (crc >> 1) : crc >> 1;
+        }
+    }
+    return ~crc;
+}
+
+// 解码渲染器写出的 PNG（8 位 RGB, zlib 存储块）, 逐项校验格式, 返回 RGB 像素; 失败时返回空
+static std::vector<uint8_t> DecodeStoredPng(const std::vector<uint8_t>& file, int& width, int& height)
+{
+    static const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    std::vector<uint8_t> none;
+    if (file.size() < 8 || memcmp(file.data(), signature, 8) != 0)
+        return none;
+
+    std::vector<uint8_t> zlib;
+    bool sawHeader = false, sawEnd = false;
+    size_t pos = 8;
+    while (pos + 12 <= file.size() && !sawEnd)
+    {
+        uint32_t length = ReadBigEndian32(&file[pos]);
+        if (pos + 12 + length > file.size())
+            return none;
+        std::string type((const char*)&file[pos + 4], 4);
+        const uint8_t* data = &file[pos + 8];
+        // CRC 覆盖类型和数据
+        CHECK(ReadBigEndian32(data + length) == ReferenceCrc32(&file[pos + 4], length + 4));
+        if (type == "IHDR")
+        {
+            CHECK(length == 13);
+            width = (int)ReadBigEndian32(data);
+            height = (int)ReadBigEndian32(data + 4);
+            CHECK(data[8] == 8);    // 位深
+            CHECK(data[9] == 2);    // RGB
+            CHECK(data[10] == 0 && data[11] == 0 && data[12] == 0);
+            sawHeader = true;
+        }
+        else if (type == "IDAT")
+        {
+            zlib.insert(zlib.end(), data, data + length);
+        }
+        else if (type == "IEND")
+        {
+            CHECK(length == 0);
+            sawEnd = true;
+        }
+        pos += 12 + length;
+    }
+    if (!sawHeader || !sawEnd || zlib.size() < 6)
+        return none;
+
+    // zlib 头部 (CMF/FLG 校验), 之后是 deflate 存储块, 最后是 Adler-32
+    CHECK((zlib[0] & 0x0F) == 8);
+    CHECK(((zlib[0] << 8) | zlib[1]) % 31 == 0);
+    std::vector<uint8_t> raw;
+    size_t offset = 2;
+    bool last = false;
+    while (!last)
+    {
+        if (offset + 5 > zlib.size() || (zlib[offset] & 0x06) != 0)
+            return none;
+        last = (zlib[offset] & 1) != 0;
+        uint16_t len = (uint16_t)(zlib[offset + 1] | (zlib[offset + 2] << 8));
+        uint16_t nlen = (uint16_t)(zlib[offset + 3] | (zlib[offset + 4] << 8));
+        CHECK((uint16_t)~len == nlen);
+        offset += 5;
+        if (offset + len > zlib.size())
+            return none;
+        raw.insert(raw.end(), zlib.begin() + offset, zlib.begin() + offset + len);
+        offset += len;
+    }
+    if (offset + 4 != zlib.size())
+        return none;
+    uint32_t a = 1, b = 0;
+    for (uint8_t value : raw)
+    {
+        a = (a + value) % 65521;
+        b = (b + a) % 65521;
+    }
+    CHECK(ReadBigEndian32(&zlib[offset]) == ((b << 16) | a));
+
+    // 每行一个过滤类型字节, 渲染器只使用 None
+    size_t rowBytes = (size_t)width * 3 + 1;
+    if (raw.size() != rowBytes * height)
+        return none;
+    std::vector<uint8_t> rgb;
+    for (int y = 0; y < height; y++)
+    {
+        CHECK(raw[y * rowBytes] == 0);
+        rgb.insert(rgb.end(), raw.begin() + y * rowBytes + 1, raw.begin() + (y + 1) * rowBytes);
+    }
+    return rgb;
+}
+
+TEST_CASE(OffscreenRenderer, PresentCentresFrameOnBlack)
+{
+    FrameInfo info;
+    std::vector<uint8_t> image = MakeImage(5, 3, info);
+    OffscreenRenderer renderer;
+    CHECK(renderer.Initialize(9, 7));
+    renderer.SetScalingMode(ScalingMode::ORIGINAL_SIZE);
+    CHECK(renderer.Present(image.data(), info, 4));
+    CHECK(renderer.Clock().FrameIndex() == 1);
+
+    // 原始尺寸居中：偏移 (2, 2), 其余为不透明黑色
+    for (int y = 0; y < 7; y++)
+    {
+        for (int x = 0; x < 9; x++)
+        {
+            const uint8_t* pixel = renderer.Framebuffer() + y * renderer.Stride() + x * 4;
+            bool inside = x >= 2 && x < 7 && y >= 2 && y < 5;
+            const uint8_t* expected = inside ? image.data() + (y - 2) * info.stride + (x - 2) * 4 : nullptr;
+            for (int c = 0; c < 3; c++)
+            {
+                CHECK(pixel[c] == (inside ? expected[c] : 0));
+            }
+            CHECK(pixel[3] == 0xFF);
+        }
+    }
+}
+
+TEST_CASE(OffscreenRenderer, Bgr24InputMatchesBgra)
+{
+    FrameInfo info;
+    std::vector<uint8_t> bgra = MakeImage(6, 4, info);
+    FrameInfo bgrInfo = info;
+    bgrInfo.stride = 6 * 3 + 2;
+    std::vector<uint8_t> bgr((size_t)bgrInfo.stride * 4, 0);
+    for (int y = 0; y < 4; y++)
+    {
+        for (int x = 0; x < 6; x++)
+        {
+            memcpy(&bgr[y * bgrInfo.stride + x * 3], &bgra[y * info.stride + x * 4], 3);
+        }
+    }
+
+    OffscreenRenderer a, b;
+    a.Initialize(6, 4);
+    b.Initialize(6, 4);
+    CHECK(a.Present(bgra.data(), info, 4));
+    CHECK(b.Present(bgr.data(), bgrInfo, 3));
+    CHECK(memcmp(a.Framebuffer(), b.Framebuffer(), 6 * 4 * 4) == 0);
+    CHECK(!a.Present(bgra.data(), info, 2));
+}
+
+TEST_CASE(OffscreenRenderer, FilterAndRedrawRegenerateFromSource)
+{
+    FrameInfo info;
+    std::vector<uint8_t> image = MakeImage(4, 4, info);
+    OffscreenRenderer renderer;
+    renderer.Initialize(4, 4);
+    renderer.Present(image.data(), info, 4);
+
+    // 黑白：与直接对源图像应用滤镜的结果相同, Redraw 不推进时钟
+    renderer.SetFilter(FilterType::GRAYSCALE, 0);
+    CHECK(renderer.Redraw());
+    std::vector<uint8_t> expected = image;
+    ApplyFrameFilter(FilterType::GRAYSCALE, 0, expected.data(), 4, 4, info.stride, 4);
+    CHECK(memcmp(renderer.Framebuffer(), expected.data(), expected.size()) == 0);
+    CHECK(renderer.Clock().FrameIndex() == 1);
+
+    // 换成马赛克：从未滤镜的源重新生成, 不会在黑白结果上叠加
+    renderer.SetFilter(FilterType::MOSAIC, 2);
+    CHECK(renderer.Redraw());
+    expected = image;
+    ApplyFrameFilter(FilterType::MOSAIC, 2, expected.data(), 4, 4, info.stride, 4);
+    CHECK(memcmp(renderer.Framebuffer(), expected.data(), expected.size()) == 0);
+
+    renderer.SetFilter(FilterType::NONE, 0);
+    CHECK(renderer.Redraw());
+    CHECK(memcmp(renderer.Framebuffer(), image.data(), image.size()) == 0);
+
+    OffscreenStats stats = renderer.GetStats();
+    CHECK(stats.presents == 4);
+    CHECK(stats.filterPasses == 2);
+}
+
+TEST_CASE(OffscreenRenderer, PngDecodesToFramebuffer)
+{
+    // 200x120 的扫描线超过一个存储块 (65535 字节), 覆盖多块输出
+    const int sizes[][2] = { { 9, 7 }, { 200, 120 } };
+    for (const auto& size : sizes)
+    {
+        FrameInfo info;
+        std::vector<uint8_t> image = MakeImage(5, 3, info);
+        OffscreenRenderer renderer;
+        renderer.Initialize(size[0], size[1]);
+        renderer.Present(image.data(), info, 4);
+
+        std::string path = "offscreen_test.png";
+        CHECK(renderer.SaveFrame(path, FrameDumpFormat::PNG));
+        int width = 0, height = 0;
+        std::vector<uint8_t> rgb = DecodeStoredPng(ReadFile(path), width, height);
+        remove(path.c_str());
+
+        CHECK(width == size[0] && height == size[1]);
+        CHECK(rgb.size() == (size_t)size[0] * size[1] * 3);
+        if (rgb.size() != (size_t)size[0] * size[1] * 3)
+            continue;
+        for (int i = 0; i < size[0] * size[1]; i++)
+        {
+            const uint8_t* bgra = renderer.Framebuffer() + i * 4;
+            CHECK(rgb[i * 3 + 0] == bgra[2]);
+            CHECK(rgb[i * 3 + 1] == bgra[1]);
+            CHECK(rgb[i * 3 + 2] == bgra[0]);
+        }
+    }
+}
+
+TEST_CASE(OffscreenRenderer, Y4mHeaderAndFrameSize)
+{
+    OffscreenRenderer renderer;
+    renderer.Initialize(8, 6);
+    renderer.Clock().SetFrameRate(30000, 1001);
+
+    // 白色帧：Y = 235, U = V = 128（BT.601 有限范围）
+    FrameInfo info = FrameInfo{};
+    info.width = 8;
+    info.height = 6;
+    info.stride = 32;
+    std::vector<uint8_t> white(32 * 6, 0xFF);
+
+    std::string path = "offscreen_test.y4m";
+    CHECK(renderer.StartCapture(path, FrameDumpFormat::Y4M));
+    for (int i = 0; i < 3; i++)
+    {
+        CHECK(renderer.Present(white.data(), info, 4));
+    }
+    renderer.StopCapture();
+    CHECK(renderer.GetStats().dumpedFrames == 3);
+
+    std::vector<uint8_t> file = ReadFile(path);
+    remove(path.c_str());
+    std::string header = "YUV4MPEG2 W8 H6 F30000:1001 Ip A1:1 C444\n";
+    size_t frameBytes = 6 + 8 * 6 * 3;
+    CHECK(file.size() == header.size() + 3 * frameBytes);
+    if (file.size() != header.size() + 3 * frameBytes)
+        return;
+    CHECK(std::string(file.begin(), file.begin() + header.size()) == header);
+    for (int frame = 0; frame < 3; frame++)
+    {
+        size_t offset = header.size() + frame * frameBytes;
+        CHECK(std::string(file.begin() + offset, file.begin() + offset + 6) == "FRAME\n");
+        offset += 6;
+        for (int i = 0; i < 48; i++)
+        {
+            CHECK(file[offset + i] == 235);
+            CHECK(file[offset + 48 + i] == 128);
+            CHECK(file[offset + 96 + i] == 128);
+        }
+    }
+}
+
+TEST_CASE(OffscreenRenderer, CaptureStopsOnResize)
+{
+    FrameInfo info;
+    std::vector<uint8_t> image = MakeImage(4, 4, info);
+    const FrameDumpFormat formats[] = { FrameDumpFormat::Y4M, FrameDumpFormat::RAW };
+    for (FrameDumpFormat format : formats)
+    {
+        OffscreenRenderer renderer;
+        renderer.Initialize(4, 4);
+        std::string path = "offscreen_test.capture";
+        CHECK(renderer.StartCapture(path, format));
+        CHECK(renderer.Present(image.data(), info, 4));
+
+        // Y4M/RAW 流中的帧必须等大, 尺寸变化后的第一次呈现结束捕获
+        renderer.Resize(8, 8);
+        CHECK(renderer.Present(image.data(), info, 4));
+        CHECK(!renderer.IsCapturing());
+        CHECK(renderer.GetStats().dumpedFrames == 1);
+        CHECK(renderer.Present(image.data(), info, 4));
+        CHECK(renderer.GetStats().dumpedFrames == 1);
+
+        std::vector<uint8_t> file = ReadFile(path);
+        remove(path.c_str());
+        size_t expected = (format == FrameDumpFormat::RAW) ? 4 * 4 * 4
+                                                           : std::string("YUV4MPEG2 W4 H4 F25:1 Ip A1:1 C444\n").size() + 6 + 4 * 4 * 3;
+        CHECK(file.size() == expected);
+    }
+}
+
+TEST_CASE(OffscreenRenderer, PngCaptureNamesFilesByFrameIndex)
+{
+    FrameInfo info;
+    std::vector<uint8_t> image = MakeImage(4, 4, info);
+    OffscreenRenderer renderer;
+    renderer.Initialize(4, 4);
+    CHECK(!renderer.StartCapture("offscreen_no_pattern.png", FrameDumpFormat::PNG));
+    CHECK(renderer.StartCapture("offscreen_test_%02d.png", FrameDumpFormat::PNG));
+    renderer.Present(image.data(), info, 4);
+    renderer.Present(image.data(), info, 4);
+    renderer.StopCapture();
+    renderer.Present(image.data(), info, 4);
+
+    CHECK(!ReadFile("offscreen_test_00.png").empty());
+    CHECK(!ReadFile("offscreen_test_01.png").empty());
+    CHECK(ReadFile("offscreen_test_02.png").empty());
+    remove("offscreen_test_00.png");
+    remove("offscreen_test_01.png");
+    CHECK(renderer.GetStats().dumpedFrames == 2);
+}
+
+// 无窗口基准：720p 合成帧经滤镜并缩放到 1080p 帧缓冲区, 输出每秒呈现帧数和帧节奏报告（截止时间为 60fps 的帧间隔）
+BENCHMARK(OffscreenRenderer, Present)
+{
+    const int frames = 120;
+    FrameInfo info;
+    std::vector<uint8_t> image = MakeImage(1280, 720, info);
+    OffscreenRenderer renderer;
+    renderer.Initialize(1920, 1080);
+    renderer.Clock().SetFrameRate(60, 1);
+
+    const FilterType filters[] = { FilterType::NONE, FilterType::GRAYSCALE, FilterType::MOSAIC };
+    for (FilterType filter : filters)
+    {
+        renderer.SetFilter(filter, 8);
+        double start = BenchNowSeconds();
+        for (int i = 0; i < frames; i++)
+        {
+            // 每帧内容不同, 避免只测到缓存命中
+            image[(size_t)(i % 720) * info.stride] = (uint8_t)i;
+            renderer.Present(image.data(), info, 4);
+        }
+        const char* label = (filter == FilterType::NONE) ? "Present 720p->1080p" :
+                            (filter == FilterType::GRAYSCALE) ? "Present 720p->1080p grayscale" : "Present 720p->1080p mosaic";
+        std::cout << "  " << label << ": " << frames / (BenchNowSeconds() - start) << " frames/s" << std::endl;
+    }
+    renderer.FrameStats().WriteReport(std::cout);
+}
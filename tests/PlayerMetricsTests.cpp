@@ -0,0 +1,172 @@
+#include "TestHarness.h"
+#include "PlayerMetrics.h"
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 分位数取所在桶的上界（并钳位到最大值）, 相对误差不超过 1/16
+static void CheckQuantile(double actual, double exact)
+{
+    CHECK(actual >= exact);
+    CHECK(actual <= exact * (1.0 + 1.0 / 16.0) + 1.0);
+}
+
+TEST_CASE(PlayerMetrics, SmallValuesAreExact)
+{
+    LatencyHistogram histogram;
+    for (uint64_t us = 0; us < 16; us++)
+    {
+        histogram.Record(us);
+    }
+    LatencySummary summary = histogram.Summarize();
+    CHECK(summary.count == 16);
+    CHECK(summary.minUs == 0.0);
+    CHECK(summary.maxUs == 15.0);
+    CHECK_NEAR(summary.meanUs, 7.5, 1e-9);
+    CHECK(summary.p50Us == 7.0);
+    CHECK(summary.p90Us == 14.0);
+    CHECK(summary.p999Us == 15.0);
+}
+
+TEST_CASE(PlayerMetrics, QuantilesWithinBucketError)
+{
+    LatencyHistogram histogram;
+    for (uint64_t us = 1; us <= 100000; us++)
+    {
+        histogram.Record(us);
+    }
+    LatencySummary summary = histogram.Summarize();
+    CHECK(summary.count == 100000);
+    CHECK(summary.minUs == 1.0);
+    CHECK(summary.maxUs == 100000.0);
+    CHECK_NEAR(summary.meanUs, 50000.5, 1e-6);
+    CheckQuantile(summary.p50Us, 50000.0);
+    CheckQuantile(summary.p90Us, 90000.0);
+    CheckQuantile(summary.p99Us, 99000.0);
+    CHECK(summary.p999Us <= summary.maxUs);
+    CheckQuantile(summary.p999Us, 99900.0);
+}
+
+TEST_CASE(PlayerMetrics, SingleValueAcrossRange)
+{
+    // 在直方图范围（2^32 us）内每个 2 的幂区间的边界附近各取几个值, 最大值所在桶的分位数钳位到最大值即精确值
+    for (int bit = 4; bit < 32; bit++)
+    {
+        const uint64_t values[] = { (1ull << bit) - 1, 1ull << bit, (1ull << bit) + 1, (3ull << bit) / 2 };
+        for (uint64_t value : values)
+        {
+            LatencyHistogram histogram;
+            histogram.Record(value);
+            histogram.Record(value / 2);
+            LatencySummary summary = histogram.Summarize();
+            CHECK(summary.p999Us == (double)value);
+            CheckQuantile(summary.p50Us, (double)(value / 2));
+        }
+    }
+}
+
+TEST_CASE(PlayerMetrics, OutliersAndReset)
+{
+    LatencyHistogram histogram;
+    for (int i = 0; i < 999; i++)
+    {
+        histogram.Record(100);
+    }
+    histogram.Record(1ull << 40);     // 超出范围的值计入最后一个桶, 分位数不超过最大值
+    LatencySummary summary = histogram.Summarize();
+    CheckQuantile(summary.p99Us, 100.0);
+    CHECK(summary.maxUs == (double)(1ull << 40));
+    CHECK(summary.p999Us <= summary.maxUs);
+
+    histogram.Reset();
+    summary = histogram.Summarize();
+    CHECK(summary.count == 0);
+    CHECK(summary.maxUs == 0.0);
+    CHECK(summary.p50Us == 0.0);
+}
+
+TEST_CASE(PlayerMetrics, ConcurrentRecording)
+{
+    LatencyHistogram histogram;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++)
+    {
+        threads.emplace_back([&histogram, t]() {
+            for (uint64_t i = 0; i < 50000; i++)
+            {
+                histogram.Record(i % 1000 + (uint64_t)t);
+            }
+        });
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+    LatencySummary summary = histogram.Summarize();
+    CHECK(summary.count == 200000);
+    CHECK(summary.minUs == 0.0);
+    CHECK(summary.maxUs == 1002.0);
+}
+
+TEST_CASE(PlayerMetrics, SnapshotAndDump)
+{
+    PlayerMetrics& metrics = PlayerMetrics::Instance();
+    if (!PlayerMetrics::IsEnabled())
+    {
+        CHECK(!metrics.GetStats().enabled);
+        return;
+    }
+
+    metrics.Reset();
+    PlayerMetrics::Record(MetricStage::DEMUX, 120);
+    PlayerMetrics::Record(MetricStage::DEMUX, 80);
+    PlayerMetrics::Count(MetricCounter::DEMUX_PACKETS, 2);
+    PlayerMetrics::SetGauge(MetricGauge::AUDIO_SYNC_DIFF_US, -350);
+
+    MetricsSnapshot snapshot = metrics.GetStats();
+    CHECK(snapshot.enabled);
+    CHECK(snapshot.stages[(int)MetricStage::DEMUX].count == 2);
+    CHECK(snapshot.stages[(int)MetricStage::DEMUX].maxUs == 120.0);
+    CHECK(snapshot.stages[(int)MetricStage::PRESENT].count == 0);
+    CHECK(snapshot.counters[(int)MetricCounter::DEMUX_PACKETS] == 2);
+    CHECK(snapshot.gauges[(int)MetricGauge::AUDIO_SYNC_DIFF_US] == -350);
+
+    // 每行一个 JSON 对象, 停止时写最后一行
+    std::string path = "player_metrics_test.jsonl";
+    CHECK(metrics.StartDump(path, 10));
+    CHECK(metrics.IsDumping());
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    metrics.StopDump();
+    CHECK(!metrics.IsDumping());
+
+    std::ifstream in(path);
+    std::string line;
+    int lines = 0;
+    bool sawDemux = false;
+    while (std::getline(in, line))
+    {
+        lines++;
+        CHECK(line.compare(0, 12, "{\"uptimeMs\":") == 0);
+        CHECK(line.back() == '}');
+        sawDemux = sawDemux || line.find("\"demux\":{\"count\":2,") != std::string::npos;
+    }
+    in.close();
+    CHECK(lines >= 1);
+    CHECK(sawDemux);
+    remove(path.c_str());
+    metrics.Reset();
+}
+
+BENCHMARK(PlayerMetrics, Record)
+{
+    LatencyHistogram histogram;
+    const int count = 10000000;
+    double start = BenchNowSeconds();
+    for (int i = 0; i < count; i++)
+    {
+        histogram.Record((uint64_t)(i & 0xFFFF));
+    }
+    ReportThroughput("LatencyHistogram::Record", count, BenchNowSeconds() - start, "records");
+}
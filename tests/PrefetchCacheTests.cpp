@@ -0,0 +1,436 @@
+#include "TestHarness.h"
+#include "PrefetchCache.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+// 内存中的文件：内容由偏移算出（放错位置的数据一定不相等）, 可以截短、在某个偏移处暂停读取或返回错误
+class MemoryFile {
+public:
+    explicit MemoryFile(int64_t size)
+        : m_size(size)
+        , m_blockAt(-1)
+        , m_blocked(false)
+        , m_failAt(-1)
+    {
+    }
+
+    static uint8_t ByteAt(int64_t offset)
+    {
+        return (uint8_t)(((uint32_t)offset * 2654435761u) >> 24);
+    }
+
+    int64_t Read(int64_t offset, uint8_t* buffer, size_t size)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (m_blockAt >= 0 && offset >= m_blockAt)
+        {
+            // 只暂停一次, 等测试调用 Release
+            m_blockAt = -1;
+            m_blocked = true;
+            m_changed.notify_all();
+            m_changed.wait(lock, [this]() { return !m_blocked; });
+        }
+        if (m_failAt >= 0 && offset >= m_failAt)
+            return -1;
+
+        int64_t count = (std::max)((int64_t)0, (std::min)((int64_t)size, m_size - offset));
+        for (int64_t i = 0; i < count; i++)
+        {
+            buffer[i] = ByteAt(offset + i);
+        }
+        return count;
+    }
+
+    PrefetchCache::ReadFunction Reader()
+    {
+        return [this](int64_t offset, uint8_t* buffer, size_t size) { return Read(offset, buffer, size); };
+    }
+
+    void Truncate(int64_t size)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_size = size;
+    }
+
+    void FailAt(int64_t offset)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_failAt = offset;
+    }
+
+    void BlockAt(int64_t offset)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_blockAt = offset;
+    }
+
+    // 等待预读线程停在 BlockAt 设置的偏移处
+    bool WaitBlocked()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        return m_changed.wait_for(lock, std::chrono::seconds(5), [this]() { return m_blocked; });
+    }
+
+    void Release()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_blocked = false;
+        }
+        m_changed.notify_all();
+    }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_changed;
+    int64_t m_size;
+    int64_t m_blockAt;
+    bool m_blocked;
+    int64_t m_failAt;
+};
+
+// 等待预读线程填满窗口（或读到文件末尾）, 之后缓存范围不再变化, 可以判断跳转是否应当命中
+static bool WaitForFetch(const PrefetchCache& cache, int64_t position)
+{
+    int64_t window = (int64_t)(cache.Capacity() - cache.KeepBehind());
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (std::chrono::steady_clock::now() < deadline)
+    {
+        int64_t start, end;
+        cache.GetRange(start, end);
+        if (end >= (std::min)(cache.FileSize(), position + window))
+            return true;
+        std::this_thread::yield();
+    }
+    return false;
+}
+
+// 读取并与文件内容比较, 返回 Read 的结果; 内容不一致的字节数累加到 mismatches
+static int ReadVerified(PrefetchCache& cache, int64_t position, int size, int& mismatches)
+{
+    std::vector<uint8_t> buffer(size);
+    int result = cache.Read(buffer.data(), size);
+    for (int i = 0; i < result; i++)
+    {
+        mismatches += buffer[i] != MemoryFile::ByteAt(position + i);
+    }
+    return result;
+}
+
+TEST_CASE(PrefetchCache, SequentialReadMatchesFile)
+{
+    static const int64_t FILE_SIZE = 300 * 1024 + 17;
+    MemoryFile file(FILE_SIZE);
+    PrefetchCache cache;
+    CHECK(cache.Start(FILE_SIZE, 64 * 1024, 4096, file.Reader(), nullptr));
+
+    int64_t position = 0;
+    int mismatches = 0;
+    int size = 1;
+    while (true)
+    {
+        int result = ReadVerified(cache, position, size, mismatches);
+        if (result < 0)
+        {
+            CHECK(result == PrefetchCache::READ_EOF);
+            break;
+        }
+        position += result;
+        size = size * 3 % 20011 + 1;
+    }
+    CHECK(position == FILE_SIZE);
+    CHECK(mismatches == 0);
+
+    MediaIOStats stats = cache.GetStats();
+    CHECK(stats.bytesDelivered == (uint64_t)FILE_SIZE);
+    CHECK(stats.bytesFetched == (uint64_t)FILE_SIZE);
+}
+
+TEST_CASE(PrefetchCache, SmallFileIsCachedWhole)
+{
+    MemoryFile file(1000);
+    PrefetchCache cache;
+    CHECK(cache.Start(1000, 64 * 1024, 4096, file.Reader(), nullptr));
+    // 容量不小于单次读取的大小, 整个文件读入后任何跳转都命中
+    CHECK(cache.Capacity() == 4096);
+    CHECK(WaitForFetch(cache, 0));
+
+    int mismatches = 0;
+    CHECK(cache.Seek(900, SEEK_SET) == 900);
+    CHECK(ReadVerified(cache, 900, 200, mismatches) == 100);
+    CHECK(cache.Seek(-1000, SEEK_END) == 0);
+    CHECK(ReadVerified(cache, 0, 50, mismatches) == 50);
+    CHECK(mismatches == 0);
+    CHECK(cache.GetStats().cachedSeeks == 2);
+}
+
+TEST_CASE(PrefetchCache, EvictionKeepsBehindRegion)
+{
+    static const int64_t FILE_SIZE = 256 * 1024;
+    MemoryFile file(FILE_SIZE);
+    PrefetchCache cache;
+    CHECK(cache.Start(FILE_SIZE, 64 * 1024, 4096, file.Reader(), nullptr));
+    int64_t capacity = (int64_t)cache.Capacity();
+    int64_t keepBehind = (int64_t)cache.KeepBehind();
+    CHECK(capacity == 64 * 1024);
+    CHECK(keepBehind == capacity / 8);
+
+    // 读过几倍容量后, 最早的数据被淘汰, 但读取位置之前的 keepBehind 字节仍在缓存中
+    int mismatches = 0;
+    int64_t position = 0;
+    while (position < 150 * 1024)
+    {
+        int result = ReadVerified(cache, position, 3000, mismatches);
+        CHECK(result > 0);
+        if (result <= 0)
+            return;
+        position += result;
+    }
+    CHECK(WaitForFetch(cache, position));
+
+    int64_t start, end;
+    cache.GetRange(start, end);
+    CHECK(end == position + capacity - keepBehind);
+    CHECK(end - start == capacity);
+    CHECK(start == position - keepBehind);
+
+    // 退回到保留区的起点：命中缓存, 数据仍是文件的内容
+    CHECK(cache.Seek(-keepBehind, SEEK_CUR) == start);
+    CHECK(cache.GetStats().cachedSeeks == 1);
+    CHECK(ReadVerified(cache, start, (int)keepBehind, mismatches) == (int)keepBehind);
+
+    // 已淘汰的位置要重新读文件
+    position = start + keepBehind;
+    CHECK(WaitForFetch(cache, position));
+    cache.GetRange(start, end);
+    CHECK(cache.Seek(start - 1, SEEK_SET) == start - 1);
+    MediaIOStats stats = cache.GetStats();
+    CHECK(stats.seeks == 2);
+    CHECK(stats.cachedSeeks == 1);
+    CHECK(ReadVerified(cache, start - 1, 5000, mismatches) > 0);
+    CHECK(mismatches == 0);
+}
+
+TEST_CASE(PrefetchCache, SeeksInsideAndOutsideCache)
+{
+    static const int64_t FILE_SIZE = 512 * 1024;
+    MemoryFile file(FILE_SIZE);
+    PrefetchCache cache;
+    CHECK(cache.Start(FILE_SIZE, 64 * 1024, 4096, file.Reader(), nullptr));
+    CHECK(WaitForFetch(cache, 0));
+
+    int64_t start, end;
+    cache.GetRange(start, end);
+    CHECK(start == 0);
+
+    int mismatches = 0;
+    // 范围内和恰好在有效数据末尾的跳转命中缓存
+    CHECK(cache.Seek(end / 2, SEEK_SET) == end / 2);
+    CHECK(cache.Seek(end, SEEK_SET) == end);
+    CHECK(cache.GetStats().cachedSeeks == 2);
+    CHECK(ReadVerified(cache, end, 1000, mismatches) > 0);
+
+    // 范围之外：缓存清空, 从目标位置重新预读
+    int64_t target = 300 * 1024 + 5;
+    CHECK(cache.Seek(target, SEEK_SET) == target);
+    MediaIOStats stats = cache.GetStats();
+    CHECK(stats.seeks == 3);
+    CHECK(stats.cachedSeeks == 2);
+    // 读取不超过保留区, 缓存起点仍是跳转目标
+    CHECK(ReadVerified(cache, target, 4000, mismatches) > 0);
+    cache.GetRange(start, end);
+    CHECK(start == target);
+
+    // 文件末尾之后的跳转有效, 读取返回 EOF; 负的目标无效
+    CHECK(cache.Seek(10, SEEK_END) == FILE_SIZE + 10);
+    CHECK(cache.Read(nullptr, 0) == PrefetchCache::READ_EOF);
+    CHECK(cache.Seek(-1, SEEK_SET) == -1);
+    CHECK(cache.Seek(0, 12345) == -1);
+    CHECK(mismatches == 0);
+}
+
+TEST_CASE(PrefetchCache, StaleFetchAfterSeekIsDiscarded)
+{
+    static const int64_t FILE_SIZE = 256 * 1024;
+    MemoryFile file(FILE_SIZE);
+    file.BlockAt(16 * 1024);
+    PrefetchCache cache;
+    CHECK(cache.Start(FILE_SIZE, 32 * 1024, 4096, file.Reader(), nullptr));
+
+    // 预读线程正在读 16K 处时跳出缓存, 读回的旧数据不能出现在新位置
+    CHECK(file.WaitBlocked());
+    int64_t target = 200 * 1024 + 3;
+    CHECK(cache.Seek(target, SEEK_SET) == target);
+    file.Release();
+
+    int mismatches = 0;
+    int64_t position = target;
+    for (int i = 0; i < 20; i++)
+    {
+        int result = ReadVerified(cache, position, 2500, mismatches);
+        CHECK(result > 0);
+        if (result <= 0)
+            break;
+        position += result;
+    }
+    CHECK(mismatches == 0);
+
+    int64_t start, end;
+    cache.GetRange(start, end);
+    CHECK(start >= target);
+    CHECK(cache.GetStats().cachedSeeks == 0);
+}
+
+TEST_CASE(PrefetchCache, FileShrinksWhileReading)
+{
+    static const int64_t FILE_SIZE = 256 * 1024;
+    static const int64_t SHRUNK_SIZE = 100000;
+    MemoryFile file(FILE_SIZE);
+    PrefetchCache cache;
+    CHECK(cache.Start(FILE_SIZE, 32 * 1024, 4096, file.Reader(), nullptr));
+
+    int mismatches = 0;
+    int64_t position = 0;
+    while (position < 50 * 1024)
+    {
+        int result = ReadVerified(cache, position, 4000, mismatches);
+        CHECK(result > 0);
+        if (result <= 0)
+            return;
+        position += result;
+    }
+
+    // 预读窗口还没到达新的末尾, 之后的读取在截短处结束
+    file.Truncate(SHRUNK_SIZE);
+    while (true)
+    {
+        int result = ReadVerified(cache, position, 4000, mismatches);
+        if (result < 0)
+        {
+            CHECK(result == PrefetchCache::READ_EOF);
+            break;
+        }
+        position += result;
+    }
+    CHECK(position == SHRUNK_SIZE);
+    CHECK(mismatches == 0);
+    CHECK(cache.FileSize() == SHRUNK_SIZE);
+    CHECK(cache.Seek(0, SEEK_END) == SHRUNK_SIZE);
+    CHECK(cache.Read(nullptr, 0) == PrefetchCache::READ_EOF);
+
+    // 截短后向前跳回仍能读到数据
+    CHECK(cache.Seek(1000, SEEK_SET) == 1000);
+    CHECK(ReadVerified(cache, 1000, 3000, mismatches) == 3000);
+    CHECK(mismatches == 0);
+}
+
+TEST_CASE(PrefetchCache, ReadErrorAndInterrupt)
+{
+    static const int64_t FILE_SIZE = 64 * 1024;
+    MemoryFile file(FILE_SIZE);
+    file.FailAt(8192);
+    std::atomic<bool> interrupted(false);
+    PrefetchCache cache;
+    CHECK(cache.Start(FILE_SIZE, 64 * 1024, 4096, file.Reader(), [&interrupted]() { return interrupted.load(); }));
+
+    int mismatches = 0;
+    CHECK(ReadVerified(cache, 0, 4096, mismatches) == 4096);
+    CHECK(ReadVerified(cache, 4096, 4096, mismatches) == 4096);
+    CHECK(cache.Read(nullptr, 100) == PrefetchCache::READ_ERROR);
+
+    // 跳转清除读取错误; 等待数据时中断回调返回 true 则放弃等待
+    file.FailAt(-1);
+    file.BlockAt(0);
+    CHECK(cache.Seek(16 * 1024, SEEK_SET) == 16 * 1024);
+    CHECK(file.WaitBlocked());
+    interrupted = true;
+    CHECK(cache.Read(nullptr, 100) == PrefetchCache::READ_INTERRUPTED);
+    file.Release();
+
+    interrupted = false;
+    CHECK(ReadVerified(cache, 16 * 1024, 1000, mismatches) == 1000);
+    CHECK(mismatches == 0);
+}
+
+TEST_CASE(PrefetchCache, RandomSeekAndRead)
+{
+    static const int64_t FILE_SIZE = 1024 * 1024 + 123;
+    MemoryFile file(FILE_SIZE);
+    PrefetchCache cache;
+    CHECK(cache.Start(FILE_SIZE, 64 * 1024, 4096, file.Reader(), nullptr));
+    int64_t capacity = (int64_t)cache.Capacity();
+    int64_t keepBehind = (int64_t)cache.KeepBehind();
+
+    std::mt19937 random(12345);
+    int64_t position = 0;
+    int mismatches = 0;
+    int wrongHits = 0;
+    int wrongRanges = 0;
+    int wrongResults = 0;
+    uint64_t expectedSeeks = 0;
+    uint64_t expectedHits = 0;
+    for (int op = 0; op < 3000; op++)
+    {
+        if (random() % 4 == 0)
+        {
+            int64_t target;
+            switch (random() % 4)
+            {
+            case 0: target = random() % (FILE_SIZE + 1000); break;
+            case 1: target = position - (int64_t)(random() % (keepBehind + 1)); break;
+            case 2: target = position + (int64_t)(random() % capacity); break;
+            default: target = FILE_SIZE - (int64_t)(random() % 50000); break;
+            }
+            target = (std::max)((int64_t)0, target);
+
+            // 预读停下后缓存范围固定, 命中与否可以预先判断
+            if (!WaitForFetch(cache, position))
+            {
+                wrongRanges++;
+                break;
+            }
+            int64_t start, end;
+            cache.GetRange(start, end);
+            bool hit = target >= start && target <= end;
+
+            wrongResults += cache.Seek(target, SEEK_SET) != target;
+            expectedSeeks++;
+            expectedHits += hit;
+            wrongHits += cache.GetStats().cachedSeeks != expectedHits;
+            position = target;
+        }
+        else
+        {
+            int size = 1 + (int)(random() % 20000);
+            int result = ReadVerified(cache, position, size, mismatches);
+            if (position >= FILE_SIZE)
+            {
+                wrongResults += result != PrefetchCache::READ_EOF;
+            }
+            else
+            {
+                wrongResults += result <= 0 || result > size;
+                if (result > 0)
+                    position += result;
+            }
+        }
+
+        int64_t start, end;
+        cache.GetRange(start, end);
+        wrongRanges += end - start > capacity || start > end;
+    }
+
+    CHECK(mismatches == 0);
+    CHECK(wrongHits == 0);
+    CHECK(wrongRanges == 0);
+    CHECK(wrongResults == 0);
+    CHECK(cache.GetStats().seeks == expectedSeeks);
+    CHECK(expectedHits > 0 && expectedHits < expectedSeeks);
+}
@@ -0,0 +1,161 @@
+#include "TestHarness.h"
+#include "SoftwareScaler.h"
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+// BGRA 测试图像：各通道是不同方向的渐变加少量伪随机扰动
+static std::vector<uint8_t> MakeImage(int width, int height, int stride)
+{
+    std::vector<uint8_t> image((size_t)stride * height, 0);
+    unsigned seed = 12345;
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            seed = seed * 1103515245u + 12345u;
+            uint8_t* pixel = &image[(size_t)y * stride + x * 4];
+            pixel[0] = (uint8_t)(x * 255 / (width > 1 ? width - 1 : 1));
+            pixel[1] = (uint8_t)(y * 255 / (height > 1 ? height - 1 : 1));
+            pixel[2] = (uint8_t)((seed >> 16) & 0xFF);
+            pixel[3] = 255;
+        }
+    }
+    return image;
+}
+
+// 双精度参考：与缩放器相同的像素中心对齐映射, 边缘钳位
+static double ReferenceTap(int i, int srcSize, int dstSize, int& index)
+{
+    double pos = (i + 0.5) * srcSize / dstSize - 0.5;
+    if (pos < 0.0)
+        pos = 0.0;
+    if (pos > srcSize - 1)
+        pos = srcSize - 1;
+    index = (int)pos;
+    return pos - index;
+}
+
+static int MaxDifferenceFromReference(const std::vector<uint8_t>& src, int srcWidth, int srcHeight, int srcStride,
+                                      const std::vector<uint8_t>& dst, int dstWidth, int dstHeight, int dstStride)
+{
+    int maxDiff = 0;
+    for (int y = 0; y < dstHeight; y++)
+    {
+        int y0 = 0;
+        double fy = ReferenceTap(y, srcHeight, dstHeight, y0);
+        int y1 = y0 + 1 < srcHeight ? y0 + 1 : y0;
+        for (int x = 0; x < dstWidth; x++)
+        {
+            int x0 = 0;
+            double fx = ReferenceTap(x, srcWidth, dstWidth, x0);
+            int x1 = x0 + 1 < srcWidth ? x0 + 1 : x0;
+            for (int c = 0; c < 4; c++)
+            {
+                double p00 = src[(size_t)y0 * srcStride + x0 * 4 + c];
+                double p01 = src[(size_t)y0 * srcStride + x1 * 4 + c];
+                double p10 = src[(size_t)y1 * srcStride + x0 * 4 + c];
+                double p11 = src[(size_t)y1 * srcStride + x1 * 4 + c];
+                double top = p00 + (p01 - p00) * fx;
+                double bottom = p10 + (p11 - p10) * fx;
+                int expected = (int)lround(top + (bottom - top) * fy);
+                int actual = dst[(size_t)y * dstStride + x * 4 + c];
+                maxDiff = (std::max)(maxDiff, std::abs(actual - expected));
+            }
+        }
+    }
+    return maxDiff;
+}
+
+static std::vector<uint8_t> ScaleImage(SoftwareScaler& scaler, const std::vector<uint8_t>& src, int srcWidth, int srcHeight,
+                                       int srcStride, int dstWidth, int dstHeight, int dstStride)
+{
+    std::vector<uint8_t> dst((size_t)dstStride * dstHeight, 0xCD);
+    CHECK(scaler.Configure(srcWidth, srcHeight, dstWidth, dstHeight));
+    scaler.Scale(src.data(), srcStride, dst.data(), dstStride);
+    return dst;
+}
+
+TEST_CASE(SoftwareScaler, SameSizeIsExact)
+{
+    SoftwareScaler scaler;
+    std::vector<uint8_t> src = MakeImage(37, 21, 37 * 4 + 12);
+    std::vector<uint8_t> dst = ScaleImage(scaler, src, 37, 21, 37 * 4 + 12, 37, 21, 37 * 4);
+    CHECK(MaxDifferenceFromReference(src, 37, 21, 37 * 4 + 12, dst, 37, 21, 37 * 4) == 0);
+}
+
+TEST_CASE(SoftwareScaler, MatchesBilinearReference)
+{
+    // 放大、缩小、非等比以及宽度不是 4 的倍数（覆盖 SIMD 尾部）
+    const int sizes[][4] = {
+        { 64, 48, 157, 93 },
+        { 160, 90, 33, 17 },
+        { 45, 30, 46, 120 },
+        { 1, 1, 9, 5 },
+        { 7, 3, 2, 1 },
+    };
+    SoftwareScaler scaler;
+    for (const int* size : sizes)
+    {
+        int srcStride = size[0] * 4 + 4;
+        int dstStride = size[2] * 4;
+        std::vector<uint8_t> src = MakeImage(size[0], size[1], srcStride);
+        std::vector<uint8_t> dst = ScaleImage(scaler, src, size[0], size[1], srcStride, size[2], size[3], dstStride);
+        CHECK(MaxDifferenceFromReference(src, size[0], size[1], srcStride, dst, size[2], size[3], dstStride) <= 1);
+    }
+}
+
+TEST_CASE(SoftwareScaler, ThreadCountDoesNotChangeOutput)
+{
+    const int srcWidth = 300, srcHeight = 200, dstWidth = 533, dstHeight = 301;
+    std::vector<uint8_t> src = MakeImage(srcWidth, srcHeight, srcWidth * 4);
+
+    SoftwareScaler single;
+    single.SetThreadCount(1);
+    std::vector<uint8_t> expected = ScaleImage(single, src, srcWidth, srcHeight, srcWidth * 4, dstWidth, dstHeight, dstWidth * 4);
+
+    for (int threads = 2; threads <= 8; threads *= 2)
+    {
+        SoftwareScaler scaler;
+        scaler.SetThreadCount(threads);
+        // 连续多帧, 检查常驻工作线程在多次调用之间的交接
+        for (int frame = 0; frame < 4; frame++)
+        {
+            CHECK(ScaleImage(scaler, src, srcWidth, srcHeight, srcWidth * 4, dstWidth, dstHeight, dstWidth * 4) == expected);
+        }
+    }
+}
+
+TEST_CASE(SoftwareScaler, RejectsEmptySizes)
+{
+    SoftwareScaler scaler;
+    CHECK(!scaler.Configure(0, 10, 10, 10));
+    CHECK(!scaler.Configure(10, 10, 10, -1));
+}
+
+BENCHMARK(SoftwareScaler, Upscale1080p)
+{
+    const int srcWidth = 1280, srcHeight = 720, dstWidth = 1920, dstHeight = 1080;
+    std::vector<uint8_t> src = MakeImage(srcWidth, srcHeight, srcWidth * 4);
+    std::vector<uint8_t> dst((size_t)dstWidth * 4 * dstHeight);
+
+    const int threadCounts[] = { 1, 0 };
+    for (int threads : threadCounts)
+    {
+        SoftwareScaler scaler;
+        scaler.SetThreadCount(threads);
+        scaler.Configure(srcWidth, srcHeight, dstWidth, dstHeight);
+
+        int frames = 0;
+        double start = BenchNowSeconds();
+        double elapsed = 0.0;
+        while (elapsed < 0.3)
+        {
+            scaler.Scale(src.data(), srcWidth * 4, dst.data(), dstWidth * 4);
+            frames++;
+            elapsed = BenchNowSeconds() - start;
+        }
+        ReportThroughput(threads == 1 ? "720p -> 1080p, 1 thread" : "720p -> 1080p, all cores",
+                         (double)frames * dstWidth * dstHeight, elapsed, "pixels");
+    }
+}
@@ -0,0 +1,179 @@
+#include "TestHarness.h"
+#include "StartupTrace.h"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// StartupTrace 是进程级单例, 本文件的用例按注册顺序运行并依赖前一个用例留下的会话状态
+static const char* TRACE_PATH = "startup_trace_test.json";
+
+static std::vector<std::string> ReadTraceLines()
+{
+    std::ifstream in(TRACE_PATH);
+    std::vector<std::string> lines;
+    std::string line;
+    while (std::getline(in, line))
+    {
+        lines.push_back(line);
+    }
+    in.close();
+    remove(TRACE_PATH);
+    return lines;
+}
+
+static int CountLines(const std::vector<std::string>& lines, const std::string& text)
+{
+    int count = 0;
+    for (const std::string& line : lines)
+    {
+        if (line.find(text) != std::string::npos)
+            count++;
+    }
+    return count;
+}
+
+TEST_CASE(StartupTrace, SessionKeepsProcessEventsAndThreadNames)
+{
+    StartupTrace& trace = StartupTrace::Instance();
+
+    // 第一次打开之前：进程启动阶段的事件
+    CHECK(trace.IsRecording());
+    trace.SetThreadName("ui");
+    trace.Complete("process init", 1.0, 3.5);
+    trace.Instant("window created");
+
+    trace.BeginSession("first.mp4");
+    std::thread worker([&trace]() {
+        trace.SetThreadName("open");
+        trace.Complete("avformat_open_input", 4.0, 9.0);
+    });
+    worker.join();
+    trace.Instant("first packet");
+    CHECK(trace.FinishSession(TRACE_PATH));
+    CHECK(!trace.IsRecording());
+
+    std::vector<std::string> lines = ReadTraceLines();
+    CHECK(lines.size() >= 2);
+    CHECK(lines.front() == "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [");
+    CHECK(lines.back() == "]}");
+    CHECK(CountLines(lines, "\"name\": \"process init\", \"ts\": 1000.000, \"dur\": 2500.000}") == 1);
+    CHECK(CountLines(lines, "\"name\": \"window created\"") == 1);
+    CHECK(CountLines(lines, "\"name\": \"avformat_open_input\", \"ts\": 4000.000, \"dur\": 5000.000}") == 1);
+    CHECK(CountLines(lines, "\"name\": \"first packet\"") == 1);
+    CHECK(CountLines(lines, "\"name\": \"time to first frame: first.mp4\"") == 1);
+    CHECK(CountLines(lines, "\"args\": {\"name\": \"ui\"}") == 1);
+    CHECK(CountLines(lines, "\"args\": {\"name\": \"open\"}") == 1);
+
+    // 两个线程的编号不同
+    size_t uiLine = 0, openLine = 0;
+    for (size_t i = 0; i < lines.size(); i++)
+    {
+        if (lines[i].find("\"args\": {\"name\": \"ui\"}") != std::string::npos)
+            uiLine = i;
+        if (lines[i].find("\"args\": {\"name\": \"open\"}") != std::string::npos)
+            openLine = i;
+    }
+    std::string uiTid = lines[uiLine].substr(0, lines[uiLine].find(", \"ph\""));
+    std::string openTid = lines[openLine].substr(0, lines[openLine].find(", \"ph\""));
+    CHECK(uiTid != openTid);
+}
+
+TEST_CASE(StartupTrace, FinishStopsRecordingUntilNextSession)
+{
+    StartupTrace& trace = StartupTrace::Instance();
+    CHECK(!trace.IsRecording());
+
+    // 停止后的阶段和时间点不记录, 线程名称仍然记录; 重复 Finish 不再导出
+    trace.Complete("after finish", 10.0, 11.0);
+    trace.Instant("late instant");
+    trace.SetThreadName("ui renamed");
+    CHECK(!trace.FinishSession(TRACE_PATH));
+
+    // 第二次打开：上一次打开的事件被丢弃, 进程启动阶段和线程名称保留
+    trace.BeginSession("second.mp4");
+    CHECK(trace.IsRecording());
+    trace.Instant("second packet");
+    CHECK(trace.FinishSession(TRACE_PATH));
+
+    std::vector<std::string> lines = ReadTraceLines();
+    CHECK(CountLines(lines, "\"name\": \"process init\"") == 1);
+    CHECK(CountLines(lines, "\"name\": \"window created\"") == 1);
+    CHECK(CountLines(lines, "\"name\": \"avformat_open_input\"") == 0);
+    CHECK(CountLines(lines, "\"name\": \"first packet\"") == 0);
+    CHECK(CountLines(lines, "first.mp4") == 0);
+    CHECK(CountLines(lines, "\"name\": \"second packet\"") == 1);
+    CHECK(CountLines(lines, "\"name\": \"time to first frame: second.mp4\"") == 1);
+    CHECK(CountLines(lines, "after finish") == 0);
+    CHECK(CountLines(lines, "late instant") == 0);
+    CHECK(CountLines(lines, "\"args\": {\"name\": \"ui renamed\"}") == 1);
+    CHECK(CountLines(lines, "\"args\": {\"name\": \"ui\"}") == 0);
+    CHECK(CountLines(lines, "\"args\": {\"name\": \"open\"}") == 1);
+}
+
+TEST_CASE(StartupTrace, EventsHaveTheirPhaseFields)
+{
+    StartupTrace& trace = StartupTrace::Instance();
+    trace.BeginSession("phases.mp4");
+    {
+        StartupTraceScope scope("scoped stage");
+    }
+    trace.Instant("instant");
+    CHECK(trace.FinishSession(TRACE_PATH));
+
+    // X 事件带 dur, 时间点事件带 s 且没有 dur, 线程名称事件只有 args
+    std::vector<std::string> lines = ReadTraceLines();
+    int complete = 0, instant = 0, metadata = 0;
+    for (size_t i = 1; i + 1 < lines.size(); i++)
+    {
+        const std::string& line = lines[i];
+        bool hasDur = line.find("\"dur\": ") != std::string::npos;
+        bool hasScope = line.find("\"s\": \"p\"") != std::string::npos;
+        if (line.find("\"ph\": \"X\"") != std::string::npos)
+        {
+            CHECK(hasDur && !hasScope);
+            CHECK(line.find("\"cat\": \"startup\"") != std::string::npos);
+            complete++;
+        }
+        else if (line.find("\"ph\": \"i\"") != std::string::npos)
+        {
+            CHECK(hasScope && !hasDur);
+            CHECK(line.find("\"ts\": ") != std::string::npos);
+            instant++;
+        }
+        else
+        {
+            CHECK(line.find("\"ph\": \"M\", \"name\": \"thread_name\"") != std::string::npos);
+            CHECK(!hasDur && !hasScope);
+            metadata++;
+        }
+        // 除最后一个事件外每行以逗号结尾
+        CHECK(line.back() == ((i + 2 < lines.size()) ? ',' : '}'));
+    }
+    CHECK(complete == 3);       // process init、scoped stage、time to first frame
+    CHECK(instant == 2);        // window created、instant
+    CHECK(metadata == 2);
+}
+
+TEST_CASE(StartupTrace, JsonEscapesPathsAndNames)
+{
+    StartupTrace& trace = StartupTrace::Instance();
+    trace.BeginSession("C:\\Videos\\\"clip\"\t1.mp4");
+    std::thread worker([&trace]() {
+        trace.SetThreadName("dec\"oder\\1\x01");
+    });
+    worker.join();
+    CHECK(trace.FinishSession(TRACE_PATH));
+
+    std::ifstream in(TRACE_PATH);
+    std::stringstream content;
+    content << in.rdbuf();
+    in.close();
+    remove(TRACE_PATH);
+    std::string json = content.str();
+    CHECK(json.find("\"name\": \"time to first frame: C:\\\\Videos\\\\\\\"clip\\\"\\t1.mp4\"") != std::string::npos);
+    CHECK(json.find("\"args\": {\"name\": \"dec\\\"oder\\\\1\\u0001\"}") != std::string::npos);
+    CHECK(json.find('\t') == std::string::npos);
+}
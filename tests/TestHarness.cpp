@@ -0,0 +1,96 @@
+#include "TestHarness.h"
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+struct RegisteredTest {
+    const char* group;
+    const char* name;
+    TestFunction function;
+    bool benchmark;
+};
+
+static std::vector<RegisteredTest>& Registry()
+{
+    static std::vector<RegisteredTest> tests;
+    return tests;
+}
+
+static int s_failures = 0;
+
+TestRegistrar::TestRegistrar(const char* group, const char* name, TestFunction function, bool benchmark)
+{
+    Registry().push_back({ group, name, function, benchmark });
+}
+
+void ReportCheckFailure(const char* file, int line, const char* expression)
+{
+    std::cerr << file << ":" << line << ": CHECK(" << expression << ") failed" << std::endl;
+    s_failures++;
+}
+
+void ReportNearFailure(const char* file, int line, const char* expression, double actual, double expected, double tolerance)
+{
+    std::cerr << file << ":" << line << ": " << expression << " = " << actual
+              << ", expected " << expected << " +/- " << tolerance << std::endl;
+    s_failures++;
+}
+
+double BenchNowSeconds()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void ReportThroughput(const char* label, double count, double seconds, const char* unit)
+{
+    std::cout << "  " << label << ": " << (seconds > 0.0 ? count / seconds / 1e6 : 0.0)
+              << " M" << unit << "/s" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    bool benchmark = false;
+    std::vector<std::string> groups;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--bench") == 0)
+            benchmark = true;
+        else
+            groups.push_back(argv[i]);
+    }
+
+    int run = 0;
+    int failed = 0;
+    for (const RegisteredTest& test : Registry())
+    {
+        if (test.benchmark != benchmark)
+            continue;
+        bool selected = groups.empty();
+        for (const std::string& group : groups)
+        {
+            selected = selected || group == test.group;
+        }
+        if (!selected)
+            continue;
+
+        int failuresBefore = s_failures;
+        std::cout << "[ RUN  ] " << test.group << "." << test.name << std::endl;
+        test.function();
+        bool passed = s_failures == failuresBefore;
+        std::cout << (passed ? "[  OK  ] " : "[ FAIL ] ") << test.group << "." << test.name << std::endl;
+        run++;
+        if (!passed)
+            failed++;
+    }
+
+    // 分组名写错时不能当作通过
+    if (run == 0)
+    {
+        std::cerr << "No " << (benchmark ? "benchmarks" : "tests") << " matched" << std::endl;
+        return 1;
+    }
+    std::cout << run - failed << "/" << run << (benchmark ? " benchmarks" : " tests") << " passed" << std::endl;
+    return failed == 0 ? 0 : 1;
+}
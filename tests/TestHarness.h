@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cmath>
+
+// 可移植模块的测试与基准 - 用例由 TEST_CASE / BENCHMARK 在静态初始化时注册
+// portable_tests [分组...] 运行测试, portable_tests --bench [分组...] 运行基准, 不指定分组时运行全部
+typedef void (*TestFunction)();
+
+struct TestRegistrar {
+    TestRegistrar(const char* group, const char* name, TestFunction function, bool benchmark);
+};
+
+// 断言失败时输出位置, 当前用例记为失败并继续执行
+void ReportCheckFailure(const char* file, int line, const char* expression);
+void ReportNearFailure(const char* file, int line, const char* expression, double actual, double expected, double tolerance);
+
+// 基准：单调时钟（秒）; count 个单位耗时 seconds 秒, 输出每秒处理的单位数
+double BenchNowSeconds();
+void ReportThroughput(const char* label, double count, double seconds, const char* unit);
+
+#define TEST_CASE(group, name) \
+    static void group##_##name(); \
+    static TestRegistrar group##_##name##_registrar(#group, #name, group##_##name, false); \
+    static void group##_##name()
+
+#define BENCHMARK(group, name) \
+    static void group##_##name(); \
+    static TestRegistrar group##_##name##_registrar(#group, #name, group##_##name, true); \
+    static void group##_##name()
+
+#define CHECK(expression) \
+    do { if (!(expression)) ReportCheckFailure(__FILE__, __LINE__, #expression); } while (0)
+
+#define CHECK_NEAR(actual, expected, tolerance) \
+    do { \
+        double checkActual = (double)(actual); \
+        double checkExpected = (double)(expected); \
+        if (!(std::fabs(checkActual - checkExpected) <= (tolerance))) \
+            ReportNearFailure(__FILE__, __LINE__, #actual, checkActual, checkExpected, (tolerance)); \
+    } while (0)
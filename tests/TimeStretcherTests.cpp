@@ -0,0 +1,148 @@
+#include "TestHarness.h"
+#include "TimeStretcher.h"
+#include <cmath>
+#include <vector>
+
+static const int SAMPLE_RATE = 44100;
+static const int BLOCK_FRAMES = 1024;
+static const double PI = 3.14159265358979323846;
+
+// 以解码器的块大小把 seconds 秒的正弦波送入伸缩器, 返回全部输出（左声道）
+static std::vector<float> StretchSine(TimeStretcher& stretcher, double frequency, double seconds)
+{
+    int totalFrames = (int)(seconds * SAMPLE_RATE);
+    std::vector<float> left(BLOCK_FRAMES), right(BLOCK_FRAMES);
+    std::vector<float> output;
+    for (int start = 0; start < totalFrames; start += BLOCK_FRAMES)
+    {
+        int frames = (totalFrames - start < BLOCK_FRAMES) ? totalFrames - start : BLOCK_FRAMES;
+        for (int i = 0; i < frames; i++)
+        {
+            left[i] = (float)(0.5 * std::sin(2.0 * PI * frequency * (start + i) / SAMPLE_RATE));
+            right[i] = left[i];
+        }
+        double outPts = NAN;
+        int produced = stretcher.Process(left.data(), right.data(), frames, (double)start / SAMPLE_RATE, outPts);
+        for (int i = 0; i < produced; i++)
+        {
+            CHECK(stretcher.OutputLeft()[i] == stretcher.OutputRight()[i]);
+        }
+        output.insert(output.end(), stretcher.OutputLeft(), stretcher.OutputLeft() + produced);
+    }
+    return output;
+}
+
+// 上升过零点的间隔估计频率（线性插值过零位置）
+static double EstimateFrequency(const std::vector<float>& samples, int begin, int end)
+{
+    double first = -1.0, last = -1.0;
+    int crossings = 0;
+    for (int i = begin + 1; i < end; i++)
+    {
+        if (samples[i - 1] < 0.0f && samples[i] >= 0.0f)
+        {
+            double position = i - 1 + samples[i - 1] / (samples[i - 1] - samples[i]);
+            if (first < 0.0)
+                first = position;
+            last = position;
+            crossings++;
+        }
+    }
+    if (crossings < 2)
+        return 0.0;
+    return (crossings - 1) * (double)SAMPLE_RATE / (last - first);
+}
+
+TEST_CASE(TimeStretcher, OutputLengthFollowsSpeed)
+{
+    const double speeds[] = { 0.5, 1.0, 2.0, 4.0 };
+    const double seconds = 4.0;
+    for (double speed : speeds)
+    {
+        TimeStretcher stretcher;
+        stretcher.Configure(SAMPLE_RATE);
+        stretcher.SetSpeed(speed);
+        CHECK(stretcher.GetSpeed() == speed);
+
+        std::vector<float> output = StretchSine(stretcher, 440.0, seconds);
+        // 尾部最多留下一个窗口加搜索范围的输入未处理（约 46ms 输入）, 最后一段另有一个跳跃的输出误差
+        double expected = seconds * SAMPLE_RATE / speed;
+        double slack = 0.05 * SAMPLE_RATE / speed + SAMPLE_RATE * 15 / 1000;
+        CHECK_NEAR((double)output.size(), expected, slack);
+    }
+}
+
+TEST_CASE(TimeStretcher, SpeedIsClamped)
+{
+    TimeStretcher stretcher;
+    stretcher.SetSpeed(8.0);
+    CHECK(stretcher.GetSpeed() == 4.0);
+    stretcher.SetSpeed(0.1);
+    CHECK(stretcher.GetSpeed() == 0.5);
+}
+
+TEST_CASE(TimeStretcher, PitchIsPreserved)
+{
+    const double speeds[] = { 0.5, 1.0, 2.0, 4.0 };
+    const double frequencies[] = { 220.0, 440.0, 1000.0 };
+    for (double speed : speeds)
+    {
+        for (double frequency : frequencies)
+        {
+            TimeStretcher stretcher;
+            stretcher.Configure(SAMPLE_RATE);
+            stretcher.SetSpeed(speed);
+            std::vector<float> output = StretchSine(stretcher, frequency, 2.0);
+
+            // 跳过第一个窗口的淡入, 稳态部分的频率不随速度变化
+            int begin = SAMPLE_RATE * 30 / 1000;
+            CHECK_NEAR(EstimateFrequency(output, begin, (int)output.size()), frequency, frequency * 0.01);
+        }
+    }
+}
+
+TEST_CASE(TimeStretcher, OutputPtsFollowsInput)
+{
+    TimeStretcher stretcher;
+    stretcher.Configure(SAMPLE_RATE);
+    stretcher.SetSpeed(2.0);
+    std::vector<float> silence(SAMPLE_RATE, 0.0f);
+    double outPts = NAN;
+    int produced = stretcher.Process(silence.data(), nullptr, SAMPLE_RATE, 10.0, outPts);
+    CHECK(produced > 0);
+    CHECK_NEAR(outPts, 10.0, 1e-9);
+}
+
+TEST_CASE(TimeStretcher, ResetClearsOverlapState)
+{
+    TimeStretcher stretcher;
+    stretcher.Configure(SAMPLE_RATE);
+    stretcher.SetSpeed(2.0);
+    StretchSine(stretcher, 440.0, 0.5);
+
+    // 跳转：Reset 丢弃缓存的输入和重叠尾部, 之后的静音输入只产生静音, 时间戳从新位置开始
+    stretcher.Reset();
+    std::vector<float> silence(SAMPLE_RATE / 2, 0.0f);
+    double outPts = NAN;
+    int produced = stretcher.Process(silence.data(), silence.data(), (int)silence.size(), 30.0, outPts);
+    CHECK(produced > 0);
+    CHECK_NEAR(outPts, 30.0, 1e-9);
+    for (int i = 0; i < produced; i++)
+    {
+        CHECK(stretcher.OutputLeft()[i] == 0.0f);
+        CHECK(stretcher.OutputRight()[i] == 0.0f);
+    }
+
+    // 对照：不 Reset 时上一段的尾部会混入
+    TimeStretcher unreset;
+    unreset.Configure(SAMPLE_RATE);
+    unreset.SetSpeed(2.0);
+    StretchSine(unreset, 440.0, 0.5);
+    produced = unreset.Process(silence.data(), silence.data(), (int)silence.size(), 30.0, outPts);
+    bool sawTail = false;
+    for (int i = 0; i < produced; i++)
+    {
+        sawTail = sawTail || unreset.OutputLeft()[i] != 0.0f;
+    }
+    CHECK(sawTail);
+}
@@ -0,0 +1,105 @@
+#include "TestHarness.h"
+#include "WorkStealingPool.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+TEST_CASE(WorkStealingPool, RunsInlineWhenNotStarted)
+{
+    WorkStealingPool pool;
+    std::thread::id runner;
+    pool.Submit([&]() { runner = std::this_thread::get_id(); });
+    CHECK(runner == std::this_thread::get_id());
+    CHECK(pool.GetStats().executedTasks == 1);
+}
+
+TEST_CASE(WorkStealingPool, ExecutesEveryTaskOnce)
+{
+    static const int TASKS = 5000;
+    std::vector<std::atomic<int>> hits(TASKS);
+    for (std::atomic<int>& hit : hits)
+    {
+        hit = 0;
+    }
+
+    WorkStealingPool pool;
+    pool.Start(4);
+    CHECK(pool.ThreadCount() == 4);
+    for (int i = 0; i < TASKS; i++)
+    {
+        pool.Submit([&hits, i]() { hits[i]++; });
+    }
+    pool.WaitIdle();
+
+    int wrong = 0;
+    for (std::atomic<int>& hit : hits)
+    {
+        wrong += (hit != 1);
+    }
+    CHECK(wrong == 0);
+    CHECK(pool.GetStats().executedTasks == (uint64_t)TASKS);
+}
+
+TEST_CASE(WorkStealingPool, NestedSubmitsAreWaitedFor)
+{
+    // 工作线程内提交的任务进入自己的队列, WaitIdle 也要等它们执行完
+    std::atomic<int> leaves(0);
+    WorkStealingPool pool;
+    pool.Start(3);
+    for (int i = 0; i < 8; i++)
+    {
+        pool.Submit([&]() {
+            for (int j = 0; j < 16; j++)
+            {
+                pool.Submit([&]() { leaves++; });
+            }
+        });
+    }
+    pool.WaitIdle();
+    CHECK(leaves == 8 * 16);
+}
+
+TEST_CASE(WorkStealingPool, IdleWorkersStealFromBusyQueue)
+{
+    // 一个任务把子任务全部放进自己的队列后忙等; 其它线程只能靠窃取执行它们
+    static const int CHILDREN = 64;
+    std::atomic<int> done(0);
+    WorkStealingPool pool;
+    pool.Start(4);
+    pool.Submit([&]() {
+        for (int i = 0; i < CHILDREN; i++)
+        {
+            pool.Submit([&]() { done++; });
+        }
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (done < CHILDREN && std::chrono::steady_clock::now() < deadline)
+        {
+            std::this_thread::yield();
+        }
+    });
+    pool.WaitIdle();
+
+    CHECK(done == CHILDREN);
+    CHECK(pool.GetStats().stolenTasks >= 1);
+}
+
+TEST_CASE(WorkStealingPool, StopDrainsQueuedTasks)
+{
+    std::atomic<int> count(0);
+    WorkStealingPool pool;
+    pool.Start(2);
+    for (int i = 0; i < 200; i++)
+    {
+        pool.Submit([&]() { count++; });
+    }
+    pool.Stop();
+    CHECK(count == 200);
+    CHECK(pool.ThreadCount() == 0);
+
+    // 停止后可以重新启动
+    pool.Start(2);
+    pool.Submit([&]() { count++; });
+    pool.WaitIdle();
+    CHECK(count == 201);
+}
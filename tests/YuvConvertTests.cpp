@@ -0,0 +1,159 @@
+#include "TestHarness.h"
+#include "YuvConvert.h"
+
+// 8 位 YUV → 期望 RGB 的参考向量（100% 彩条的原色、黑、白）
+// 取自 BT.601 / BT.709 标准中 R'G'B' → Y'CbCr 的整数化结果, 反变换回 RGB 允许 ±2 的舍入误差
+struct YuvVector {
+    uint8_t y, u, v;
+    uint8_t r, g, b;
+};
+
+static const YuvVector BT601_LIMITED[] = {
+    {  16, 128, 128,    0,   0,   0 },
+    { 235, 128, 128,  255, 255, 255 },
+    { 126, 128, 128,  128, 128, 128 },
+    {  81,  90, 240,  255,   0,   0 },
+    { 145,  54,  34,    0, 255,   0 },
+    {  41, 240, 110,    0,   0, 255 },
+    { 210,  16, 146,  255, 255,   0 },
+};
+
+static const YuvVector BT601_FULL[] = {
+    {   0, 128, 128,    0,   0,   0 },
+    { 255, 128, 128,  255, 255, 255 },
+    {  76,  85, 255,  255,   0,   0 },
+    { 150,  44,  21,    0, 255,   0 },
+    {  29, 255, 107,    0,   0, 255 },
+};
+
+static const YuvVector BT709_LIMITED[] = {
+    {  16, 128, 128,    0,   0,   0 },
+    { 235, 128, 128,  255, 255, 255 },
+    {  63, 102, 240,  255,   0,   0 },
+    { 173,  42,  26,    0, 255,   0 },
+    {  32, 240, 118,    0,   0, 255 },
+};
+
+static const YuvVector BT709_FULL[] = {
+    {   0, 128, 128,    0,   0,   0 },
+    { 255, 128, 128,  255, 255, 255 },
+    {  54,  99, 255,  255,   0,   0 },
+    { 182,  30,  12,    0, 255,   0 },
+    {  18, 255, 116,    0,   0, 255 },
+};
+
+// 用 2x2 的 4:2:0 纯色图像走一遍参考转换, 返回左上角像素的 BGRA
+static void ConvertSolid(const YuvVector& vector, const YuvToRgbMatrix& matrix, uint8_t bgra[4])
+{
+    uint8_t lumaPlane[4] = { vector.y, vector.y, vector.y, vector.y };
+    uint8_t uPlane[1] = { vector.u };
+    uint8_t vPlane[1] = { vector.v };
+    const uint8_t* planes[3] = { lumaPlane, uPlane, vPlane };
+    const int strides[3] = { 2, 1, 1 };
+
+    uint8_t dst[2 * 2 * 4];
+    ConvertYuvToBgraReference(planes, strides, 2, 2, 1, 1, matrix, dst, 2 * 4, 2, 2);
+    for (int i = 0; i < 4; i++)
+    {
+        bgra[i] = dst[i];
+    }
+}
+
+template <size_t N>
+static void CheckVectors(const YuvVector (&vectors)[N], YuvColorSpace colorSpace, bool fullRange)
+{
+    YuvToRgbMatrix matrix = MakeYuvToRgbMatrix(colorSpace, fullRange);
+    for (const YuvVector& vector : vectors)
+    {
+        uint8_t bgra[4];
+        ConvertSolid(vector, matrix, bgra);
+        CHECK_NEAR(bgra[2], vector.r, 2);
+        CHECK_NEAR(bgra[1], vector.g, 2);
+        CHECK_NEAR(bgra[0], vector.b, 2);
+        CHECK(bgra[3] == 255);
+    }
+}
+
+TEST_CASE(YuvConvert, Bt601LimitedRange)
+{
+    CheckVectors(BT601_LIMITED, YuvColorSpace::BT601, false);
+}
+
+TEST_CASE(YuvConvert, Bt601FullRange)
+{
+    CheckVectors(BT601_FULL, YuvColorSpace::BT601, true);
+}
+
+TEST_CASE(YuvConvert, Bt709LimitedRange)
+{
+    CheckVectors(BT709_LIMITED, YuvColorSpace::BT709, false);
+}
+
+TEST_CASE(YuvConvert, Bt709FullRange)
+{
+    CheckVectors(BT709_FULL, YuvColorSpace::BT709, true);
+}
+
+TEST_CASE(YuvConvert, MatrixMatchesPublishedCoefficients)
+{
+    // 有限范围的常用系数: R = 1.164(Y-16) + 1.596(V-128) 等
+    YuvToRgbMatrix bt601 = MakeYuvToRgbMatrix(YuvColorSpace::BT601, false);
+    CHECK_NEAR(bt601.rows[0][0], 1.164, 1e-3);
+    CHECK_NEAR(bt601.rows[0][1], 0.0, 1e-6);
+    CHECK_NEAR(bt601.rows[0][2], 1.596, 1e-3);
+    CHECK_NEAR(bt601.rows[1][1], -0.392, 1e-3);
+    CHECK_NEAR(bt601.rows[1][2], -0.813, 1e-3);
+    CHECK_NEAR(bt601.rows[2][1], 2.017, 1e-3);
+    CHECK_NEAR(bt601.rows[2][2], 0.0, 1e-6);
+
+    YuvToRgbMatrix bt709 = MakeYuvToRgbMatrix(YuvColorSpace::BT709, false);
+    CHECK_NEAR(bt709.rows[0][2], 1.793, 1e-3);
+    CHECK_NEAR(bt709.rows[1][1], -0.213, 1e-3);
+    CHECK_NEAR(bt709.rows[1][2], -0.533, 1e-3);
+    CHECK_NEAR(bt709.rows[2][1], 2.112, 1e-3);
+
+    // 全范围 BT.601 即 JPEG 的系数
+    YuvToRgbMatrix jpeg = MakeYuvToRgbMatrix(YuvColorSpace::BT601, true);
+    CHECK_NEAR(jpeg.rows[0][0], 1.0, 1e-6);
+    CHECK_NEAR(jpeg.rows[0][2], 1.402, 1e-3);
+    CHECK_NEAR(jpeg.rows[1][1], -0.344, 1e-3);
+    CHECK_NEAR(jpeg.rows[1][2], -0.714, 1e-3);
+    CHECK_NEAR(jpeg.rows[2][1], 1.772, 1e-3);
+}
+
+TEST_CASE(YuvConvert, ColorSpaceAndRangeMatter)
+{
+    // BT.709 的红色按 BT.601 解释会明显偏色; 有限范围的黑按全范围解释不是纯黑
+    uint8_t bgra[4];
+    ConvertSolid(BT709_LIMITED[2], MakeYuvToRgbMatrix(YuvColorSpace::BT601, false), bgra);
+    CHECK(bgra[1] > 10 || bgra[0] > 10 || bgra[2] < 245);
+
+    ConvertSolid(BT601_LIMITED[0], MakeYuvToRgbMatrix(YuvColorSpace::BT601, true), bgra);
+    CHECK(bgra[0] == 16 && bgra[1] == 16 && bgra[2] == 16);
+}
+
+TEST_CASE(YuvConvert, GrayscaleDropsChroma)
+{
+    uint8_t bgra[4];
+    ConvertSolid(BT601_LIMITED[3], MakeYuvToRgbMatrix(YuvColorSpace::BT601, false, true), bgra);
+    CHECK(bgra[0] == bgra[1] && bgra[1] == bgra[2]);
+    CHECK_NEAR(bgra[0], (81 - 16) * 255.0 / 219.0, 1.0);
+}
+
+TEST_CASE(YuvConvert, ChromaIsUpsampledBilinearly)
+{
+    // 4x1 亮度恒定, 2x1 色度从左到右 U 由 0 变到 255: 输出中间两列介于两端之间并单调
+    uint8_t lumaPlane[4] = { 128, 128, 128, 128 };
+    uint8_t uPlane[2] = { 0, 255 };
+    uint8_t vPlane[2] = { 128, 128 };
+    const uint8_t* planes[3] = { lumaPlane, uPlane, vPlane };
+    const int strides[3] = { 4, 2, 2 };
+
+    uint8_t dst[4 * 4];
+    ConvertYuvToBgraReference(planes, strides, 4, 1, 1, 0, MakeYuvToRgbMatrix(YuvColorSpace::BT601, true), dst, 16, 4, 1);
+    // B = Y + 1.772 (U - 0.5): 两端饱和, 中间两列由 U 插值 (0.25, 0.75) 得到
+    CHECK(dst[0] == 0);
+    CHECK(dst[12] == 255);
+    CHECK_NEAR(dst[4], (128.0 / 255.0 + 1.772 * (63.75 / 255.0 - 128.0 / 255.0)) * 255.0, 1.5);
+    CHECK_NEAR(dst[8], (128.0 / 255.0 + 1.772 * (191.25 / 255.0 - 128.0 / 255.0)) * 255.0, 1.5);
+}